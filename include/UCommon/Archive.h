@@ -23,6 +23,7 @@ SOFTWARE.
 */
 
 #pragma once
+#include "Guid.h"
 #include "Utils.h"
 
 #define UBPA_UCOMMON_ARCHIVE_TO_NAMESPACE(NameSpace) \
@@ -30,11 +31,19 @@ namespace NameSpace \
 { \
 	using IArchive = UCommon::IArchive; \
 	using FMemoryArchive = UCommon::FMemoryArchive; \
+	using FCompressedArchiveConfig = UCommon::FCompressedArchiveConfig; \
+	using FCompressedArchive = UCommon::FCompressedArchive; \
+	using FFileArchiveConfig = UCommon::FFileArchiveConfig; \
 	using FFileArchive = UCommon::FFileArchive; \
+	using FMappedFileArchive = UCommon::FMappedFileArchive; \
+	using FChunkFileArchive = UCommon::FChunkFileArchive; \
+	using FRandomAccessFile = UCommon::FRandomAccessFile; \
 }
 
 namespace UCommon
 {
+	class FThreadPool;
+
 	class UBPA_UCOMMON_API IArchive
 	{
 		struct FImpl;
@@ -99,6 +108,17 @@ namespace UCommon
 
 		virtual void Serialize(void* Pointer, uint64_t Length) {}
 
+		/**
+		 * Loading only: return a pointer to the next Length bytes of the archive and skip them,
+		 * so that the caller can use them in place instead of copying.
+		 * Returns nullptr (and consumes nothing) if the archive can't expose its storage.
+		 * The pointer is writable (writes never reach the source) and lives as long as the archive.
+		 */
+		virtual const void* SerializeView(uint64_t Length) { return nullptr; }
+
+		/** Whether SerializeView() exposes the storage, a nullptr from SerializeView() is then an error (e.g. a truncated file). */
+		virtual bool CanSerializeView() const { return false; }
+
 		void LoadVersion(uint64_t Key, int64_t Version);
 	};
 
@@ -107,14 +127,26 @@ namespace UCommon
 		struct FImpl;
 		FImpl* Impl;
 	public:
+		/** Loading from Storage, or Saving into a growing storage owned by the archive if Storage is empty. */
 		FMemoryArchive(TSpan<const uint8_t> Storage = {});
+		/**
+		 * Saving into the caller's fixed buffer (or a slice of an arena), nothing is allocated.
+		 * Writing past Capacity is an error, the extra bytes are dropped and IsValid() becomes false.
+		 */
+		FMemoryArchive(uint8_t* Buffer, uint64_t Capacity);
 		FMemoryArchive(FMemoryArchive&& Other) noexcept;
 		FMemoryArchive& operator=(FMemoryArchive&& Other) noexcept;
 		void Swap(FMemoryArchive& Other) noexcept;
 		virtual ~FMemoryArchive();
 
+		/** False once a fixed buffer overflowed or the growing storage couldn't be allocated. */
+		bool IsValid() const noexcept;
+
 		virtual void Serialize(void* Pointer, uint64_t Length) override;
 
+		/** Saving: make room for Capacity bytes in total, the storage grows geometrically anyway. */
+		void Reserve(uint64_t Capacity);
+
 		TSpan<const uint8_t> GetStorage() const;
 	};
 
@@ -133,6 +165,66 @@ namespace UCommon
 		bool IsValid() const noexcept;
 
 		virtual void Serialize(void* Pointer, uint64_t Length) override;
+		virtual const void* SerializeView(uint64_t Length) override;
+		virtual bool CanSerializeView() const override;
+
+		/** Saving: make room for Capacity bytes in total, the storage grows geometrically anyway. */
+		void Reserve(uint64_t Capacity);
+	};
+
+	struct FCompressedArchiveConfig
+	{
+		/** Saving only: bytes per independently compressed block. */
+		uint64_t BlockSize = 256 * 1024;
+		/**
+		 * Saving only: element size of the byte-plane shuffle applied before compression,
+		 * byte i of every element goes to plane i (4 suits float data). 0 or 1 disables it.
+		 */
+		uint32_t ShuffleWidth = 4;
+		/** Compress (Saving) or decompress (Loading) batches of blocks in parallel on this pool. */
+		FThreadPool* ThreadPool = nullptr;
+	};
+
+	/**
+	 * RAII, decorates another archive with block-wise compression (byte-plane shuffle + LZ),
+	 * the stream is self-delimited so that other data can follow it in the inner archive.
+	 * Versions are taken from and given back to the inner archive, like FArchiveWrapper.
+	 * Every block decompresses independently, loads are parallel with a thread pool too.
+	 */
+	class UBPA_UCOMMON_API FCompressedArchive : public IArchive
+	{
+		struct FImpl;
+		FImpl* Impl;
+	public:
+		FCompressedArchive(IArchive* InArchive, const FCompressedArchiveConfig& Config = FCompressedArchiveConfig());
+		FCompressedArchive(FCompressedArchive&& Other) noexcept;
+		FCompressedArchive& operator=(FCompressedArchive&& Other) noexcept;
+		void Swap(FCompressedArchive& Other) noexcept;
+		virtual ~FCompressedArchive();
+
+		bool IsValid() const noexcept;
+
+		virtual void Serialize(void* Pointer, uint64_t Length) override;
+
+		/** Uncompressed bytes serialized so far. */
+		uint64_t GetRawSize() const noexcept;
+		/** Bytes of the compressed stream written or read so far in the inner archive. */
+		uint64_t GetCompressedSize() const noexcept;
+	};
+
+	/** Saving options of FFileArchive. */
+	struct FFileArchiveConfig
+	{
+		/**
+		 * Size of the write buffer in bytes.
+		 * 0 writes every Serialize call straight to the stream.
+		 */
+		uint64_t BufferSize = 0;
+		/**
+		 * With a BufferSize, use two buffers: a full buffer is written to the file
+		 * on this pool while the caller keeps serializing into the other one.
+		 */
+		FThreadPool* ThreadPool = nullptr;
 	};
 
 	class UBPA_UCOMMON_API FFileArchive : public IArchive
@@ -141,6 +233,7 @@ namespace UCommon
 		FImpl* Impl;
 	public:
 		FFileArchive(EState State, const char* FilePath);
+		FFileArchive(EState State, const char* FilePath, const FFileArchiveConfig& Config);
 		FFileArchive(FFileArchive&& Other) noexcept;
 		FFileArchive& operator=(FFileArchive&& Other) noexcept;
 		void Swap(FFileArchive& Other) noexcept;
@@ -150,10 +243,107 @@ namespace UCommon
 
 		virtual void Serialize(void* Pointer, uint64_t Length) override;
 
-	private:
+		/** Moves to the absolute byte offset Index in the file (the file header included). */
 		void Seek(uint64_t Index);
+		/** The absolute byte offset in the file. */
 		uint64_t Tell() const;
 	};
+
+	/**
+	 * Loading archive over a memory mapping of a file written by FFileArchive.
+	 * Opening is O(1) whatever the file size, pages are read lazily on first access.
+	 * SerializeView() returns pointers into the mapping, FTex2D::Serialize uses them to load
+	 * the storage without copy (EOwnership::DoNotTakeOwnership), so such textures must not outlive the archive.
+	 * The mapping is copy-on-write, writing to the textures never modifies the file.
+	 * Reading past the end of the file is an error: nothing is read (Serialize() zero-fills),
+	 * SerializeView() returns nullptr and IsValid() becomes false.
+	 */
+	class UBPA_UCOMMON_API FMappedFileArchive : public IArchive
+	{
+		struct FImpl;
+		FImpl* Impl;
+	public:
+		FMappedFileArchive(const char* FilePath);
+		FMappedFileArchive(FMappedFileArchive&& Other) noexcept;
+		FMappedFileArchive& operator=(FMappedFileArchive&& Other) noexcept;
+		void Swap(FMappedFileArchive& Other) noexcept;
+		virtual ~FMappedFileArchive();
+
+		bool IsValid() const;
+
+		virtual void Serialize(void* Pointer, uint64_t Length) override;
+		virtual const void* SerializeView(uint64_t Length) override;
+		virtual bool CanSerializeView() const override;
+
+		/** The whole mapped file. */
+		TSpan<const uint8_t> GetMapping() const;
+	};
+
+	/**
+	 * Positional reads (Loading) or writes (Saving) on a file, safe to call concurrently,
+	 * e.g. to fill independent regions of a file from several threads.
+	 * Saving opens the file without truncating it, writing past the end extends it.
+	 * A Loading and a Saving file can be open on the same path at once, e.g. to read and write back tiles.
+	 */
+	class UBPA_UCOMMON_API FRandomAccessFile
+	{
+		struct FImpl;
+		FImpl* Impl;
+	public:
+		FRandomAccessFile(IArchive::EState State, const char* FilePath);
+		FRandomAccessFile(FRandomAccessFile&& Other) noexcept;
+		FRandomAccessFile& operator=(FRandomAccessFile&& Other) noexcept;
+		void Swap(FRandomAccessFile& Other) noexcept;
+		~FRandomAccessFile();
+
+		bool IsValid() const;
+
+		/** Loading only, returns false unless all Length bytes are read. */
+		bool ReadAt(uint64_t Offset, void* Pointer, uint64_t Length) const;
+		/** Saving only, returns false unless all Length bytes are written. */
+		bool WriteAt(uint64_t Offset, const void* Pointer, uint64_t Length);
+	};
+
+	/**
+	 * File of independently loadable chunks, keyed by a FGuid and/or a name.
+	 * Layout: FFileArchive header | chunk header | chunk 0 | chunk 1 | ... | table of contents | version map
+	 * Loading only reads the table of contents, a chunk is then fetched with one seek and a sequential read.
+	 */
+	class UBPA_UCOMMON_API FChunkFileArchive : public IArchive
+	{
+		struct FImpl;
+		FImpl* Impl;
+	public:
+		FChunkFileArchive(EState State, const char* FilePath);
+		FChunkFileArchive(FChunkFileArchive&& Other) noexcept;
+		FChunkFileArchive& operator=(FChunkFileArchive&& Other) noexcept;
+		void Swap(FChunkFileArchive& Other) noexcept;
+		virtual ~FChunkFileArchive();
+
+		/** Loading: false if the table of contents is out of the file or has a duplicated Guid or name. */
+		bool IsValid() const;
+
+		/** Serializes the current chunk, only valid between BeginChunk/EndChunk (Saving) or after SeekChunk (Loading). */
+		virtual void Serialize(void* Pointer, uint64_t Length) override;
+
+		/** Saving: starts a new chunk, Guid (if valid) and Name (if not empty) must be unique in the file. */
+		void BeginChunk(const FGuid& Guid, const char* Name = "");
+		void BeginChunk(const char* Name);
+		/** Saving: ends the current chunk. */
+		void EndChunk();
+
+		/** Loading: moves to the start of the chunk Index, returns false if out of range. */
+		bool SeekChunk(uint64_t Index);
+
+		uint64_t GetNumChunks() const;
+		/** Returns -1 if not found. */
+		int64_t FindChunk(const FGuid& Guid) const;
+		/** Returns -1 if not found. */
+		int64_t FindChunk(const char* Name) const;
+		const FGuid& GetChunkGuid(uint64_t Index) const;
+		const char* GetChunkName(uint64_t Index) const;
+		uint64_t GetChunkSize(uint64_t Index) const;
+	};
 }
 
 UBPA_UCOMMON_ARCHIVE_TO_NAMESPACE(UCommonTest)
@@ -112,10 +112,29 @@ SOFTWARE.
 #if !defined(UBPA_UCOMMON_MALLOC) && !defined(UBPA_UCOMMON_REALLOC) && !defined(UBPA_UCOMMON_FREE)
 #include <cstdlib>
 #define UBPA_UCOMMON_MALLOC(size) (malloc(size))
-#define UBPA_UCOMMON_REALLOC(size) (realloc(ptr,size))
+#define UBPA_UCOMMON_REALLOC(ptr,size) (realloc(ptr,size))
 #define UBPA_UCOMMON_FREE(ptr) (free(ptr))
 #endif
 
+/**
+ * SIMD code paths, picked at compile time from the target options (e.g. -mavx2 -mf16c, /arch:AVX2).
+ * Every path has a scalar fallback with the same results, define UBPA_UCOMMON_NO_SIMD to use it only.
+ */
+#if !defined(UBPA_UCOMMON_NO_SIMD)
+ #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define UBPA_UCOMMON_SIMD_SSE2 1
+ #endif
+ #if defined(__AVX2__)
+  #define UBPA_UCOMMON_SIMD_AVX2 1
+ #endif
+ #if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+  #define UBPA_UCOMMON_SIMD_F16C 1
+ #endif
+ #if defined(__aarch64__) || defined(_M_ARM64)
+  #define UBPA_UCOMMON_SIMD_NEON 1
+ #endif
+#endif // !UBPA_UCOMMON_NO_SIMD
+
 #ifndef UBPA_UCOMMON_ASTC_EXP
 #define UBPA_UCOMMON_ASTC_EXP 0
 #endif
@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#define UBPA_UCOMMON_TASK_GRAPH_TO_NAMESPACE(NameSpace) \
+namespace NameSpace \
+{ \
+	using FTaskGraph = UCommon::FTaskGraph; \
+}
+
+namespace UCommon
+{
+	/**
+	 * Directed acyclic graph of tasks executed on a FThreadPool.
+	 * A node is enqueued as soon as all of its predecessors have finished (no barrier between stages),
+	 * and the first successor made ready by a node runs directly on the same thread as a continuation.
+	 * Nodes and edges must be added while the graph is not running.
+	 * A graph can be run again after Wait() returns.
+	 */
+	class UBPA_UCOMMON_API FTaskGraph
+	{
+	public:
+		FTaskGraph();
+		FTaskGraph(FTaskGraph&& Other) noexcept;
+		FTaskGraph& operator=(FTaskGraph&& Other) noexcept;
+		void Swap(FTaskGraph& Other) noexcept;
+		~FTaskGraph();
+
+		/** Returns the index of the new node. */
+		uint64_t AddNode(FTask Task);
+
+		/** To runs after From has finished. */
+		void AddEdge(uint64_t From, uint64_t To);
+
+		/** AddNode + AddEdge(Prerequisite, Node) */
+		uint64_t AddContinuation(uint64_t Prerequisite, FTask Task);
+
+		/** The new node runs after all Prerequisites have finished. */
+		uint64_t AddContinuation(TSpan<const uint64_t> Prerequisites, FTask Task);
+
+		uint64_t GetNumNodes() const noexcept;
+
+		/**
+		 * Start executing the graph, returns immediately.
+		 * Returns false (and runs nothing) if the graph has a cycle.
+		 */
+		bool Run(FThreadPool& ThreadPool);
+
+		/** Blocks until every node of the current run has finished, running pool tasks meanwhile. */
+		void Wait();
+
+		bool IsRunning() const noexcept;
+
+		/** Remove all nodes and edges. */
+		void Reset();
+
+		FTaskGraph(const FTaskGraph&) = delete;
+		FTaskGraph& operator=(const FTaskGraph&) = delete;
+
+	private:
+		struct FImpl;
+		FImpl* Impl;
+	};
+}
+
+UBPA_UCOMMON_TASK_GRAPH_TO_NAMESPACE(UCommonTest)
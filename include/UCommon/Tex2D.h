@@ -33,12 +33,74 @@ namespace NameSpace \
     using FGrid2DIterator = UCommon::FGrid2DIterator; \
     using FGrid2D = UCommon::FGrid2D; \
     using FTex2D = UCommon::FTex2D; \
+    using FConstTex2DView = UCommon::FConstTex2DView; \
+    using FTex2DView = UCommon::FTex2DView; \
+    using EMipFilter = UCommon::EMipFilter; \
+    using EResizeFilter = UCommon::EResizeFilter; \
+    using ETex2DStorageLayout = UCommon::ETex2DStorageLayout; \
+    using FTex2DMipChain = UCommon::FTex2DMipChain; \
+    using FTex2DSummedAreaTable = UCommon::FTex2DSummedAreaTable; \
+    using FTex2DErrorStats = UCommon::FTex2DErrorStats; \
+    using FTex2DStoragePool = UCommon::FTex2DStoragePool; \
+    using FTex2DStoragePoolScope = UCommon::FTex2DStoragePoolScope; \
+    template<typename ElementT, uint64_t N, bool bConst = false> using TTex2DView = UCommon::TTex2DView<ElementT, N, bConst>; \
+    template<typename ElementT, uint64_t N> using TConstTex2DView = UCommon::TConstTex2DView<ElementT, N>; \
+    template<typename ElementT, uint64_t N> using TTex2D = UCommon::TTex2D<ElementT, N>; \
 }
 
 namespace UCommon
 {
 	struct FGrid2DIterator;
 	class FTexCube;
+	class FTex2D;
+	class FTex2DView;
+	class FTex2DMipChain;
+	class FTex2DSummedAreaTable;
+	class FTex2DStoragePool;
+	class FTex2DStoragePoolScope;
+
+	template<typename ElementT, uint64_t N, bool bConst = false>
+	class TTex2DView;
+
+	template<typename ElementT, uint64_t N>
+	using TConstTex2DView = TTex2DView<ElementT, N, true>;
+
+	template<typename ElementT, uint64_t N>
+	class TTex2D;
+
+	/** Filter of the 2:1 reduction between two mip levels. */
+	enum class EMipFilter : std::uint64_t
+	{
+		Box,     /** Average of 2x2 texels, same as FTex2D::DownSample(). */
+		Kaiser,  /** Kaiser windowed sinc (width 3, alpha 4), sharper than Box. */
+		Lanczos, /** Lanczos3 windowed sinc, sharpest, may ring at hard edges. */
+	};
+
+	/** Reconstruction filter of FTex2D::Resize, stretched over the source texels when minifying. */
+	enum class EResizeFilter : std::uint64_t
+	{
+		Triangle,   /** Tent, radius 1. Bilinear interpolation when magnifying. */
+		CatmullRom, /** Cubic (B = 0, C = 1/2), radius 2, interpolating and sharp. */
+		Lanczos3,   /** Lanczos3 windowed sinc, radius 3. */
+		Mitchell,   /** Cubic (B = C = 1/3), radius 2, slightly soft, little ringing. */
+	};
+
+	/** Order of the texels in the storage of a FTex2D. */
+	enum class ETex2DStorageLayout : std::uint64_t
+	{
+		Linear, /** Row-major, FGrid2D::GetIndex. */
+		/**
+		 * 8x8 tiles in row-major order, the texels of a tile in Morton (Z) order,
+		 * Width and Height are padded to multiples of 8. Neighbouring rows are close in memory,
+		 * so the taps of BilinearSample and the 2x2 footprints of DownSample share cache lines.
+		 */
+		Tiled,
+		/**
+		 * One row-major plane per channel, plane C starts at element C * Width * Height.
+		 * Per-channel work reads contiguous elements (GetPlaneView), e.g. a single coverage or alpha channel.
+		 */
+		Planar,
+	};
 
 	struct UBPA_UCOMMON_API FGrid2D
 	{
@@ -108,12 +170,235 @@ namespace UCommon
 		}
 	};
 
+	/**
+	 * A non-owning rectangle of texels, e.g. a tile, a cube face or a crop of a FTex2D.
+	 * Storage points to the texel at the origin, rows are RowStride bytes apart.
+	 * The viewed storage must outlive the view.
+	 */
+	class UBPA_UCOMMON_API FConstTex2DView
+	{
+	public:
+		FConstTex2DView() noexcept;
+
+		/**
+		 * @param InStorage the first texel of the view.
+		 * @param InGrid2D the extent of the view.
+		 * @param InRowStride the distance between two rows in bytes, 0 means packed rows.
+		 */
+		FConstTex2DView(const void* InStorage, const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType, uint64_t InRowStride = 0) noexcept;
+
+		/** The whole texture. */
+		FConstTex2DView(const FTex2D& Tex) noexcept;
+
+		bool IsValid() const noexcept;
+
+		const FGrid2D& GetGrid2D() const noexcept;
+
+		uint64_t GetNumChannels() const noexcept;
+
+		EElementType GetElementType() const noexcept;
+
+		/** Bytes between two rows. */
+		uint64_t GetRowStride() const noexcept;
+
+		/** Bytes of the texels of one row. */
+		uint64_t GetRowSizeInBytes() const noexcept;
+
+		/** Whether rows are packed, so the view is one contiguous range of GetGrid2D().Height * GetRowSizeInBytes() bytes. */
+		bool IsContiguous() const noexcept;
+
+		const void* GetRow(uint64_t Y) const noexcept;
+
+		template<typename T>
+		const T& At(const FUint64Vector2& Point, uint64_t C) const noexcept;
+
+		template<typename T>
+		const T& At(const FUint64Vector2& Point) const noexcept;
+
+		float GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept;
+
+		/** The rectangle [InOrigin, InOrigin + InGrid2D) of this view. */
+		FConstTex2DView GetSubView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept;
+
+		/** Same as FTex2D::BilinearSample, the address modes apply at the edges of the view. */
+		void BilinearSample(float* Result, const FVector2f& Texcoord, ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap) const noexcept;
+
+		/** Same as FTex2D::BilinearSampleBatch, the address modes apply at the edges of the view. */
+		void BilinearSampleBatch(TSpan<const FVector2f> Texcoords, float* Results, ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap, FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Convert all elements into Dst, which has the same Grid2D and NumChannels and any supported ElementType.
+		 * Rows are split across ThreadPool if not nullptr.
+		 */
+		void ConvertTo(const FTex2DView& Dst, FThreadPool* ThreadPool = nullptr) const;
+
+		/** Save in the format of FTex2D::Serialize, as a packed texture of the view's extent. */
+		void Save(IArchive& Archive) const;
+
+	protected:
+		const uint8_t* Storage;
+		FGrid2D Grid2D;
+		uint64_t NumChannels;
+		EElementType ElementType;
+		uint64_t RowStride;
+	};
+
+	/** Same as FConstTex2DView, with write access. */
+	class UBPA_UCOMMON_API FTex2DView : public FConstTex2DView
+	{
+	public:
+		FTex2DView() noexcept;
+
+		FTex2DView(void* InStorage, const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType, uint64_t InRowStride = 0) noexcept;
+
+		/** The whole texture. */
+		FTex2DView(FTex2D& Tex) noexcept;
+
+		void* GetRow(uint64_t Y) const noexcept;
+
+		template<typename T>
+		T& At(const FUint64Vector2& Point, uint64_t C) const noexcept;
+
+		template<typename T>
+		T& At(const FUint64Vector2& Point) const noexcept;
+
+		void SetFloat(const FUint64Vector2& Point, uint64_t C, float Value) const noexcept;
+
+		FTex2DView GetSubView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept;
+
+		/** Same as FTex2D::Clamp. */
+		void Clamp(float MinValue, float MaxValue, FThreadPool* ThreadPool = nullptr) const;
+
+		/** Same as FTex2D::Min. */
+		void Min(float MinValue, FThreadPool* ThreadPool = nullptr) const;
+
+		/** Same as FTex2D::Max. */
+		void Max(float MaxValue, FThreadPool* ThreadPool = nullptr) const;
+
+		/** Same as FTex2D::Threshold. */
+		void Threshold(float ThresholdValue, FThreadPool* ThreadPool = nullptr) const;
+
+		/** Same as FTex2D::Apply. */
+		template<typename OpT>
+		void Apply(OpT&& Op, FThreadPool* ThreadPool = nullptr) const;
+
+		/** Copy the texels of Src, which has the same layout. */
+		void CopyFrom(const FConstTex2DView& Src) const noexcept;
+
+		/**
+		 * Load a texture saved by FTex2D::Serialize or FConstTex2DView::Save into the view.
+		 * Returns false (nothing loaded) if its Grid2D, NumChannels or ElementType differs from the view's.
+		 */
+		bool Load(IArchive& Archive) const;
+
+	private:
+		using FApplyFunction = void(*)(void* Context, float* Values, uint64_t NumValues);
+		void ApplyImpl(FApplyFunction Function, void* Context, FThreadPool* ThreadPool) const;
+	};
+
+	/** Alignment of the storages FTex2D allocates internally, a cache line and the widest SIMD register. */
+	static constexpr uint64_t Tex2DStorageAlignment = 64;
+
+	/**
+	 * Allocate a storage aligned to Tex2DStorageAlignment (no initialization),
+	 * drawn from the current FTex2DStoragePool of the thread if there is one.
+	 * It must be freed by FreeTex2DStorage.
+	 */
+	UBPA_UCOMMON_API void* AllocateTex2DStorage(uint64_t SizeInBytes);
+
+	/** Free a storage of AllocateTex2DStorage, into the current FTex2DStoragePool of the thread if there is one. */
+	UBPA_UCOMMON_API void FreeTex2DStorage(void* Storage) noexcept;
+
+	/**
+	 * Cache of freed texture storages by size class (4 classes per power of two),
+	 * so that temporaries (mip levels, converted copies, resized textures) reuse the storages of the previous ones.
+	 * A pool only serves the threads it is current on (FTex2DStoragePoolScope), opt-in per thread or per scope.
+	 * It is thread-safe, the same pool can be current on several threads at the same time.
+	 */
+	class UBPA_UCOMMON_API FTex2DStoragePool
+	{
+	public:
+		struct FStats
+		{
+			uint64_t NumAllocations = 0; /** Allocations served by the pool. */
+			uint64_t NumHits = 0; /** Allocations served by a cached storage. */
+			uint64_t NumFrees = 0; /** Storages freed into the pool. */
+			uint64_t NumCachedFrees = 0; /** Freed storages kept in the cache. */
+			uint64_t CachedSizeInBytes = 0;
+			uint64_t PeakCachedSizeInBytes = 0;
+
+			/** NumHits / NumAllocations, 0 if there is no allocation. */
+			double GetHitRate() const noexcept;
+		};
+
+		/** @param InMaxCachedSizeInBytes freed storages beyond it are returned to the system. */
+		explicit FTex2DStoragePool(uint64_t InMaxCachedSizeInBytes = uint64_t(1) << 30);
+		~FTex2DStoragePool();
+
+		FTex2DStoragePool(const FTex2DStoragePool&) = delete;
+		FTex2DStoragePool& operator=(const FTex2DStoragePool&) = delete;
+
+		/** The storage is aligned to Tex2DStorageAlignment and has GetSizeClass(SizeInBytes) bytes. */
+		void* Allocate(uint64_t SizeInBytes);
+
+		/** Storage of AllocateTex2DStorage, from any pool or none. */
+		void Free(void* Storage) noexcept;
+
+		/** Return all cached storages to the system. */
+		void Trim() noexcept;
+
+		FStats GetStats() const noexcept;
+		void ResetStats() noexcept;
+
+		/** The smallest size class not less than SizeInBytes. */
+		static uint64_t GetSizeClass(uint64_t SizeInBytes) noexcept;
+
+		/** The current pool of this thread, nullptr if there is none. */
+		static FTex2DStoragePool* GetCurrent() noexcept;
+
+	private:
+		struct FImpl;
+		FImpl* Impl;
+	};
+
+	/**
+	 * Make a pool the current one of this thread until the end of the scope, then restore the previous one.
+	 * Scopes nest, a nullptr pool disables pooling in the scope.
+	 */
+	class UBPA_UCOMMON_API FTex2DStoragePoolScope
+	{
+	public:
+		explicit FTex2DStoragePoolScope(FTex2DStoragePool* Pool) noexcept;
+		~FTex2DStoragePoolScope();
+
+		FTex2DStoragePoolScope(const FTex2DStoragePoolScope&) = delete;
+		FTex2DStoragePoolScope& operator=(const FTex2DStoragePoolScope&) = delete;
+
+	private:
+		FTex2DStoragePool* PreviousPool;
+	};
+
+	/** Error of one channel against a reference texture, see FTex2D::ComputeErrorStats. */
+	struct UBPA_UCOMMON_API FTex2DErrorStats
+	{
+		double MSE = 0.;
+		double MaxAbsError = 0.;
+		/** Max of |Value - Reference| / max(|Reference|, RelativeEpsilon). */
+		double MaxRelError = 0.;
+
+		/** 10 * log10(Peak^2 / MSE) in dB, +inf if MSE is 0. */
+		double GetPSNR(double Peak = 1.) const noexcept;
+	};
+
 	class UBPA_UCOMMON_API FTex2D
 	{
 	public:
 		/** Required number of floating point numbers for the storage. */
-		static uint64_t GetRequiredStorageSizeInBytes(FGrid2D Grid2D, uint64_t NumChannels, EElementType ElementType) noexcept;
-		static uint64_t GetNumElements(FGrid2D Grid2D, uint64_t NumChannels) noexcept;
+		static uint64_t GetRequiredStorageSizeInBytes(FGrid2D Grid2D, uint64_t NumChannels, EElementType ElementType, ETex2DStorageLayout StorageLayout = ETex2DStorageLayout::Linear) noexcept;
+		static uint64_t GetNumElements(FGrid2D Grid2D, uint64_t NumChannels, ETex2DStorageLayout StorageLayout = ETex2DStorageLayout::Linear) noexcept;
+
+		/** The Grid2D the storage is allocated for, Grid2D padded to whole tiles if Tiled. */
+		static FGrid2D GetStorageGrid2D(FGrid2D Grid2D, ETex2DStorageLayout StorageLayout) noexcept;
 
 		FTex2D() noexcept;
 
@@ -125,8 +410,9 @@ namespace UCommon
 		 * @param InOwnership control the ownership of InStorage.
 		 * @param InElementType the element type of the storage.
 		 * @param InStorage the storage of the texture, deleted by `free`.
+		 * @param InStorageLayout the order of the texels in InStorage.
 		 */
-		FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EOwnership InOwnership, EElementType InElementType, void* InStorage) noexcept;
+		FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EOwnership InOwnership, EElementType InElementType, void* InStorage, ETex2DStorageLayout InStorageLayout = ETex2DStorageLayout::Linear) noexcept;
 
 		FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType InElementType, const void* InStorage);
 
@@ -137,19 +423,20 @@ namespace UCommon
 		FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, const Element* InStorage);
 
 		/**
-		 * Allocate a storage internally by `malloc` (no initialization).
+		 * Allocate a storage internally by AllocateTex2DStorage (no initialization).
 		 *
 		 * @param InGrid2D the Grid2D of the texture.
 		 * @param InNumChannels the channel number of the texture.
 		 * @param InElementType the element type of the storage.
+		 * @param InStorageLayout the order of the texels in the storage.
 		 */
-		FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType InElementType);
+		FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType InElementType, ETex2DStorageLayout InStorageLayout = ETex2DStorageLayout::Linear);
 
 		/**
 		 * Copy with the explicitly specified ownership and InEmptyStorage (may be nullptr).
 		 *
 		 * @param InEmptyStorage is always used when it is not `nullptr`.
-		 *        When it is `nullptr` it causes the internal use of `malloc` (`TakeOwnership`)
+		 *        When it is `nullptr` it causes the internal use of AllocateTex2DStorage (`TakeOwnership`)
 		 *        or `Other.Storage` (`DoNotTakeOwnership`).
 		 * @param InOwnership control the ownership of `InEmptyStorage`.
 		 */
@@ -157,7 +444,7 @@ namespace UCommon
 
 		/**
 		 * Copy with propagated ownership.
-		 * When the Ownership of Other is TakeOwnership, it causes the internal use of `malloc`.
+		 * When the Ownership of Other is TakeOwnership, it causes the internal use of AllocateTex2DStorage.
 		 */
 		FTex2D(const FTex2D& Other);
 
@@ -171,10 +458,13 @@ namespace UCommon
 
 		uint64_t GetNumChannels() const noexcept;
 
+		/** Number of elements in the storage, including the padding texels if Tiled. */
 		uint64_t GetNumElements() const noexcept;
 
 		EOwnership GetStorageOwnership() const noexcept;
 
+		ETex2DStorageLayout GetStorageLayout() const noexcept;
+
 		EElementType GetElementType() const noexcept;
 
 		/** Number of bytes in the storage. */
@@ -183,8 +473,24 @@ namespace UCommon
 		void* GetStorage() noexcept;
 		const void* GetStorage() const noexcept;
 
+		/** Index of the texel at Point in the storage, in texels, following the storage layout (in a plane if Planar). */
+		uint64_t GetTexelIndex(const FUint64Vector2& Point) const noexcept;
+
+		/** Index of the element in the storage, following the storage layout. */
 		uint64_t GetIndex(const FUint64Vector2& Point, uint64_t C) const noexcept;
 
+		/** Views are row-major, the storage layout must be Linear. */
+		FTex2DView GetView() noexcept;
+		FConstTex2DView GetView() const noexcept;
+
+		/** The rectangle [InOrigin, InOrigin + InGrid2D) of the texture, without copy, the storage layout must be Linear. */
+		FTex2DView GetView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) noexcept;
+		FConstTex2DView GetView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept;
+
+		/** The plane of channel C as a single-channel view, the storage layout must be Planar. */
+		FTex2DView GetPlaneView(uint64_t C) noexcept;
+		FConstTex2DView GetPlaneView(uint64_t C) const noexcept;
+
 		template<typename T>
 		T& At(uint64_t Index) noexcept;
 		template<typename T>
@@ -195,6 +501,7 @@ namespace UCommon
 		template<typename T>
 		const T& At(const FUint64Vector2& Point, uint64_t C) const noexcept;
 
+		/** The whole texel as a vector, the storage layout must not be Planar. */
 		template<typename T>
 		T& At(const FUint64Vector2& Point) noexcept;
 		template<typename T>
@@ -215,83 +522,175 @@ namespace UCommon
 		/** Release `Storage` and reset all member variables. */
 		void Reset() noexcept;
 
-		/** Whether `Grid2D`, `NumChannels` and `ElementType` are the same as `Other`'s. */
+		/** Whether `Grid2D`, `NumChannels`, `ElementType` and the storage layout are the same as `Other`'s. */
 		bool IsLayoutSameWith(const FTex2D& Other) const noexcept;
 
 		void BilinearSample(float* Result, const FVector2f& Texcoord, ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap) const noexcept;
 
+		/**
+		 * BilinearSample for each of Texcoords, Results has Texcoords.Num() * NumChannels floats.
+		 * The kernel is picked once per call (specialized for ElementType and the address modes),
+		 * with AVX2 the taps of 8 samples are computed together and Float/Half texels are gathered with SIMD.
+		 * Texcoords are split across ThreadPool if not nullptr.
+		 * Results are the same as BilinearSample, up to rounding if the compiler contracts into FMA.
+		 */
+		void BilinearSampleBatch(TSpan<const FVector2f> Texcoords, float* Results, ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap, FThreadPool* ThreadPool = nullptr) const;
+
 		void BilinearSampleAlignCorner(float* Result, const FVector2f& Texcoord) const noexcept;
 
 		/**
 		 * Width = Width/2
 		 * Height = Height/2
+		 * The result has the same storage layout.
 		 */
 		FTex2D DownSample() const;
 
 		/**
-		 * Resize texture using bilinear interpolation.
-		 * InGrid2D size must be >= 0.5x of current Grid2D size (no upper limit).
+		 * Generate the whole mip chain (Grid2D.GetNumMips() levels) in one allocation, level 0 is a copy.
+		 * Each level is filtered from the previous one, in tiles on ThreadPool if not nullptr.
+		 * Supports Uint8 (as unorm), Half, Float, Double. The levels are Linear, other storage layouts go through a Linear copy.
+		 */
+		FTex2DMipChain GenerateMips(EMipFilter Filter = EMipFilter::Box, FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Resize texture to any size with a separable filter (a horizontal and a vertical pass),
+		 * texel centers aligned and edges clamped. The same size returns a copy.
+		 * Rows are split across ThreadPool if not nullptr.
+		 * Supports Uint8 (as unorm, clamped), Half, Float, Double.
+		 * The result has the same storage layout, other storage layouts than Linear go through a Linear copy.
 		 *
-		 * @param InGrid2D the target Grid2D, must satisfy:
-		 *        - InGrid2D.Width >= Width/2
-		 *        - InGrid2D.Height >= Height/2
+		 * @param InGrid2D the target Grid2D
 		 */
-		FTex2D Resize(const FGrid2D& InGrid2D) const;
+		FTex2D Resize(const FGrid2D& InGrid2D, EResizeFilter Filter = EResizeFilter::Triangle, FThreadPool* ThreadPool = nullptr) const;
 
 		/**
-		 * Downsample texture to target size.
-		 * Uses repeated DownSample() calls followed by Resize().
+		 * Downsample texture to target size, in one Resize() pass.
 		 *
 		 * @param InGrid2D the target Grid2D, must be smaller or equal to current size
 		 */
-		FTex2D DownSample(const FGrid2D& InGrid2D) const;
+		FTex2D DownSample(const FGrid2D& InGrid2D, EResizeFilter Filter = EResizeFilter::Triangle, FThreadPool* ThreadPool = nullptr) const;
 
-		FTex2D ToFloat() const;
+		/**
+		 * Mean over the (2*Radius+1)^2 window around each texel, clipped at the edges (divided by the texels inside).
+		 * Goes through a FTex2DSummedAreaTable, so the cost per texel does not depend on Radius.
+		 * The result has the same ElementType (Uint8 as unorm, rounded) and storage layout.
+		 */
+		FTex2D BoxBlur(uint64_t Radius, FThreadPool* ThreadPool = nullptr) const;
 
-		void ToUint8(FTex2D& Tex) const;
+		/**
+		 * Error of each channel against Reference, which has the same Grid2D and NumChannels
+		 * (any ElementType, Uint8 as unorm, other storage layouts are compared through Linear copies).
+		 * Vectorized, blocks of rows are split across ThreadPool if not nullptr, the result does not depend on it.
+		 *
+		 * @param Results NumChannels entries
+		 * @param RelativeEpsilon lower bound of |Reference| in the relative error
+		 */
+		void ComputeErrorStats(const FTex2D& Reference, FTex2DErrorStats* Results, float RelativeEpsilon = 1e-6f, FThreadPool* ThreadPool = nullptr) const;
+
+		/** Mean squared error over all channels, same as ComputeErrorStats. */
+		double ComputeMSE(const FTex2D& Reference, FThreadPool* ThreadPool = nullptr) const;
 
-		FTex2D ToUint8() const;
+		/** PSNR in dB of ComputeMSE for the peak value, +inf for equal textures. */
+		double ComputePSNR(const FTex2D& Reference, double Peak = 1., FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Mean SSIM (Wang et al. 2004) with an 11-tap separable Gaussian window (sigma 1.5), edges clamped,
+		 * C1 = (0.01 * Peak)^2 and C2 = (0.03 * Peak)^2. Same requirements as ComputeErrorStats, tiles are split across ThreadPool.
+		 *
+		 * @param ChannelResults the mean SSIM of each channel if not nullptr
+		 * @return the mean over channels
+		 */
+		double ComputeSSIM(const FTex2D& Reference, double* ChannelResults = nullptr, double Peak = 1., FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Histogram of |Value - Reference| of each channel, NumBins uniform bins over [0, MaxError),
+		 * larger errors and NaN are counted in the last bin. Same requirements as ComputeErrorStats.
+		 *
+		 * @param Histograms NumChannels * NumBins counts, channel-major, overwritten
+		 */
+		void ComputeErrorHistograms(const FTex2D& Reference, float MaxError, uint64_t NumBins, uint64_t* Histograms, FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Convert all elements into Tex, which has the same Grid2D, NumChannels and storage layout and any supported ElementType.
+		 * Uses the vectorized ElementConvert, rows are split across ThreadPool if not nullptr.
+		 */
+		void ConvertTo(FTex2D& Tex, FThreadPool* ThreadPool = nullptr) const;
+
+		FTex2D ConvertTo(EElementType InElementType, FThreadPool* ThreadPool = nullptr) const;
+
+		FTex2D ToFloat(FThreadPool* ThreadPool = nullptr) const;
+
+		FTex2D ToHalf(FThreadPool* ThreadPool = nullptr) const;
+
+		void ToUint8(FTex2D& Tex, FThreadPool* ThreadPool = nullptr) const;
+
+		FTex2D ToUint8(FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Copy with the texels reordered into InStorageLayout (the padding texels of Tiled are zero).
+		 * Rows (of tiles) are split across ThreadPool if not nullptr.
+		 * Between Tiled and Planar it goes through Linear.
+		 */
+		FTex2D ToStorageLayout(ETex2DStorageLayout InStorageLayout, FThreadPool* ThreadPool = nullptr) const;
 
 		/**
 		 * Clamp all elements to [MinValue, MaxValue].
 		 * Only supports Uint8 (as unorm), Half, Float, Double.
+		 * Rows are split across ThreadPool if not nullptr and the texture is large.
 		 *
 		 * @param MinValue minimum value to clamp to
 		 * @param MaxValue maximum value to clamp to
 		 */
-		void Clamp(float MinValue, float MaxValue) noexcept;
+		void Clamp(float MinValue, float MaxValue, FThreadPool* ThreadPool = nullptr);
 
 		/**
 		 * Clamp all elements to minimum value.
 		 * Only supports Uint8 (as unorm), Half, Float, Double.
+		 * Rows are split across ThreadPool if not nullptr and the texture is large.
 		 *
 		 * @param MinValue minimum value to clamp to
 		 */
-		void Min(float MinValue) noexcept;
+		void Min(float MinValue, FThreadPool* ThreadPool = nullptr);
 
 		/**
 		 * Clamp all elements to maximum value.
 		 * Only supports Uint8 (as unorm), Half, Float, Double.
+		 * Rows are split across ThreadPool if not nullptr and the texture is large.
 		 *
 		 * @param MaxValue maximum value to clamp to
 		 */
-		void Max(float MaxValue) noexcept;
+		void Max(float MaxValue, FThreadPool* ThreadPool = nullptr);
 
 		/**
 		 * Set all elements below threshold to zero.
 		 * Only supports Uint8 (as unorm), Half, Float, Double.
+		 * Rows are split across ThreadPool if not nullptr and the texture is large.
 		 *
 		 * @param ThresholdValue threshold value, elements < ThresholdValue will be set to 0
 		 */
-		void Threshold(float ThresholdValue) noexcept;
+		void Threshold(float ThresholdValue, FThreadPool* ThreadPool = nullptr);
+
+		/**
+		 * Generic pointwise operation: call Op(float* Values, uint64_t NumValues) on chunks of the elements as floats,
+		 * the changed Values are stored back (converted by ElementConvert, so Uint8 is clamped to [0, 1]).
+		 * Float elements are passed in place, write Op as a plain loop over Values so that it vectorizes.
+		 * Rows are split across ThreadPool if not nullptr and the texture is large, then Op is called concurrently.
+		 */
+		template<typename OpT>
+		void Apply(OpT&& Op, FThreadPool* ThreadPool = nullptr);
 
 		/**
 		 * Image inpainting algorithm to fill uncovered (coverage = 0) regions.
 		 * Uses mipmap-based approach to propagate valid pixels into invalid regions.
+		 * The pyramid is allocated in one block, each level is split across ThreadPool if not nullptr,
+		 * the result doesn't depend on ThreadPool.
 		 *
-		 * @param CoverageData texture with same layout indicating coverage (0 = uncovered, >0 = covered)
+		 * Other storage layouts than Linear (of either texture) go through Linear copies, the storage layout is kept.
+		 *
+		 * @param CoverageData texture with same Grid2D and 1 or NumChannels channels indicating coverage
+		 *        (0 = uncovered, >0 = covered), of any supported ElementType (Uint8 as unorm). It is not modified.
 		 */
-		void ImageInpainting(FTex2D CoverageData);
+		void ImageInpainting(const FTex2D& CoverageData, FThreadPool* ThreadPool = nullptr);
 
 		// Equirectangular
 		void ToTexCube(FTexCube& TexCube) const;
@@ -300,22 +699,328 @@ namespace UCommon
 		/**
 		 * If layout is same with Rhs's, just copy the storage,
 		 * else copy with propagated ownership.
-		 * When the Ownership of Other is TakeOwnership, it causes the internal use of `malloc`.
+		 * When the Ownership of Other is TakeOwnership, it causes the internal use of AllocateTex2DStorage.
 		 */
 		FTex2D& operator=(const FTex2D& Rhs);
 
 		FTex2D& operator=(FTex2D&& Rhs) noexcept;
 
+		/**
+		 * The texels are always serialized in Linear order, so the format doesn't depend on the storage layout.
+		 * Loading gives a Linear texture, use ToStorageLayout to reorder it again.
+		 * Loading from a truncated FMappedFileArchive gives an empty texture (IsValid() is false).
+		 */
 		void Serialize(IArchive& Archive);
 
+		/**
+		 * Same format as Serialize(Archive), but the storage is serialized in bands of BandHeight rows
+		 * (0 picks about 4 MB per band).
+		 * Loading: OnBand(RowBegin, RowEnd) is called once the rows are loaded, e.g. to convert or process them.
+		 * Saving: OnBand(RowBegin, RowEnd) is called before the rows are written, e.g. to produce them.
+		 * With a ThreadPool, OnBand runs on it and overlaps the serialization of the next (Loading)
+		 * or previous (Saving) band. Calls are in band order and never concurrent.
+		 * Saving: the storage layout must be Linear. Loading gives a Linear texture.
+		 */
+		template<typename BodyT>
+		void SerializeBands(IArchive& Archive, uint64_t BandHeight, BodyT&& OnBand, FThreadPool* ThreadPool = nullptr)
+		{
+			using FBody = std::remove_reference_t<BodyT>;
+			SerializeBandsImpl(Archive, BandHeight,
+				[](void* Context, uint64_t RowBegin, uint64_t RowEnd) { (*static_cast<FBody*>(Context))(RowBegin, RowEnd); },
+				const_cast<void*>(static_cast<const void*>(&OnBand)), ThreadPool);
+		}
+
+		/**
+		 * Write a file readable by FFileArchive + Serialize, holding only this texture.
+		 * Bands of BandHeight rows (0 picks about 4 MB per band) are written concurrently
+		 * at their own offsets of the file on ThreadPool. Other storage layouts than Linear go through a Linear copy.
+		 */
+		bool SaveFileParallel(const char* FilePath, FThreadPool& ThreadPool, uint64_t BandHeight = 0) const;
+
+		/**
+		 * Load a file written by SaveFileParallel (or a FFileArchive starting with a serialized FTex2D),
+		 * reading bands concurrently on ThreadPool. The texture must be empty.
+		 */
+		bool LoadFileParallel(const char* FilePath, FThreadPool& ThreadPool, uint64_t BandHeight = 0);
+
 		static void Copy(FTex2D& Dst, const FUint64Vector2& DstPoint, const FTex2D& Src, const FUint64Vector2& SrcPoint, const FUint64Vector2& Range);
+		static void Copy(const FTex2DView& Dst, const FConstTex2DView& Src) noexcept;
 
 	private:
+		using FBandFunction = void(*)(void* Context, uint64_t RowBegin, uint64_t RowEnd);
+
+		void SerializeBandsImpl(IArchive& Archive, uint64_t BandHeight, FBandFunction Function, void* Context, FThreadPool* ThreadPool);
+		void SerializeLayout(IArchive& Archive);
+		uint64_t GetDefaultBandHeight() const noexcept;
+		void FreeStorage() noexcept;
+
+		/** The whole storage as a packed texture of GetStorageGrid2D(), for the operations that don't depend on texel positions. */
+		FTex2DView GetStorageView() noexcept;
+		FConstTex2DView GetStorageView() const noexcept;
+
 		FGrid2D Grid2D;
 		uint64_t NumChannels;
 		EOwnership Ownership;
 		EElementType ElementType;
 		void* Storage;
+		ETex2DStorageLayout StorageLayout;
+		/** Storage is from AllocateTex2DStorage rather than given by the user, freed by FreeTex2DStorage instead of `free`. */
+		bool bInternalStorage;
+	};
+
+	/**
+	 * Mip levels stored back to back in one allocation, level 0 first.
+	 * GetMip returns a view (DoNotTakeOwnership) into the storage.
+	 */
+	class UBPA_UCOMMON_API FTex2DMipChain
+	{
+	public:
+		FTex2DMipChain() noexcept;
+
+		/**
+		 * Allocate the storage of levels [0, InNumMips) internally by AllocateTex2DStorage (no initialization).
+		 *
+		 * @param InGrid2D the Grid2D of level 0, level i is max(1, Width >> i) x max(1, Height >> i).
+		 * @param InNumMips the number of levels, 0 means InGrid2D.GetNumMips().
+		 */
+		FTex2DMipChain(const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType, uint64_t InNumMips = 0);
+
+		bool IsValid() const noexcept;
+
+		uint64_t GetNumMips() const noexcept;
+
+		FGrid2D GetMipGrid2D(uint64_t Level) const noexcept;
+
+		uint64_t GetNumChannels() const noexcept;
+
+		EElementType GetElementType() const noexcept;
+
+		FTex2D GetMip(uint64_t Level) noexcept;
+		const FTex2D GetMip(uint64_t Level) const noexcept;
+
+		/** All levels as one row of texels. */
+		const FTex2D& GetFlatTex2D() const noexcept;
+
+	private:
+		/** Offset of the level in the storage, in texels. */
+		uint64_t GetMipOffset(uint64_t Level) const noexcept;
+
+		FGrid2D Grid2D;
+		uint64_t NumMips;
+		FTex2D FlatTex2D;
+	};
+
+	/**
+	 * Summed-area table of a texture in double (Uint8 as unorm), optionally with the table of squared values.
+	 * Entry (X, Y) is the sum over the texels [0, X) x [0, Y) per channel, so the tables are (Width+1) x (Height+1)
+	 * and the sum over any rectangle takes 4 reads.
+	 */
+	class UBPA_UCOMMON_API FTex2DSummedAreaTable
+	{
+	public:
+		struct FStats
+		{
+			uint64_t Count = 0; /** Texels in the rectangle. */
+			double Sum = 0.;
+			double Mean = 0.;
+			/** Population variance, needs the squared sums (0 otherwise). */
+			double Variance = 0.;
+		};
+
+		FTex2DSummedAreaTable() noexcept;
+
+		/**
+		 * Build the tables with a two-pass prefix scan: rows are scanned in parallel, then the rows are accumulated
+		 * top-down with the columns split across ThreadPool if not nullptr.
+		 *
+		 * @param bWithSquaredSums also build the table of squared values, required by the variance.
+		 */
+		explicit FTex2DSummedAreaTable(const FConstTex2DView& View, bool bWithSquaredSums = false, FThreadPool* ThreadPool = nullptr);
+
+		bool IsValid() const noexcept;
+
+		/** The Grid2D of the source texture. */
+		const FGrid2D& GetGrid2D() const noexcept;
+
+		uint64_t GetNumChannels() const noexcept;
+
+		bool HasSquaredSums() const noexcept;
+
+		/** Sum of channel C over the texels [Min, Max). */
+		double GetSum(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept;
+
+		/** Sum of squares of channel C over the texels [Min, Max), needs the squared sums. */
+		double GetSquaredSum(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept;
+
+		/** Mean of channel C over the texels [Min, Max), which must not be empty. */
+		double GetMean(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept;
+
+		FStats GetStats(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept;
+
+		/** Stats over the (2*Radius+1)^2 window around Point, clipped at the edges. */
+		FStats GetWindowStats(const FUint64Vector2& Point, uint64_t Radius, uint64_t C) const noexcept;
+
+		/**
+		 * Write the window mean of every texel into Dst (same Grid2D and NumChannels, any ElementType).
+		 * Rows are split across ThreadPool if not nullptr.
+		 */
+		void BoxFilter(const FTex2DView& Dst, uint64_t Radius, FThreadPool* ThreadPool = nullptr) const;
+
+		/** The (Width+1) x (Height+1) table of sums, Double. */
+		const FTex2D& GetSums() const noexcept;
+
+		/** The (Width+1) x (Height+1) table of squared sums, Double, invalid if not built. */
+		const FTex2D& GetSquaredSums() const noexcept;
+
+	private:
+		/** Clip the window around Point to the texture, as [Min, Max). */
+		void GetWindow(const FUint64Vector2& Point, uint64_t Radius, FUint64Vector2& Min, FUint64Vector2& Max) const noexcept;
+
+		double GetRectangleSum(const FTex2D& Table, const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept;
+
+		FGrid2D Grid2D;
+		uint64_t NumChannels;
+		FTex2D Sums;
+		FTex2D SquaredSums;
+	};
+
+	/**
+	 * FTex2DView with the element type and the channel number known at compile time:
+	 * accesses need no switch on the element type and the texel size is a constant.
+	 * Layout and lifetime rules are those of FConstTex2DView, it converts to and from the untyped view without copy.
+	 */
+	template<typename ElementT, uint64_t N, bool bConst>
+	class TTex2DView
+	{
+		static_assert(IsDirectSupported<ElementT>, "ElementT is not supported");
+		static_assert(N > 0, "N must be positive");
+
+	public:
+		static constexpr uint64_t NumChannels = N;
+		static constexpr EElementType ElementType = ElementTypeOf<ElementT>;
+
+		using FElement = std::conditional_t<bConst, const ElementT, ElementT>;
+		using FUntypedView = std::conditional_t<bConst, FConstTex2DView, FTex2DView>;
+
+		TTex2DView() noexcept;
+
+		/**
+		 * @param InStorage the first texel of the view.
+		 * @param InGrid2D the extent of the view.
+		 * @param InRowStride the distance between two rows in bytes, 0 means packed rows.
+		 */
+		TTex2DView(FElement* InStorage, const FGrid2D& InGrid2D, uint64_t InRowStride = 0) noexcept;
+
+		/** View's element type and channel number must be ElementT and N. */
+		explicit TTex2DView(const FUntypedView& View) noexcept;
+
+		/** Read-only view of a writable view. */
+		template<bool bOtherConst, std::enable_if_t<bConst && !bOtherConst, int> = 0>
+		TTex2DView(const TTex2DView<ElementT, N, bOtherConst>& Other) noexcept;
+
+		operator FUntypedView() const noexcept;
+
+		bool IsValid() const noexcept;
+
+		const FGrid2D& GetGrid2D() const noexcept;
+
+		/** Bytes between two rows. */
+		uint64_t GetRowStride() const noexcept;
+
+		/** Bytes of the texels of one row. */
+		uint64_t GetRowSizeInBytes() const noexcept;
+
+		/** Whether rows are packed, so the view is one contiguous range of GetGrid2D().Height * GetRowSizeInBytes() bytes. */
+		bool IsContiguous() const noexcept;
+
+		/** The Width * N elements of row Y. */
+		FElement* GetRow(uint64_t Y) const noexcept;
+
+		/** The N elements of the texel at Point. */
+		FElement* GetTexel(const FUint64Vector2& Point) const noexcept;
+
+		FElement& At(const FUint64Vector2& Point, uint64_t C) const noexcept;
+
+		float GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept;
+
+		void SetFloat(const FUint64Vector2& Point, uint64_t C, float Value) const noexcept;
+
+		/** The rectangle [InOrigin, InOrigin + InGrid2D) of this view. */
+		TTex2DView GetSubView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept;
+
+		/** Same as FConstTex2DView::BilinearSample, with the address modes resolved at compile time. */
+		template<ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap>
+		void BilinearSample(float* Result, const FVector2f& Texcoord) const noexcept;
+
+	private:
+		template<typename, uint64_t, bool>
+		friend class TTex2DView;
+
+		std::conditional_t<bConst, const uint8_t*, uint8_t*> Storage;
+		FGrid2D Grid2D;
+		uint64_t RowStride;
+	};
+
+	/**
+	 * A Linear FTex2D with the element type and the channel number known at compile time.
+	 * It owns a FTex2D (so the storage is aligned and pooled as usual) and converts to and from it without copy.
+	 */
+	template<typename ElementT, uint64_t N>
+	class TTex2D
+	{
+		static_assert(IsDirectSupported<ElementT>, "ElementT is not supported");
+		static_assert(N > 0, "N must be positive");
+
+	public:
+		static constexpr uint64_t NumChannels = N;
+		static constexpr EElementType ElementType = ElementTypeOf<ElementT>;
+
+		using FView = TTex2DView<ElementT, N>;
+		using FConstView = TConstTex2DView<ElementT, N>;
+
+		TTex2D() noexcept;
+
+		/** Allocate a storage internally by AllocateTex2DStorage (no initialization). */
+		explicit TTex2D(const FGrid2D& InGrid2D);
+
+		/** Take InTex2D without copy, its element type, channel number and storage layout must be ElementT, N and Linear. */
+		explicit TTex2D(FTex2D InTex2D) noexcept;
+
+		bool IsValid() const noexcept;
+
+		const FGrid2D& GetGrid2D() const noexcept;
+
+		ElementT* GetStorage() noexcept;
+		const ElementT* GetStorage() const noexcept;
+
+		ElementT* GetRow(uint64_t Y) noexcept;
+		const ElementT* GetRow(uint64_t Y) const noexcept;
+
+		ElementT* GetTexel(const FUint64Vector2& Point) noexcept;
+		const ElementT* GetTexel(const FUint64Vector2& Point) const noexcept;
+
+		ElementT& At(const FUint64Vector2& Point, uint64_t C) noexcept;
+		const ElementT& At(const FUint64Vector2& Point, uint64_t C) const noexcept;
+
+		float GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept;
+
+		void SetFloat(const FUint64Vector2& Point, uint64_t C, float Value) noexcept;
+
+		/** Same as TTex2DView::BilinearSample. */
+		template<ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap>
+		void BilinearSample(float* Result, const FVector2f& Texcoord) const noexcept;
+
+		FView GetView() noexcept;
+		FConstView GetView() const noexcept;
+
+		/** The untyped texture, e.g. for serialization or the FTex2D algorithms. */
+		const FTex2D& GetTex2D() const noexcept;
+
+		/** Move the texture out without copy, this one becomes invalid. */
+		FTex2D ReleaseTex2D() noexcept;
+
+	private:
+		FTex2D Tex2D;
 	};
 } // UCommon
 
@@ -26,6 +26,78 @@ SOFTWARE.
 
 #include "Tex2D.h"
 
+#include <algorithm>
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/** ApplyAddressMode with the mode known at compile time. */
+		template<ETextureAddress AddressMode>
+		inline uint64_t ApplyAddressModeT(int64_t Coord, uint64_t Size) noexcept
+		{
+			const int64_t SignedSize = static_cast<int64_t>(Size);
+			if constexpr (AddressMode == ETextureAddress::Clamp)
+			{
+				return static_cast<uint64_t>(std::clamp(Coord, static_cast<int64_t>(0), SignedSize - 1));
+			}
+			else
+			{
+				if (static_cast<uint64_t>(Coord) < Size)
+				{
+					return static_cast<uint64_t>(Coord);
+				}
+				if constexpr (AddressMode == ETextureAddress::Wrap)
+				{
+					const int64_t Wrapped = Coord % SignedSize;
+					return static_cast<uint64_t>(Wrapped < 0 ? Wrapped + SignedSize : Wrapped);
+				}
+				else
+				{
+					const int64_t AbsCoord = Coord < 0 ? -Coord - 1 : Coord;
+					const int64_t Wrapped = AbsCoord % (SignedSize * 2);
+					return static_cast<uint64_t>(Wrapped >= SignedSize ? SignedSize * 2 - Wrapped - 1 : Wrapped);
+				}
+			}
+		}
+
+		inline float LoadElementFloat(const uint8_t* Element) noexcept { return ElementUint8ToFloat(*Element); }
+		inline float LoadElementFloat(const FHalf* Element) noexcept { return ElementHalfToFloat(*Element); }
+		inline float LoadElementFloat(const float* Element) noexcept { return *Element; }
+		inline float LoadElementFloat(const double* Element) noexcept { return static_cast<float>(*Element); }
+
+		inline void StoreElementFloat(uint8_t* Element, float Value) noexcept { *Element = ElementFloatToUint8(Value); }
+		inline void StoreElementFloat(FHalf* Element, float Value) noexcept { *Element = ElementFloatToHalf(Value); }
+		inline void StoreElementFloat(float* Element, float Value) noexcept { *Element = Value; }
+		inline void StoreElementFloat(double* Element, float Value) noexcept { *Element = static_cast<double>(Value); }
+
+		/** Accumulator of the box filters (DownSample), Uint8 is averaged as integers and rounded. */
+		template<typename T>
+		struct TBoxSum
+		{
+			using FType = T;
+			static FType Load(T Value) noexcept { return Value; }
+			static T Store(FType Sum, uint64_t Count) noexcept { return Sum / static_cast<T>(Count); }
+		};
+
+		template<>
+		struct TBoxSum<uint8_t>
+		{
+			using FType = uint16_t;
+			static FType Load(uint8_t Value) noexcept { return Value; }
+			static uint8_t Store(FType Sum, uint64_t Count) noexcept { return static_cast<uint8_t>((Sum + Count / 2) / Count); }
+		};
+
+		template<>
+		struct TBoxSum<FHalf>
+		{
+			using FType = float;
+			static FType Load(FHalf Value) noexcept { return ElementHalfToFloat(Value); }
+			static FHalf Store(FType Sum, uint64_t Count) noexcept { return ElementFloatToHalf(Sum / static_cast<float>(Count)); }
+		};
+	}
+}
+
 template<typename Element>
 UCommon::FTex2D::FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EOwnership InOwnership, Element* InStorage) noexcept
 	: FTex2D(InGrid2D, InNumChannels, InOwnership, ElementTypeOf<Element>, InStorage) {}
@@ -55,7 +127,7 @@ T& UCommon::FTex2D::At(const FUint64Vector2& Point, uint64_t C) noexcept
 {
 	static_assert(!UCommon::IsVector_v<T>, "T must not be a vector type");
 	UBPA_UCOMMON_ASSERT(C < NumChannels);
-	return At<T>(Grid2D.GetIndex(Point) * NumChannels + C);
+	return At<T>(GetIndex(Point, C));
 }
 
 template<typename T>
@@ -68,7 +140,8 @@ template<typename T>
 T& UCommon::FTex2D::At(const FUint64Vector2& Point) noexcept
 {
 	static_assert(UCommon::IsVector_v<T>, "T must be a vector type");
-	return At<T>(Grid2D.GetIndex(Point));
+	UBPA_UCOMMON_ASSERT(StorageLayout != ETex2DStorageLayout::Planar);
+	return At<T>(GetTexelIndex(Point));
 }
 
 template<typename T>
@@ -76,3 +149,286 @@ const T& UCommon::FTex2D::At(const FUint64Vector2& Point) const noexcept
 {
 	return const_cast<UCommon::FTex2D*>(this)->At<T>(Point);
 }
+
+template<typename T>
+const T& UCommon::FConstTex2DView::At(const FUint64Vector2& Point, uint64_t C) const noexcept
+{
+	static_assert(!UCommon::IsVector_v<T>, "T must not be a vector type");
+	UBPA_UCOMMON_ASSERT(ElementType == ElementTypeOf<T>);
+	UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point) && C < NumChannels);
+	return reinterpret_cast<const T*>(GetRow(Point.Y))[Point.X * NumChannels + C];
+}
+
+template<typename T>
+const T& UCommon::FConstTex2DView::At(const FUint64Vector2& Point) const noexcept
+{
+	static_assert(UCommon::IsVector_v<T>, "T must be a vector type");
+	UBPA_UCOMMON_ASSERT(ElementType == ElementTypeOf<T>);
+	UBPA_UCOMMON_ASSERT(sizeof(T) == NumChannels * ElementGetSize(ElementType));
+	UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point));
+	return reinterpret_cast<const T*>(GetRow(Point.Y))[Point.X];
+}
+
+template<typename T>
+T& UCommon::FTex2DView::At(const FUint64Vector2& Point, uint64_t C) const noexcept
+{
+	return const_cast<T&>(FConstTex2DView::At<T>(Point, C));
+}
+
+template<typename T>
+T& UCommon::FTex2DView::At(const FUint64Vector2& Point) const noexcept
+{
+	return const_cast<T&>(FConstTex2DView::At<T>(Point));
+}
+
+template<typename OpT>
+void UCommon::FTex2DView::Apply(OpT&& Op, FThreadPool* ThreadPool) const
+{
+	using FOp = std::remove_reference_t<OpT>;
+	ApplyImpl([](void* Context, float* Values, uint64_t NumValues) { (*static_cast<FOp*>(Context))(Values, NumValues); },
+		const_cast<void*>(static_cast<const void*>(&Op)), ThreadPool);
+}
+
+template<typename OpT>
+void UCommon::FTex2D::Apply(OpT&& Op, FThreadPool* ThreadPool)
+{
+	GetStorageView().Apply(std::forward<OpT>(Op), ThreadPool);
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+UCommon::TTex2DView<ElementT, N, bConst>::TTex2DView() noexcept :
+	Storage(nullptr),
+	RowStride(0) {}
+
+template<typename ElementT, uint64_t N, bool bConst>
+UCommon::TTex2DView<ElementT, N, bConst>::TTex2DView(FElement* InStorage, const FGrid2D& InGrid2D, uint64_t InRowStride) noexcept :
+	Storage(reinterpret_cast<decltype(Storage)>(InStorage)),
+	Grid2D(InGrid2D),
+	RowStride(InRowStride != 0 ? InRowStride : InGrid2D.Width * N * sizeof(ElementT))
+{
+	UBPA_UCOMMON_ASSERT(RowStride >= GetRowSizeInBytes());
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+UCommon::TTex2DView<ElementT, N, bConst>::TTex2DView(const FUntypedView& View) noexcept :
+	Storage(View.GetGrid2D().Height > 0 ? static_cast<decltype(Storage)>(View.GetRow(0)) : nullptr),
+	Grid2D(View.GetGrid2D()),
+	RowStride(View.GetRowStride())
+{
+	UBPA_UCOMMON_ASSERT(View.GetElementType() == ElementType && View.GetNumChannels() == N);
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+template<bool bOtherConst, std::enable_if_t<bConst && !bOtherConst, int>>
+UCommon::TTex2DView<ElementT, N, bConst>::TTex2DView(const TTex2DView<ElementT, N, bOtherConst>& Other) noexcept :
+	Storage(Other.Storage),
+	Grid2D(Other.Grid2D),
+	RowStride(Other.RowStride) {}
+
+template<typename ElementT, uint64_t N, bool bConst>
+UCommon::TTex2DView<ElementT, N, bConst>::operator FUntypedView() const noexcept
+{
+	return FUntypedView(Storage, Grid2D, N, ElementType, RowStride);
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+bool UCommon::TTex2DView<ElementT, N, bConst>::IsValid() const noexcept { return !Grid2D.IsAreaEmpty() && Storage; }
+
+template<typename ElementT, uint64_t N, bool bConst>
+const UCommon::FGrid2D& UCommon::TTex2DView<ElementT, N, bConst>::GetGrid2D() const noexcept { return Grid2D; }
+
+template<typename ElementT, uint64_t N, bool bConst>
+uint64_t UCommon::TTex2DView<ElementT, N, bConst>::GetRowStride() const noexcept { return RowStride; }
+
+template<typename ElementT, uint64_t N, bool bConst>
+uint64_t UCommon::TTex2DView<ElementT, N, bConst>::GetRowSizeInBytes() const noexcept { return Grid2D.Width * N * sizeof(ElementT); }
+
+template<typename ElementT, uint64_t N, bool bConst>
+bool UCommon::TTex2DView<ElementT, N, bConst>::IsContiguous() const noexcept { return RowStride == GetRowSizeInBytes(); }
+
+template<typename ElementT, uint64_t N, bool bConst>
+auto UCommon::TTex2DView<ElementT, N, bConst>::GetRow(uint64_t Y) const noexcept -> FElement*
+{
+	UBPA_UCOMMON_ASSERT(Y < Grid2D.Height);
+	return reinterpret_cast<FElement*>(Storage + Y * RowStride);
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+auto UCommon::TTex2DView<ElementT, N, bConst>::GetTexel(const FUint64Vector2& Point) const noexcept -> FElement*
+{
+	UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point));
+	return GetRow(Point.Y) + Point.X * N;
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+auto UCommon::TTex2DView<ElementT, N, bConst>::At(const FUint64Vector2& Point, uint64_t C) const noexcept -> FElement&
+{
+	UBPA_UCOMMON_ASSERT(C < N);
+	return GetTexel(Point)[C];
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+float UCommon::TTex2DView<ElementT, N, bConst>::GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept
+{
+	return Details::LoadElementFloat(&At(Point, C));
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+void UCommon::TTex2DView<ElementT, N, bConst>::SetFloat(const FUint64Vector2& Point, uint64_t C, float Value) const noexcept
+{
+	static_assert(!bConst, "the view is read-only");
+	Details::StoreElementFloat(&At(Point, C), Value);
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+UCommon::TTex2DView<ElementT, N, bConst> UCommon::TTex2DView<ElementT, N, bConst>::GetSubView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(InOrigin.X + InGrid2D.Width <= Grid2D.Width && InOrigin.Y + InGrid2D.Height <= Grid2D.Height);
+	FElement* Origin = reinterpret_cast<FElement*>(Storage + InOrigin.Y * RowStride) + InOrigin.X * N;
+	return TTex2DView(Origin, InGrid2D, RowStride);
+}
+
+template<typename ElementT, uint64_t N, bool bConst>
+template<UCommon::ETextureAddress AddressModeX, UCommon::ETextureAddress AddressModeY>
+void UCommon::TTex2DView<ElementT, N, bConst>::BilinearSample(float* Result, const FVector2f& Texcoord) const noexcept
+{
+	const FUint64Vector2 Extent = Grid2D.GetExtent();
+	const FVector2f PointT = Texcoord * FVector2f(Extent);
+	const FVector2f PointTOffset = PointT - 0.5f;
+	const FInt64Vector2 IntPoint0 = FInt64Vector2(PointTOffset.Floor());
+
+	const uint64_t X0 = Details::ApplyAddressModeT<AddressModeX>(IntPoint0.X, Extent.X);
+	const uint64_t X1 = Details::ApplyAddressModeT<AddressModeX>(IntPoint0.X + 1, Extent.X);
+	const uint64_t Y0 = Details::ApplyAddressModeT<AddressModeY>(IntPoint0.Y, Extent.Y);
+	const uint64_t Y1 = Details::ApplyAddressModeT<AddressModeY>(IntPoint0.Y + 1, Extent.Y);
+
+	const FVector2f LocalTexcoord = (PointT - (FVector2f(IntPoint0) + 0.5f)).Clamp(0.f, 1.f);
+	const FVector2f OneMinusLocalTexcoord = FVector2f(1.f) - LocalTexcoord;
+
+	const float Weights[4] =
+	{
+		OneMinusLocalTexcoord.X * OneMinusLocalTexcoord.Y,
+		OneMinusLocalTexcoord.X * LocalTexcoord.Y,
+		LocalTexcoord.X * OneMinusLocalTexcoord.Y,
+		LocalTexcoord.X * LocalTexcoord.Y,
+	};
+
+	const FElement* Row0 = GetRow(Y0);
+	const FElement* Row1 = GetRow(Y1);
+	const FElement* Texels[4] = { Row0 + X0 * N, Row1 + X0 * N, Row0 + X1 * N, Row1 + X1 * N };
+
+	for (uint64_t C = 0; C < N; C++)
+	{
+		const float Val2[4] =
+		{
+			Details::LoadElementFloat(Texels[0] + C),
+			Details::LoadElementFloat(Texels[1] + C),
+			Details::LoadElementFloat(Texels[2] + C),
+			Details::LoadElementFloat(Texels[3] + C),
+		};
+		Result[C] = UCommon::BilinearInterpolate(Val2, Weights);
+	}
+}
+
+template<typename ElementT, uint64_t N>
+UCommon::TTex2D<ElementT, N>::TTex2D() noexcept {}
+
+template<typename ElementT, uint64_t N>
+UCommon::TTex2D<ElementT, N>::TTex2D(const FGrid2D& InGrid2D) :
+	Tex2D(InGrid2D, N, ElementType) {}
+
+template<typename ElementT, uint64_t N>
+UCommon::TTex2D<ElementT, N>::TTex2D(FTex2D InTex2D) noexcept :
+	Tex2D(std::move(InTex2D))
+{
+	UBPA_UCOMMON_ASSERT(!Tex2D.IsValid()
+		|| (Tex2D.GetElementType() == ElementType && Tex2D.GetNumChannels() == N && Tex2D.GetStorageLayout() == ETex2DStorageLayout::Linear));
+}
+
+template<typename ElementT, uint64_t N>
+bool UCommon::TTex2D<ElementT, N>::IsValid() const noexcept { return Tex2D.IsValid(); }
+
+template<typename ElementT, uint64_t N>
+const UCommon::FGrid2D& UCommon::TTex2D<ElementT, N>::GetGrid2D() const noexcept { return Tex2D.GetGrid2D(); }
+
+template<typename ElementT, uint64_t N>
+ElementT* UCommon::TTex2D<ElementT, N>::GetStorage() noexcept { return static_cast<ElementT*>(Tex2D.GetStorage()); }
+
+template<typename ElementT, uint64_t N>
+const ElementT* UCommon::TTex2D<ElementT, N>::GetStorage() const noexcept { return static_cast<const ElementT*>(Tex2D.GetStorage()); }
+
+template<typename ElementT, uint64_t N>
+ElementT* UCommon::TTex2D<ElementT, N>::GetRow(uint64_t Y) noexcept
+{
+	return const_cast<ElementT*>(static_cast<const TTex2D*>(this)->GetRow(Y));
+}
+
+template<typename ElementT, uint64_t N>
+const ElementT* UCommon::TTex2D<ElementT, N>::GetRow(uint64_t Y) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Y < GetGrid2D().Height);
+	return GetStorage() + Y * GetGrid2D().Width * N;
+}
+
+template<typename ElementT, uint64_t N>
+ElementT* UCommon::TTex2D<ElementT, N>::GetTexel(const FUint64Vector2& Point) noexcept
+{
+	return const_cast<ElementT*>(static_cast<const TTex2D*>(this)->GetTexel(Point));
+}
+
+template<typename ElementT, uint64_t N>
+const ElementT* UCommon::TTex2D<ElementT, N>::GetTexel(const FUint64Vector2& Point) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(GetGrid2D().Contains(Point));
+	return GetStorage() + (Point.Y * GetGrid2D().Width + Point.X) * N;
+}
+
+template<typename ElementT, uint64_t N>
+ElementT& UCommon::TTex2D<ElementT, N>::At(const FUint64Vector2& Point, uint64_t C) noexcept
+{
+	return const_cast<ElementT&>(static_cast<const TTex2D*>(this)->At(Point, C));
+}
+
+template<typename ElementT, uint64_t N>
+const ElementT& UCommon::TTex2D<ElementT, N>::At(const FUint64Vector2& Point, uint64_t C) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(C < N);
+	return GetTexel(Point)[C];
+}
+
+template<typename ElementT, uint64_t N>
+float UCommon::TTex2D<ElementT, N>::GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept
+{
+	return Details::LoadElementFloat(&At(Point, C));
+}
+
+template<typename ElementT, uint64_t N>
+void UCommon::TTex2D<ElementT, N>::SetFloat(const FUint64Vector2& Point, uint64_t C, float Value) noexcept
+{
+	Details::StoreElementFloat(&At(Point, C), Value);
+}
+
+template<typename ElementT, uint64_t N>
+template<UCommon::ETextureAddress AddressModeX, UCommon::ETextureAddress AddressModeY>
+void UCommon::TTex2D<ElementT, N>::BilinearSample(float* Result, const FVector2f& Texcoord) const noexcept
+{
+	GetView().template BilinearSample<AddressModeX, AddressModeY>(Result, Texcoord);
+}
+
+template<typename ElementT, uint64_t N>
+typename UCommon::TTex2D<ElementT, N>::FView UCommon::TTex2D<ElementT, N>::GetView() noexcept
+{
+	return FView(GetStorage(), GetGrid2D());
+}
+
+template<typename ElementT, uint64_t N>
+typename UCommon::TTex2D<ElementT, N>::FConstView UCommon::TTex2D<ElementT, N>::GetView() const noexcept
+{
+	return FConstView(GetStorage(), GetGrid2D());
+}
+
+template<typename ElementT, uint64_t N>
+const UCommon::FTex2D& UCommon::TTex2D<ElementT, N>::GetTex2D() const noexcept { return Tex2D; }
+
+template<typename ElementT, uint64_t N>
+UCommon::FTex2D UCommon::TTex2D<ElementT, N>::ReleaseTex2D() noexcept { return std::move(Tex2D); }
@@ -0,0 +1,349 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Tex2D.h"
+
+#define UBPA_UCOMMON_TEX3D_TO_NAMESPACE(NameSpace) \
+namespace NameSpace \
+{ \
+    using FGrid3DIterator = UCommon::FGrid3DIterator; \
+    using FGrid3D = UCommon::FGrid3D; \
+    using ETex3DStorageLayout = UCommon::ETex3DStorageLayout; \
+    using FTex3D = UCommon::FTex3D; \
+    using FTex3DMipChain = UCommon::FTex3DMipChain; \
+}
+
+namespace UCommon
+{
+	struct FGrid3DIterator;
+	class FTex3DMipChain;
+
+	/** Order of the texels in the storage of a FTex3D. */
+	enum class ETex3DStorageLayout : std::uint64_t
+	{
+		Linear, /** Slice-major then row-major, FGrid3D::GetIndex. Slice Z is a Linear Width x Height texture. */
+		/**
+		 * 4x4x4 bricks in slice-major then row-major order, the texels of a brick in Morton order,
+		 * Width, Height and Depth are padded to multiples of 4. The 8 taps of TrilinearSample are mostly in one brick,
+		 * so neighbouring rows and slices share cache lines.
+		 */
+		Bricked,
+	};
+
+	struct UBPA_UCOMMON_API FGrid3D
+	{
+		uint64_t Width;
+		uint64_t Height;
+		uint64_t Depth;
+
+		FGrid3D(uint64_t InWidth, uint64_t InHeight, uint64_t InDepth) noexcept;
+		FGrid3D(const FUint64Vector& Size) noexcept;
+		FGrid3D() noexcept;
+
+		/** Width x Height x Depth */
+		uint64_t GetVolume() const noexcept;
+
+		bool IsVolumeEmpty() const noexcept;
+
+		/** Width x Height */
+		FGrid2D GetSliceGrid2D() const noexcept;
+
+		bool Contains(const FUint64Vector& Point) const noexcept;
+
+		uint64_t GetIndex(const FUint64Vector& Point) const noexcept;
+
+		FVector3f GetTexcoord(const FUint64Vector& Point) const noexcept;
+
+		FUint64Vector GetPoint(const FVector3f& Texcoord) const noexcept;
+		FUint64Vector GetPoint(uint64_t Index) const noexcept;
+
+		FUint64Vector GetExtent() const noexcept;
+
+		uint64_t GetNumMips() const noexcept;
+
+		uint64_t& operator[](uint64_t Index) noexcept;
+		const uint64_t& operator[](uint64_t Index) const noexcept;
+
+		FGrid3DIterator GetIterator(const FUint64Vector& Point) const noexcept;
+		FGrid3DIterator GetIterator(uint64_t Index) const noexcept;
+
+		FGrid3DIterator begin() const noexcept;
+		FGrid3DIterator end() const noexcept;
+
+		UBPA_UCOMMON_API friend bool operator==(const FGrid3D& Lhs, const FGrid3D& Rhs) noexcept;
+		UBPA_UCOMMON_API friend bool operator!=(const FGrid3D& Lhs, const FGrid3D& Rhs) noexcept;
+	};
+
+	struct UBPA_UCOMMON_API FGrid3DIterator
+	{
+		FGrid3D Grid3D;
+		FUint64Vector Point;
+
+		FGrid3DIterator& operator++() noexcept
+		{
+			if (++Point.X == Grid3D.Width)
+			{
+				Point.X = 0;
+				if (++Point.Y == Grid3D.Height)
+				{
+					Point.Y = 0;
+					++Point.Z;
+				}
+			}
+
+			return *this;
+		}
+
+		const FUint64Vector& operator*() const noexcept
+		{
+			return Point;
+		}
+
+		friend bool operator!=(const FGrid3DIterator& Lhs, const FGrid3DIterator& Rhs) noexcept
+		{
+			UBPA_UCOMMON_ASSERT(Lhs.Grid3D == Rhs.Grid3D);
+			return Lhs.Point != Rhs.Point;
+		}
+	};
+
+	/**
+	 * Volume texture, e.g. a probe volume of SH coefficients.
+	 * The storage is held by a FTex2D (see GetFlatTex2D), so the ownership, allocation and element types are the same as FTex2D's:
+	 * Linear stacks the slices vertically (Width x Height * Depth), Bricked has one brick per row (64 x NumBricks).
+	 */
+	class UBPA_UCOMMON_API FTex3D
+	{
+	public:
+		static uint64_t GetRequiredStorageSizeInBytes(const FGrid3D& Grid3D, uint64_t NumChannels, EElementType ElementType, ETex3DStorageLayout StorageLayout = ETex3DStorageLayout::Linear) noexcept;
+		static uint64_t GetNumElements(const FGrid3D& Grid3D, uint64_t NumChannels, ETex3DStorageLayout StorageLayout = ETex3DStorageLayout::Linear) noexcept;
+
+		/** The Grid3D the storage is allocated for, Grid3D padded to whole bricks if Bricked. */
+		static FGrid3D GetStorageGrid3D(const FGrid3D& Grid3D, ETex3DStorageLayout StorageLayout) noexcept;
+
+		/** The Grid2D of the FTex2D holding the storage. */
+		static FGrid2D GetFlatGrid2D(const FGrid3D& Grid3D, ETex3DStorageLayout StorageLayout) noexcept;
+
+		FTex3D() noexcept;
+
+		/**
+		 * An advanced contructor (no initalization).
+		 *
+		 * @param InOwnership control the ownership of InStorage.
+		 * @param InStorage the storage of the texture, deleted by `free`.
+		 * @param InStorageLayout the order of the texels in InStorage.
+		 */
+		FTex3D(const FGrid3D& InGrid3D, uint64_t InNumChannels, EOwnership InOwnership, EElementType InElementType, void* InStorage, ETex3DStorageLayout InStorageLayout = ETex3DStorageLayout::Linear) noexcept;
+
+		/** Allocate a storage internally by AllocateTex2DStorage (no initialization). */
+		FTex3D(const FGrid3D& InGrid3D, uint64_t InNumChannels, EElementType InElementType, ETex3DStorageLayout InStorageLayout = ETex3DStorageLayout::Linear);
+
+		/**
+		 * Linear volume of the InDepth slices stacked vertically in InFlatTex2D, keeping its storage and ownership.
+		 * InFlatTex2D must be Linear and its Height a multiple of InDepth.
+		 */
+		FTex3D(FTex2D InFlatTex2D, uint64_t InDepth) noexcept;
+
+		/**
+		 * Copy with the explicitly specified ownership and InEmptyStorage (may be nullptr),
+		 * same as the FTex2D constructor.
+		 */
+		FTex3D(const FTex3D& Other, EOwnership InOwnership, void* InEmptyStorage);
+
+		/** Copy with propagated ownership. */
+		FTex3D(const FTex3D& Other);
+
+		FTex3D(FTex3D&& Other) noexcept;
+
+		~FTex3D();
+
+		bool IsValid() const noexcept;
+
+		const FGrid3D& GetGrid3D() const noexcept;
+
+		uint64_t GetNumChannels() const noexcept;
+
+		/** Number of elements in the storage, including the padding texels if Bricked. */
+		uint64_t GetNumElements() const noexcept;
+
+		EOwnership GetStorageOwnership() const noexcept;
+
+		ETex3DStorageLayout GetStorageLayout() const noexcept;
+
+		EElementType GetElementType() const noexcept;
+
+		/** Number of bytes in the storage. */
+		uint64_t GetStorageSizeInBytes() const noexcept;
+
+		void* GetStorage() noexcept;
+		const void* GetStorage() const noexcept;
+
+		/** The FTex2D holding the storage. */
+		const FTex2D& GetFlatTex2D() const noexcept;
+
+		/** Index of the texel at Point in the storage, in texels, following the storage layout. */
+		uint64_t GetTexelIndex(const FUint64Vector& Point) const noexcept;
+
+		/** Index of the element in the storage, following the storage layout. */
+		uint64_t GetIndex(const FUint64Vector& Point, uint64_t C) const noexcept;
+
+		/** Slice Z as a Width x Height view, without copy, the storage layout must be Linear. */
+		FTex2DView GetSliceView(uint64_t Z) noexcept;
+		FConstTex2DView GetSliceView(uint64_t Z) const noexcept;
+
+		template<typename T>
+		T& At(uint64_t Index) noexcept;
+		template<typename T>
+		const T& At(uint64_t Index) const noexcept;
+
+		template<typename T>
+		T& At(const FUint64Vector& Point, uint64_t C) noexcept;
+		template<typename T>
+		const T& At(const FUint64Vector& Point, uint64_t C) const noexcept;
+
+		/** The whole texel as a vector. */
+		template<typename T>
+		T& At(const FUint64Vector& Point) noexcept;
+		template<typename T>
+		const T& At(const FUint64Vector& Point) const noexcept;
+
+		float GetFloat(uint64_t Index) const noexcept;
+		float GetFloat(const FUint64Vector& Point, uint64_t C) const noexcept;
+
+		void SetFloat(uint64_t Index, float Value) noexcept;
+		void SetFloat(const FUint64Vector& Point, uint64_t C, float Value) noexcept;
+
+		/** Release the storage and reset all member variables. */
+		void Reset() noexcept;
+
+		/** Whether `Grid3D`, `NumChannels`, `ElementType` and the storage layout are the same as `Other`'s. */
+		bool IsLayoutSameWith(const FTex3D& Other) const noexcept;
+
+		/**
+		 * Trilinear filtering of the 8 texels around Texcoord, texel centers at (Point + 0.5) / Extent,
+		 * the same conventions as FTex2D::BilinearSample. Result has NumChannels floats.
+		 */
+		void TrilinearSample(float* Result, const FVector3f& Texcoord, ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap, ETextureAddress AddressModeZ = ETextureAddress::Wrap) const noexcept;
+
+		/**
+		 * TrilinearSample for each of Texcoords, Results has Texcoords.Num() * NumChannels floats.
+		 * The kernel is picked once per call (specialized for ElementType and the storage layout),
+		 * with AVX2 the taps of 8 samples are computed together, a single channel is gathered
+		 * and the channels of a texel are interpolated 8 at a time for Float/Half.
+		 * Texcoords are split across ThreadPool if not nullptr.
+		 * Results are the same as TrilinearSample, up to rounding if the compiler contracts into FMA.
+		 */
+		void TrilinearSampleBatch(TSpan<const FVector3f> Texcoords, float* Results, ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap, ETextureAddress AddressModeZ = ETextureAddress::Wrap, FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Average of 2x2x2 texels, each extent is halved (at least 1, an extent of 1 is not filtered).
+		 * Supports Uint8 (as unorm), Half, Float, Double. The result has the same storage layout.
+		 */
+		FTex3D DownSample(FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Generate the whole mip chain (Grid3D.GetNumMips() levels) in one allocation, level 0 is a copy.
+		 * Each level is DownSample of the previous one, slices are split across ThreadPool if not nullptr.
+		 * The levels have the same storage layout.
+		 */
+		FTex3DMipChain GenerateMips(FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * Copy with the texels reordered into InStorageLayout (the padding texels of Bricked are zero).
+		 * Slices are split across ThreadPool if not nullptr.
+		 */
+		FTex3D ToStorageLayout(ETex3DStorageLayout InStorageLayout, FThreadPool* ThreadPool = nullptr) const;
+
+		/**
+		 * If layout is same with Rhs's, just copy the storage,
+		 * else copy with propagated ownership.
+		 */
+		FTex3D& operator=(const FTex3D& Rhs);
+
+		FTex3D& operator=(FTex3D&& Rhs) noexcept;
+
+		/**
+		 * Grid3D followed by the slices as one Linear FTex2D (see FTex2D::Serialize), so a loaded Linear texture
+		 * may point into a FMappedFileArchive. Bricked textures are saved through a Linear copy,
+		 * loading gives a Linear texture, use ToStorageLayout to reorder it again.
+		 * Loading a truncated or inconsistent archive gives an empty texture (IsValid() is false).
+		 */
+		void Serialize(IArchive& Archive);
+
+	private:
+		FGrid3D Grid3D;
+		ETex3DStorageLayout StorageLayout;
+		FTex2D FlatTex2D;
+	};
+
+	/**
+	 * Mip levels of a FTex3D stored back to back in one allocation, level 0 first.
+	 * GetMip returns a view (DoNotTakeOwnership) into the storage.
+	 */
+	class UBPA_UCOMMON_API FTex3DMipChain
+	{
+	public:
+		FTex3DMipChain() noexcept;
+
+		/**
+		 * Allocate the storage of levels [0, InNumMips) internally by AllocateTex2DStorage (no initialization).
+		 *
+		 * @param InGrid3D the Grid3D of level 0, level i is max(1, Width >> i) x max(1, Height >> i) x max(1, Depth >> i).
+		 * @param InNumMips the number of levels, 0 means InGrid3D.GetNumMips().
+		 */
+		FTex3DMipChain(const FGrid3D& InGrid3D, uint64_t InNumChannels, EElementType InElementType, ETex3DStorageLayout InStorageLayout = ETex3DStorageLayout::Linear, uint64_t InNumMips = 0);
+
+		bool IsValid() const noexcept;
+
+		uint64_t GetNumMips() const noexcept;
+
+		FGrid3D GetMipGrid3D(uint64_t Level) const noexcept;
+
+		uint64_t GetNumChannels() const noexcept;
+
+		EElementType GetElementType() const noexcept;
+
+		ETex3DStorageLayout GetStorageLayout() const noexcept;
+
+		FTex3D GetMip(uint64_t Level) noexcept;
+		const FTex3D GetMip(uint64_t Level) const noexcept;
+
+		/** All levels as one row of texels. */
+		const FTex2D& GetFlatTex2D() const noexcept;
+
+	private:
+		/** Offset of the level in the storage, in texels. */
+		uint64_t GetMipOffset(uint64_t Level) const noexcept;
+
+		FGrid3D Grid3D;
+		uint64_t NumMips;
+		ETex3DStorageLayout StorageLayout;
+		FTex2D FlatTex2D;
+	};
+} // UCommon
+
+UBPA_UCOMMON_TEX3D_TO_NAMESPACE(UCommonTest)
+
+#include "Tex3D.inl"
@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Tex3D.h"
+
+template<typename T>
+T& UCommon::FTex3D::At(uint64_t Index) noexcept
+{
+	return FlatTex2D.At<T>(Index);
+}
+
+template<typename T>
+const T& UCommon::FTex3D::At(uint64_t Index) const noexcept
+{
+	return const_cast<UCommon::FTex3D*>(this)->At<T>(Index);
+}
+
+template<typename T>
+T& UCommon::FTex3D::At(const FUint64Vector& Point, uint64_t C) noexcept
+{
+	static_assert(!UCommon::IsVector_v<T>, "T must not be a vector type");
+	return At<T>(GetIndex(Point, C));
+}
+
+template<typename T>
+const T& UCommon::FTex3D::At(const FUint64Vector& Point, uint64_t C) const noexcept
+{
+	return const_cast<UCommon::FTex3D*>(this)->At<T>(Point, C);
+}
+
+template<typename T>
+T& UCommon::FTex3D::At(const FUint64Vector& Point) noexcept
+{
+	static_assert(UCommon::IsVector_v<T>, "T must be a vector type");
+	return At<T>(GetTexelIndex(Point));
+}
+
+template<typename T>
+const T& UCommon::FTex3D::At(const FUint64Vector& Point) const noexcept
+{
+	return const_cast<UCommon::FTex3D*>(this)->At<T>(Point);
+}
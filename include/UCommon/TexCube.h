@@ -159,6 +159,10 @@ namespace UCommon
 
 		FGridCube GetGridCube() const noexcept;
 
+		/** The face as a view into FlatTex2D, without copy. */
+		FTex2DView GetFaceView(ECubeFace Face) noexcept;
+		FConstTex2DView GetFaceView(ECubeFace Face) const noexcept;
+
 		void BilinearSample(float* Result, const FCubeTexcoord& CubeTexcoord) const noexcept;
 
 		void ToEquirectangular(FTex2D& Equirectangular) const;
@@ -24,43 +24,429 @@ SOFTWARE.
 
 #pragma once
 
-#include "Cpp17.h"
+#include "Vector.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
 #include <functional>
 #include <future>
+#include <mutex>
+#include <new>
 
 #define UBPA_UCOMMON_THREAD_POOL_TO_NAMESPACE(NameSpace) \
 namespace NameSpace \
 { \
+	using FTask = UCommon::FTask; \
+	template<typename T> using TTaskFuture = UCommon::TTaskFuture<T>; \
 	using FThreadPool = UCommon::FThreadPool; \
 	using FThreadPoolRegistry = UCommon::FThreadPoolRegistry; \
 }
 
 namespace UCommon
 {
+    struct FGrid2D;
+    class FThreadPool;
+
+    /**
+     * Move-only type-erased void() callable.
+     * Callables of at most InlineSize bytes (and nothrow movable) are stored in place,
+     * larger ones are allocated on the heap and counted by FThreadPool::GetNumTaskAllocations().
+     */
+    class UBPA_UCOMMON_API FTask
+    {
+    public:
+        static constexpr uint64_t InlineSize = 56;
+
+        FTask() noexcept : VTable(nullptr) {}
+
+        template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, FTask>::value>>
+        FTask(F&& Function)
+        {
+            using FFunction = std::decay_t<F>;
+            Construct(std::forward<F>(Function), std::integral_constant<bool,
+                sizeof(FFunction) <= InlineSize && alignof(FFunction) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<FFunction>::value>());
+        }
+
+        FTask(FTask&& Other) noexcept : VTable(Other.VTable)
+        {
+            if (VTable)
+            {
+                VTable->Move(Storage, Other.Storage);
+                Other.VTable = nullptr;
+            }
+        }
+
+        FTask& operator=(FTask&& Rhs) noexcept
+        {
+            FTask Tmp(std::move(Rhs));
+            Reset();
+            if (Tmp.VTable)
+            {
+                Tmp.VTable->Move(Storage, Tmp.Storage);
+                VTable = Tmp.VTable;
+                Tmp.VTable = nullptr;
+            }
+            return *this;
+        }
+
+        ~FTask() { Reset(); }
+
+        void operator()() { UBPA_UCOMMON_ASSERT(VTable); VTable->Invoke(Storage); }
+
+        bool IsValid() const noexcept { return VTable != nullptr; }
+
+        /** Counted heap allocation used by the task machinery. */
+        static void* Allocate(uint64_t Size);
+        static void Free(void* Pointer) noexcept;
+
+        FTask(const FTask&) = delete;
+        FTask& operator=(const FTask&) = delete;
+
+    private:
+        struct FVTable
+        {
+            void (*Invoke)(void* Storage);
+            /** Move-construct Dst from Src and destroy Src. */
+            void (*Move)(void* Dst, void* Src) noexcept;
+            void (*Destroy)(void* Storage) noexcept;
+        };
+
+        template<typename F>
+        struct TInlineOps
+        {
+            static void Invoke(void* Storage) { (*static_cast<F*>(Storage))(); }
+            static void Move(void* Dst, void* Src) noexcept { new(Dst) F(std::move(*static_cast<F*>(Src))); static_cast<F*>(Src)->~F(); }
+            static void Destroy(void* Storage) noexcept { static_cast<F*>(Storage)->~F(); }
+            static const FVTable* GetVTable() noexcept { static const FVTable VTable = { &Invoke, &Move, &Destroy }; return &VTable; }
+        };
+
+        template<typename F>
+        struct THeapOps
+        {
+            static void Invoke(void* Storage) { (**static_cast<F**>(Storage))(); }
+            static void Move(void* Dst, void* Src) noexcept { *static_cast<F**>(Dst) = *static_cast<F**>(Src); }
+            static void Destroy(void* Storage) noexcept { F* Function = *static_cast<F**>(Storage); Function->~F(); Free(Function); }
+            static const FVTable* GetVTable() noexcept { static const FVTable VTable = { &Invoke, &Move, &Destroy }; return &VTable; }
+        };
+
+        template<typename F>
+        void Construct(F&& Function, std::true_type /*bInline*/)
+        {
+            using FFunction = std::decay_t<F>;
+            new(Storage) FFunction(std::forward<F>(Function));
+            VTable = TInlineOps<FFunction>::GetVTable();
+        }
+
+        template<typename F>
+        void Construct(F&& Function, std::false_type /*bInline*/)
+        {
+            using FFunction = std::decay_t<F>;
+            *reinterpret_cast<FFunction**>(Storage) = new(Allocate(sizeof(FFunction))) FFunction(std::forward<F>(Function));
+            VTable = THeapOps<FFunction>::GetVTable();
+        }
+
+        void Reset() noexcept
+        {
+            if (VTable)
+            {
+                VTable->Destroy(Storage);
+                VTable = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) unsigned char Storage[InlineSize];
+        const FVTable* VTable;
+    };
+
+    namespace Details
+    {
+        /**
+         * Shared state of a TTaskFuture, recycled through a per-type free list.
+         * The task and the future each hold a reference (a bit of Flags); the task drops its
+         * reference and publishes the result in one atomic step, so once the future sees
+         * the result it is the last owner.
+         * Recycled states are never freed before exit, late notifications are only spurious wakeups.
+         */
+        struct FTaskStateBase
+        {
+            static constexpr uint32_t TaskRef = 1;
+            static constexpr uint32_t FutureRef = 2;
+            static constexpr uint32_t Ready = 4;
+
+            std::atomic<uint32_t> Flags{ 0 };
+            std::mutex Mutex;
+            std::condition_variable Condition;
+            /** Set instead of the value when the task threw, published by Ready like the value. */
+            std::exception_ptr Exception;
+
+            bool IsReady() const noexcept { return (Flags.load(std::memory_order_acquire) & Ready) != 0; }
+        };
+
+        template<typename T>
+        struct TTaskStateStorage : FTaskStateBase
+        {
+            static_assert(!std::is_reference<T>::value && alignof(T) <= alignof(std::max_align_t), "unsupported task result type");
+
+            alignas(T) unsigned char Storage[sizeof(T)];
+
+            template<typename F>
+            void Run(F& Function) { new(Storage) T(Function()); }
+            T& GetValue() noexcept { return *reinterpret_cast<T*>(Storage); }
+            /** Destroys the result of a completed task, the value or the exception. */
+            void DestroyValue() noexcept
+            {
+                if (this->Exception)
+                {
+                    this->Exception = nullptr;
+                    return;
+                }
+                GetValue().~T();
+            }
+        };
+
+        template<>
+        struct TTaskStateStorage<void> : FTaskStateBase
+        {
+            template<typename F>
+            void Run(F& Function) { Function(); }
+            void GetValue() noexcept {}
+            void DestroyValue() noexcept { this->Exception = nullptr; }
+        };
+
+        template<typename T>
+        struct TTaskState : TTaskStateStorage<T>
+        {
+            using FTaskStateBase::TaskRef;
+            using FTaskStateBase::FutureRef;
+            using FTaskStateBase::Ready;
+
+            TTaskState* NextFree = nullptr;
+
+            struct FFreeList
+            {
+                std::mutex Mutex;
+                TTaskState* Head = nullptr;
+
+                ~FFreeList()
+                {
+                    while (Head)
+                    {
+                        TTaskState* State = Head;
+                        Head = State->NextFree;
+                        State->~TTaskState();
+                        FTask::Free(State);
+                    }
+                }
+            };
+
+            static FFreeList& GetFreeList()
+            {
+                static FFreeList FreeList;
+                return FreeList;
+            }
+
+            /** Returns a state referenced by a future and a task. */
+            static TTaskState* Acquire()
+            {
+                TTaskState* State = nullptr;
+                {
+                    FFreeList& FreeList = GetFreeList();
+                    std::lock_guard<std::mutex> Lock(FreeList.Mutex);
+                    if (FreeList.Head)
+                    {
+                        State = FreeList.Head;
+                        FreeList.Head = State->NextFree;
+                    }
+                }
+                if (!State)
+                {
+                    State = new(FTask::Allocate(sizeof(TTaskState))) TTaskState;
+                }
+                State->Flags.store(TaskRef | FutureRef, std::memory_order_relaxed);
+                return State;
+            }
+
+            static void Recycle(TTaskState* State) noexcept
+            {
+                FFreeList& FreeList = GetFreeList();
+                std::lock_guard<std::mutex> Lock(FreeList.Mutex);
+                State->NextFree = FreeList.Head;
+                FreeList.Head = State;
+            }
+
+            /** Called by the task after running: drop the task reference and publish the result. */
+            void Complete() noexcept
+            {
+                const uint32_t Old = this->Flags.fetch_xor(TaskRef | Ready, std::memory_order_acq_rel);
+                if (!(Old & FutureRef))
+                {
+                    this->DestroyValue();
+                    Recycle(this);
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> Lock(this->Mutex);
+                }
+                this->Condition.notify_all();
+            }
+
+            /** Called by a task that never ran. */
+            void ReleaseTask() noexcept
+            {
+                const uint32_t Old = this->Flags.fetch_and(~TaskRef, std::memory_order_acq_rel);
+                if (!(Old & FutureRef))
+                {
+                    Recycle(this);
+                }
+            }
+
+            void ReleaseFuture() noexcept
+            {
+                const uint32_t Old = this->Flags.fetch_and(~FutureRef, std::memory_order_acq_rel);
+                if (!(Old & TaskRef))
+                {
+                    if (Old & Ready)
+                    {
+                        this->DestroyValue();
+                    }
+                    Recycle(this);
+                }
+            }
+        };
+
+        /** The callable stored in the FTask of FThreadPool::EnqueueTask, owns the task reference to the state. */
+        template<typename T, typename F>
+        struct TTaskRunner
+        {
+            F Function;
+            TTaskState<T>* State;
+
+            TTaskRunner(F&& InFunction, TTaskState<T>* InState) : Function(std::move(InFunction)), State(InState) {}
+            TTaskRunner(TTaskRunner&& Other) noexcept(std::is_nothrow_move_constructible<F>::value)
+                : Function(std::move(Other.Function)), State(Other.State) { Other.State = nullptr; }
+            ~TTaskRunner() { if (State) { State->ReleaseTask(); } }
+
+            void operator()()
+            {
+                TTaskState<T>* RunState = State;
+                State = nullptr;
+                // like std::packaged_task: the exception goes to the future, the worker and the state survive
+                try
+                {
+                    RunState->Run(Function);
+                }
+                catch (...)
+                {
+                    RunState->Exception = std::current_exception();
+                }
+                RunState->Complete();
+            }
+        };
+    }
+
+    /**
+     * Future of FThreadPool::EnqueueTask.
+     * Its shared state comes from a pool, so no allocation happens once the pool is warm.
+     * Wait() runs other tasks of the thread pool while the result is not ready.
+     */
+    template<typename T>
+    class TTaskFuture
+    {
+    public:
+        TTaskFuture() noexcept : State(nullptr), ThreadPool(nullptr) {}
+        TTaskFuture(Details::TTaskState<T>* InState, FThreadPool* InThreadPool) noexcept : State(InState), ThreadPool(InThreadPool) {}
+        TTaskFuture(TTaskFuture&& Other) noexcept : State(Other.State), ThreadPool(Other.ThreadPool) { Other.State = nullptr; }
+        TTaskFuture& operator=(TTaskFuture&& Rhs) noexcept
+        {
+            TTaskFuture Tmp(std::move(Rhs));
+            std::swap(State, Tmp.State);
+            std::swap(ThreadPool, Tmp.ThreadPool);
+            return *this;
+        }
+        ~TTaskFuture() { Reset(); }
+
+        bool IsValid() const noexcept { return State != nullptr; }
+
+        bool IsReady() const noexcept
+        {
+            UBPA_UCOMMON_ASSERT(IsValid());
+            return State->IsReady();
+        }
+
+        void Wait() const;
+
+        /** Waits and moves the result out, call it at most once. Rethrows the exception of the task if it threw. */
+        T Get()
+        {
+            Wait();
+            if (State->Exception)
+            {
+                std::rethrow_exception(State->Exception);
+            }
+            if constexpr (!std::is_void_v<T>)
+            {
+                return std::move(State->GetValue());
+            }
+        }
+
+        void Reset() noexcept
+        {
+            if (State)
+            {
+                State->ReleaseFuture();
+                State = nullptr;
+            }
+        }
+
+        TTaskFuture(const TTaskFuture&) = delete;
+        TTaskFuture& operator=(const TTaskFuture&) = delete;
+
+    private:
+        Details::TTaskState<T>* State;
+        FThreadPool* ThreadPool;
+    };
+
     class UBPA_UCOMMON_API FThreadPool
     {
         struct FImpl;
         FImpl* Impl;
     public:
-        FThreadPool(uint64_t NumThread = std::thread::hardware_concurrency());
+        enum class EScheduler : uint32_t
+        {
+            /** One FIFO queue shared by all workers behind a single mutex. */
+            SharedQueue = 0,
+            /**
+             * One deque per worker. Workers pop their own deque in LIFO order and
+             * steal from the front (FIFO) of other workers' deques when it is empty.
+             * Tasks enqueued from a worker go to that worker's deque, others are
+             * distributed round-robin.
+             */
+            WorkStealing = 1,
+        };
+
+        FThreadPool(uint64_t NumThread = std::thread::hardware_concurrency(), EScheduler Scheduler = EScheduler::SharedQueue);
         ~FThreadPool();
 
         bool Enqueue(std::function<void()> Function);
 
+        /** Fire-and-forget enqueue, allocation-free for callables that fit in FTask::InlineSize. */
+        bool Enqueue(FTask Task);
+
         /** Add new work item to the pool. */
         template<class F, class... Args>
         std::future<InvokeResult_t<F, Args...>> Enqueue(F&& Function, Args&&... Arguments)
         {
             using return_type = InvokeResult_t<F, Args...>;
 
-            auto task = new std::packaged_task<return_type()>(
+            std::packaged_task<return_type()> task(
                 std::bind(std::forward<F>(Function), std::forward<Args>(Arguments)...)
                 );
 
-            std::future<return_type> res = task->get_future();
+            std::future<return_type> res = task.get_future();
 
-            if (!Enqueue(std::function<void()>([task]() { (*task)(); delete task; })))
+            if (!Enqueue(FTask(std::move(task))))
             {
                 return std::future<return_type>();
             }
@@ -68,12 +454,135 @@ namespace UCommon
             return res;
         }
 
+        /**
+         * Add new work item to the pool and return a pooled future.
+         * Unlike Enqueue, nothing is allocated in the steady state when the bound callable
+         * fits in FTask::InlineSize (together with one pointer).
+         */
+        template<class F, class... Args>
+        TTaskFuture<InvokeResult_t<F, Args...>> EnqueueTask(F&& Function, Args&&... Arguments)
+        {
+            using return_type = InvokeResult_t<F, Args...>;
+            using FBound = decltype(std::bind(std::forward<F>(Function), std::forward<Args>(Arguments)...));
+
+            Details::TTaskState<return_type>* State = Details::TTaskState<return_type>::Acquire();
+            TTaskFuture<return_type> Future(State, this);
+
+            if (!Enqueue(FTask(Details::TTaskRunner<return_type, FBound>(
+                std::bind(std::forward<F>(Function), std::forward<Args>(Arguments)...), State))))
+            {
+                return TTaskFuture<return_type>();
+            }
+
+            return Future;
+        }
+
+        /**
+         * Run Body(Index) for every Index in [Begin, End).
+         * The range is split into chunks of GrainSize indices (0 picks a chunk size
+         * from the number of threads), and the calling thread runs chunks too.
+         * Returns when every index has been processed.
+         * Can be called from a task of this pool (nested parallel regions).
+         */
+        template<typename BodyT>
+        void ParallelFor(uint64_t Begin, uint64_t End, uint64_t GrainSize, BodyT&& Body)
+        {
+            ParallelForRange(Begin, End, GrainSize, [&Body](uint64_t ChunkBegin, uint64_t ChunkEnd)
+            {
+                for (uint64_t Index = ChunkBegin; Index < ChunkEnd; Index++)
+                {
+                    Body(Index);
+                }
+            });
+        }
+
+        /** Same as ParallelFor, but calls Body(ChunkBegin, ChunkEnd) once per chunk. */
+        template<typename BodyT>
+        void ParallelForRange(uint64_t Begin, uint64_t End, uint64_t GrainSize, BodyT&& Body)
+        {
+            using FBody = std::remove_reference_t<BodyT>;
+            ParallelForImpl(Begin, End, GrainSize,
+                [](void* Context, uint64_t ChunkBegin, uint64_t ChunkEnd) { (*static_cast<FBody*>(Context))(ChunkBegin, ChunkEnd); },
+                const_cast<void*>(static_cast<const void*>(&Body)));
+        }
+
+        /**
+         * Split Grid into tiles of TileSize texels (the last row/column of tiles may be smaller)
+         * and call Body(TileMin, TileMax) once per tile, TileMax exclusive.
+         * Same threading guarantees as ParallelFor.
+         */
+        template<typename BodyT>
+        void ParallelFor(const FGrid2D& Grid, const FUint64Vector2& TileSize, BodyT&& Body)
+        {
+            using FBody = std::remove_reference_t<BodyT>;
+            ParallelFor2DImpl(Grid, TileSize,
+                [](void* Context, const FUint64Vector2& TileMin, const FUint64Vector2& TileMax) { (*static_cast<FBody*>(Context))(TileMin, TileMax); },
+                const_cast<void*>(static_cast<const void*>(&Body)));
+        }
+
+        /**
+         * Run one queued task on the calling thread, if any.
+         * Used to help the pool instead of blocking while waiting for tasks.
+         */
+        bool TryRunOneTask();
+
+        /**
+         * Block until Predicate() holds, running queued tasks meanwhile.
+         * The thread that makes Predicate() true must lock Mutex before notifying Condition.
+         * The pool notifies Condition too when a task is enqueued, so the caller only sleeps
+         * while there is nothing to help with.
+         */
+        template<typename PredicateT>
+        void WaitUntil(std::mutex& Mutex, std::condition_variable& Condition, PredicateT&& Predicate)
+        {
+            using FPredicate = std::remove_reference_t<PredicateT>;
+            WaitUntilImpl(Mutex, Condition,
+                [](void* Context) { return static_cast<bool>((*static_cast<FPredicate*>(Context))()); },
+                const_cast<void*>(static_cast<const void*>(&Predicate)));
+        }
+
         size_t GetNumThreads() const noexcept;
 
+        EScheduler GetScheduler() const noexcept;
+
+        /**
+         * Number of heap allocations made by the task machinery so far (all pools):
+         * FTask callables too large for the inline storage, pooled future states and task queue growth.
+         * Constant in the steady state of the allocation-free paths.
+         */
+        static uint64_t GetNumTaskAllocations() noexcept;
+
         FThreadPool(const FThreadPool&) = delete;
         FThreadPool& operator=(const FThreadPool&) = delete;
+
+    private:
+        using FRangeFunction = void(*)(void* Context, uint64_t ChunkBegin, uint64_t ChunkEnd);
+        using FTileFunction = void(*)(void* Context, const FUint64Vector2& TileMin, const FUint64Vector2& TileMax);
+        using FPredicateFunction = bool(*)(void* Context);
+
+        void ParallelForImpl(uint64_t Begin, uint64_t End, uint64_t GrainSize, FRangeFunction Function, void* Context);
+        void ParallelFor2DImpl(const FGrid2D& Grid, const FUint64Vector2& TileSize, FTileFunction Function, void* Context);
+        void WaitUntilImpl(std::mutex& Mutex, std::condition_variable& Condition, FPredicateFunction Predicate, void* Context);
     };
 
+    template<typename T>
+    void TTaskFuture<T>::Wait() const
+    {
+        UBPA_UCOMMON_ASSERT(IsValid());
+        if (IsReady())
+        {
+            return;
+        }
+        if (ThreadPool)
+        {
+            // woken by the completion and by tasks enqueued meanwhile, which may be needed to finish this one
+            ThreadPool->WaitUntil(State->Mutex, State->Condition, [this] { return IsReady(); });
+            return;
+        }
+        std::unique_lock<std::mutex> Lock(State->Mutex);
+        State->Condition.wait(Lock, [this] { return IsReady(); });
+    }
+
     class UBPA_UCOMMON_API FThreadPoolRegistry
     {
     public:
@@ -34,11 +34,14 @@ SOFTWARE.
 #include "Half.h"
 #include "Matrix.h"
 #include "SH.h"
+#include "TaskGraph.h"
 #include "Tex2D.h"
+#include "Tex3D.h"
 #include "TexCube.h"
 #include "ThreadPool.h"
 #include "Utils.h"
 #include "Vector.h"
+#include "VirtualTex2D.h"
 
 #define UBPA_UCOMMON_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_ARCHIVE_TO_NAMESPACE(NameSpace) \
@@ -50,8 +53,11 @@ UBPA_UCOMMON_GUID_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_HALF_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_MATRIX_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_SH_TO_NAMESPACE(NameSpace) \
+UBPA_UCOMMON_TASK_GRAPH_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_TEX2D_TO_NAMESPACE(NameSpace) \
+UBPA_UCOMMON_TEX3D_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_TEXCUBE_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_THREAD_POOL_TO_NAMESPACE(NameSpace) \
 UBPA_UCOMMON_UTILS_TO_NAMESPACE(NameSpace) \
-UBPA_UCOMMON_VECTOR_TO_NAMESPACE(NameSpace)
+UBPA_UCOMMON_VECTOR_TO_NAMESPACE(NameSpace) \
+UBPA_UCOMMON_VIRTUAL_TEX2D_TO_NAMESPACE(NameSpace)
@@ -472,6 +472,14 @@ namespace UCommon
 	static FColor ElementDoubleColorClampToColor(const FDoubleColor& Element) noexcept
 	{ return { ElementDoubleClampToUint8(Element.X), ElementDoubleClampToUint8(Element.Y), ElementDoubleClampToUint8(Element.Z), ElementDoubleClampToUint8(Element.W) }; }
 
+	/**
+	 * Convert NumElements elements of SrcType to DstType, both in Uint8, Half, Float and Double.
+	 * Same results as the scalar helpers above: Uint8 is unorm, conversions to Uint8 clamp
+	 * (ElementFloatClampToUint8 of the float value) and Double goes to Half through float.
+	 * Vectorized (SSE2/AVX2/F16C or NEON) when the build enables it.
+	 */
+	UBPA_UCOMMON_API void ElementConvert(void* Dst, EElementType DstType, const void* Src, EElementType SrcType, uint64_t NumElements) noexcept;
+
 	static bool ElementIsASTC(EElementType ElementType) noexcept
 	{
 		return (uint64_t)ElementType >= (uint64_t)EElementType::ASTC_4x4
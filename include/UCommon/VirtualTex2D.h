@@ -0,0 +1,156 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Tex2D.h"
+
+#define UBPA_UCOMMON_VIRTUAL_TEX2D_TO_NAMESPACE(NameSpace) \
+namespace NameSpace \
+{ \
+    using FVirtualTex2D = UCommon::FVirtualTex2D; \
+}
+
+namespace UCommon
+{
+	class FThreadPool;
+
+	/**
+	 * Out-of-core texture: the texels live in a file as square tiles, only a fixed budget of tiles is kept in memory.
+	 * Accesses page tiles in on demand, the least recently used tile is evicted and written back if it is dirty.
+	 * Layout: FFileArchive header | Grid2D, NumChannels, ElementType, TileSize | tile 0 | tile 1 | ... | version map
+	 * Tiles are packed Linear textures of TileSize x TileSize texels in row-major order, the edge tiles are padded.
+	 *
+	 * The texel accessors change the cache, so they are not const, and a texture must not be used by several threads at once.
+	 */
+	class UBPA_UCOMMON_API FVirtualTex2D
+	{
+	public:
+		struct FStats
+		{
+			uint64_t NumHits = 0; /** Tile accesses served by the cache. */
+			uint64_t NumMisses = 0; /** Tile accesses which paged a tile in. */
+			uint64_t NumReads = 0; /** Tiles read from the file, misses which overwrite the whole tile don't read it. */
+			uint64_t NumWriteBacks = 0; /** Dirty tiles written to the file. */
+		};
+
+		static constexpr uint64_t DefaultTileSize = 128;
+		static constexpr uint64_t DefaultCacheSizeInBytes = uint64_t(256) << 20;
+
+		/**
+		 * The cache keeps CacheSizeInBytes / (bytes of a tile) tiles, and never less than 4,
+		 * the footprint of a bilinear sample.
+		 */
+		static uint64_t GetNumCachedTiles(uint64_t TileSize, uint64_t NumChannels, EElementType ElementType, uint64_t CacheSizeInBytes) noexcept;
+
+		FVirtualTex2D() noexcept;
+
+		/** Create the file (replacing any), all texels are 0 until written. */
+		FVirtualTex2D(const char* FilePath, const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType,
+			uint64_t InTileSize = DefaultTileSize, uint64_t CacheSizeInBytes = DefaultCacheSizeInBytes);
+
+		/**
+		 * Open a file of FVirtualTex2D, invalid if the header is damaged or the file doesn't hold all the tiles.
+		 * Writes need bWritable: on a read-only texture SetFloat, CopyFrom, Clamp and ImageInpainting do nothing
+		 * and Flush() returns false.
+		 */
+		explicit FVirtualTex2D(const char* FilePath, bool bWritable = false, uint64_t CacheSizeInBytes = DefaultCacheSizeInBytes);
+
+		FVirtualTex2D(FVirtualTex2D&& Other) noexcept;
+		FVirtualTex2D& operator=(FVirtualTex2D&& Other) noexcept;
+		void Swap(FVirtualTex2D& Other) noexcept;
+
+		/** Writes the dirty tiles back. */
+		~FVirtualTex2D();
+
+		bool IsValid() const noexcept;
+
+		bool IsWritable() const noexcept;
+
+		const FGrid2D& GetGrid2D() const noexcept;
+
+		uint64_t GetNumChannels() const noexcept;
+
+		EElementType GetElementType() const noexcept;
+
+		uint64_t GetTileSize() const noexcept;
+
+		/** Number of tiles along X and Y. */
+		FGrid2D GetTileGrid2D() const noexcept;
+
+		uint64_t GetNumCachedTiles() const noexcept;
+
+		float GetFloat(const FUint64Vector2& Point, uint64_t C);
+
+		/** Uint8 must be in [0, 1] as FTex2D::SetFloat. */
+		void SetFloat(const FUint64Vector2& Point, uint64_t C, float Value);
+
+		/** Same as FTex2D::BilinearSample. */
+		void BilinearSample(float* Result, const FVector2f& Texcoord, ETextureAddress AddressModeX = ETextureAddress::Wrap, ETextureAddress AddressModeY = ETextureAddress::Wrap);
+
+		/** Copy the texels [Origin, Origin + Dst extent) into Dst, which has the same NumChannels and ElementType. */
+		void CopyTo(const FTex2DView& Dst, const FUint64Vector2& Origin);
+
+		/** Copy Src (same NumChannels and ElementType) to the texels [Origin, Origin + Src extent), whole tiles are not read. */
+		void CopyFrom(const FUint64Vector2& Origin, const FConstTex2DView& Src);
+
+		/**
+		 * Write the dirty tiles back, returns false if a tile failed to be read or written since the texture was opened,
+		 * or a write was rejected because the texture is read-only.
+		 */
+		bool Flush();
+
+		/**
+		 * Same as FTex2D::DownSample(), into a new file with the same tile size and cache budget.
+		 * Each destination tile is computed from its source window alone, so the result is identical to the in-memory one.
+		 * Besides the caches of both textures, the peak memory adds the window of (2 * TileSize)^2 texels and its half.
+		 */
+		FVirtualTex2D DownSample(const char* DstFilePath);
+
+		/** Same as FTex2D::Clamp, one tile at a time, each tile is split across ThreadPool if not nullptr. */
+		void Clamp(float MinValue, float MaxValue, FThreadPool* ThreadPool = nullptr);
+
+		/**
+		 * FTex2D::ImageInpainting one tile at a time: each tile is inpainted within a window of Apron texels around it
+		 * (clipped at the edges) and only the tile is written back, so holes are filled from at most Apron texels away.
+		 * The result equals the in-memory one when the window covers the texture.
+		 * The window is not part of the cache budgets: besides the caches of both textures, the peak memory adds
+		 * (TileSize + 2 * Apron)^2 texels of this texture and of CoverageData, plus the working memory
+		 * of FTex2D::ImageInpainting on the window.
+		 *
+		 * @param CoverageData same Grid2D and 1 or NumChannels channels, any tile size.
+		 * @param Apron 0 means one tile size.
+		 */
+		void ImageInpainting(FVirtualTex2D& CoverageData, uint64_t Apron = 0, FThreadPool* ThreadPool = nullptr);
+
+		FStats GetStats() const noexcept;
+		void ResetStats() noexcept;
+
+	private:
+		struct FImpl;
+		FImpl* Impl;
+	};
+} // UCommon
+
+UBPA_UCOMMON_VIRTUAL_TEX2D_TO_NAMESPACE(UCommonTest)
@@ -53,17 +53,17 @@ int main(int Argc, char** Argv)
 		}
 	}
 
-	// Load FTex2D from binary file
-	FTex2D Tex2D;
+	// Load FTex2D from binary file.
+	// The file is memory-mapped and Tex2D points into the mapping (pages are read on demand),
+	// so Reader must outlive Tex2D.
+	FMappedFileArchive Reader(InputPath);
+	if (!Reader.IsValid())
 	{
-		FFileArchive Reader(IArchive::EState::Loading, InputPath);
-		if (!Reader.IsValid())
-		{
-			std::cerr << "Error: Failed to open input file: " << InputPath << std::endl;
-			return 1;
-		}
-		Tex2D.Serialize(Reader);
+		std::cerr << "Error: Failed to open input file: " << InputPath << std::endl;
+		return 1;
 	}
+	FTex2D Tex2D;
+	Tex2D.Serialize(Reader);
 
 	// Check if texture is valid
 	if (!Tex2D.IsValid())
@@ -94,27 +94,8 @@ int main(int Argc, char** Argv)
 
 	std::cout << "Cropping region: [" << X << ", " << (X + W) << ") x [" << Y << ", " << (Y + H) << ")" << std::endl;
 
-	// Create cropped texture
-	const FGrid2D CroppedGrid2D(W, H);
-	const uint64_t NumChannels = Tex2D.GetNumChannels();
-	const EElementType ElementType = Tex2D.GetElementType();
-	FTex2D CroppedTex2D(CroppedGrid2D, NumChannels, ElementType);
-
-	// Copy pixel data
-	const uint64_t ElementSize = ElementGetSize(ElementType);
-	const uint64_t RowSizeInBytes = W * NumChannels * ElementSize;
-
-	for (uint64_t DstY = 0; DstY < H; ++DstY)
-	{
-		const uint64_t SrcY = Y + DstY;
-		const uint64_t SrcOffset = (SrcY * Grid2D.Width + X) * NumChannels * ElementSize;
-		const uint64_t DstOffset = DstY * W * NumChannels * ElementSize;
-
-		const uint8_t* SrcPtr = static_cast<const uint8_t*>(Tex2D.GetStorage()) + SrcOffset;
-		uint8_t* DstPtr = static_cast<uint8_t*>(CroppedTex2D.GetStorage()) + DstOffset;
-
-		std::memcpy(DstPtr, SrcPtr, RowSizeInBytes);
-	}
+	// The crop is a view into the mapped texture, saved without a copy
+	const FConstTex2DView CroppedView = Tex2D.GetView(FUint64Vector2(X, Y), FGrid2D(W, H));
 
 	// Save cropped texture
 	{
@@ -124,7 +105,7 @@ int main(int Argc, char** Argv)
 			std::cerr << "Error: Failed to create output file: " << OutputPath << std::endl;
 			return 1;
 		}
-		CroppedTex2D.Serialize(Writer);
+		CroppedView.Save(Writer);
 	}
 
 	std::cout << "Output Texture Info:" << std::endl;
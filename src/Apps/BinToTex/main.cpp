@@ -44,17 +44,17 @@ int main(int Argc, char** Argv)
 		}
 	}
 
-	// Load FTex2D from binary file
-	FTex2D Tex2D;
+	// Load FTex2D from binary file.
+	// The file is memory-mapped and Tex2D points into the mapping (pages are read on demand),
+	// so Reader must outlive Tex2D.
+	FMappedFileArchive Reader(InputPath);
+	if (!Reader.IsValid())
 	{
-		FFileArchive Reader(IArchive::EState::Loading, InputPath);
-		if (!Reader.IsValid())
-		{
-			std::cerr << "Error: Failed to open input file: " << InputPath << std::endl;
-			return 1;
-		}
-		Tex2D.Serialize(Reader);
+		std::cerr << "Error: Failed to open input file: " << InputPath << std::endl;
+		return 1;
 	}
+	FTex2D Tex2D;
+	Tex2D.Serialize(Reader);
 
 	// Check if texture is valid
 	if (!Tex2D.IsValid())
@@ -1,8 +1,10 @@
 #include <UCommon/UCommon.h>
 #include <UCommon_ext/Tex2DIO.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 
 using namespace UCommon;
 
@@ -86,11 +88,13 @@ int main(int Argc, char** Argv)
 	{
 		std::cout << "Preparing inpainting..." << std::endl;
 		
-		// Convert to Float if needed (ImageInpainting requires non-Uint8 coverage)
-		FTex2D ProcessTex = (ElementType == EElementType::Uint8) ? Tex2D.ToFloat() : Tex2D;
+		FThreadPool ThreadPool(std::max(1u, std::thread::hardware_concurrency()));
+
+		// Convert to Float if needed, so that the filled colors are not quantized to Uint8 on every mip level
+		FTex2D ProcessTex = (ElementType == EElementType::Uint8) ? Tex2D.ToFloat(&ThreadPool) : Tex2D;
 		
-		// Create coverage texture based on whether pixels are all zero
-		FTex2D CoverageTex(Grid2D, ProcessTex.GetNumChannels(), ProcessTex.GetElementType());
+		// Create coverage texture based on whether pixels are all zero, one Uint8 channel shared by all color channels
+		FTex2D CoverageTex(Grid2D, 1, EElementType::Uint8);
 		
 		std::cout << "Generating coverage map (pixels with all channels = 0 are uncovered)..." << std::endl;
 		
@@ -115,10 +119,7 @@ int main(int Argc, char** Argv)
 				NumUncoveredPixels++;
 			}
 			
-			for (uint64_t C = 0; C < CoverageTex.GetNumChannels(); C++)
-			{
-				CoverageTex.SetFloat(Point, C, CoverageValue);
-			}
+			CoverageTex.SetFloat(Point, 0, CoverageValue);
 		}
 		
 		const uint64_t TotalPixels = Grid2D.Width * Grid2D.Height;
@@ -138,12 +139,12 @@ int main(int Argc, char** Argv)
 		else
 		{
 			std::cout << "Performing inpainting..." << std::endl;
-			ProcessTex.ImageInpainting(CoverageTex);
+			ProcessTex.ImageInpainting(CoverageTex, &ThreadPool);
 			std::cout << "Inpainting completed successfully" << std::endl;
 		}
 		
 		// Convert back to original type if needed
-		Tex2D = (ElementType == EElementType::Uint8) ? ProcessTex.ToUint8() : ProcessTex;
+		Tex2D = (ElementType == EElementType::Uint8) ? ProcessTex.ToUint8(&ThreadPool) : ProcessTex;
 	}
 	else
 	{
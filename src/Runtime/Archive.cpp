@@ -23,10 +23,117 @@ SOFTWARE.
 */
 
 #include <UCommon/Archive.h>
+#include <UCommon/ThreadPool.h>
 
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <unordered_map>
 #include <fstream>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace UCommon
+{
+	/** Header of the files written by FFileArchive, the version map is at the end of the file. */
+	struct FFileArchiveHeader
+	{
+		uint8_t Magic[4] = { 'U', 'b', 'p', 'a' };
+		uint32_t NumVersionKeys = 0;
+		uint64_t VersionMapOffset = 0;
+	};
+
+	/**
+	 * Append-only byte storage of the saving archives.
+	 * Grows geometrically without initializing the new bytes, or writes into a fixed external buffer.
+	 */
+	class FWriteBuffer
+	{
+	public:
+		FWriteBuffer() = default;
+		FWriteBuffer(uint8_t* InData, uint64_t InCapacity)
+			: Data(InData), Capacity(InCapacity), bExternal(true) {}
+		FWriteBuffer(const FWriteBuffer&) = delete;
+		FWriteBuffer& operator=(const FWriteBuffer&) = delete;
+		~FWriteBuffer()
+		{
+			if (!bExternal)
+			{
+				UBPA_UCOMMON_FREE(Data);
+			}
+		}
+
+		/** Returns false if a fixed buffer can't grow or the allocation fails, the storage is unchanged then. */
+		bool Reserve(uint64_t NewCapacity)
+		{
+			if (NewCapacity <= Capacity)
+			{
+				return true;
+			}
+			if (bExternal)
+			{
+				UBPA_UCOMMON_ASSERT(false && "a fixed buffer can't grow");
+				return false;
+			}
+			uint8_t* NewData = static_cast<uint8_t*>(UBPA_UCOMMON_REALLOC(Data, NewCapacity));
+			if (!NewData)
+			{
+				return false;
+			}
+			Data = NewData;
+			Capacity = NewCapacity;
+			return true;
+		}
+
+		/** Returns false if a fixed buffer is too small or growing fails, nothing is written then. */
+		bool Append(const void* Pointer, uint64_t Length)
+		{
+			if (Length == 0)
+			{
+				return true;
+			}
+			if (Size + Length > Capacity)
+			{
+				if (bExternal)
+				{
+					return false;
+				}
+				// geometric growth first, the exact size if that much memory isn't available
+				if (!Reserve(std::max(Size + Length, std::max<uint64_t>(2 * Capacity, 256))) && !Reserve(Size + Length))
+				{
+					return false;
+				}
+			}
+			std::memcpy(Data + Size, Pointer, Length);
+			Size += Length;
+			return true;
+		}
+
+		uint8_t* GetData() noexcept { return Data; }
+		const uint8_t* GetData() const noexcept { return Data; }
+		uint64_t GetSize() const noexcept { return Size; }
+
+	private:
+		uint8_t* Data = nullptr;
+		uint64_t Size = 0;
+		uint64_t Capacity = 0;
+		bool bExternal = false;
+	};
+}
 
 //////////////
 // IArchive //
@@ -125,16 +232,23 @@ struct UCommon::FMemoryArchive::FImpl
 {
 	FImpl(TSpan<const uint8_t> Storage)
 		: ReadStorage(Storage) {}
+	FImpl(uint8_t* Buffer, uint64_t Capacity)
+		: WriteStorage(Buffer, Capacity) {}
 
 	TSpan<const uint8_t> ReadStorage;
-	std::vector<uint8_t> WriteStorage;
+	FWriteBuffer WriteStorage;
 	uint64_t ReadIndex = 0;
+	bool bOverflowed = false;
 };
 
 UCommon::FMemoryArchive::FMemoryArchive(TSpan<const uint8_t> Storage)
 	: IArchive(Storage.Empty() ? EState::Saving : EState::Loading)
 	, Impl(new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(Storage)) {}
 
+UCommon::FMemoryArchive::FMemoryArchive(uint8_t* Buffer, uint64_t Capacity)
+	: IArchive(EState::Saving)
+	, Impl(new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(Buffer, Capacity)) {}
+
 UCommon::FMemoryArchive::FMemoryArchive(FMemoryArchive&& Other) noexcept
 	: IArchive(std::move(Other))
 	, Impl(Other.Impl)
@@ -172,14 +286,24 @@ void UCommon::FMemoryArchive::Serialize(void* Pointer, uint64_t Length)
 		std::memcpy(Pointer, Impl->ReadStorage.GetData() + Impl->ReadIndex, Length);
 		Impl->ReadIndex += Length;
 	}
-	else
+	else if (!Impl->bOverflowed && !Impl->WriteStorage.Append(Pointer, Length))
 	{
-		const size_t OriginalSize = Impl->WriteStorage.size();
-		Impl->WriteStorage.resize(OriginalSize + Length);
-		std::memcpy(Impl->WriteStorage.data() + OriginalSize, Pointer, Length);
+		UBPA_UCOMMON_ASSERT(false && "the fixed buffer is full or out of memory");
+		Impl->bOverflowed = true;
 	}
 }
 
+bool UCommon::FMemoryArchive::IsValid() const noexcept
+{
+	return !Impl->bOverflowed;
+}
+
+void UCommon::FMemoryArchive::Reserve(uint64_t Capacity)
+{
+	UBPA_UCOMMON_ASSERT(GetState() == EState::Saving);
+	Impl->WriteStorage.Reserve(Capacity);
+}
+
 UCommon::TSpan<const uint8_t> UCommon::FMemoryArchive::GetStorage() const
 {
 	if (GetState() == EState::Loading)
@@ -188,7 +312,7 @@ UCommon::TSpan<const uint8_t> UCommon::FMemoryArchive::GetStorage() const
 	}
 	else
 	{
-		return { Impl->WriteStorage.data(), Impl->WriteStorage.size() };
+		return { Impl->WriteStorage.GetData(), Impl->WriteStorage.GetSize() };
 	}
 }
 
@@ -211,7 +335,7 @@ struct UCommon::FArchiveWrapper::FImpl
 	}
 
 	IArchive* Archive = nullptr;
-	std::vector<uint8_t> WriteStorage;
+	FWriteBuffer WriteStorage;
 };
 
 UCommon::FArchiveWrapper::FArchiveWrapper(IArchive* InArchive)
@@ -270,7 +394,7 @@ UCommon::FArchiveWrapper::~FArchiveWrapper()
 		if (GetState() == EState::Saving)
 		{
 			FImpl::FHeader Header;
-			Header.Size = Impl->WriteStorage.size();
+			Header.Size = Impl->WriteStorage.GetSize();
 			Header.NumVersionKeys = Header.Size > 0 ? (uint32_t)GetVersionKeys().Num() : 0;
 			Impl->Archive->ByteSerialize(Header);
 			if (Header.NumVersionKeys > 0)
@@ -284,7 +408,7 @@ UCommon::FArchiveWrapper::~FArchiveWrapper()
 			}
 			if (Header.Size > 0)
 			{
-				Impl->Archive->Serialize(Impl->WriteStorage.data(), Impl->WriteStorage.size());
+				Impl->Archive->Serialize(Impl->WriteStorage.GetData(), Impl->WriteStorage.GetSize());
 			}
 		}
 		Impl->~FImpl();
@@ -297,6 +421,21 @@ bool UCommon::FArchiveWrapper::IsValid() const noexcept
 	return Impl->Archive != nullptr;
 }
 
+const void* UCommon::FArchiveWrapper::SerializeView(uint64_t Length)
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	if (GetState() == EState::Loading)
+	{
+		return Impl->Archive->SerializeView(Length);
+	}
+	return nullptr;
+}
+
+bool UCommon::FArchiveWrapper::CanSerializeView() const
+{
+	return GetState() == EState::Loading && Impl->Archive && Impl->Archive->CanSerializeView();
+}
+
 void UCommon::FArchiveWrapper::Serialize(void* Pointer, uint64_t Length)
 {
 	UBPA_UCOMMON_ASSERT(IsValid());
@@ -306,153 +445,1478 @@ void UCommon::FArchiveWrapper::Serialize(void* Pointer, uint64_t Length)
 	}
 	else
 	{
-		const size_t OriginalSize = Impl->WriteStorage.size();
-		Impl->WriteStorage.resize(OriginalSize + Length);
-		std::memcpy(Impl->WriteStorage.data() + OriginalSize, Pointer, Length);
+		if (!Impl->WriteStorage.Append(Pointer, Length))
+		{
+			UBPA_UCOMMON_ASSERT(false && "out of memory");
+		}
 	}
 }
 
-//////////////////
-// FFileArchive //
-//////////////////
+void UCommon::FArchiveWrapper::Reserve(uint64_t Capacity)
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && GetState() == EState::Saving);
+	Impl->WriteStorage.Reserve(Capacity);
+}
 
-struct UCommon::FFileArchive::FImpl
+////////////////////////
+// FCompressedArchive //
+////////////////////////
+
+namespace UCommon
 {
-	struct FHeader
+	namespace Details
 	{
-		uint8_t Magic[4] = { 'U', 'b', 'p', 'a' };
-		uint32_t NumVersionKeys = 0;
-		uint64_t VersionMapOffset = 0;
-	};
+		/**
+		 * LZ77 codec with an LZ4-like sequence layout:
+		 * token (literal length << 4 | match length - 4), extra length bytes when a nibble is 15,
+		 * literals, 16-bit little-endian offset, extra match length bytes.
+		 * The last sequence has literals only, at least LZLastLiterals of them when the input is long enough.
+		 */
+		constexpr uint64_t LZMinMatch = 4;
+		constexpr uint64_t LZLastLiterals = 5;
+		constexpr uint64_t LZMaxOffset = 65535;
+		constexpr uint32_t LZHashLog = 14;
 
-	FImpl(EState State, const char* FilePath)
-	{
-		if (State == EState::Loading)
+		static uint64_t LZCompressBound(uint64_t Size)
 		{
-			Ifs.open(FilePath, std::ifstream::binary);
+			return Size + Size / 255 + 16;
 		}
-		else
+
+		static uint32_t LZRead32(const uint8_t* Pointer)
 		{
-			Ofs.open(FilePath, std::ofstream::binary);
+			uint32_t Value;
+			std::memcpy(&Value, Pointer, sizeof(uint32_t));
+			return Value;
 		}
-	}
-	std::ifstream Ifs;
-	std::ofstream Ofs;
-};
 
-UCommon::FFileArchive::FFileArchive(EState State, const char* FilePath)
-	: IArchive(State)
-	, Impl(new UBPA_UCOMMON_MALLOC(sizeof(FImpl))FImpl(State, FilePath))
-{
-	if (!IsValid())
-	{
-		return;
-	}
+		static uint32_t LZHash(uint32_t Sequence)
+		{
+			return (Sequence * 2654435761u) >> (32 - LZHashLog);
+		}
 
-	FImpl::FHeader Header;
-	ByteSerialize(Header);
-	UBPA_UCOMMON_ASSERT(std::memcmp(Header.Magic, "Ubpa", 4) == 0);
-	if (GetState() == EState::Loading
-		&& Header.NumVersionKeys > 0)
-	{
-		Seek(Header.VersionMapOffset);
-		for (uint32_t Index = 0; Index < Header.NumVersionKeys; Index++)
+		static void LZWriteLength(uint8_t*& Output, uint64_t Length)
 		{
-			uint64_t Key;
-			int64_t Version;
-			ByteSerialize(Key);
-			ByteSerialize(Version);
-			LoadVersion(Key, Version);
+			while (Length >= 255)
+			{
+				*Output++ = 255;
+				Length -= 255;
+			}
+			*Output++ = (uint8_t)Length;
 		}
-		Seek(sizeof(FImpl::FHeader));
-	}
-}
 
-UCommon::FFileArchive::~FFileArchive()
-{
-	if (Impl)
-	{
-		if (GetState() == EState::Saving)
+		static uint8_t* LZWriteSequence(uint8_t* Output, const uint8_t* Literals, uint64_t NumLiterals, uint64_t Offset, uint64_t MatchLength)
 		{
-			FImpl::FHeader Header;
-			Header.VersionMapOffset = Tell();
-			Header.NumVersionKeys = (uint32_t)GetVersionKeys().Num();
-			Seek(0);
-			ByteSerialize(Header);
-			Seek(Header.VersionMapOffset);
-			for (uint64_t Key : GetVersionKeys())
+			uint8_t* Token = Output++;
+			const uint64_t MatchCode = MatchLength > 0 ? MatchLength - LZMinMatch : 0;
+			*Token = (uint8_t)((std::min<uint64_t>(NumLiterals, 15) << 4) | std::min<uint64_t>(MatchCode, 15));
+			if (NumLiterals >= 15)
 			{
-				ByteSerialize(Key);
-				int64_t Version = GetVersion(Key);
-				ByteSerialize(Version);
+				LZWriteLength(Output, NumLiterals - 15);
+			}
+			std::memcpy(Output, Literals, NumLiterals);
+			Output += NumLiterals;
+			if (MatchLength > 0)
+			{
+				*Output++ = (uint8_t)(Offset & 0xFF);
+				*Output++ = (uint8_t)(Offset >> 8);
+				if (MatchCode >= 15)
+				{
+					LZWriteLength(Output, MatchCode - 15);
+				}
 			}
+			return Output;
 		}
 
-		Impl->~FImpl();
-		UBPA_UCOMMON_FREE(Impl);
-	}
-}
+		/** Output must hold LZCompressBound(Size) bytes. Returns the compressed size. */
+		static uint64_t LZCompress(const uint8_t* Input, uint64_t Size, uint8_t* Output)
+		{
+			uint32_t HashTable[1 << LZHashLog];
+			std::memset(HashTable, 0, sizeof(HashTable));
 
-UCommon::FFileArchive::FFileArchive(FFileArchive&& Other) noexcept
-	: IArchive(std::move(Other))
-	, Impl(Other.Impl)
-{
-	Other.Impl = nullptr;
-}
+			uint8_t* const OutputBegin = Output;
+			uint64_t Anchor = 0;
+			uint64_t Cursor = 0;
+			const uint64_t MatchLimit = Size > LZLastLiterals ? Size - LZLastLiterals : 0;
+			while (Cursor + LZMinMatch <= MatchLimit)
+			{
+				const uint32_t Sequence = LZRead32(Input + Cursor);
+				const uint32_t Hash = LZHash(Sequence);
+				const uint64_t Candidate = HashTable[Hash];
+				HashTable[Hash] = (uint32_t)Cursor;
+				if (Candidate >= Cursor || Cursor - Candidate > LZMaxOffset || LZRead32(Input + Candidate) != Sequence)
+				{
+					// skip faster through incompressible data
+					Cursor += 1 + ((Cursor - Anchor) >> 6);
+					continue;
+				}
 
-void UCommon::FFileArchive::Swap(FFileArchive& Other) noexcept
-{
-	IArchive::Swap(Other);
-	std::swap(Impl, Other.Impl);
-}
+				uint64_t MatchLength = LZMinMatch;
+				while (Cursor + MatchLength < MatchLimit && Input[Candidate + MatchLength] == Input[Cursor + MatchLength])
+				{
+					MatchLength++;
+				}
 
-UCommon::FFileArchive& UCommon::FFileArchive::operator=(FFileArchive&& Other) noexcept
-{
-	FFileArchive Temp(std::move(Other));
-	Swap(Temp);
-	return *this;
-}
+				Output = LZWriteSequence(Output, Input + Anchor, Cursor - Anchor, Cursor - Candidate, MatchLength);
+				Cursor += MatchLength;
+				Anchor = Cursor;
+				if (Cursor + LZMinMatch <= MatchLimit)
+				{
+					HashTable[LZHash(LZRead32(Input + Cursor - 2))] = (uint32_t)(Cursor - 2);
+				}
+			}
+			Output = LZWriteSequence(Output, Input + Anchor, Size - Anchor, 0, 0);
+			return Output - OutputBegin;
+		}
 
-bool UCommon::FFileArchive::IsValid() const
-{
-	return Impl->Ifs.is_open() || Impl->Ofs.is_open();
+		static bool LZReadLength(const uint8_t*& Input, const uint8_t* InputEnd, uint64_t& Length)
+		{
+			uint8_t Byte;
+			do
+			{
+				if (Input == InputEnd)
+				{
+					return false;
+				}
+				Byte = *Input++;
+				Length += Byte;
+			} while (Byte == 255);
+			return true;
+		}
+
+		/** Returns false if Input is not a valid stream of exactly OutputSize bytes. */
+		static bool LZDecompress(const uint8_t* Input, uint64_t InputSize, uint8_t* Output, uint64_t OutputSize)
+		{
+			const uint8_t* const InputEnd = Input + InputSize;
+			uint8_t* const OutputBegin = Output;
+			uint8_t* const OutputEnd = Output + OutputSize;
+			while (Input < InputEnd)
+			{
+				const uint8_t Token = *Input++;
+
+				uint64_t NumLiterals = Token >> 4;
+				if (NumLiterals == 15 && !LZReadLength(Input, InputEnd, NumLiterals))
+				{
+					return false;
+				}
+				if (NumLiterals > (uint64_t)(InputEnd - Input) || NumLiterals > (uint64_t)(OutputEnd - Output))
+				{
+					return false;
+				}
+				std::memcpy(Output, Input, NumLiterals);
+				Input += NumLiterals;
+				Output += NumLiterals;
+
+				if (Input == InputEnd)
+				{
+					break;
+				}
+
+				if (InputEnd - Input < 2)
+				{
+					return false;
+				}
+				const uint64_t Offset = Input[0] | ((uint64_t)Input[1] << 8);
+				Input += 2;
+				uint64_t MatchLength = Token & 15;
+				if (MatchLength == 15 && !LZReadLength(Input, InputEnd, MatchLength))
+				{
+					return false;
+				}
+				MatchLength += LZMinMatch;
+				if (Offset == 0 || Offset > (uint64_t)(Output - OutputBegin) || MatchLength > (uint64_t)(OutputEnd - Output))
+				{
+					return false;
+				}
+
+				const uint8_t* Match = Output - Offset;
+				if (Offset >= MatchLength)
+				{
+					std::memcpy(Output, Match, MatchLength);
+					Output += MatchLength;
+				}
+				else
+				{
+					// overlapping, repeats the last Offset bytes
+					for (uint64_t Index = 0; Index < MatchLength; Index++)
+					{
+						*Output++ = Match[Index];
+					}
+				}
+			}
+			return Output == OutputEnd;
+		}
+
+		/** Byte i of every Width-byte element goes to plane i, the tail which isn't a whole element is copied. */
+		static void ByteShuffle(const uint8_t* Input, uint64_t Size, uint64_t Width, uint8_t* Output)
+		{
+			const uint64_t NumElements = Size / Width;
+			for (uint64_t ByteIndex = 0; ByteIndex < Width; ByteIndex++)
+			{
+				uint8_t* Plane = Output + ByteIndex * NumElements;
+				for (uint64_t Index = 0; Index < NumElements; Index++)
+				{
+					Plane[Index] = Input[Index * Width + ByteIndex];
+				}
+			}
+			std::memcpy(Output + NumElements * Width, Input + NumElements * Width, Size - NumElements * Width);
+		}
+
+		static void ByteUnshuffle(const uint8_t* Input, uint64_t Size, uint64_t Width, uint8_t* Output)
+		{
+			const uint64_t NumElements = Size / Width;
+			for (uint64_t ByteIndex = 0; ByteIndex < Width; ByteIndex++)
+			{
+				const uint8_t* Plane = Input + ByteIndex * NumElements;
+				for (uint64_t Index = 0; Index < NumElements; Index++)
+				{
+					Output[Index * Width + ByteIndex] = Plane[Index];
+				}
+			}
+			std::memcpy(Output + NumElements * Width, Input + NumElements * Width, Size - NumElements * Width);
+		}
+	}
 }
 
-void UCommon::FFileArchive::Serialize(void* Pointer, uint64_t Length)
+struct UCommon::FCompressedArchive::FImpl
 {
-	UBPA_UCOMMON_ASSERT(IsValid());
-	if (GetState() == EState::Loading)
+	struct FHeader
 	{
-		Impl->Ifs.read((char*)Pointer, Length);
-	}
-	else
+		uint8_t Magic[4] = { 'U', 'b', 'p', 'Z' };
+		uint32_t ShuffleWidth = 0;
+		uint64_t BlockSize = 0;
+	};
+
+	/** Precedes every block, a block with RawSize 0 ends the stream. */
+	struct FBlockHeader
 	{
-		Impl->Ofs.write((const char*)Pointer, Length);
-	}
-}
+		uint32_t RawSize = 0;
+		/** 0 if the block is stored as is. */
+		uint32_t CompressedSize = 0;
+	};
 
-void UCommon::FFileArchive::Seek(uint64_t Index)
-{
-	UBPA_UCOMMON_ASSERT(IsValid());
-	if (GetState() == EState::Loading)
+	struct FBlock
 	{
-		Impl->Ifs.seekg(Index);
-	}
-	else
+		std::vector<uint8_t> Raw;
+		std::vector<uint8_t> Compressed;
+		std::vector<uint8_t> Shuffled;
+		FBlockHeader Header;
+	};
+
+	FImpl(IArchive* InArchive, const FCompressedArchiveConfig& InConfig)
+		: Archive(InArchive)
+		, Config(InConfig)
 	{
-		Impl->Ofs.seekp(Index);
+		UBPA_UCOMMON_ASSERT(InArchive);
+		UBPA_UCOMMON_ASSERT(Config.BlockSize > 0 && Config.BlockSize <= UINT32_MAX);
+		NumBatchBlocks = Config.ThreadPool ? 2 * (Config.ThreadPool->GetNumThreads() + 1) : 1;
+		Blocks.resize(NumBatchBlocks);
 	}
-}
 
-uint64_t UCommon::FFileArchive::Tell() const
-{
-	UBPA_UCOMMON_ASSERT(IsValid());
-	if (GetState() == EState::Loading)
+	void CompressBlock(FBlock& Block) const
 	{
-		return Impl->Ifs.tellg();
+		const uint64_t RawSize = Block.Header.RawSize;
+		const uint8_t* Input = Block.Raw.data();
+		if (Config.ShuffleWidth > 1)
+		{
+			Block.Shuffled.resize(RawSize);
+			Details::ByteShuffle(Input, RawSize, Config.ShuffleWidth, Block.Shuffled.data());
+			Input = Block.Shuffled.data();
+		}
+		Block.Compressed.resize(Details::LZCompressBound(RawSize));
+		const uint64_t CompressedSize = Details::LZCompress(Input, RawSize, Block.Compressed.data());
+		Block.Header.CompressedSize = CompressedSize < RawSize ? (uint32_t)CompressedSize : 0;
 	}
-	else
+
+	bool DecompressBlock(FBlock& Block) const
 	{
-		return Impl->Ofs.tellp();
+		const uint64_t RawSize = Block.Header.RawSize;
+		if (Block.Header.CompressedSize == 0)
+		{
+			Block.Raw.swap(Block.Compressed);
+			return true;
+		}
+
+		Block.Raw.resize(RawSize);
+
+		uint8_t* Output = Block.Raw.data();
+		if (ShuffleWidth > 1)
+		{
+			Block.Shuffled.resize(RawSize);
+			Output = Block.Shuffled.data();
+		}
+		if (!Details::LZDecompress(Block.Compressed.data(), Block.Header.CompressedSize, Output, RawSize))
+		{
+			return false;
+		}
+		if (ShuffleWidth > 1)
+		{
+			Details::ByteUnshuffle(Output, RawSize, ShuffleWidth, Block.Raw.data());
+		}
+		return true;
 	}
+
+	/** Compresses and writes the NumBlocks full blocks of the batch. */
+	void WriteBatch()
+	{
+		auto Compress = [this](uint64_t Index) { CompressBlock(Blocks[Index]); };
+		if (Config.ThreadPool && NumBlocks > 1)
+		{
+			Config.ThreadPool->ParallelFor(0, NumBlocks, 1, Compress);
+		}
+		else
+		{
+			for (uint64_t Index = 0; Index < NumBlocks; Index++)
+			{
+				Compress(Index);
+			}
+		}
+
+		for (uint64_t Index = 0; Index < NumBlocks; Index++)
+		{
+			FBlock& Block = Blocks[Index];
+			Archive->ByteSerialize(Block.Header);
+			if (Block.Header.CompressedSize > 0)
+			{
+				Archive->Serialize(Block.Compressed.data(), Block.Header.CompressedSize);
+			}
+			else
+			{
+				Archive->Serialize(Block.Raw.data(), Block.Header.RawSize);
+			}
+			CompressedSize += sizeof(FBlockHeader) + (Block.Header.CompressedSize > 0 ? Block.Header.CompressedSize : Block.Header.RawSize);
+		}
+		NumBlocks = 0;
+	}
+
+	/** Reads and decompresses the next batch, returns false at the end of the stream or on corrupted data. */
+	bool ReadBatch()
+	{
+		NumBlocks = 0;
+		CurrentBlock = 0;
+		ReadIndex = 0;
+		while (!bEnded && NumBlocks < NumBatchBlocks)
+		{
+			FBlock& Block = Blocks[NumBlocks];
+			Archive->ByteSerialize(Block.Header);
+			CompressedSize += sizeof(FBlockHeader);
+			if (Block.Header.RawSize == 0)
+			{
+				bEnded = true;
+				break;
+			}
+			if (Block.Header.RawSize > BlockSize || Block.Header.CompressedSize >= Block.Header.RawSize)
+			{
+				bCorrupted = true;
+				return false;
+			}
+			const uint64_t StoredSize = Block.Header.CompressedSize > 0 ? Block.Header.CompressedSize : Block.Header.RawSize;
+			Block.Compressed.resize(StoredSize);
+			Archive->Serialize(Block.Compressed.data(), StoredSize);
+			CompressedSize += StoredSize;
+			NumBlocks++;
+		}
+
+		std::atomic<bool> bSucceeded{ true };
+		auto Decompress = [this, &bSucceeded](uint64_t Index)
+		{
+			if (!DecompressBlock(Blocks[Index]))
+			{
+				bSucceeded.store(false, std::memory_order_relaxed);
+			}
+		};
+		if (Config.ThreadPool && NumBlocks > 1)
+		{
+			Config.ThreadPool->ParallelFor(0, NumBlocks, 1, Decompress);
+		}
+		else
+		{
+			for (uint64_t Index = 0; Index < NumBlocks; Index++)
+			{
+				Decompress(Index);
+			}
+		}
+		if (!bSucceeded.load(std::memory_order_relaxed))
+		{
+			bCorrupted = true;
+			return false;
+		}
+		return NumBlocks > 0;
+	}
+
+	/**
+	 * Loading: consumes the blocks which haven't been read, so that the inner archive is right after the stream.
+	 * Runs in the destructor: block headers are checked as in ReadBatch and skipped through a small buffer.
+	 */
+	void SkipToEnd()
+	{
+		uint8_t Skipped[4096];
+		while (!bEnded && !bCorrupted)
+		{
+			FBlockHeader Header;
+			Archive->ByteSerialize(Header);
+			CompressedSize += sizeof(FBlockHeader);
+			if (Header.RawSize == 0)
+			{
+				bEnded = true;
+				break;
+			}
+			if (Header.RawSize > BlockSize || Header.CompressedSize >= Header.RawSize)
+			{
+				bCorrupted = true;
+				break;
+			}
+			const uint64_t StoredSize = Header.CompressedSize > 0 ? Header.CompressedSize : Header.RawSize;
+			for (uint64_t Offset = 0; Offset < StoredSize; Offset += sizeof(Skipped))
+			{
+				Archive->Serialize(Skipped, std::min<uint64_t>(sizeof(Skipped), StoredSize - Offset));
+			}
+			CompressedSize += StoredSize;
+		}
+	}
+
+	IArchive* Archive = nullptr;
+	FCompressedArchiveConfig Config;
+	uint64_t BlockSize = 0;
+	uint64_t ShuffleWidth = 0;
+
+	std::vector<FBlock> Blocks;
+	uint64_t NumBatchBlocks = 0;
+	/** Saving: full blocks of the batch, Loading: decompressed blocks of the batch. */
+	uint64_t NumBlocks = 0;
+	/** Loading: block being read and the read position in it. */
+	uint64_t CurrentBlock = 0;
+	uint64_t ReadIndex = 0;
+	bool bEnded = false;
+	bool bCorrupted = false;
+
+	uint64_t RawSize = 0;
+	uint64_t CompressedSize = 0;
+};
+
+UCommon::FCompressedArchive::FCompressedArchive(IArchive* InArchive, const FCompressedArchiveConfig& Config)
+	: IArchive(InArchive->GetState())
+	, Impl(new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(InArchive, Config))
+{
+	for (uint64_t Key : Impl->Archive->GetVersionKeys())
+	{
+		if (GetState() == EState::Loading)
+		{
+			LoadVersion(Key, Impl->Archive->GetVersion(Key));
+		}
+		else
+		{
+			UseVersion(Key, Impl->Archive->GetVersion(Key));
+		}
+	}
+
+	FImpl::FHeader Header;
+	if (GetState() == EState::Loading)
+	{
+		Impl->Archive->ByteSerialize(Header);
+		if (std::memcmp(Header.Magic, "UbpZ", 4) != 0 || Header.BlockSize == 0 || Header.BlockSize > UINT32_MAX)
+		{
+			Impl->bCorrupted = true;
+		}
+		Impl->BlockSize = Header.BlockSize;
+		Impl->ShuffleWidth = Header.ShuffleWidth;
+	}
+	else
+	{
+		Impl->BlockSize = Config.BlockSize;
+		Impl->ShuffleWidth = Config.ShuffleWidth;
+		Header.BlockSize = Config.BlockSize;
+		Header.ShuffleWidth = Config.ShuffleWidth;
+		Impl->Archive->ByteSerialize(Header);
+		Impl->Blocks[0].Raw.resize(Impl->BlockSize);
+	}
+	Impl->CompressedSize = sizeof(FImpl::FHeader);
+}
+
+UCommon::FCompressedArchive::FCompressedArchive(FCompressedArchive&& Other) noexcept
+	: IArchive(std::move(Other))
+	, Impl(Other.Impl)
+{
+	Other.Impl = nullptr;
+}
+
+void UCommon::FCompressedArchive::Swap(FCompressedArchive& Other) noexcept
+{
+	IArchive::Swap(Other);
+	std::swap(Impl, Other.Impl);
+}
+
+UCommon::FCompressedArchive& UCommon::FCompressedArchive::operator=(FCompressedArchive&& Other) noexcept
+{
+	FCompressedArchive Temp(std::move(Other));
+	Swap(Temp);
+	return *this;
+}
+
+UCommon::FCompressedArchive::~FCompressedArchive()
+{
+	if (Impl)
+	{
+		if (GetState() == EState::Saving)
+		{
+			if (Impl->Blocks[Impl->NumBlocks].Header.RawSize > 0)
+			{
+				Impl->NumBlocks++;
+			}
+			Impl->WriteBatch();
+			FImpl::FBlockHeader End;
+			Impl->Archive->ByteSerialize(End);
+			Impl->CompressedSize += sizeof(FImpl::FBlockHeader);
+
+			for (uint64_t Key : GetVersionKeys())
+			{
+				Impl->Archive->UseVersion(Key, GetVersion(Key));
+			}
+		}
+		else
+		{
+			Impl->SkipToEnd();
+		}
+		Impl->~FImpl();
+		UBPA_UCOMMON_FREE(Impl);
+	}
+}
+
+bool UCommon::FCompressedArchive::IsValid() const noexcept
+{
+	return !Impl->bCorrupted;
+}
+
+void UCommon::FCompressedArchive::Serialize(void* Pointer, uint64_t Length)
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	uint8_t* Bytes = static_cast<uint8_t*>(Pointer);
+	Impl->RawSize += Length;
+	if (GetState() == EState::Loading)
+	{
+		while (Length > 0)
+		{
+			if (Impl->CurrentBlock == Impl->NumBlocks)
+			{
+				if (!Impl->ReadBatch())
+				{
+					UBPA_UCOMMON_ASSERT(IsValid() && "read past the end of the compressed stream");
+					std::memset(Bytes, 0, Length);
+					return;
+				}
+			}
+			const FImpl::FBlock& Block = Impl->Blocks[Impl->CurrentBlock];
+			const uint64_t NumBytes = std::min<uint64_t>(Length, Block.Header.RawSize - Impl->ReadIndex);
+			std::memcpy(Bytes, Block.Raw.data() + Impl->ReadIndex, NumBytes);
+			Bytes += NumBytes;
+			Length -= NumBytes;
+			Impl->ReadIndex += NumBytes;
+			if (Impl->ReadIndex == Block.Header.RawSize)
+			{
+				Impl->CurrentBlock++;
+				Impl->ReadIndex = 0;
+			}
+		}
+	}
+	else
+	{
+		while (Length > 0)
+		{
+			FImpl::FBlock& Block = Impl->Blocks[Impl->NumBlocks];
+			const uint64_t NumBytes = std::min<uint64_t>(Length, Impl->BlockSize - Block.Header.RawSize);
+			std::memcpy(Block.Raw.data() + Block.Header.RawSize, Bytes, NumBytes);
+			Block.Header.RawSize += (uint32_t)NumBytes;
+			Bytes += NumBytes;
+			Length -= NumBytes;
+			if (Block.Header.RawSize == Impl->BlockSize)
+			{
+				Impl->NumBlocks++;
+				if (Impl->NumBlocks == Impl->NumBatchBlocks)
+				{
+					Impl->WriteBatch();
+				}
+				FImpl::FBlock& NextBlock = Impl->Blocks[Impl->NumBlocks];
+				NextBlock.Raw.resize(Impl->BlockSize);
+				NextBlock.Header.RawSize = 0;
+			}
+		}
+	}
+}
+
+uint64_t UCommon::FCompressedArchive::GetRawSize() const noexcept
+{
+	return Impl->RawSize;
+}
+
+uint64_t UCommon::FCompressedArchive::GetCompressedSize() const noexcept
+{
+	return Impl->CompressedSize;
+}
+
+//////////////////
+// FFileArchive //
+//////////////////
+
+struct UCommon::FFileArchive::FImpl
+{
+	using FHeader = FFileArchiveHeader;
+
+	FImpl(EState State, const char* FilePath, const FFileArchiveConfig& InConfig)
+		: Config(InConfig)
+	{
+		if (State == EState::Loading)
+		{
+			Ifs.open(FilePath, std::ifstream::binary);
+		}
+		else
+		{
+			Ofs.open(FilePath, std::ofstream::binary);
+			if (Config.BufferSize > 0)
+			{
+				Buffers[0].resize(Config.BufferSize);
+				if (Config.ThreadPool)
+				{
+					Buffers[1].resize(Config.BufferSize);
+				}
+			}
+		}
+	}
+
+	~FImpl()
+	{
+		Flush();
+	}
+
+	void Write(const uint8_t* Data, uint64_t Length)
+	{
+		if (Config.BufferSize == 0)
+		{
+			Ofs.write(reinterpret_cast<const char*>(Data), Length);
+			return;
+		}
+
+		if (!Config.ThreadPool && Length >= Config.BufferSize)
+		{
+			// too large to be worth a copy
+			Flush();
+			Ofs.write(reinterpret_cast<const char*>(Data), Length);
+			return;
+		}
+
+		while (Length > 0)
+		{
+			const uint64_t NumBytes = std::min(Length, Config.BufferSize - NumBufferedBytes);
+			std::memcpy(Buffers[CurrentBuffer].data() + NumBufferedBytes, Data, NumBytes);
+			NumBufferedBytes += NumBytes;
+			Data += NumBytes;
+			Length -= NumBytes;
+			if (NumBufferedBytes == Config.BufferSize)
+			{
+				WriteBuffer();
+			}
+		}
+	}
+
+	/** Hand the current buffer over to the stream, asynchronously with a thread pool. */
+	void WriteBuffer()
+	{
+		if (NumBufferedBytes == 0)
+		{
+			return;
+		}
+
+		WaitPendingWrite();
+
+		if (Config.ThreadPool)
+		{
+			const uint8_t* Data = Buffers[CurrentBuffer].data();
+			const uint64_t Length = NumBufferedBytes;
+			PendingWrite = Config.ThreadPool->EnqueueTask([this, Data, Length]
+			{
+				Ofs.write(reinterpret_cast<const char*>(Data), Length);
+			});
+			if (PendingWrite.IsValid())
+			{
+				CurrentBuffer ^= 1;
+				NumBufferedBytes = 0;
+				return;
+			}
+			// the pool is stopping, the buffer must not be refilled before it is written
+		}
+		Ofs.write(reinterpret_cast<const char*>(Buffers[CurrentBuffer].data()), NumBufferedBytes);
+		NumBufferedBytes = 0;
+	}
+
+	void WaitPendingWrite()
+	{
+		if (PendingWrite.IsValid())
+		{
+			PendingWrite.Wait();
+			PendingWrite.Reset();
+		}
+	}
+
+	/** Everything serialized so far has reached the stream. */
+	void Flush()
+	{
+		WriteBuffer();
+		WaitPendingWrite();
+	}
+
+	std::ifstream Ifs;
+	std::ofstream Ofs;
+
+	FFileArchiveConfig Config;
+	std::vector<uint8_t> Buffers[2];
+	uint64_t CurrentBuffer = 0;
+	uint64_t NumBufferedBytes = 0;
+	TTaskFuture<void> PendingWrite;
+};
+
+UCommon::FFileArchive::FFileArchive(EState State, const char* FilePath)
+	: FFileArchive(State, FilePath, FFileArchiveConfig())
+{
+}
+
+UCommon::FFileArchive::FFileArchive(EState State, const char* FilePath, const FFileArchiveConfig& Config)
+	: IArchive(State)
+	, Impl(new UBPA_UCOMMON_MALLOC(sizeof(FImpl))FImpl(State, FilePath, Config))
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	FImpl::FHeader Header;
+	ByteSerialize(Header);
+	UBPA_UCOMMON_ASSERT(std::memcmp(Header.Magic, "Ubpa", 4) == 0);
+	if (GetState() == EState::Loading
+		&& Header.NumVersionKeys > 0)
+	{
+		Seek(Header.VersionMapOffset);
+		for (uint32_t Index = 0; Index < Header.NumVersionKeys; Index++)
+		{
+			uint64_t Key;
+			int64_t Version;
+			ByteSerialize(Key);
+			ByteSerialize(Version);
+			LoadVersion(Key, Version);
+		}
+		Seek(sizeof(FImpl::FHeader));
+	}
+}
+
+UCommon::FFileArchive::~FFileArchive()
+{
+	if (Impl)
+	{
+		if (GetState() == EState::Saving)
+		{
+			FImpl::FHeader Header;
+			Header.VersionMapOffset = Tell();
+			Header.NumVersionKeys = (uint32_t)GetVersionKeys().Num();
+			Seek(0);
+			ByteSerialize(Header);
+			Seek(Header.VersionMapOffset);
+			for (uint64_t Key : GetVersionKeys())
+			{
+				ByteSerialize(Key);
+				int64_t Version = GetVersion(Key);
+				ByteSerialize(Version);
+			}
+		}
+
+		Impl->~FImpl();
+		UBPA_UCOMMON_FREE(Impl);
+	}
+}
+
+UCommon::FFileArchive::FFileArchive(FFileArchive&& Other) noexcept
+	: IArchive(std::move(Other))
+	, Impl(Other.Impl)
+{
+	Other.Impl = nullptr;
+}
+
+void UCommon::FFileArchive::Swap(FFileArchive& Other) noexcept
+{
+	IArchive::Swap(Other);
+	std::swap(Impl, Other.Impl);
+}
+
+UCommon::FFileArchive& UCommon::FFileArchive::operator=(FFileArchive&& Other) noexcept
+{
+	FFileArchive Temp(std::move(Other));
+	Swap(Temp);
+	return *this;
+}
+
+bool UCommon::FFileArchive::IsValid() const
+{
+	return Impl->Ifs.is_open() || Impl->Ofs.is_open();
+}
+
+void UCommon::FFileArchive::Serialize(void* Pointer, uint64_t Length)
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	if (GetState() == EState::Loading)
+	{
+		Impl->Ifs.read((char*)Pointer, Length);
+	}
+	else
+	{
+		Impl->Write(static_cast<const uint8_t*>(Pointer), Length);
+	}
+}
+
+void UCommon::FFileArchive::Seek(uint64_t Index)
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	if (GetState() == EState::Loading)
+	{
+		Impl->Ifs.seekg(Index);
+	}
+	else
+	{
+		Impl->Flush();
+		Impl->Ofs.seekp(Index);
+	}
+}
+
+uint64_t UCommon::FFileArchive::Tell() const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	if (GetState() == EState::Loading)
+	{
+		return Impl->Ifs.tellg();
+	}
+	else
+	{
+		// the stream position is only stable without a write in flight
+		Impl->WaitPendingWrite();
+		return static_cast<uint64_t>(Impl->Ofs.tellp()) + Impl->NumBufferedBytes;
+	}
+}
+
+////////////////////////
+// FMappedFileArchive //
+////////////////////////
+
+struct UCommon::FMappedFileArchive::FImpl
+{
+	FImpl(const char* FilePath)
+	{
+#if defined(_WIN32)
+		const HANDLE File = CreateFileA(FilePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		LARGE_INTEGER FileSize;
+		if (GetFileSizeEx(File, &FileSize) && FileSize.QuadPart > 0)
+		{
+			// the view keeps the mapping and the file alive, both handles can be closed
+			const HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			if (Mapping)
+			{
+				Data = static_cast<uint8_t*>(MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, 0));
+				Size = Data ? static_cast<uint64_t>(FileSize.QuadPart) : 0;
+				CloseHandle(Mapping);
+			}
+		}
+		CloseHandle(File);
+#else
+		const int File = open(FilePath, O_RDONLY);
+		if (File < 0)
+		{
+			return;
+		}
+		struct stat FileStat;
+		if (fstat(File, &FileStat) == 0 && FileStat.st_size > 0)
+		{
+			// private writable mapping: copy-on-write, the file is never modified
+			void* Mapping = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, File, 0);
+			if (Mapping != MAP_FAILED)
+			{
+				Data = static_cast<uint8_t*>(Mapping);
+				Size = static_cast<uint64_t>(FileStat.st_size);
+			}
+		}
+		close(File);
+#endif
+	}
+
+	~FImpl()
+	{
+		if (!Data)
+		{
+			return;
+		}
+#if defined(_WIN32)
+		UnmapViewOfFile(Data);
+#else
+		munmap(Data, static_cast<size_t>(Size));
+#endif
+	}
+
+	uint8_t* Data = nullptr;
+	uint64_t Size = 0;
+	uint64_t Offset = 0;
+	bool bValid = false;
+};
+
+UCommon::FMappedFileArchive::FMappedFileArchive(const char* FilePath)
+	: IArchive(EState::Loading)
+	, Impl(new UBPA_UCOMMON_MALLOC(sizeof(FImpl))FImpl(FilePath))
+{
+	FFileArchiveHeader Header;
+	if (Impl->Size < sizeof(FFileArchiveHeader))
+	{
+		return;
+	}
+	std::memcpy(&Header, Impl->Data, sizeof(FFileArchiveHeader));
+	if (std::memcmp(Header.Magic, "Ubpa", 4) != 0
+		|| Header.VersionMapOffset > Impl->Size
+		|| Header.NumVersionKeys > (Impl->Size - Header.VersionMapOffset) / (sizeof(uint64_t) + sizeof(int64_t)))
+	{
+		return;
+	}
+
+	Impl->bValid = true;
+	if (Header.NumVersionKeys > 0)
+	{
+		Impl->Offset = Header.VersionMapOffset;
+		for (uint32_t Index = 0; Index < Header.NumVersionKeys; Index++)
+		{
+			uint64_t Key;
+			int64_t Version;
+			ByteSerialize(Key);
+			ByteSerialize(Version);
+			LoadVersion(Key, Version);
+		}
+	}
+	Impl->Offset = sizeof(FFileArchiveHeader);
+}
+
+UCommon::FMappedFileArchive::FMappedFileArchive(FMappedFileArchive&& Other) noexcept
+	: IArchive(std::move(Other))
+	, Impl(Other.Impl)
+{
+	Other.Impl = nullptr;
+}
+
+void UCommon::FMappedFileArchive::Swap(FMappedFileArchive& Other) noexcept
+{
+	IArchive::Swap(Other);
+	std::swap(Impl, Other.Impl);
+}
+
+UCommon::FMappedFileArchive& UCommon::FMappedFileArchive::operator=(FMappedFileArchive&& Other) noexcept
+{
+	FMappedFileArchive Temp(std::move(Other));
+	Swap(Temp);
+	return *this;
+}
+
+UCommon::FMappedFileArchive::~FMappedFileArchive()
+{
+	if (Impl)
+	{
+		Impl->~FImpl();
+		UBPA_UCOMMON_FREE(Impl);
+	}
+}
+
+bool UCommon::FMappedFileArchive::IsValid() const
+{
+	return Impl->bValid;
+}
+
+void UCommon::FMappedFileArchive::Serialize(void* Pointer, uint64_t Length)
+{
+	if (!Impl->bValid || Length > Impl->Size - Impl->Offset)
+	{
+		// truncated or corrupt file: never read past the mapping
+		Impl->bValid = false;
+		if (Length > 0)
+		{
+			std::memset(Pointer, 0, Length);
+		}
+		return;
+	}
+	std::memcpy(Pointer, Impl->Data + Impl->Offset, Length);
+	Impl->Offset += Length;
+}
+
+const void* UCommon::FMappedFileArchive::SerializeView(uint64_t Length)
+{
+	if (!Impl->bValid || Length > Impl->Size - Impl->Offset)
+	{
+		Impl->bValid = false;
+		return nullptr;
+	}
+	const void* View = Impl->Data + Impl->Offset;
+	Impl->Offset += Length;
+	return View;
+}
+
+bool UCommon::FMappedFileArchive::CanSerializeView() const
+{
+	return true;
+}
+
+UCommon::TSpan<const uint8_t> UCommon::FMappedFileArchive::GetMapping() const
+{
+	return { Impl->Data, Impl->Size };
+}
+
+///////////////////////
+// FRandomAccessFile //
+///////////////////////
+
+struct UCommon::FRandomAccessFile::FImpl
+{
+	FImpl(IArchive::EState InState, const char* FilePath)
+		: State(InState)
+	{
+#if defined(_WIN32)
+		File = State == IArchive::EState::Loading
+			? CreateFileA(FilePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)
+			: CreateFileA(FilePath, GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+		File = State == IArchive::EState::Loading
+			? open(FilePath, O_RDONLY)
+			: open(FilePath, O_WRONLY | O_CREAT, 0644);
+#endif
+	}
+
+	~FImpl()
+	{
+		if (!IsValid())
+		{
+			return;
+		}
+#if defined(_WIN32)
+		CloseHandle(File);
+#else
+		close(File);
+#endif
+	}
+
+	bool IsValid() const
+	{
+#if defined(_WIN32)
+		return File != INVALID_HANDLE_VALUE;
+#else
+		return File >= 0;
+#endif
+	}
+
+	IArchive::EState State;
+#if defined(_WIN32)
+	HANDLE File = INVALID_HANDLE_VALUE;
+#else
+	int File = -1;
+#endif
+};
+
+UCommon::FRandomAccessFile::FRandomAccessFile(IArchive::EState State, const char* FilePath)
+	: Impl(new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(State, FilePath))
+{
+}
+
+UCommon::FRandomAccessFile::FRandomAccessFile(FRandomAccessFile&& Other) noexcept
+	: Impl(Other.Impl)
+{
+	Other.Impl = nullptr;
+}
+
+void UCommon::FRandomAccessFile::Swap(FRandomAccessFile& Other) noexcept
+{
+	std::swap(Impl, Other.Impl);
+}
+
+UCommon::FRandomAccessFile& UCommon::FRandomAccessFile::operator=(FRandomAccessFile&& Other) noexcept
+{
+	FRandomAccessFile Temp(std::move(Other));
+	Swap(Temp);
+	return *this;
+}
+
+UCommon::FRandomAccessFile::~FRandomAccessFile()
+{
+	if (Impl)
+	{
+		Impl->~FImpl();
+		UBPA_UCOMMON_FREE(Impl);
+	}
+}
+
+bool UCommon::FRandomAccessFile::IsValid() const
+{
+	return Impl->IsValid();
+}
+
+bool UCommon::FRandomAccessFile::ReadAt(uint64_t Offset, void* Pointer, uint64_t Length) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && Impl->State == IArchive::EState::Loading);
+	uint8_t* Bytes = static_cast<uint8_t*>(Pointer);
+	while (Length > 0)
+	{
+#if defined(_WIN32)
+		OVERLAPPED Overlapped = {};
+		Overlapped.Offset = static_cast<DWORD>(Offset);
+		Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+		DWORD NumBytes = 0;
+		if (!ReadFile(Impl->File, Bytes, static_cast<DWORD>(std::min<uint64_t>(Length, 1u << 30)), &NumBytes, &Overlapped) || NumBytes == 0)
+		{
+			return false;
+		}
+#else
+		const ssize_t NumBytes = pread(Impl->File, Bytes, static_cast<size_t>(std::min<uint64_t>(Length, 1u << 30)), static_cast<off_t>(Offset));
+		if (NumBytes <= 0)
+		{
+			return false;
+		}
+#endif
+		Bytes += NumBytes;
+		Offset += NumBytes;
+		Length -= NumBytes;
+	}
+	return true;
+}
+
+bool UCommon::FRandomAccessFile::WriteAt(uint64_t Offset, const void* Pointer, uint64_t Length)
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && Impl->State == IArchive::EState::Saving);
+	const uint8_t* Bytes = static_cast<const uint8_t*>(Pointer);
+	while (Length > 0)
+	{
+#if defined(_WIN32)
+		OVERLAPPED Overlapped = {};
+		Overlapped.Offset = static_cast<DWORD>(Offset);
+		Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+		DWORD NumBytes = 0;
+		if (!WriteFile(Impl->File, Bytes, static_cast<DWORD>(std::min<uint64_t>(Length, 1u << 30)), &NumBytes, &Overlapped) || NumBytes == 0)
+		{
+			return false;
+		}
+#else
+		const ssize_t NumBytes = pwrite(Impl->File, Bytes, static_cast<size_t>(std::min<uint64_t>(Length, 1u << 30)), static_cast<off_t>(Offset));
+		if (NumBytes <= 0)
+		{
+			return false;
+		}
+#endif
+		Bytes += NumBytes;
+		Offset += NumBytes;
+		Length -= NumBytes;
+	}
+	return true;
+}
+
+///////////////////////
+// FChunkFileArchive //
+///////////////////////
+
+struct UCommon::FChunkFileArchive::FImpl
+{
+	/** Right after the FFileArchive header, patched once the table of contents is written. */
+	struct FHeader
+	{
+		uint8_t Magic[4] = { 'U', 'b', 'p', 'C' };
+		uint32_t Padding = 0;
+		uint64_t NumChunks = 0;
+		uint64_t TableOffset = 0;
+	};
+
+	struct FChunk
+	{
+		FGuid Guid;
+		std::string Name;
+		uint64_t Offset = 0;
+		uint64_t Size = 0;
+	};
+
+	struct FGuidHash
+	{
+		size_t operator()(const FGuid& Guid) const noexcept
+		{
+			return (size_t)((((uint64_t)Guid.A << 32) | Guid.B) ^ ((((uint64_t)Guid.C << 32) | Guid.D) * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
+	FImpl(EState State, const char* FilePath)
+		: File(State, FilePath)
+	{
+	}
+
+	/** Loading: drop a partially read table of contents, the archive stays invalid. */
+	void ClearChunks()
+	{
+		Chunks.clear();
+		GuidMap.clear();
+		NameMap.clear();
+	}
+
+	/** Returns false if the Guid or the Name is already used, nothing is indexed then. */
+	bool AddChunkIndex(uint64_t Index)
+	{
+		const FChunk& Chunk = Chunks[Index];
+		if ((Chunk.Guid.IsValid() && GuidMap.find(Chunk.Guid) != GuidMap.end())
+			|| (!Chunk.Name.empty() && NameMap.find(Chunk.Name) != NameMap.end()))
+		{
+			return false;
+		}
+		if (Chunk.Guid.IsValid())
+		{
+			GuidMap[Chunk.Guid] = Index;
+		}
+		if (!Chunk.Name.empty())
+		{
+			NameMap[Chunk.Name] = Index;
+		}
+		return true;
+	}
+
+	FFileArchive File;
+	bool bValid = false;
+
+	std::vector<FChunk> Chunks;
+	std::unordered_map<FGuid, uint64_t, FGuidHash> GuidMap;
+	std::unordered_map<std::string, uint64_t> NameMap;
+
+	/** Saving: the chunk being written, Loading: the chunk being read. -1 if none. */
+	int64_t CurrentChunk = -1;
+	/** Loading: bytes left in the current chunk. */
+	uint64_t NumRemainingBytes = 0;
+};
+
+UCommon::FChunkFileArchive::FChunkFileArchive(EState State, const char* FilePath)
+	: IArchive(State)
+	, Impl(new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(State, FilePath))
+{
+	if (!Impl->File.IsValid())
+	{
+		return;
+	}
+
+	FImpl::FHeader Header;
+	if (State == EState::Saving)
+	{
+		// placeholder, patched in the destructor
+		Impl->File.ByteSerialize(Header);
+		Impl->bValid = true;
+		return;
+	}
+
+	for (uint64_t Key : Impl->File.GetVersionKeys())
+	{
+		LoadVersion(Key, Impl->File.GetVersion(Key));
+	}
+
+	Impl->File.ByteSerialize(Header);
+	if (std::memcmp(Header.Magic, "UbpC", 4) != 0)
+	{
+		return;
+	}
+
+	// the table comes from the file, bound every count by the file size before allocating
+	uint64_t FileSize = 0;
+	{
+		std::ifstream Ifs(FilePath, std::ifstream::binary | std::ifstream::ate);
+		const std::streamoff End = Ifs.tellg();
+		FileSize = End > 0 ? (uint64_t)End : 0;
+	}
+	const uint64_t MinEntrySize = sizeof(FGuid) + 3 * sizeof(uint64_t);
+	if (Header.TableOffset < sizeof(FFileArchiveHeader) + sizeof(FImpl::FHeader)
+		|| Header.TableOffset > FileSize
+		|| Header.NumChunks > (FileSize - Header.TableOffset) / MinEntrySize)
+	{
+		return;
+	}
+
+	Impl->File.Seek(Header.TableOffset);
+	Impl->Chunks.resize(Header.NumChunks);
+	uint64_t TableEnd = Header.TableOffset;
+	for (uint64_t Index = 0; Index < Header.NumChunks; Index++)
+	{
+		FImpl::FChunk& Chunk = Impl->Chunks[Index];
+		Impl->File.ByteSerialize(Chunk.Guid);
+		uint64_t NameLength = 0;
+		Impl->File.ByteSerialize(NameLength);
+		TableEnd += MinEntrySize;
+		if (NameLength > FileSize - std::min(FileSize, TableEnd))
+		{
+			Impl->ClearChunks();
+			return;
+		}
+		TableEnd += NameLength;
+		Chunk.Name.resize(NameLength);
+		if (NameLength > 0)
+		{
+			Impl->File.Serialize(&Chunk.Name[0], NameLength);
+		}
+		Impl->File.ByteSerialize(Chunk.Offset);
+		Impl->File.ByteSerialize(Chunk.Size);
+		if (Chunk.Offset > FileSize || Chunk.Size > FileSize - Chunk.Offset || !Impl->AddChunkIndex(Index))
+		{
+			// out of the file, or a duplicated Guid or name
+			Impl->ClearChunks();
+			return;
+		}
+	}
+	Impl->bValid = true;
+}
+
+UCommon::FChunkFileArchive::FChunkFileArchive(FChunkFileArchive&& Other) noexcept
+	: IArchive(std::move(Other))
+	, Impl(Other.Impl)
+{
+	Other.Impl = nullptr;
+}
+
+void UCommon::FChunkFileArchive::Swap(FChunkFileArchive& Other) noexcept
+{
+	IArchive::Swap(Other);
+	std::swap(Impl, Other.Impl);
+}
+
+UCommon::FChunkFileArchive& UCommon::FChunkFileArchive::operator=(FChunkFileArchive&& Other) noexcept
+{
+	FChunkFileArchive Temp(std::move(Other));
+	Swap(Temp);
+	return *this;
+}
+
+UCommon::FChunkFileArchive::~FChunkFileArchive()
+{
+	if (Impl)
+	{
+		if (GetState() == EState::Saving && Impl->bValid)
+		{
+			if (Impl->CurrentChunk >= 0)
+			{
+				EndChunk();
+			}
+
+			FImpl::FHeader Header;
+			Header.NumChunks = Impl->Chunks.size();
+			Header.TableOffset = Impl->File.Tell();
+			for (FImpl::FChunk& Chunk : Impl->Chunks)
+			{
+				Impl->File.ByteSerialize(Chunk.Guid);
+				uint64_t NameLength = Chunk.Name.size();
+				Impl->File.ByteSerialize(NameLength);
+				if (NameLength > 0)
+				{
+					Impl->File.Serialize(&Chunk.Name[0], NameLength);
+				}
+				Impl->File.ByteSerialize(Chunk.Offset);
+				Impl->File.ByteSerialize(Chunk.Size);
+			}
+			const uint64_t End = Impl->File.Tell();
+			Impl->File.Seek(sizeof(FFileArchiveHeader));
+			Impl->File.ByteSerialize(Header);
+			// FFileArchive appends its version map at the current position
+			Impl->File.Seek(End);
+
+			for (uint64_t Key : GetVersionKeys())
+			{
+				Impl->File.UseVersion(Key, GetVersion(Key));
+			}
+		}
+		Impl->~FImpl();
+		UBPA_UCOMMON_FREE(Impl);
+	}
+}
+
+bool UCommon::FChunkFileArchive::IsValid() const
+{
+	return Impl->bValid;
+}
+
+void UCommon::FChunkFileArchive::Serialize(void* Pointer, uint64_t Length)
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && Impl->CurrentChunk >= 0);
+	if (GetState() == EState::Loading)
+	{
+		UBPA_UCOMMON_ASSERT(Length <= Impl->NumRemainingBytes);
+		Impl->NumRemainingBytes -= Length;
+	}
+	Impl->File.Serialize(Pointer, Length);
+}
+
+void UCommon::FChunkFileArchive::BeginChunk(const FGuid& Guid, const char* Name)
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && GetState() == EState::Saving && Impl->CurrentChunk < 0);
+	FImpl::FChunk Chunk;
+	Chunk.Guid = Guid;
+	Chunk.Name = Name;
+	Chunk.Offset = Impl->File.Tell();
+	Impl->CurrentChunk = (int64_t)Impl->Chunks.size();
+	Impl->Chunks.push_back(std::move(Chunk));
+	const bool bUnique = Impl->AddChunkIndex(Impl->CurrentChunk);
+	UBPA_UCOMMON_ASSERT(bUnique && "the Guid or the Name of the chunk is already used");
+}
+
+void UCommon::FChunkFileArchive::BeginChunk(const char* Name)
+{
+	BeginChunk(FGuid(), Name);
+}
+
+void UCommon::FChunkFileArchive::EndChunk()
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && GetState() == EState::Saving && Impl->CurrentChunk >= 0);
+	FImpl::FChunk& Chunk = Impl->Chunks[Impl->CurrentChunk];
+	Chunk.Size = Impl->File.Tell() - Chunk.Offset;
+	Impl->CurrentChunk = -1;
+}
+
+bool UCommon::FChunkFileArchive::SeekChunk(uint64_t Index)
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && GetState() == EState::Loading);
+	if (Index >= Impl->Chunks.size())
+	{
+		return false;
+	}
+	const FImpl::FChunk& Chunk = Impl->Chunks[Index];
+	Impl->File.Seek(Chunk.Offset);
+	Impl->CurrentChunk = (int64_t)Index;
+	Impl->NumRemainingBytes = Chunk.Size;
+	return true;
+}
+
+uint64_t UCommon::FChunkFileArchive::GetNumChunks() const
+{
+	return Impl->Chunks.size();
+}
+
+int64_t UCommon::FChunkFileArchive::FindChunk(const FGuid& Guid) const
+{
+	auto Target = Impl->GuidMap.find(Guid);
+	return Target != Impl->GuidMap.end() ? (int64_t)Target->second : -1;
+}
+
+int64_t UCommon::FChunkFileArchive::FindChunk(const char* Name) const
+{
+	auto Target = Impl->NameMap.find(Name);
+	return Target != Impl->NameMap.end() ? (int64_t)Target->second : -1;
+}
+
+const UCommon::FGuid& UCommon::FChunkFileArchive::GetChunkGuid(uint64_t Index) const
+{
+	UBPA_UCOMMON_ASSERT(Index < Impl->Chunks.size());
+	return Impl->Chunks[Index].Guid;
+}
+
+const char* UCommon::FChunkFileArchive::GetChunkName(uint64_t Index) const
+{
+	UBPA_UCOMMON_ASSERT(Index < Impl->Chunks.size());
+	return Impl->Chunks[Index].Name.c_str();
+}
+
+uint64_t UCommon::FChunkFileArchive::GetChunkSize(uint64_t Index) const
+{
+	UBPA_UCOMMON_ASSERT(Index < Impl->Chunks.size());
+	return Impl->Chunks[Index].Size;
 }
@@ -0,0 +1,262 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/TaskGraph.h>
+
+#include <deque>
+#include <vector>
+
+struct UCommon::FTaskGraph::FImpl
+{
+	struct FNode
+	{
+		FTask Task;
+		std::vector<uint64_t> Successors;
+		uint64_t NumPredecessors = 0;
+		std::atomic<uint64_t> NumPendingPredecessors{ 0 };
+
+		FNode(FTask&& InTask) : Task(std::move(InTask)) {}
+	};
+
+	/** deque: nodes hold atomics and must not move */
+	std::deque<FNode> Nodes;
+
+	FThreadPool* ThreadPool = nullptr;
+	std::atomic<uint64_t> NumPendingNodes{ 0 };
+	std::atomic<bool> bRunning{ false };
+	std::mutex Mutex;
+	std::condition_variable Condition;
+
+	bool HasCycle() const
+	{
+		// Kahn's algorithm
+		std::vector<uint64_t> NumPredecessors(Nodes.size());
+		std::vector<uint64_t> ReadyNodes;
+		for (uint64_t i = 0; i < Nodes.size(); i++)
+		{
+			NumPredecessors[i] = Nodes[i].NumPredecessors;
+			if (NumPredecessors[i] == 0)
+			{
+				ReadyNodes.push_back(i);
+			}
+		}
+		uint64_t NumVisitedNodes = 0;
+		while (!ReadyNodes.empty())
+		{
+			const uint64_t Node = ReadyNodes.back();
+			ReadyNodes.pop_back();
+			NumVisitedNodes++;
+			for (uint64_t Successor : Nodes[Node].Successors)
+			{
+				if (--NumPredecessors[Successor] == 0)
+				{
+					ReadyNodes.push_back(Successor);
+				}
+			}
+		}
+		return NumVisitedNodes != Nodes.size();
+	}
+
+	void Enqueue(uint64_t NodeIndex)
+	{
+		if (!ThreadPool->Enqueue(FTask([this, NodeIndex] { Execute(NodeIndex); })))
+		{
+			// the pool is stopping, don't leave the graph hanging
+			Execute(NodeIndex);
+		}
+	}
+
+	void Execute(uint64_t NodeIndex)
+	{
+		while (true)
+		{
+			FNode& Node = Nodes[NodeIndex];
+			Node.Task();
+
+			// the first ready successor continues on this thread, the others go to the pool
+			uint64_t Continuation = static_cast<uint64_t>(-1);
+			for (uint64_t Successor : Node.Successors)
+			{
+				if (Nodes[Successor].NumPendingPredecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					if (Continuation == static_cast<uint64_t>(-1))
+					{
+						Continuation = Successor;
+					}
+					else
+					{
+						Enqueue(Successor);
+					}
+				}
+			}
+
+			FinishNode();
+
+			if (Continuation == static_cast<uint64_t>(-1))
+			{
+				return;
+			}
+			NodeIndex = Continuation;
+		}
+	}
+
+	void FinishNode()
+	{
+		if (NumPendingNodes.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		{
+			return;
+		}
+		// notify under the lock: Wait() may destroy the graph as soon as it can take the lock
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bRunning.store(false, std::memory_order_release);
+		Condition.notify_all();
+	}
+};
+
+UCommon::FTaskGraph::FTaskGraph()
+	: Impl(new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl) {}
+
+UCommon::FTaskGraph::FTaskGraph(FTaskGraph&& Other) noexcept
+	: Impl(Other.Impl)
+{
+	Other.Impl = nullptr;
+}
+
+void UCommon::FTaskGraph::Swap(FTaskGraph& Other) noexcept
+{
+	std::swap(Impl, Other.Impl);
+}
+
+UCommon::FTaskGraph& UCommon::FTaskGraph::operator=(FTaskGraph&& Other) noexcept
+{
+	FTaskGraph Temp(std::move(Other));
+	Swap(Temp);
+	return *this;
+}
+
+UCommon::FTaskGraph::~FTaskGraph()
+{
+	if (Impl)
+	{
+		UBPA_UCOMMON_ASSERT(!IsRunning());
+		Impl->~FImpl();
+		UBPA_UCOMMON_FREE(Impl);
+	}
+}
+
+uint64_t UCommon::FTaskGraph::AddNode(FTask Task)
+{
+	UBPA_UCOMMON_ASSERT(!IsRunning() && Task.IsValid());
+	Impl->Nodes.emplace_back(std::move(Task));
+	return Impl->Nodes.size() - 1;
+}
+
+void UCommon::FTaskGraph::AddEdge(uint64_t From, uint64_t To)
+{
+	UBPA_UCOMMON_ASSERT(!IsRunning());
+	UBPA_UCOMMON_ASSERT(From < Impl->Nodes.size() && To < Impl->Nodes.size() && From != To);
+	Impl->Nodes[From].Successors.push_back(To);
+	Impl->Nodes[To].NumPredecessors++;
+}
+
+uint64_t UCommon::FTaskGraph::AddContinuation(uint64_t Prerequisite, FTask Task)
+{
+	return AddContinuation(TSpan<const uint64_t>(&Prerequisite, 1), std::move(Task));
+}
+
+uint64_t UCommon::FTaskGraph::AddContinuation(TSpan<const uint64_t> Prerequisites, FTask Task)
+{
+	const uint64_t Node = AddNode(std::move(Task));
+	for (uint64_t Prerequisite : Prerequisites)
+	{
+		AddEdge(Prerequisite, Node);
+	}
+	return Node;
+}
+
+uint64_t UCommon::FTaskGraph::GetNumNodes() const noexcept
+{
+	return Impl->Nodes.size();
+}
+
+bool UCommon::FTaskGraph::Run(FThreadPool& ThreadPool)
+{
+	UBPA_UCOMMON_ASSERT(!IsRunning());
+
+	if (Impl->Nodes.empty())
+	{
+		return true;
+	}
+
+	if (Impl->HasCycle())
+	{
+		return false;
+	}
+
+	Impl->ThreadPool = &ThreadPool;
+	for (FImpl::FNode& Node : Impl->Nodes)
+	{
+		Node.NumPendingPredecessors.store(Node.NumPredecessors, std::memory_order_relaxed);
+	}
+	Impl->NumPendingNodes.store(Impl->Nodes.size(), std::memory_order_relaxed);
+	Impl->bRunning.store(true, std::memory_order_release);
+
+	// collect the roots first, the graph may finish (and be destroyed by another thread) before the last Enqueue returns
+	std::vector<uint64_t> Roots;
+	for (uint64_t i = 0; i < Impl->Nodes.size(); i++)
+	{
+		if (Impl->Nodes[i].NumPredecessors == 0)
+		{
+			Roots.push_back(i);
+		}
+	}
+	for (uint64_t Root : Roots)
+	{
+		Impl->Enqueue(Root);
+	}
+
+	return true;
+}
+
+void UCommon::FTaskGraph::Wait()
+{
+	if (IsRunning())
+	{
+		// woken by FinishNode and by tasks enqueued meanwhile, e.g. the successors of the running nodes
+		Impl->ThreadPool->WaitUntil(Impl->Mutex, Impl->Condition, [this] { return !IsRunning(); });
+	}
+	// synchronize with the notifying thread before the caller may destroy the graph
+	std::lock_guard<std::mutex> Lock(Impl->Mutex);
+}
+
+bool UCommon::FTaskGraph::IsRunning() const noexcept
+{
+	return Impl->bRunning.load(std::memory_order_acquire);
+}
+
+void UCommon::FTaskGraph::Reset()
+{
+	UBPA_UCOMMON_ASSERT(!IsRunning());
+	Impl->Nodes.clear();
+}
@@ -24,9 +24,21 @@ SOFTWARE.
 
 #include <UCommon/Tex2D.h>
 #include <UCommon/TexCube.h>
-
+#include <UCommon/ThreadPool.h>
+
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
 #include <vector>
 
+#if defined(UBPA_UCOMMON_SIMD_SSE2) || defined(UBPA_UCOMMON_SIMD_AVX2) || defined(UBPA_UCOMMON_SIMD_F16C)
+#include <immintrin.h>
+#endif
+
 //
 // FGrid2D
 ///////////
@@ -125,202 +137,1769 @@ namespace UCommon
 }
 
 //
-// FTex2D
+// FConstTex2DView
 ///////////
 
-uint64_t UCommon::FTex2D::GetRequiredStorageSizeInBytes(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType ElementType) noexcept
+namespace UCommon
 {
-	return InGrid2D.GetArea() * InNumChannels * ElementGetSize(ElementType);
-}
+	namespace Details
+	{
+		static float GetElementFloat(const void* Elements, EElementType ElementType, uint64_t Index) noexcept
+		{
+			switch (ElementType)
+			{
+			case EElementType::Uint8:
+				return ElementUint8ToFloat(static_cast<const uint8_t*>(Elements)[Index]);
+			case EElementType::Half:
+				return ElementHalfToFloat(static_cast<const FHalf*>(Elements)[Index]);
+			case EElementType::Float:
+				return static_cast<const float*>(Elements)[Index];
+			case EElementType::Double:
+				return static_cast<float>(static_cast<const double*>(Elements)[Index]);
+			default:
+				UBPA_UCOMMON_NO_ENTRY();
+				return 0.f;
+			}
+		}
 
-uint64_t UCommon::FTex2D::GetNumElements(FGrid2D Grid2D, uint64_t NumChannels) noexcept
-{
-	return Grid2D.GetArea() * NumChannels;
-}
+		/** Tiles of ETex2DStorageLayout::Tiled are TileExtent x TileExtent texels. */
+		static constexpr uint64_t TileExtentLog2 = 3;
+		static constexpr uint64_t TileExtent = uint64_t(1) << TileExtentLog2;
+		static constexpr uint64_t TileArea = TileExtent * TileExtent;
 
-UCommon::FTex2D::FTex2D() noexcept :
-	NumChannels(0),
-	Ownership(EOwnership::DoNotTakeOwnership),
-	ElementType(EElementType::Unknown),
-	Storage(nullptr) {}
+		static inline uint64_t GetNumTiles(uint64_t Extent) noexcept
+		{
+			return (Extent + TileExtent - 1) >> TileExtentLog2;
+		}
 
-UCommon::FTex2D::FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EOwnership InOwnership, EElementType InElementType, void* InStorage) noexcept :
-	Grid2D(InGrid2D),
-	NumChannels(InNumChannels),
-	Ownership(InOwnership),
-	ElementType(InElementType),
-	Storage(InStorage)
-{
-	UBPA_UCOMMON_ASSERT(!InGrid2D.IsAreaEmpty());
-	UBPA_UCOMMON_ASSERT(InNumChannels > 0);
-	UBPA_UCOMMON_ASSERT(InStorage);
-}
+		/** Spread the bits of Coord (< TileExtent) to the even bits, X of a Morton code. */
+		static inline uint64_t MortonSpread(uint64_t Coord) noexcept
+		{
+			Coord = (Coord | (Coord << 2)) & 0x33;
+			return (Coord | (Coord << 1)) & 0x55;
+		}
 
-UCommon::FTex2D::FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType InElementType, const void* InStorage)
-	: FTex2D(InGrid2D, InNumChannels, EOwnership::TakeOwnership, InElementType,
-		CreateCopy(InStorage, GetRequiredStorageSizeInBytes(InGrid2D, InNumChannels, InElementType))) {}
+		/** The Tiled texel index is separable: GetTiledColumnIndex(X) + GetTiledRowIndex(Y, NumTilesX). */
+		static inline uint64_t GetTiledColumnIndex(uint64_t X) noexcept
+		{
+			return ((X >> TileExtentLog2) << (2 * TileExtentLog2)) + MortonSpread(X & (TileExtent - 1));
+		}
 
-UCommon::FTex2D::FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType InElementType) :
-	FTex2D(InGrid2D,
-		InNumChannels,
-		EOwnership::TakeOwnership,
-		InElementType,
-		UBPA_UCOMMON_MALLOC(GetRequiredStorageSizeInBytes(InGrid2D, InNumChannels, InElementType))) {
-}
+		static inline uint64_t GetTiledRowIndex(uint64_t Y, uint64_t NumTilesX) noexcept
+		{
+			return (Y >> TileExtentLog2) * NumTilesX * TileArea + (MortonSpread(Y & (TileExtent - 1)) << 1);
+		}
 
-UCommon::FTex2D::FTex2D(FTex2D&& Other) noexcept :
-	Grid2D(Other.GetGrid2D()),
-	NumChannels(Other.NumChannels),
-	Ownership(Other.Ownership),
-	ElementType(Other.ElementType),
-	Storage(Other.Storage)
-{
-	Other.Grid2D = FGrid2D();
-	Other.NumChannels = 0;
-	Other.Ownership = EOwnership::DoNotTakeOwnership;
-	Other.ElementType = EElementType();
-	Other.Storage = nullptr;
-}
+		/**
+		 * Copy the texels of the TileY-th row of tiles from Linear to Tiled (bTiling) or back.
+		 * Linear points to the first of its rows, packed. Padding texels of Tiled are zeroed when tiling.
+		 * StaticTexelSize is TexelSize if not 0, so that the copies of common texel sizes are inlined.
+		 */
+		template<uint64_t StaticTexelSize>
+		static void CopyTileRow(uint8_t* Tiled, uint8_t* Linear, const FGrid2D& Grid2D, uint64_t DynamicTexelSize, uint64_t TileY, bool bTiling) noexcept
+		{
+			const uint64_t TexelSize = StaticTexelSize != 0 ? StaticTexelSize : DynamicTexelSize;
+			const uint64_t NumTilesX = GetNumTiles(Grid2D.Width);
+			const uint64_t FirstY = TileY * TileExtent;
+			const uint64_t NumRows = std::min(TileExtent, Grid2D.Height - FirstY);
+			const uint64_t RowSize = Grid2D.Width * TexelSize;
+			uint8_t* TileRow = Tiled + GetTiledRowIndex(FirstY, NumTilesX) * TexelSize;
+			for (uint64_t LocalY = 0; LocalY < TileExtent; LocalY++)
+			{
+				uint8_t* TiledRow = TileRow + (MortonSpread(LocalY) << 1) * TexelSize;
+				uint64_t X = 0;
+				if (LocalY < NumRows)
+				{
+					uint8_t* LinearRow = Linear + LocalY * RowSize;
+					// X and X + 1 are neighbours in Morton order for even X
+					for (; X + 2 <= Grid2D.Width; X += 2)
+					{
+						uint8_t* TiledTexels = TiledRow + GetTiledColumnIndex(X) * TexelSize;
+						if (bTiling)
+						{
+							std::memcpy(TiledTexels, LinearRow + X * TexelSize, 2 * TexelSize);
+						}
+						else
+						{
+							std::memcpy(LinearRow + X * TexelSize, TiledTexels, 2 * TexelSize);
+						}
+					}
+					if (X < Grid2D.Width)
+					{
+						uint8_t* TiledTexel = TiledRow + GetTiledColumnIndex(X) * TexelSize;
+						if (bTiling)
+						{
+							std::memcpy(TiledTexel, LinearRow + X * TexelSize, TexelSize);
+						}
+						else
+						{
+							std::memcpy(LinearRow + X * TexelSize, TiledTexel, TexelSize);
+						}
+						X++;
+					}
+				}
+				if (bTiling)
+				{
+					for (; X < NumTilesX * TileExtent; X++)
+					{
+						std::memset(TiledRow + GetTiledColumnIndex(X) * TexelSize, 0, TexelSize);
+					}
+				}
+			}
+		}
 
-UCommon::FTex2D::FTex2D(const FTex2D& Other, EOwnership InOwnership, void* InEmptyStorage)
-	: Grid2D(Other.GetGrid2D())
-	, NumChannels(Other.NumChannels)
-	, Ownership(InOwnership)
-	, ElementType(Other.ElementType)
-	, Storage(InEmptyStorage)
-{
-	UBPA_UCOMMON_ASSERT(Other.IsValid() || !InEmptyStorage);
+		static void CopyTileRow(uint8_t* Tiled, uint8_t* Linear, const FGrid2D& Grid2D, uint64_t TexelSize, uint64_t TileY, bool bTiling) noexcept
+		{
+			switch (TexelSize)
+			{
+			case 1: CopyTileRow<1>(Tiled, Linear, Grid2D, TexelSize, TileY, bTiling); break;
+			case 2: CopyTileRow<2>(Tiled, Linear, Grid2D, TexelSize, TileY, bTiling); break;
+			case 4: CopyTileRow<4>(Tiled, Linear, Grid2D, TexelSize, TileY, bTiling); break;
+			case 8: CopyTileRow<8>(Tiled, Linear, Grid2D, TexelSize, TileY, bTiling); break;
+			case 16: CopyTileRow<16>(Tiled, Linear, Grid2D, TexelSize, TileY, bTiling); break;
+			default: CopyTileRow<0>(Tiled, Linear, Grid2D, TexelSize, TileY, bTiling); break;
+			}
+		}
 
-	if (Storage || Ownership == EOwnership::TakeOwnership)
-	{
-		if (!Storage)
+		/**
+		 * Copy NumTexels texels from Interleaved to the planes of Planar (bPlanarizing) or back.
+		 * Planar points to the first texel in plane 0, the planes are PlaneStride elements apart.
+		 * T is an unsigned integer of the element size, StaticNumChannels is NumChannels if not 0,
+		 * so that the loops of common channel counts are unrolled and vectorized.
+		 */
+		template<typename T, uint64_t StaticNumChannels>
+		static void CopyPlanarTexels(T* Planar, T* Interleaved, uint64_t PlaneStride, uint64_t DynamicNumChannels, uint64_t NumTexels, bool bPlanarizing) noexcept
+		{
+			const uint64_t NumChannels = StaticNumChannels != 0 ? StaticNumChannels : DynamicNumChannels;
+			if constexpr (StaticNumChannels != 0)
+			{
+				if (bPlanarizing)
+				{
+					for (uint64_t Index = 0; Index < NumTexels; Index++)
+					{
+						for (uint64_t C = 0; C < StaticNumChannels; C++)
+						{
+							Planar[C * PlaneStride + Index] = Interleaved[Index * StaticNumChannels + C];
+						}
+					}
+				}
+				else
+				{
+					for (uint64_t Index = 0; Index < NumTexels; Index++)
+					{
+						for (uint64_t C = 0; C < StaticNumChannels; C++)
+						{
+							Interleaved[Index * StaticNumChannels + C] = Planar[C * PlaneStride + Index];
+						}
+					}
+				}
+			}
+			else
+			{
+				// one plane at a time, so that the contiguous side stays in cache
+				for (uint64_t C = 0; C < NumChannels; C++)
+				{
+					T* Plane = Planar + C * PlaneStride;
+					if (bPlanarizing)
+					{
+						for (uint64_t Index = 0; Index < NumTexels; Index++)
+						{
+							Plane[Index] = Interleaved[Index * NumChannels + C];
+						}
+					}
+					else
+					{
+						for (uint64_t Index = 0; Index < NumTexels; Index++)
+						{
+							Interleaved[Index * NumChannels + C] = Plane[Index];
+						}
+					}
+				}
+			}
+		}
+
+		template<typename T>
+		static void CopyPlanarTexels(uint8_t* Planar, uint8_t* Interleaved, uint64_t PlaneStride, uint64_t NumChannels, uint64_t NumTexels, bool bPlanarizing) noexcept
 		{
-			Storage = UBPA_UCOMMON_MALLOC(Other.GetStorageSizeInBytes());
+			T* PlanarElements = reinterpret_cast<T*>(Planar);
+			T* InterleavedElements = reinterpret_cast<T*>(Interleaved);
+			switch (NumChannels)
+			{
+			case 2: CopyPlanarTexels<T, 2>(PlanarElements, InterleavedElements, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			case 3: CopyPlanarTexels<T, 3>(PlanarElements, InterleavedElements, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			case 4: CopyPlanarTexels<T, 4>(PlanarElements, InterleavedElements, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			default: CopyPlanarTexels<T, 0>(PlanarElements, InterleavedElements, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			}
+		}
+
+		static void CopyPlanarTexels(uint8_t* Planar, uint8_t* Interleaved, uint64_t ElementSize, uint64_t PlaneStride, uint64_t NumChannels, uint64_t NumTexels, bool bPlanarizing) noexcept
+		{
+			if (NumChannels == 1)
+			{
+				std::memcpy(bPlanarizing ? Planar : Interleaved, bPlanarizing ? Interleaved : Planar, NumTexels * ElementSize);
+				return;
+			}
+			switch (ElementSize)
+			{
+			case 1: CopyPlanarTexels<uint8_t>(Planar, Interleaved, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			case 2: CopyPlanarTexels<uint16_t>(Planar, Interleaved, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			case 4: CopyPlanarTexels<uint32_t>(Planar, Interleaved, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			case 8: CopyPlanarTexels<uint64_t>(Planar, Interleaved, PlaneStride, NumChannels, NumTexels, bPlanarizing); break;
+			default: UBPA_UCOMMON_NO_ENTRY(); break;
+			}
+		}
+
+		static void SerializeLayout(IArchive& Archive, FGrid2D& Grid2D, uint64_t& NumChannels, EOwnership& Ownership, EElementType& ElementType)
+		{
+			Archive.ByteSerialize(Grid2D);
+			Archive.ByteSerialize(NumChannels);
+			Archive.ByteSerialize(Ownership);
+			Archive.ByteSerialize(ElementType);
+		}
+
+		/** Elements per task of the pointwise operations, smaller views run on the calling thread. */
+		static constexpr uint64_t PointwiseGrainSize = 1 << 16;
+
+		/**
+		 * Call Function(Elements, NumElements) for each row of View, or once per range of rows if the rows are packed.
+		 * Rows are split across ThreadPool if not nullptr and the view has at least 2 * PointwiseGrainSize elements.
+		 */
+		template<typename T, typename FunctionT>
+		static void ForEachRow(const FTex2DView& View, FThreadPool* ThreadPool, FunctionT&& Function)
+		{
+			const FGrid2D& Grid2D = View.GetGrid2D();
+			const uint64_t RowNumElements = Grid2D.Width * View.GetNumChannels();
+			const bool bContiguous = View.IsContiguous();
+			auto ForRows = [&](uint64_t RowBegin, uint64_t RowEnd)
+			{
+				if (bContiguous)
+				{
+					Function(static_cast<T*>(View.GetRow(RowBegin)), RowNumElements * (RowEnd - RowBegin));
+					return;
+				}
+				for (uint64_t Y = RowBegin; Y < RowEnd; Y++)
+				{
+					Function(static_cast<T*>(View.GetRow(Y)), RowNumElements);
+				}
+			};
+
+			if (ThreadPool && RowNumElements * Grid2D.Height >= 2 * PointwiseGrainSize)
+			{
+				ThreadPool->ParallelForRange(0, Grid2D.Height, std::max<uint64_t>(1, PointwiseGrainSize / RowNumElements), ForRows);
+			}
+			else
+			{
+				ForRows(0, Grid2D.Height);
+			}
 		}
-		memcpy(Storage, Other.Storage, Other.GetStorageSizeInBytes());
-	}
-	else
-	{
-		UBPA_UCOMMON_ASSERT(!Storage && Ownership == EOwnership::DoNotTakeOwnership);
-		Storage = Other.Storage;
 	}
 }
 
-UCommon::FTex2D::FTex2D(const FTex2D& Other) :
-	FTex2D(Other, Other.Ownership, nullptr) {
-}
+UCommon::FConstTex2DView::FConstTex2DView() noexcept :
+	Storage(nullptr),
+	NumChannels(0),
+	ElementType(EElementType::Unknown),
+	RowStride(0) {}
 
-UCommon::FTex2D::~FTex2D()
+UCommon::FConstTex2DView::FConstTex2DView(const void* InStorage, const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType, uint64_t InRowStride) noexcept :
+	Storage(static_cast<const uint8_t*>(InStorage)),
+	Grid2D(InGrid2D),
+	NumChannels(InNumChannels),
+	ElementType(InElementType),
+	RowStride(InRowStride != 0 ? InRowStride : InGrid2D.Width * InNumChannels * ElementGetSize(InElementType))
 {
-	if (Ownership == EOwnership::TakeOwnership)
-	{
-		UBPA_UCOMMON_FREE(Storage);
-	}
+	UBPA_UCOMMON_ASSERT(RowStride >= GetRowSizeInBytes());
 }
 
-bool UCommon::FTex2D::IsValid() const noexcept
+UCommon::FConstTex2DView::FConstTex2DView(const FTex2D& Tex) noexcept :
+	FConstTex2DView(Tex.GetStorage(), Tex.GetGrid2D(), Tex.GetNumChannels(), Tex.GetElementType())
 {
-	return !Grid2D.IsAreaEmpty() && NumChannels > 0 && Storage;
+	UBPA_UCOMMON_ASSERT(Tex.GetStorageLayout() == ETex2DStorageLayout::Linear);
 }
 
-uint64_t UCommon::FTex2D::GetIndex(const FUint64Vector2& Point, uint64_t C) const noexcept
+bool UCommon::FConstTex2DView::IsValid() const noexcept { return !Grid2D.IsAreaEmpty() && NumChannels > 0 && Storage; }
+const UCommon::FGrid2D& UCommon::FConstTex2DView::GetGrid2D() const noexcept { return Grid2D; }
+uint64_t UCommon::FConstTex2DView::GetNumChannels() const noexcept { return NumChannels; }
+UCommon::EElementType UCommon::FConstTex2DView::GetElementType() const noexcept { return ElementType; }
+uint64_t UCommon::FConstTex2DView::GetRowStride() const noexcept { return RowStride; }
+uint64_t UCommon::FConstTex2DView::GetRowSizeInBytes() const noexcept { return Grid2D.Width * NumChannels * ElementGetSize(ElementType); }
+bool UCommon::FConstTex2DView::IsContiguous() const noexcept { return RowStride == GetRowSizeInBytes() || Grid2D.Height <= 1; }
+
+const void* UCommon::FConstTex2DView::GetRow(uint64_t Y) const noexcept
 {
-	UBPA_UCOMMON_ASSERT(C < NumChannels);
-	return Grid2D.GetIndex(Point) * NumChannels + C;
+	UBPA_UCOMMON_ASSERT(Y < Grid2D.Height);
+	return Storage + Y * RowStride;
 }
 
-float UCommon::FTex2D::GetFloat(uint64_t Index) const noexcept
+float UCommon::FConstTex2DView::GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept
 {
-	switch (ElementType)
-	{
-	case UCommon::EElementType::Uint8:
-		return ElementUint8ToFloat(At<uint8_t>(Index));
-	case UCommon::EElementType::Float:
-		return At<float>(Index);
-	case UCommon::EElementType::Double:
-		return static_cast<float>(At<double>(Index));
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		return 0.f;
-	}
+	UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point) && C < NumChannels);
+	return Details::GetElementFloat(GetRow(Point.Y), ElementType, Point.X * NumChannels + C);
 }
 
-UCommon::FLinearColorRGB UCommon::FTex2D::GetLinearColorRGB(const FUint64Vector2& Point) const noexcept
+UCommon::FConstTex2DView UCommon::FConstTex2DView::GetSubView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept
 {
-	switch (ElementType)
-	{
-	case UCommon::EElementType::Uint8:
-		return ElementColorToLinearColor(At<FColorRGB>(Point));
-	case UCommon::EElementType::Float:
-		return At<FLinearColorRGB>(Point);
-	case UCommon::EElementType::Double:
-		return FLinearColorRGB(At<FDoubleColorRGB>(Point));
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		return FLinearColorRGB(0.f);
-	}
+	UBPA_UCOMMON_ASSERT(InOrigin.X + InGrid2D.Width <= Grid2D.Width && InOrigin.Y + InGrid2D.Height <= Grid2D.Height);
+	const uint8_t* Origin = Storage + InOrigin.Y * RowStride + InOrigin.X * NumChannels * ElementGetSize(ElementType);
+	return FConstTex2DView(Origin, InGrid2D, NumChannels, ElementType, RowStride);
 }
 
-UCommon::FLinearColor UCommon::FTex2D::GetLinearColor(const FUint64Vector2& Point) const noexcept
+void UCommon::FConstTex2DView::BilinearSample(float* Result, const FVector2f& Texcoord, ETextureAddress AddressModeX, ETextureAddress AddressModeY) const noexcept
 {
-	switch (ElementType)
+	const FVector2f PointT = Texcoord * FVector2f(Grid2D.GetExtent());
+	const FVector2f PointTOffset = PointT - 0.5f;
+	const FInt64Vector2 IntPoint0 = FInt64Vector2(PointTOffset.Floor());
+	const FInt64Vector2 IntPoint1 = IntPoint0 + 1;
+
+	// Apply address mode to integer coordinates
+	const FUint64Vector2 Points[2] =
 	{
-	case UCommon::EElementType::Uint8:
-		return ElementColorToLinearColor(At<FColor>(Point));
-	case UCommon::EElementType::Float:
-		return At<FLinearColor>(Point);
-	case UCommon::EElementType::Double:
-		return FLinearColor(At<FDoubleColor>(Point));
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		return FLinearColor(0.f);
-	}
-}
+		ApplyAddressMode(IntPoint0, Grid2D.GetExtent(), AddressModeX, AddressModeY),
+		ApplyAddressMode(IntPoint1, Grid2D.GetExtent(), AddressModeX, AddressModeY),
+	};
 
-UCommon::FDoubleColorRGB UCommon::FTex2D::GetDoubleColorRGB(const FUint64Vector2& Point) const noexcept
-{
-	switch (ElementType)
+	const FVector2f LocalTexcoord = (PointT - (FVector2f(IntPoint0) + 0.5f)).Clamp(0.f, 1.f);
+
+	const FVector2f OneMinusLocalTexcoord = FVector2f(1.f) - LocalTexcoord;
+
+	const float Weights[4] =
 	{
-	case UCommon::EElementType::Uint8:
-		return ElementColorToDoubleColor(At<FColorRGB>(Point));
-	case UCommon::EElementType::Float:
-		return FDoubleColorRGB(At<FLinearColorRGB>(Point));
-	case UCommon::EElementType::Double:
-		return At<FDoubleColorRGB>(Point);
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		return FDoubleColorRGB(0.f);
-	}
-}
+		OneMinusLocalTexcoord.X * OneMinusLocalTexcoord.Y,
+		OneMinusLocalTexcoord.X * LocalTexcoord.Y,
+		LocalTexcoord.X * OneMinusLocalTexcoord.Y,
+		LocalTexcoord.X * LocalTexcoord.Y,
+	};
 
-UCommon::FDoubleColor UCommon::FTex2D::GetDoubleColor(const FUint64Vector2& Point) const noexcept
-{
-	switch (ElementType)
+	const void* Rows[2] = { GetRow(Points[0].Y), GetRow(Points[1].Y) };
+	const void* Texels[4] = { Rows[0], Rows[1], Rows[0], Rows[1] };
+	const uint64_t Offsets[4] =
 	{
-	case UCommon::EElementType::Uint8:
-		return ElementColorToDoubleColor(At<FColor>(Point));
-	case UCommon::EElementType::Float:
-		return FDoubleColor(At<FLinearColor>(Point));
-	case UCommon::EElementType::Double:
-		return At<FDoubleColor>(Point);
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		return FDoubleColor(0.f);
-	}
-}
+		Points[0].X * NumChannels,
+		Points[0].X * NumChannels,
+		Points[1].X * NumChannels,
+		Points[1].X * NumChannels,
+	};
 
-float UCommon::FTex2D::GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept
-{
-	return GetFloat(GetIndex(Point, C));
+	for (uint64_t C = 0; C < NumChannels; C++)
+	{
+		float Val2[4];
+		for (uint64_t i = 0; i < 4; i++)
+		{
+			Val2[i] = Details::GetElementFloat(Texels[i], ElementType, Offsets[i] + C);
+		}
+		*Result++ = UCommon::BilinearInterpolate(Val2, Weights);
+	}
 }
 
-void UCommon::FTex2D::SetFloat(uint64_t Index, float Value) noexcept
+namespace UCommon
+{
+	namespace Details
+	{
+		/** The texels read by the BilinearSampleBatch kernels. */
+		struct FBilinearSampleSource
+		{
+			const uint8_t* Storage;
+			FUint64Vector2 Extent;
+			uint64_t NumChannels;
+			/** Bytes between two rows if Linear or Planar, between two rows of tiles if Tiled. */
+			uint64_t RowStride;
+			/** Bytes between two planes if Planar. */
+			uint64_t PlaneStride;
+		};
+
+		static FBilinearSampleSource MakeBilinearSampleSource(const FConstTex2DView& View) noexcept
+		{
+			return { static_cast<const uint8_t*>(View.GetRow(0)), View.GetGrid2D().GetExtent(), View.GetNumChannels(), View.GetRowStride(), 0 };
+		}
+
+		static FBilinearSampleSource MakeBilinearSampleSource(const FTex2D& Tex) noexcept
+		{
+			const FGrid2D& Grid2D = Tex.GetGrid2D();
+			const uint64_t ElementSize = ElementGetSize(Tex.GetElementType());
+			const uint64_t TexelSize = Tex.GetNumChannels() * ElementSize;
+			const uint8_t* Storage = static_cast<const uint8_t*>(Tex.GetStorage());
+			switch (Tex.GetStorageLayout())
+			{
+			case ETex2DStorageLayout::Tiled:
+				return { Storage, Grid2D.GetExtent(), Tex.GetNumChannels(), GetNumTiles(Grid2D.Width) * TileArea * TexelSize, 0 };
+			case ETex2DStorageLayout::Planar:
+				return { Storage, Grid2D.GetExtent(), Tex.GetNumChannels(), Grid2D.Width * ElementSize, Grid2D.GetArea() * ElementSize };
+			default:
+				return { Storage, Grid2D.GetExtent(), Tex.GetNumChannels(), Grid2D.Width * TexelSize, 0 };
+			}
+		}
+
+		/** Byte offset of the texels of column X, to be added to GetRowOffset (in plane 0 if Planar). */
+		template<ETex2DStorageLayout StorageLayout>
+		static inline uint64_t GetColumnOffset(uint64_t X, uint64_t TexelSize) noexcept
+		{
+			if constexpr (StorageLayout != ETex2DStorageLayout::Tiled)
+			{
+				return X * TexelSize;
+			}
+			else
+			{
+				return GetTiledColumnIndex(X) * TexelSize;
+			}
+		}
+
+		template<ETex2DStorageLayout StorageLayout>
+		static inline uint64_t GetRowOffset(uint64_t Y, uint64_t TexelSize, uint64_t RowStride) noexcept
+		{
+			if constexpr (StorageLayout != ETex2DStorageLayout::Tiled)
+			{
+				return Y * RowStride;
+			}
+			else
+			{
+				return (Y >> TileExtentLog2) * RowStride + (MortonSpread(Y & (TileExtent - 1)) << 1) * TexelSize;
+			}
+		}
+
+		/**
+		 * The four taps of FConstTex2DView::BilinearSample at Texcoord,
+		 * as byte offsets of the texels from Source.Storage, in the order of BilinearInterpolate.
+		 */
+		template<typename T, ETex2DStorageLayout StorageLayout, ETextureAddress AddressModeX, ETextureAddress AddressModeY>
+		static inline void ComputeBilinearTaps(const FBilinearSampleSource& Source, const FVector2f& Texcoord, uint64_t Offsets[4], float Weights[4]) noexcept
+		{
+			const FUint64Vector2 Extent = Source.Extent;
+			const FVector2f PointT = Texcoord * FVector2f(Extent);
+			const FVector2f PointTOffset = PointT - 0.5f;
+			const FInt64Vector2 IntPoint0 = FInt64Vector2(PointTOffset.Floor());
+
+			const uint64_t X0 = ApplyAddressModeT<AddressModeX>(IntPoint0.X, Extent.X);
+			const uint64_t X1 = ApplyAddressModeT<AddressModeX>(IntPoint0.X + 1, Extent.X);
+			const uint64_t Y0 = ApplyAddressModeT<AddressModeY>(IntPoint0.Y, Extent.Y);
+			const uint64_t Y1 = ApplyAddressModeT<AddressModeY>(IntPoint0.Y + 1, Extent.Y);
+
+			const FVector2f LocalTexcoord = (PointT - (FVector2f(IntPoint0) + 0.5f)).Clamp(0.f, 1.f);
+			const FVector2f OneMinusLocalTexcoord = FVector2f(1.f) - LocalTexcoord;
+
+			Weights[0] = OneMinusLocalTexcoord.X * OneMinusLocalTexcoord.Y;
+			Weights[1] = OneMinusLocalTexcoord.X * LocalTexcoord.Y;
+			Weights[2] = LocalTexcoord.X * OneMinusLocalTexcoord.Y;
+			Weights[3] = LocalTexcoord.X * LocalTexcoord.Y;
+
+			// a texel of a plane is one element
+			const uint64_t TexelSize = (StorageLayout == ETex2DStorageLayout::Planar ? 1 : Source.NumChannels) * sizeof(T);
+			const uint64_t Columns[2] = { GetColumnOffset<StorageLayout>(X0, TexelSize), GetColumnOffset<StorageLayout>(X1, TexelSize) };
+			const uint64_t Rows[2] = { GetRowOffset<StorageLayout>(Y0, TexelSize, Source.RowStride), GetRowOffset<StorageLayout>(Y1, TexelSize, Source.RowStride) };
+			Offsets[0] = Rows[0] + Columns[0];
+			Offsets[1] = Rows[1] + Columns[0];
+			Offsets[2] = Rows[0] + Columns[1];
+			Offsets[3] = Rows[1] + Columns[1];
+		}
+
+		template<typename T>
+		static inline void BilinearInterpolateTexels(const uint8_t* Storage, const uint64_t Offsets[4], const float Weights[4], uint64_t NumChannels, float* Result) noexcept
+		{
+			const T* Texels[4] =
+			{
+				reinterpret_cast<const T*>(Storage + Offsets[0]),
+				reinterpret_cast<const T*>(Storage + Offsets[1]),
+				reinterpret_cast<const T*>(Storage + Offsets[2]),
+				reinterpret_cast<const T*>(Storage + Offsets[3]),
+			};
+			uint64_t C = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			if constexpr (std::is_same_v<T, float> || std::is_same_v<T, FHalf>)
+			{
+				// 4 channels at a time, same operation order as BilinearInterpolate
+				const __m128 W0 = _mm_set1_ps(Weights[0]);
+				const __m128 W1 = _mm_set1_ps(Weights[1]);
+				const __m128 W2 = _mm_set1_ps(Weights[2]);
+				const __m128 W3 = _mm_set1_ps(Weights[3]);
+				for (; C + 4 <= NumChannels; C += 4)
+				{
+					__m128 V[4];
+					for (uint64_t Tap = 0; Tap < 4; Tap++)
+					{
+						if constexpr (std::is_same_v<T, float>)
+						{
+							V[Tap] = _mm_loadu_ps(Texels[Tap] + C);
+						}
+						else
+						{
+#if defined(UBPA_UCOMMON_SIMD_F16C)
+							V[Tap] = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Texels[Tap] + C)));
+#else
+							V[Tap] = _mm_setr_ps(LoadElementFloat(Texels[Tap] + C), LoadElementFloat(Texels[Tap] + C + 1), LoadElementFloat(Texels[Tap] + C + 2), LoadElementFloat(Texels[Tap] + C + 3));
+#endif
+						}
+					}
+					const __m128 Value0 = _mm_add_ps(_mm_mul_ps(V[1], W1), _mm_mul_ps(V[0], W0));
+					const __m128 Value1 = _mm_add_ps(_mm_mul_ps(V[3], W3), _mm_mul_ps(V[2], W2));
+					_mm_storeu_ps(Result + C, _mm_add_ps(Value1, Value0));
+				}
+			}
+#endif
+			for (; C < NumChannels; C++)
+			{
+				const float Val2[4] =
+				{
+					LoadElementFloat(Texels[0] + C),
+					LoadElementFloat(Texels[1] + C),
+					LoadElementFloat(Texels[2] + C),
+					LoadElementFloat(Texels[3] + C),
+				};
+				Result[C] = UCommon::BilinearInterpolate(Val2, Weights);
+			}
+		}
+
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+		/** ApplyAddressModeT on 8 lanes of coordinates in [-1, Size]. */
+		template<ETextureAddress AddressMode>
+		static inline __m256i ApplyAddressModeNear8(__m256i Coords, int32_t Size) noexcept
+		{
+			const __m256i Zero = _mm256_setzero_si256();
+			const __m256i Last = _mm256_set1_epi32(Size - 1);
+			if constexpr (AddressMode == ETextureAddress::Wrap)
+			{
+				Coords = _mm256_blendv_epi8(Coords, Last, _mm256_cmpgt_epi32(Zero, Coords));
+				return _mm256_blendv_epi8(Coords, Zero, _mm256_cmpgt_epi32(Coords, Last));
+			}
+			else
+			{
+				// Clamp and Mirror agree on [-1, Size]
+				return _mm256_min_epi32(_mm256_max_epi32(Coords, Zero), Last);
+			}
+		}
+
+		/** MortonSpread on 8 lanes. */
+		static inline __m256i MortonSpread8(__m256i Coords) noexcept
+		{
+			Coords = _mm256_and_si256(_mm256_or_si256(Coords, _mm256_slli_epi32(Coords, 2)), _mm256_set1_epi32(0x33));
+			return _mm256_and_si256(_mm256_or_si256(Coords, _mm256_slli_epi32(Coords, 1)), _mm256_set1_epi32(0x55));
+		}
+
+		/** GetColumnOffset on 8 lanes, Strides is { TexelSize, RowStride }. */
+		template<ETex2DStorageLayout StorageLayout>
+		static inline __m256i GetColumnOffset8(__m256i X, const __m256i Strides[2]) noexcept
+		{
+			if constexpr (StorageLayout != ETex2DStorageLayout::Tiled)
+			{
+				return _mm256_mullo_epi32(X, Strides[0]);
+			}
+			else
+			{
+				const __m256i TileBase = _mm256_slli_epi32(_mm256_srli_epi32(X, TileExtentLog2), 2 * TileExtentLog2);
+				const __m256i Local = MortonSpread8(_mm256_and_si256(X, _mm256_set1_epi32(TileExtent - 1)));
+				return _mm256_mullo_epi32(_mm256_add_epi32(TileBase, Local), Strides[0]);
+			}
+		}
+
+		/** GetRowOffset on 8 lanes, Strides is { TexelSize, RowStride }. */
+		template<ETex2DStorageLayout StorageLayout>
+		static inline __m256i GetRowOffset8(__m256i Y, const __m256i Strides[2]) noexcept
+		{
+			if constexpr (StorageLayout != ETex2DStorageLayout::Tiled)
+			{
+				return _mm256_mullo_epi32(Y, Strides[1]);
+			}
+			else
+			{
+				const __m256i TileRow = _mm256_mullo_epi32(_mm256_srli_epi32(Y, TileExtentLog2), Strides[1]);
+				const __m256i Local = _mm256_slli_epi32(MortonSpread8(_mm256_and_si256(Y, _mm256_set1_epi32(TileExtent - 1))), 1);
+				return _mm256_add_epi32(TileRow, _mm256_mullo_epi32(Local, Strides[0]));
+			}
+		}
+
+		/**
+		 * ComputeBilinearTaps for Texcoords[0, 8) with the same float operations,
+		 * false if a coordinate is too far outside the view, then the lanes are left for the scalar path.
+		 */
+		template<ETex2DStorageLayout StorageLayout, ETextureAddress AddressModeX, ETextureAddress AddressModeY>
+		static inline bool ComputeBilinearTaps8(const FVector2f* Texcoords, __m256 Extent[2], int32_t Size[2], __m256i Strides[2], __m256i Offsets[4], __m256 Weights[4]) noexcept
+		{
+			// deinterleave 8 (X, Y) pairs
+			const __m256 Lo = _mm256_loadu_ps(reinterpret_cast<const float*>(Texcoords));
+			const __m256 Hi = _mm256_loadu_ps(reinterpret_cast<const float*>(Texcoords) + 8);
+			const __m256i Order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+			const __m256 LoXY = _mm256_permutevar8x32_ps(Lo, Order);
+			const __m256 HiXY = _mm256_permutevar8x32_ps(Hi, Order);
+			const __m256 Texcoord[2] =
+			{
+				_mm256_permute2f128_ps(LoXY, HiXY, 0x20),
+				_mm256_permute2f128_ps(LoXY, HiXY, 0x31),
+			};
+
+			constexpr ETextureAddress AddressModes[2] = { AddressModeX, AddressModeY };
+			__m256i Coords[2][2];
+			__m256 LocalTexcoord[2];
+			for (uint64_t Axis = 0; Axis < 2; Axis++)
+			{
+				const __m256 PointT = _mm256_mul_ps(Texcoord[Axis], Extent[Axis]);
+				const __m256 Floor = _mm256_floor_ps(_mm256_sub_ps(PointT, _mm256_set1_ps(0.5f)));
+				const float MinCoord = AddressModes[Axis] == ETextureAddress::Clamp ? -1073741824.f : -1.f;
+				const float MaxCoord = AddressModes[Axis] == ETextureAddress::Clamp ? 1073741824.f : static_cast<float>(Size[Axis] - 1);
+				const __m256 InRange = _mm256_and_ps(
+					_mm256_cmp_ps(Floor, _mm256_set1_ps(MinCoord), _CMP_GE_OQ),
+					_mm256_cmp_ps(Floor, _mm256_set1_ps(MaxCoord), _CMP_LE_OQ));
+				if (_mm256_movemask_ps(InRange) != 0xFF)
+				{
+					return false;
+				}
+
+				const __m256i Coord0 = _mm256_cvttps_epi32(Floor);
+				const __m256i Coord1 = _mm256_add_epi32(Coord0, _mm256_set1_epi32(1));
+				if (AddressModes[Axis] == ETextureAddress::Wrap)
+				{
+					Coords[Axis][0] = ApplyAddressModeNear8<ETextureAddress::Wrap>(Coord0, Size[Axis]);
+					Coords[Axis][1] = ApplyAddressModeNear8<ETextureAddress::Wrap>(Coord1, Size[Axis]);
+				}
+				else
+				{
+					Coords[Axis][0] = ApplyAddressModeNear8<ETextureAddress::Clamp>(Coord0, Size[Axis]);
+					Coords[Axis][1] = ApplyAddressModeNear8<ETextureAddress::Clamp>(Coord1, Size[Axis]);
+				}
+
+				const __m256 Local = _mm256_sub_ps(PointT, _mm256_add_ps(Floor, _mm256_set1_ps(0.5f)));
+				LocalTexcoord[Axis] = _mm256_min_ps(_mm256_max_ps(Local, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+			}
+
+			const __m256 One = _mm256_set1_ps(1.f);
+			const __m256 OneMinusX = _mm256_sub_ps(One, LocalTexcoord[0]);
+			const __m256 OneMinusY = _mm256_sub_ps(One, LocalTexcoord[1]);
+			Weights[0] = _mm256_mul_ps(OneMinusX, OneMinusY);
+			Weights[1] = _mm256_mul_ps(OneMinusX, LocalTexcoord[1]);
+			Weights[2] = _mm256_mul_ps(LocalTexcoord[0], OneMinusY);
+			Weights[3] = _mm256_mul_ps(LocalTexcoord[0], LocalTexcoord[1]);
+
+			const __m256i X0 = GetColumnOffset8<StorageLayout>(Coords[0][0], Strides);
+			const __m256i X1 = GetColumnOffset8<StorageLayout>(Coords[0][1], Strides);
+			const __m256i Y0 = GetRowOffset8<StorageLayout>(Coords[1][0], Strides);
+			const __m256i Y1 = GetRowOffset8<StorageLayout>(Coords[1][1], Strides);
+			Offsets[0] = _mm256_add_epi32(Y0, X0);
+			Offsets[1] = _mm256_add_epi32(Y1, X0);
+			Offsets[2] = _mm256_add_epi32(Y0, X1);
+			Offsets[3] = _mm256_add_epi32(Y1, X1);
+			return true;
+		}
+#endif
+
+		/** Sample Texcoords[0, NumTexcoords) of Source, which has ElementType T. */
+		template<typename T, ETex2DStorageLayout StorageLayout, ETextureAddress AddressModeX, ETextureAddress AddressModeY>
+		static void BilinearSampleBatchKernel(const FBilinearSampleSource& Source, const FVector2f* Texcoords, uint64_t NumTexcoords, float* Results) noexcept
+		{
+			const uint8_t* Storage = Source.Storage;
+			const uint64_t NumChannels = Source.NumChannels;
+
+			auto SampleOne = [&](uint64_t Index)
+			{
+				uint64_t Offsets[4];
+				float Weights[4];
+				ComputeBilinearTaps<T, StorageLayout, AddressModeX, AddressModeY>(Source, Texcoords[Index], Offsets, Weights);
+				if constexpr (StorageLayout == ETex2DStorageLayout::Planar)
+				{
+					// the taps are the same in every plane
+					for (uint64_t C = 0; C < NumChannels; C++)
+					{
+						BilinearInterpolateTexels<T>(Storage + C * Source.PlaneStride, Offsets, Weights, 1, Results + Index * NumChannels + C);
+					}
+				}
+				else
+				{
+					BilinearInterpolateTexels<T>(Storage, Offsets, Weights, NumChannels, Results + Index * NumChannels);
+				}
+			};
+
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			// 8 samples at a time, gather offsets are int32 and the extent is exact in float
+			const FUint64Vector2 Extent = Source.Extent;
+			const uint64_t NumRowStrides = StorageLayout == ETex2DStorageLayout::Tiled ? GetNumTiles(Extent.Y) : Extent.Y;
+			if (Source.RowStride * NumRowStrides <= static_cast<uint64_t>(INT32_MAX) && Extent.X < (1u << 24) && Extent.Y < (1u << 24))
+			{
+				__m256 ExtentF[2] = { _mm256_set1_ps(static_cast<float>(Extent.X)), _mm256_set1_ps(static_cast<float>(Extent.Y)) };
+				int32_t Size[2] = { static_cast<int32_t>(Extent.X), static_cast<int32_t>(Extent.Y) };
+				const uint64_t TexelSize = (StorageLayout == ETex2DStorageLayout::Planar ? 1 : NumChannels) * sizeof(T);
+				__m256i Strides[2] = { _mm256_set1_epi32(static_cast<int32_t>(TexelSize)), _mm256_set1_epi32(static_cast<int32_t>(Source.RowStride)) };
+				for (; Index + 8 <= NumTexcoords; Index += 8)
+				{
+					__m256i Offsets[4];
+					__m256 Weights[4];
+					if (!ComputeBilinearTaps8<StorageLayout, AddressModeX, AddressModeY>(Texcoords + Index, ExtentF, Size, Strides, Offsets, Weights))
+					{
+						for (uint64_t Lane = 0; Lane < 8; Lane++)
+						{
+							SampleOne(Index + Lane);
+						}
+						continue;
+					}
+
+					if (NumChannels == 1 || StorageLayout == ETex2DStorageLayout::Planar)
+					{
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							const uint8_t* Plane = Storage + C * Source.PlaneStride;
+							__m256 Values[4];
+							for (uint64_t Tap = 0; Tap < 4; Tap++)
+							{
+								if constexpr (std::is_same_v<T, float>)
+								{
+									Values[Tap] = _mm256_i32gather_ps(reinterpret_cast<const float*>(Plane), Offsets[Tap], 1);
+								}
+								else
+								{
+									alignas(32) int32_t LaneOffsets[8];
+									_mm256_store_si256(reinterpret_cast<__m256i*>(LaneOffsets), Offsets[Tap]);
+#if defined(UBPA_UCOMMON_SIMD_F16C)
+									if constexpr (std::is_same_v<T, FHalf>)
+									{
+										// a 32-bit gather could read past the end of the storage
+										alignas(16) uint16_t Halves[8];
+										for (uint64_t Lane = 0; Lane < 8; Lane++)
+										{
+											std::memcpy(&Halves[Lane], Plane + LaneOffsets[Lane], sizeof(uint16_t));
+										}
+										Values[Tap] = _mm256_cvtph_ps(_mm_load_si128(reinterpret_cast<const __m128i*>(Halves)));
+										continue;
+									}
+#endif
+									alignas(32) float Lanes[8];
+									for (uint64_t Lane = 0; Lane < 8; Lane++)
+									{
+										Lanes[Lane] = LoadElementFloat(reinterpret_cast<const T*>(Plane + LaneOffsets[Lane]));
+									}
+									Values[Tap] = _mm256_load_ps(Lanes);
+								}
+							}
+							const __m256 Value0 = _mm256_add_ps(_mm256_mul_ps(Values[1], Weights[1]), _mm256_mul_ps(Values[0], Weights[0]));
+							const __m256 Value1 = _mm256_add_ps(_mm256_mul_ps(Values[3], Weights[3]), _mm256_mul_ps(Values[2], Weights[2]));
+							const __m256 Value = _mm256_add_ps(Value1, Value0);
+							if (NumChannels == 1)
+							{
+								_mm256_storeu_ps(Results + Index, Value);
+							}
+							else
+							{
+								alignas(32) float Lanes[8];
+								_mm256_store_ps(Lanes, Value);
+								for (uint64_t Lane = 0; Lane < 8; Lane++)
+								{
+									Results[(Index + Lane) * NumChannels + C] = Lanes[Lane];
+								}
+							}
+						}
+						continue;
+					}
+
+					alignas(32) int32_t LaneOffsets[4][8];
+					alignas(32) float LaneWeights[4][8];
+					for (uint64_t Tap = 0; Tap < 4; Tap++)
+					{
+						_mm256_store_si256(reinterpret_cast<__m256i*>(LaneOffsets[Tap]), Offsets[Tap]);
+						_mm256_store_ps(LaneWeights[Tap], Weights[Tap]);
+					}
+					for (uint64_t Lane = 0; Lane < 8; Lane++)
+					{
+						const uint64_t SampleOffsets[4] = { (uint64_t)LaneOffsets[0][Lane], (uint64_t)LaneOffsets[1][Lane], (uint64_t)LaneOffsets[2][Lane], (uint64_t)LaneOffsets[3][Lane] };
+						const float SampleWeights[4] = { LaneWeights[0][Lane], LaneWeights[1][Lane], LaneWeights[2][Lane], LaneWeights[3][Lane] };
+						BilinearInterpolateTexels<T>(Storage, SampleOffsets, SampleWeights, NumChannels, Results + (Index + Lane) * NumChannels);
+					}
+				}
+			}
+#endif
+
+			for (; Index < NumTexcoords; Index++)
+			{
+				SampleOne(Index);
+			}
+		}
+
+		using FBilinearSampleBatchKernel = void(*)(const FBilinearSampleSource&, const FVector2f*, uint64_t, float*) noexcept;
+
+		template<typename T, ETex2DStorageLayout StorageLayout, ETextureAddress AddressModeX>
+		static FBilinearSampleBatchKernel GetBilinearSampleBatchKernel(ETextureAddress AddressModeY) noexcept
+		{
+			switch (AddressModeY)
+			{
+			case ETextureAddress::Wrap: return &BilinearSampleBatchKernel<T, StorageLayout, AddressModeX, ETextureAddress::Wrap>;
+			case ETextureAddress::Clamp: return &BilinearSampleBatchKernel<T, StorageLayout, AddressModeX, ETextureAddress::Clamp>;
+			case ETextureAddress::Mirror: return &BilinearSampleBatchKernel<T, StorageLayout, AddressModeX, ETextureAddress::Mirror>;
+			default: UBPA_UCOMMON_NO_ENTRY(); return nullptr;
+			}
+		}
+
+		template<typename T, ETex2DStorageLayout StorageLayout>
+		static FBilinearSampleBatchKernel GetBilinearSampleBatchKernel(ETextureAddress AddressModeX, ETextureAddress AddressModeY) noexcept
+		{
+			switch (AddressModeX)
+			{
+			case ETextureAddress::Wrap: return GetBilinearSampleBatchKernel<T, StorageLayout, ETextureAddress::Wrap>(AddressModeY);
+			case ETextureAddress::Clamp: return GetBilinearSampleBatchKernel<T, StorageLayout, ETextureAddress::Clamp>(AddressModeY);
+			case ETextureAddress::Mirror: return GetBilinearSampleBatchKernel<T, StorageLayout, ETextureAddress::Mirror>(AddressModeY);
+			default: UBPA_UCOMMON_NO_ENTRY(); return nullptr;
+			}
+		}
+
+		template<typename T>
+		static FBilinearSampleBatchKernel GetBilinearSampleBatchKernel(ETex2DStorageLayout StorageLayout, ETextureAddress AddressModeX, ETextureAddress AddressModeY) noexcept
+		{
+			switch (StorageLayout)
+			{
+			case ETex2DStorageLayout::Linear: return GetBilinearSampleBatchKernel<T, ETex2DStorageLayout::Linear>(AddressModeX, AddressModeY);
+			case ETex2DStorageLayout::Tiled: return GetBilinearSampleBatchKernel<T, ETex2DStorageLayout::Tiled>(AddressModeX, AddressModeY);
+			case ETex2DStorageLayout::Planar: return GetBilinearSampleBatchKernel<T, ETex2DStorageLayout::Planar>(AddressModeX, AddressModeY);
+			default: UBPA_UCOMMON_NO_ENTRY(); return nullptr;
+			}
+		}
+
+		static FBilinearSampleBatchKernel GetBilinearSampleBatchKernel(EElementType ElementType, ETex2DStorageLayout StorageLayout, ETextureAddress AddressModeX, ETextureAddress AddressModeY) noexcept
+		{
+			switch (ElementType)
+			{
+			case EElementType::Uint8: return GetBilinearSampleBatchKernel<uint8_t>(StorageLayout, AddressModeX, AddressModeY);
+			case EElementType::Half: return GetBilinearSampleBatchKernel<FHalf>(StorageLayout, AddressModeX, AddressModeY);
+			case EElementType::Float: return GetBilinearSampleBatchKernel<float>(StorageLayout, AddressModeX, AddressModeY);
+			case EElementType::Double: return GetBilinearSampleBatchKernel<double>(StorageLayout, AddressModeX, AddressModeY);
+			default: UBPA_UCOMMON_NO_ENTRY(); return nullptr;
+			}
+		}
+
+		static void BilinearSampleBatch(const FBilinearSampleSource& Source, EElementType ElementType, ETex2DStorageLayout StorageLayout, TSpan<const FVector2f> Texcoords, float* Results, ETextureAddress AddressModeX, ETextureAddress AddressModeY, FThreadPool* ThreadPool)
+		{
+			UBPA_UCOMMON_ASSERT(Results || Texcoords.Empty());
+
+			const FBilinearSampleBatchKernel Kernel = GetBilinearSampleBatchKernel(ElementType, StorageLayout, AddressModeX, AddressModeY);
+			auto SampleRange = [&](uint64_t Begin, uint64_t End)
+			{
+				Kernel(Source, Texcoords.GetData() + Begin, End - Begin, Results + Begin * Source.NumChannels);
+			};
+
+			if (ThreadPool)
+			{
+				// Chunks of whole 8-sample groups, so each sample takes the same path as without ThreadPool.
+				const uint64_t NumGroups = (Texcoords.Num() + 7) / 8;
+				ThreadPool->ParallelForRange(0, NumGroups, 0, [&](uint64_t GroupBegin, uint64_t GroupEnd)
+				{
+					SampleRange(GroupBegin * 8, std::min(GroupEnd * 8, Texcoords.Num()));
+				});
+			}
+			else
+			{
+				SampleRange(0, Texcoords.Num());
+			}
+		}
+	}
+}
+
+void UCommon::FConstTex2DView::BilinearSampleBatch(TSpan<const FVector2f> Texcoords, float* Results, ETextureAddress AddressModeX, ETextureAddress AddressModeY, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	Details::BilinearSampleBatch(Details::MakeBilinearSampleSource(*this), ElementType, ETex2DStorageLayout::Linear, Texcoords, Results, AddressModeX, AddressModeY, ThreadPool);
+}
+
+void UCommon::FConstTex2DView::ConvertTo(const FTex2DView& Dst, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(Dst.GetGrid2D() == Grid2D);
+	UBPA_UCOMMON_ASSERT(Dst.GetNumChannels() == NumChannels);
+
+	const uint64_t RowNumElements = Grid2D.Width * NumChannels;
+	const bool bContiguous = IsContiguous() && Dst.IsContiguous();
+	auto ConvertRows = [&](uint64_t RowBegin, uint64_t RowEnd)
+	{
+		if (bContiguous)
+		{
+			ElementConvert(Dst.GetRow(RowBegin), Dst.GetElementType(), GetRow(RowBegin), ElementType, (RowEnd - RowBegin) * RowNumElements);
+			return;
+		}
+		for (uint64_t Y = RowBegin; Y < RowEnd; Y++)
+		{
+			ElementConvert(Dst.GetRow(Y), Dst.GetElementType(), GetRow(Y), ElementType, RowNumElements);
+		}
+	};
+
+	if (ThreadPool)
+	{
+		ThreadPool->ParallelForRange(0, Grid2D.Height, 0, ConvertRows);
+	}
+	else
+	{
+		ConvertRows(0, Grid2D.Height);
+	}
+}
+
+void UCommon::FConstTex2DView::Save(IArchive& Archive) const
+{
+	UBPA_UCOMMON_ASSERT(Archive.GetState() == IArchive::EState::Saving);
+	FGrid2D LayoutGrid2D = Grid2D;
+	uint64_t LayoutNumChannels = NumChannels;
+	EOwnership LayoutOwnership = EOwnership::TakeOwnership;
+	EElementType LayoutElementType = ElementType;
+	Details::SerializeLayout(Archive, LayoutGrid2D, LayoutNumChannels, LayoutOwnership, LayoutElementType);
+	if (IsContiguous())
+	{
+		Archive.Serialize(const_cast<uint8_t*>(Storage), Grid2D.Height * GetRowSizeInBytes());
+		return;
+	}
+	for (uint64_t Y = 0; Y < Grid2D.Height; Y++)
+	{
+		Archive.Serialize(const_cast<void*>(GetRow(Y)), GetRowSizeInBytes());
+	}
+}
+
+//
+// FTex2DView
+///////////
+
+UCommon::FTex2DView::FTex2DView() noexcept = default;
+
+UCommon::FTex2DView::FTex2DView(void* InStorage, const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType, uint64_t InRowStride) noexcept :
+	FConstTex2DView(InStorage, InGrid2D, InNumChannels, InElementType, InRowStride) {}
+
+UCommon::FTex2DView::FTex2DView(FTex2D& Tex) noexcept :
+	FConstTex2DView(Tex) {}
+
+void* UCommon::FTex2DView::GetRow(uint64_t Y) const noexcept
+{
+	return const_cast<void*>(FConstTex2DView::GetRow(Y));
+}
+
+void UCommon::FTex2DView::SetFloat(const FUint64Vector2& Point, uint64_t C, float Value) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point) && C < NumChannels);
+	void* Row = GetRow(Point.Y);
+	const uint64_t Index = Point.X * NumChannels + C;
+	switch (ElementType)
+	{
+	case UCommon::EElementType::Uint8:
+		static_cast<uint8_t*>(Row)[Index] = ElementFloatToUint8(Value);
+		break;
+	case UCommon::EElementType::Half:
+		static_cast<FHalf*>(Row)[Index] = ElementFloatToHalf(Value);
+		break;
+	case UCommon::EElementType::Float:
+		static_cast<float*>(Row)[Index] = Value;
+		break;
+	case UCommon::EElementType::Double:
+		static_cast<double*>(Row)[Index] = static_cast<double>(Value);
+		break;
+	default:
+		UBPA_UCOMMON_NO_ENTRY();
+		break;
+	}
+}
+
+UCommon::FTex2DView UCommon::FTex2DView::GetSubView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept
+{
+	const FConstTex2DView SubView = FConstTex2DView::GetSubView(InOrigin, InGrid2D);
+	return FTex2DView(const_cast<void*>(SubView.GetRow(0)), InGrid2D, NumChannels, ElementType, RowStride);
+}
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/**
+		 * Clamp, Min, Max and Threshold as one select: elements < LowerBound become LowerValue,
+		 * then elements > UpperBound become UpperValue. Unreachable bounds (-inf, +inf, 0 and 255 for Uint8) disable a side.
+		 * Elements failing both comparisons (including NaN) keep their bits, as in a scalar loop of branches.
+		 */
+		static void SelectElements(uint8_t* Values, uint64_t Num, uint8_t LowerBound, uint8_t LowerValue, uint8_t UpperBound, uint8_t UpperValue) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			const __m256i Lower = _mm256_set1_epi8(static_cast<char>(LowerBound));
+			const __m256i LowerReplacement = _mm256_set1_epi8(static_cast<char>(LowerValue));
+			const __m256i Upper = _mm256_set1_epi8(static_cast<char>(UpperBound));
+			const __m256i UpperReplacement = _mm256_set1_epi8(static_cast<char>(UpperValue));
+			for (; Index + 32 <= Num; Index += 32)
+			{
+				__m256i Value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Values + Index));
+				// unsigned Value >= Lower <=> max(Value, Lower) == Value
+				const __m256i NotBelow = _mm256_cmpeq_epi8(_mm256_max_epu8(Value, Lower), Value);
+				Value = _mm256_blendv_epi8(LowerReplacement, Value, NotBelow);
+				const __m256i NotAbove = _mm256_cmpeq_epi8(_mm256_min_epu8(Value, Upper), Value);
+				Value = _mm256_blendv_epi8(UpperReplacement, Value, NotAbove);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(Values + Index), Value);
+			}
+#elif defined(UBPA_UCOMMON_SIMD_SSE2)
+			const __m128i Lower = _mm_set1_epi8(static_cast<char>(LowerBound));
+			const __m128i LowerReplacement = _mm_set1_epi8(static_cast<char>(LowerValue));
+			const __m128i Upper = _mm_set1_epi8(static_cast<char>(UpperBound));
+			const __m128i UpperReplacement = _mm_set1_epi8(static_cast<char>(UpperValue));
+			for (; Index + 16 <= Num; Index += 16)
+			{
+				__m128i Value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Values + Index));
+				const __m128i NotBelow = _mm_cmpeq_epi8(_mm_max_epu8(Value, Lower), Value);
+				Value = _mm_or_si128(_mm_and_si128(NotBelow, Value), _mm_andnot_si128(NotBelow, LowerReplacement));
+				const __m128i NotAbove = _mm_cmpeq_epi8(_mm_min_epu8(Value, Upper), Value);
+				Value = _mm_or_si128(_mm_and_si128(NotAbove, Value), _mm_andnot_si128(NotAbove, UpperReplacement));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Values + Index), Value);
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				if (Values[Index] < LowerBound)
+				{
+					Values[Index] = LowerValue;
+				}
+				if (Values[Index] > UpperBound)
+				{
+					Values[Index] = UpperValue;
+				}
+			}
+		}
+
+		static void SelectElements(FHalf* Values, uint64_t Num, float LowerBound, FHalf LowerValue, float UpperBound, FHalf UpperValue) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_F16C)
+			// compare as floats, select the original half bits
+			const __m256 Lower = _mm256_set1_ps(LowerBound);
+			const __m256 Upper = _mm256_set1_ps(UpperBound);
+			uint16_t LowerBits;
+			uint16_t UpperBits;
+			std::memcpy(&LowerBits, &LowerValue, sizeof(uint16_t));
+			std::memcpy(&UpperBits, &UpperValue, sizeof(uint16_t));
+			const __m128i LowerReplacement = _mm_set1_epi16(static_cast<short>(LowerBits));
+			const __m128i UpperReplacement = _mm_set1_epi16(static_cast<short>(UpperBits));
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				__m128i Bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Values + Index));
+				__m256 Value = _mm256_cvtph_ps(Bits);
+				const __m256i Below = _mm256_castps_si256(_mm256_cmp_ps(Value, Lower, _CMP_LT_OQ));
+				Bits = _mm_blendv_epi8(Bits, LowerReplacement, _mm_packs_epi32(_mm256_castsi256_si128(Below), _mm256_extractf128_si256(Below, 1)));
+				Value = _mm256_cvtph_ps(Bits);
+				const __m256i Above = _mm256_castps_si256(_mm256_cmp_ps(Value, Upper, _CMP_GT_OQ));
+				Bits = _mm_blendv_epi8(Bits, UpperReplacement, _mm_packs_epi32(_mm256_castsi256_si128(Above), _mm256_extractf128_si256(Above, 1)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Values + Index), Bits);
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				if (ElementHalfToFloat(Values[Index]) < LowerBound)
+				{
+					Values[Index] = LowerValue;
+				}
+				if (ElementHalfToFloat(Values[Index]) > UpperBound)
+				{
+					Values[Index] = UpperValue;
+				}
+			}
+		}
+
+		static void SelectElements(float* Values, uint64_t Num, float LowerBound, float LowerValue, float UpperBound, float UpperValue) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			const __m256 Lower = _mm256_set1_ps(LowerBound);
+			const __m256 LowerReplacement = _mm256_set1_ps(LowerValue);
+			const __m256 Upper = _mm256_set1_ps(UpperBound);
+			const __m256 UpperReplacement = _mm256_set1_ps(UpperValue);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				__m256 Value = _mm256_loadu_ps(Values + Index);
+				Value = _mm256_blendv_ps(Value, LowerReplacement, _mm256_cmp_ps(Value, Lower, _CMP_LT_OQ));
+				Value = _mm256_blendv_ps(Value, UpperReplacement, _mm256_cmp_ps(Value, Upper, _CMP_GT_OQ));
+				_mm256_storeu_ps(Values + Index, Value);
+			}
+#elif defined(UBPA_UCOMMON_SIMD_SSE2)
+			const __m128 Lower = _mm_set1_ps(LowerBound);
+			const __m128 LowerReplacement = _mm_set1_ps(LowerValue);
+			const __m128 Upper = _mm_set1_ps(UpperBound);
+			const __m128 UpperReplacement = _mm_set1_ps(UpperValue);
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				__m128 Value = _mm_loadu_ps(Values + Index);
+				const __m128 Below = _mm_cmplt_ps(Value, Lower);
+				Value = _mm_or_ps(_mm_and_ps(Below, LowerReplacement), _mm_andnot_ps(Below, Value));
+				const __m128 Above = _mm_cmpgt_ps(Value, Upper);
+				Value = _mm_or_ps(_mm_and_ps(Above, UpperReplacement), _mm_andnot_ps(Above, Value));
+				_mm_storeu_ps(Values + Index, Value);
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				if (Values[Index] < LowerBound)
+				{
+					Values[Index] = LowerValue;
+				}
+				if (Values[Index] > UpperBound)
+				{
+					Values[Index] = UpperValue;
+				}
+			}
+		}
+
+		static void SelectElements(double* Values, uint64_t Num, double LowerBound, double LowerValue, double UpperBound, double UpperValue) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			const __m256d Lower = _mm256_set1_pd(LowerBound);
+			const __m256d LowerReplacement = _mm256_set1_pd(LowerValue);
+			const __m256d Upper = _mm256_set1_pd(UpperBound);
+			const __m256d UpperReplacement = _mm256_set1_pd(UpperValue);
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				__m256d Value = _mm256_loadu_pd(Values + Index);
+				Value = _mm256_blendv_pd(Value, LowerReplacement, _mm256_cmp_pd(Value, Lower, _CMP_LT_OQ));
+				Value = _mm256_blendv_pd(Value, UpperReplacement, _mm256_cmp_pd(Value, Upper, _CMP_GT_OQ));
+				_mm256_storeu_pd(Values + Index, Value);
+			}
+#elif defined(UBPA_UCOMMON_SIMD_SSE2)
+			const __m128d Lower = _mm_set1_pd(LowerBound);
+			const __m128d LowerReplacement = _mm_set1_pd(LowerValue);
+			const __m128d Upper = _mm_set1_pd(UpperBound);
+			const __m128d UpperReplacement = _mm_set1_pd(UpperValue);
+			for (; Index + 2 <= Num; Index += 2)
+			{
+				__m128d Value = _mm_loadu_pd(Values + Index);
+				const __m128d Below = _mm_cmplt_pd(Value, Lower);
+				Value = _mm_or_pd(_mm_and_pd(Below, LowerReplacement), _mm_andnot_pd(Below, Value));
+				const __m128d Above = _mm_cmpgt_pd(Value, Upper);
+				Value = _mm_or_pd(_mm_and_pd(Above, UpperReplacement), _mm_andnot_pd(Above, Value));
+				_mm_storeu_pd(Values + Index, Value);
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				if (Values[Index] < LowerBound)
+				{
+					Values[Index] = LowerValue;
+				}
+				if (Values[Index] > UpperBound)
+				{
+					Values[Index] = UpperValue;
+				}
+			}
+		}
+
+		/** Run SelectElements on all elements of View, Uint8 bounds and values are converted as unorm. */
+		static void SelectElements(const FTex2DView& View, float LowerBound, float LowerValue, float UpperBound, float UpperValue, FThreadPool* ThreadPool)
+		{
+			switch (View.GetElementType())
+			{
+			case EElementType::Uint8:
+			{
+				const uint8_t LowerBoundUint8 = LowerBound == -std::numeric_limits<float>::infinity() ? 0 : ElementFloatClampToUint8(LowerBound);
+				const uint8_t UpperBoundUint8 = UpperBound == std::numeric_limits<float>::infinity() ? 255 : ElementFloatClampToUint8(UpperBound);
+				const uint8_t LowerValueUint8 = ElementFloatClampToUint8(LowerValue);
+				const uint8_t UpperValueUint8 = ElementFloatClampToUint8(UpperValue);
+				ForEachRow<uint8_t>(View, ThreadPool, [&](uint8_t* Values, uint64_t NumElements)
+				{
+					SelectElements(Values, NumElements, LowerBoundUint8, LowerValueUint8, UpperBoundUint8, UpperValueUint8);
+				});
+				break;
+			}
+			case EElementType::Half:
+			{
+				const FHalf LowerValueHalf = static_cast<FHalf>(LowerValue);
+				const FHalf UpperValueHalf = static_cast<FHalf>(UpperValue);
+				ForEachRow<FHalf>(View, ThreadPool, [&](FHalf* Values, uint64_t NumElements)
+				{
+					SelectElements(Values, NumElements, LowerBound, LowerValueHalf, UpperBound, UpperValueHalf);
+				});
+				break;
+			}
+			case EElementType::Float:
+				ForEachRow<float>(View, ThreadPool, [&](float* Values, uint64_t NumElements)
+				{
+					SelectElements(Values, NumElements, LowerBound, LowerValue, UpperBound, UpperValue);
+				});
+				break;
+			case EElementType::Double:
+				ForEachRow<double>(View, ThreadPool, [&](double* Values, uint64_t NumElements)
+				{
+					SelectElements(Values, NumElements, static_cast<double>(LowerBound), static_cast<double>(LowerValue), static_cast<double>(UpperBound), static_cast<double>(UpperValue));
+				});
+				break;
+			default:
+				UBPA_UCOMMON_NO_ENTRY();
+				break;
+			}
+		}
+	}
+}
+
+void UCommon::FTex2DView::Clamp(float MinValue, float MaxValue, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(MinValue <= MaxValue);
+	Details::SelectElements(*this, MinValue, MinValue, MaxValue, MaxValue, ThreadPool);
+}
+
+void UCommon::FTex2DView::Min(float MinValue, FThreadPool* ThreadPool) const
+{
+	Details::SelectElements(*this, MinValue, MinValue, std::numeric_limits<float>::infinity(), 0.f, ThreadPool);
+}
+
+void UCommon::FTex2DView::Max(float MaxValue, FThreadPool* ThreadPool) const
+{
+	Details::SelectElements(*this, -std::numeric_limits<float>::infinity(), 0.f, MaxValue, MaxValue, ThreadPool);
+}
+
+void UCommon::FTex2DView::Threshold(float ThresholdValue, FThreadPool* ThreadPool) const
+{
+	Details::SelectElements(*this, ThresholdValue, 0.f, std::numeric_limits<float>::infinity(), 0.f, ThreadPool);
+}
+
+void UCommon::FTex2DView::ApplyImpl(FApplyFunction Function, void* Context, FThreadPool* ThreadPool) const
+{
+	if (ElementType == EElementType::Float)
+	{
+		Details::ForEachRow<float>(*this, ThreadPool, [&](float* Values, uint64_t NumElements)
+		{
+			Function(Context, Values, NumElements);
+		});
+		return;
+	}
+
+	// other types go through a float buffer on the stack, converted with the SIMD kernels of ElementConvert
+	constexpr uint64_t BufferSize = 1024;
+	const uint64_t ElementSize = ElementGetSize(ElementType);
+	Details::ForEachRow<uint8_t>(*this, ThreadPool, [&](uint8_t* Values, uint64_t NumElements)
+	{
+		float Buffer[BufferSize];
+		for (uint64_t Offset = 0; Offset < NumElements; Offset += BufferSize)
+		{
+			const uint64_t Num = std::min(BufferSize, NumElements - Offset);
+			uint8_t* Elements = Values + Offset * ElementSize;
+			ElementConvert(Buffer, EElementType::Float, Elements, ElementType, Num);
+			Function(Context, Buffer, Num);
+			ElementConvert(Elements, ElementType, Buffer, EElementType::Float, Num);
+		}
+	});
+}
+
+void UCommon::FTex2DView::CopyFrom(const FConstTex2DView& Src) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Src.GetGrid2D() == Grid2D);
+	UBPA_UCOMMON_ASSERT(Src.GetNumChannels() == NumChannels);
+	UBPA_UCOMMON_ASSERT(Src.GetElementType() == ElementType);
+	if (IsContiguous() && Src.IsContiguous())
+	{
+		std::memcpy(GetRow(0), Src.GetRow(0), Grid2D.Height * GetRowSizeInBytes());
+		return;
+	}
+	for (uint64_t Y = 0; Y < Grid2D.Height; Y++)
+	{
+		std::memcpy(GetRow(Y), Src.GetRow(Y), GetRowSizeInBytes());
+	}
+}
+
+bool UCommon::FTex2DView::Load(IArchive& Archive) const
+{
+	UBPA_UCOMMON_ASSERT(Archive.GetState() == IArchive::EState::Loading);
+	FGrid2D LayoutGrid2D;
+	uint64_t LayoutNumChannels = 0;
+	EOwnership LayoutOwnership = EOwnership::TakeOwnership;
+	EElementType LayoutElementType = EElementType::Unknown;
+	Details::SerializeLayout(Archive, LayoutGrid2D, LayoutNumChannels, LayoutOwnership, LayoutElementType);
+	if (LayoutGrid2D != Grid2D || LayoutNumChannels != NumChannels || LayoutElementType != ElementType)
+	{
+		return false;
+	}
+	if (IsContiguous())
+	{
+		Archive.Serialize(GetRow(0), Grid2D.Height * GetRowSizeInBytes());
+		return true;
+	}
+	for (uint64_t Y = 0; Y < Grid2D.Height; Y++)
+	{
+		Archive.Serialize(GetRow(Y), GetRowSizeInBytes());
+	}
+	return true;
+}
+
+//
+// FTex2DStoragePool
+///////////
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/** In front of every storage of AllocateTex2DStorage. */
+		struct FTex2DStorageHeader
+		{
+			void* Block;
+			uint64_t Capacity;
+		};
+
+		static void* AllocateAlignedTex2DStorage(uint64_t Capacity)
+		{
+			void* Block = UBPA_UCOMMON_MALLOC(Capacity + sizeof(FTex2DStorageHeader) + Tex2DStorageAlignment);
+			if (!Block)
+			{
+				return nullptr;
+			}
+			const uintptr_t Address = (reinterpret_cast<uintptr_t>(Block) + sizeof(FTex2DStorageHeader) + Tex2DStorageAlignment - 1) & ~uintptr_t(Tex2DStorageAlignment - 1);
+			FTex2DStorageHeader* Header = reinterpret_cast<FTex2DStorageHeader*>(Address) - 1;
+			Header->Block = Block;
+			Header->Capacity = Capacity;
+			return reinterpret_cast<void*>(Address);
+		}
+
+		static const FTex2DStorageHeader& GetTex2DStorageHeader(void* Storage) noexcept
+		{
+			UBPA_UCOMMON_ASSERT(reinterpret_cast<uintptr_t>(Storage) % Tex2DStorageAlignment == 0);
+			return *(static_cast<const FTex2DStorageHeader*>(Storage) - 1);
+		}
+
+		static void FreeAlignedTex2DStorage(void* Storage) noexcept
+		{
+			UBPA_UCOMMON_FREE(GetTex2DStorageHeader(Storage).Block);
+		}
+
+		static thread_local FTex2DStoragePool* CurrentTex2DStoragePool = nullptr;
+	}
+}
+
+struct UCommon::FTex2DStoragePool::FImpl
+{
+	FImpl(uint64_t InMaxCachedSizeInBytes) : MaxCachedSizeInBytes(InMaxCachedSizeInBytes) {}
+
+	const uint64_t MaxCachedSizeInBytes;
+	mutable std::mutex Mutex;
+	/** Size class -> cached storages. */
+	std::unordered_map<uint64_t, std::vector<void*>> FreeLists;
+	FStats Stats;
+};
+
+double UCommon::FTex2DStoragePool::FStats::GetHitRate() const noexcept
+{
+	return NumAllocations > 0 ? static_cast<double>(NumHits) / static_cast<double>(NumAllocations) : 0.;
+}
+
+UCommon::FTex2DStoragePool::FTex2DStoragePool(uint64_t InMaxCachedSizeInBytes)
+	: Impl(new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(InMaxCachedSizeInBytes)) {}
+
+UCommon::FTex2DStoragePool::~FTex2DStoragePool()
+{
+	UBPA_UCOMMON_ASSERT(Details::CurrentTex2DStoragePool != this);
+	Trim();
+	Impl->~FImpl();
+	UBPA_UCOMMON_FREE(Impl);
+}
+
+void* UCommon::FTex2DStoragePool::Allocate(uint64_t SizeInBytes)
+{
+	const uint64_t SizeClass = GetSizeClass(SizeInBytes);
+	{
+		std::lock_guard<std::mutex> Lock(Impl->Mutex);
+		Impl->Stats.NumAllocations++;
+		auto Target = Impl->FreeLists.find(SizeClass);
+		if (Target != Impl->FreeLists.end() && !Target->second.empty())
+		{
+			void* Storage = Target->second.back();
+			Target->second.pop_back();
+			Impl->Stats.NumHits++;
+			Impl->Stats.CachedSizeInBytes -= SizeClass;
+			return Storage;
+		}
+	}
+	return Details::AllocateAlignedTex2DStorage(SizeClass);
+}
+
+void UCommon::FTex2DStoragePool::Free(void* Storage) noexcept
+{
+	if (!Storage)
+	{
+		return;
+	}
+
+	const uint64_t Capacity = Details::GetTex2DStorageHeader(Storage).Capacity;
+	{
+		std::lock_guard<std::mutex> Lock(Impl->Mutex);
+		Impl->Stats.NumFrees++;
+		// storages allocated outside of pools have exact sizes, only the ones of a size class are reusable
+		if (GetSizeClass(Capacity) == Capacity && Impl->Stats.CachedSizeInBytes + Capacity <= Impl->MaxCachedSizeInBytes)
+		{
+			Impl->FreeLists[Capacity].push_back(Storage);
+			Impl->Stats.NumCachedFrees++;
+			Impl->Stats.CachedSizeInBytes += Capacity;
+			Impl->Stats.PeakCachedSizeInBytes = std::max(Impl->Stats.PeakCachedSizeInBytes, Impl->Stats.CachedSizeInBytes);
+			return;
+		}
+	}
+	Details::FreeAlignedTex2DStorage(Storage);
+}
+
+void UCommon::FTex2DStoragePool::Trim() noexcept
+{
+	std::unordered_map<uint64_t, std::vector<void*>> FreeLists;
+	{
+		std::lock_guard<std::mutex> Lock(Impl->Mutex);
+		FreeLists.swap(Impl->FreeLists);
+		Impl->Stats.CachedSizeInBytes = 0;
+	}
+	for (const auto& FreeList : FreeLists)
+	{
+		for (void* Storage : FreeList.second)
+		{
+			Details::FreeAlignedTex2DStorage(Storage);
+		}
+	}
+}
+
+UCommon::FTex2DStoragePool::FStats UCommon::FTex2DStoragePool::GetStats() const noexcept
+{
+	std::lock_guard<std::mutex> Lock(Impl->Mutex);
+	return Impl->Stats;
+}
+
+void UCommon::FTex2DStoragePool::ResetStats() noexcept
+{
+	std::lock_guard<std::mutex> Lock(Impl->Mutex);
+	const uint64_t CachedSizeInBytes = Impl->Stats.CachedSizeInBytes;
+	Impl->Stats = FStats();
+	Impl->Stats.CachedSizeInBytes = CachedSizeInBytes;
+	Impl->Stats.PeakCachedSizeInBytes = CachedSizeInBytes;
+}
+
+uint64_t UCommon::FTex2DStoragePool::GetSizeClass(uint64_t SizeInBytes) noexcept
+{
+	if (SizeInBytes <= Tex2DStorageAlignment)
+	{
+		return Tex2DStorageAlignment;
+	}
+	// 4 classes per power of two, at most 25% larger than the size
+	const uint64_t Step = uint64_t(1) << (MSB64(SizeInBytes - 1) - 2);
+	return (SizeInBytes + Step - 1) & ~(Step - 1);
+}
+
+UCommon::FTex2DStoragePool* UCommon::FTex2DStoragePool::GetCurrent() noexcept { return Details::CurrentTex2DStoragePool; }
+
+UCommon::FTex2DStoragePoolScope::FTex2DStoragePoolScope(FTex2DStoragePool* Pool) noexcept
+	: PreviousPool(Details::CurrentTex2DStoragePool)
+{
+	Details::CurrentTex2DStoragePool = Pool;
+}
+
+UCommon::FTex2DStoragePoolScope::~FTex2DStoragePoolScope()
+{
+	Details::CurrentTex2DStoragePool = PreviousPool;
+}
+
+void* UCommon::AllocateTex2DStorage(uint64_t SizeInBytes)
+{
+	if (FTex2DStoragePool* Pool = Details::CurrentTex2DStoragePool)
+	{
+		return Pool->Allocate(SizeInBytes);
+	}
+	return Details::AllocateAlignedTex2DStorage(SizeInBytes);
+}
+
+void UCommon::FreeTex2DStorage(void* Storage) noexcept
+{
+	if (!Storage)
+	{
+		return;
+	}
+	if (FTex2DStoragePool* Pool = Details::CurrentTex2DStoragePool)
+	{
+		Pool->Free(Storage);
+		return;
+	}
+	Details::FreeAlignedTex2DStorage(Storage);
+}
+
+//
+// FTex2D
+///////////
+
+uint64_t UCommon::FTex2D::GetRequiredStorageSizeInBytes(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType ElementType, ETex2DStorageLayout StorageLayout) noexcept
+{
+	return GetNumElements(InGrid2D, InNumChannels, StorageLayout) * ElementGetSize(ElementType);
+}
+
+uint64_t UCommon::FTex2D::GetNumElements(FGrid2D Grid2D, uint64_t NumChannels, ETex2DStorageLayout StorageLayout) noexcept
+{
+	return GetStorageGrid2D(Grid2D, StorageLayout).GetArea() * NumChannels;
+}
+
+UCommon::FGrid2D UCommon::FTex2D::GetStorageGrid2D(FGrid2D Grid2D, ETex2DStorageLayout StorageLayout) noexcept
+{
+	if (StorageLayout != ETex2DStorageLayout::Tiled)
+	{
+		return Grid2D;
+	}
+	return FGrid2D(Details::GetNumTiles(Grid2D.Width) * Details::TileExtent, Details::GetNumTiles(Grid2D.Height) * Details::TileExtent);
+}
+
+UCommon::FTex2D::FTex2D() noexcept :
+	NumChannels(0),
+	Ownership(EOwnership::DoNotTakeOwnership),
+	ElementType(EElementType::Unknown),
+	Storage(nullptr),
+	StorageLayout(ETex2DStorageLayout::Linear),
+	bInternalStorage(false) {}
+
+UCommon::FTex2D::FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EOwnership InOwnership, EElementType InElementType, void* InStorage, ETex2DStorageLayout InStorageLayout) noexcept :
+	Grid2D(InGrid2D),
+	NumChannels(InNumChannels),
+	Ownership(InOwnership),
+	ElementType(InElementType),
+	Storage(InStorage),
+	StorageLayout(InStorageLayout),
+	bInternalStorage(false)
+{
+	UBPA_UCOMMON_ASSERT(!InGrid2D.IsAreaEmpty());
+	UBPA_UCOMMON_ASSERT(InNumChannels > 0);
+	UBPA_UCOMMON_ASSERT(InStorage);
+}
+
+UCommon::FTex2D::FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType InElementType, const void* InStorage)
+	: FTex2D(InGrid2D, InNumChannels, InElementType)
+{
+	std::memcpy(Storage, InStorage, GetStorageSizeInBytes());
+}
+
+UCommon::FTex2D::FTex2D(FGrid2D InGrid2D, uint64_t InNumChannels, EElementType InElementType, ETex2DStorageLayout InStorageLayout) :
+	FTex2D(InGrid2D,
+		InNumChannels,
+		EOwnership::TakeOwnership,
+		InElementType,
+		AllocateTex2DStorage(GetRequiredStorageSizeInBytes(InGrid2D, InNumChannels, InElementType, InStorageLayout)),
+		InStorageLayout) {
+	bInternalStorage = true;
+}
+
+UCommon::FTex2D::FTex2D(FTex2D&& Other) noexcept :
+	Grid2D(Other.GetGrid2D()),
+	NumChannels(Other.NumChannels),
+	Ownership(Other.Ownership),
+	ElementType(Other.ElementType),
+	Storage(Other.Storage),
+	StorageLayout(Other.StorageLayout),
+	bInternalStorage(Other.bInternalStorage)
+{
+	Other.Grid2D = FGrid2D();
+	Other.NumChannels = 0;
+	Other.Ownership = EOwnership::DoNotTakeOwnership;
+	Other.ElementType = EElementType();
+	Other.Storage = nullptr;
+	Other.StorageLayout = ETex2DStorageLayout::Linear;
+	Other.bInternalStorage = false;
+}
+
+UCommon::FTex2D::FTex2D(const FTex2D& Other, EOwnership InOwnership, void* InEmptyStorage)
+	: Grid2D(Other.GetGrid2D())
+	, NumChannels(Other.NumChannels)
+	, Ownership(InOwnership)
+	, ElementType(Other.ElementType)
+	, Storage(InEmptyStorage)
+	, StorageLayout(Other.StorageLayout)
+	, bInternalStorage(false)
+{
+	UBPA_UCOMMON_ASSERT(Other.IsValid() || !InEmptyStorage);
+
+	if (Storage || Ownership == EOwnership::TakeOwnership)
+	{
+		if (!Storage)
+		{
+			Storage = AllocateTex2DStorage(Other.GetStorageSizeInBytes());
+			bInternalStorage = true;
+		}
+		memcpy(Storage, Other.Storage, Other.GetStorageSizeInBytes());
+	}
+	else
+	{
+		UBPA_UCOMMON_ASSERT(!Storage && Ownership == EOwnership::DoNotTakeOwnership);
+		Storage = Other.Storage;
+	}
+}
+
+UCommon::FTex2D::FTex2D(const FTex2D& Other) :
+	FTex2D(Other, Other.Ownership, nullptr) {
+}
+
+UCommon::FTex2D::~FTex2D()
+{
+	FreeStorage();
+}
+
+void UCommon::FTex2D::FreeStorage() noexcept
+{
+	if (Ownership == EOwnership::TakeOwnership)
+	{
+		if (bInternalStorage)
+		{
+			FreeTex2DStorage(Storage);
+		}
+		else
+		{
+			UBPA_UCOMMON_FREE(Storage);
+		}
+	}
+}
+
+bool UCommon::FTex2D::IsValid() const noexcept
+{
+	return !Grid2D.IsAreaEmpty() && NumChannels > 0 && Storage;
+}
+
+uint64_t UCommon::FTex2D::GetTexelIndex(const FUint64Vector2& Point) const noexcept
+{
+	if (StorageLayout != ETex2DStorageLayout::Tiled)
+	{
+		return Grid2D.GetIndex(Point);
+	}
+	UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point));
+	return Details::GetTiledRowIndex(Point.Y, Details::GetNumTiles(Grid2D.Width)) + Details::GetTiledColumnIndex(Point.X);
+}
+
+uint64_t UCommon::FTex2D::GetIndex(const FUint64Vector2& Point, uint64_t C) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(C < NumChannels);
+	if (StorageLayout == ETex2DStorageLayout::Planar)
+	{
+		return C * Grid2D.GetArea() + GetTexelIndex(Point);
+	}
+	return GetTexelIndex(Point) * NumChannels + C;
+}
+
+UCommon::FTex2DView UCommon::FTex2D::GetPlaneView(uint64_t C) noexcept
+{
+	UBPA_UCOMMON_ASSERT(StorageLayout == ETex2DStorageLayout::Planar && C < NumChannels);
+	return FTex2DView(static_cast<uint8_t*>(Storage) + C * Grid2D.GetArea() * ElementGetSize(ElementType), Grid2D, 1, ElementType);
+}
+
+UCommon::FConstTex2DView UCommon::FTex2D::GetPlaneView(uint64_t C) const noexcept
+{
+	return const_cast<FTex2D*>(this)->GetPlaneView(C);
+}
+
+UCommon::FTex2DView UCommon::FTex2D::GetView() noexcept
+{
+	return FTex2DView(*this);
+}
+
+UCommon::FConstTex2DView UCommon::FTex2D::GetView() const noexcept
+{
+	return FConstTex2DView(*this);
+}
+
+UCommon::FTex2DView UCommon::FTex2D::GetView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) noexcept
+{
+	return GetView().GetSubView(InOrigin, InGrid2D);
+}
+
+UCommon::FConstTex2DView UCommon::FTex2D::GetView(const FUint64Vector2& InOrigin, const FGrid2D& InGrid2D) const noexcept
+{
+	return GetView().GetSubView(InOrigin, InGrid2D);
+}
+
+UCommon::FTex2DView UCommon::FTex2D::GetStorageView() noexcept
+{
+	return FTex2DView(Storage, GetStorageGrid2D(Grid2D, StorageLayout), NumChannels, ElementType);
+}
+
+UCommon::FConstTex2DView UCommon::FTex2D::GetStorageView() const noexcept
+{
+	return FConstTex2DView(Storage, GetStorageGrid2D(Grid2D, StorageLayout), NumChannels, ElementType);
+}
+
+float UCommon::FTex2D::GetFloat(uint64_t Index) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Index < GetNumElements());
+	return Details::GetElementFloat(Storage, ElementType, Index);
+}
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/** FTex2D::At<VectorT>(Point) by value, gathered from the planes if Planar. */
+		template<typename VectorT>
+		static VectorT LoadTexel(const FTex2D& Tex, const FUint64Vector2& Point) noexcept
+		{
+			if (Tex.GetStorageLayout() != ETex2DStorageLayout::Planar)
+			{
+				return Tex.At<VectorT>(Point);
+			}
+			using ElementT = typename TRemoveVector<VectorT>::value_type;
+			VectorT Texel;
+			for (uint64_t C = 0; C < sizeof(VectorT) / sizeof(ElementT); C++)
+			{
+				Texel[C] = Tex.At<ElementT>(Point, C);
+			}
+			return Texel;
+		}
+	}
+}
+
+UCommon::FLinearColorRGB UCommon::FTex2D::GetLinearColorRGB(const FUint64Vector2& Point) const noexcept
+{
+	switch (ElementType)
+	{
+	case UCommon::EElementType::Uint8:
+		return ElementColorToLinearColor(Details::LoadTexel<FColorRGB>(*this, Point));
+	case UCommon::EElementType::Float:
+		return Details::LoadTexel<FLinearColorRGB>(*this, Point);
+	case UCommon::EElementType::Double:
+		return FLinearColorRGB(Details::LoadTexel<FDoubleColorRGB>(*this, Point));
+	default:
+		UBPA_UCOMMON_NO_ENTRY();
+		return FLinearColorRGB(0.f);
+	}
+}
+
+UCommon::FLinearColor UCommon::FTex2D::GetLinearColor(const FUint64Vector2& Point) const noexcept
+{
+	switch (ElementType)
+	{
+	case UCommon::EElementType::Uint8:
+		return ElementColorToLinearColor(Details::LoadTexel<FColor>(*this, Point));
+	case UCommon::EElementType::Float:
+		return Details::LoadTexel<FLinearColor>(*this, Point);
+	case UCommon::EElementType::Double:
+		return FLinearColor(Details::LoadTexel<FDoubleColor>(*this, Point));
+	default:
+		UBPA_UCOMMON_NO_ENTRY();
+		return FLinearColor(0.f);
+	}
+}
+
+UCommon::FDoubleColorRGB UCommon::FTex2D::GetDoubleColorRGB(const FUint64Vector2& Point) const noexcept
+{
+	switch (ElementType)
+	{
+	case UCommon::EElementType::Uint8:
+		return ElementColorToDoubleColor(Details::LoadTexel<FColorRGB>(*this, Point));
+	case UCommon::EElementType::Float:
+		return FDoubleColorRGB(Details::LoadTexel<FLinearColorRGB>(*this, Point));
+	case UCommon::EElementType::Double:
+		return Details::LoadTexel<FDoubleColorRGB>(*this, Point);
+	default:
+		UBPA_UCOMMON_NO_ENTRY();
+		return FDoubleColorRGB(0.f);
+	}
+}
+
+UCommon::FDoubleColor UCommon::FTex2D::GetDoubleColor(const FUint64Vector2& Point) const noexcept
+{
+	switch (ElementType)
+	{
+	case UCommon::EElementType::Uint8:
+		return ElementColorToDoubleColor(Details::LoadTexel<FColor>(*this, Point));
+	case UCommon::EElementType::Float:
+		return FDoubleColor(Details::LoadTexel<FLinearColor>(*this, Point));
+	case UCommon::EElementType::Double:
+		return Details::LoadTexel<FDoubleColor>(*this, Point);
+	default:
+		UBPA_UCOMMON_NO_ENTRY();
+		return FDoubleColor(0.f);
+	}
+}
+
+float UCommon::FTex2D::GetFloat(const FUint64Vector2& Point, uint64_t C) const noexcept
+{
+	return GetFloat(GetIndex(Point, C));
+}
+
+void UCommon::FTex2D::SetFloat(uint64_t Index, float Value) noexcept
 {
 	switch (ElementType)
 	{
 	case UCommon::EElementType::Uint8:
 		At<uint8_t>(Index) = ElementFloatToUint8(Value);
 		break;
+	case UCommon::EElementType::Half:
+		At<FHalf>(Index) = ElementFloatToHalf(Value);
+		break;
 	case UCommon::EElementType::Float:
 		At<float>(Index) = Value;
 		break;
@@ -340,9 +1919,10 @@ void UCommon::FTex2D::SetFloat(const FUint64Vector2& Point, uint64_t C, float Va
 
 uint64_t UCommon::FTex2D::GetNumChannels() const noexcept { return NumChannels; }
 const UCommon::FGrid2D& UCommon::FTex2D::GetGrid2D() const noexcept { return Grid2D; }
-uint64_t UCommon::FTex2D::GetNumElements() const noexcept { return GetNumElements(Grid2D, NumChannels); }
-uint64_t UCommon::FTex2D::GetStorageSizeInBytes() const noexcept { return GetRequiredStorageSizeInBytes(Grid2D, NumChannels, ElementType); }
+uint64_t UCommon::FTex2D::GetNumElements() const noexcept { return GetNumElements(Grid2D, NumChannels, StorageLayout); }
+uint64_t UCommon::FTex2D::GetStorageSizeInBytes() const noexcept { return GetRequiredStorageSizeInBytes(Grid2D, NumChannels, ElementType, StorageLayout); }
 UCommon::EOwnership UCommon::FTex2D::GetStorageOwnership() const noexcept { return Ownership; }
+UCommon::ETex2DStorageLayout UCommon::FTex2D::GetStorageLayout() const noexcept { return StorageLayout; }
 UCommon::EElementType UCommon::FTex2D::GetElementType() const noexcept { return ElementType; }
 
 void* UCommon::FTex2D::GetStorage() noexcept { return Storage; }
@@ -350,10 +1930,7 @@ const void* UCommon::FTex2D::GetStorage() const noexcept { return Storage; }
 
 void UCommon::FTex2D::Reset() noexcept
 {
-	if (Ownership == EOwnership::TakeOwnership)
-	{
-		UBPA_UCOMMON_FREE(Storage);
-	}
+	FreeStorage();
 
 	Grid2D = FGrid2D();
 	NumChannels = 0;
@@ -361,58 +1938,35 @@ void UCommon::FTex2D::Reset() noexcept
 	Ownership = EOwnership::DoNotTakeOwnership;
 	ElementType = EElementType();
 	Storage = nullptr;
+	StorageLayout = ETex2DStorageLayout::Linear;
+	bInternalStorage = false;
 }
 
 bool UCommon::FTex2D::IsLayoutSameWith(const FTex2D& Other) const noexcept
 {
 	return Grid2D == Other.Grid2D
 		&& ElementType == Other.ElementType
-		&& NumChannels == Other.NumChannels;
+		&& NumChannels == Other.NumChannels
+		&& StorageLayout == Other.StorageLayout;
 }
 
 void UCommon::FTex2D::BilinearSample(float* Result, const FVector2f& Texcoord, ETextureAddress AddressModeX, ETextureAddress AddressModeY) const noexcept
 {
-	const FVector2f PointT = Texcoord * FVector2f(Grid2D.GetExtent());
-	const FVector2f PointTOffset = PointT - 0.5f;
-	const FInt64Vector2 IntPoint0 = FInt64Vector2(PointTOffset.Floor());
-	const FInt64Vector2 IntPoint1 = IntPoint0 + 1;
-
-	// Apply address mode to integer coordinates
-	const FUint64Vector2 Points[2] =
-	{
-		ApplyAddressMode(IntPoint0, Grid2D.GetExtent(), AddressModeX, AddressModeY),
-		ApplyAddressMode(IntPoint1, Grid2D.GetExtent(), AddressModeX, AddressModeY),
-	};
-
-	const FVector2f LocalTexcoord = (PointT - (FVector2f(IntPoint0) + 0.5f)).Clamp(0.f, 1.f);
-
-	const FVector2f OneMinusLocalTexcoord = FVector2f(1.f) - LocalTexcoord;
-
-	const float Weights[4] =
+	if (StorageLayout == ETex2DStorageLayout::Linear)
 	{
-		OneMinusLocalTexcoord.X * OneMinusLocalTexcoord.Y,
-		OneMinusLocalTexcoord.X * LocalTexcoord.Y,
-		LocalTexcoord.X * OneMinusLocalTexcoord.Y,
-		LocalTexcoord.X * LocalTexcoord.Y,
-	};
+		GetView().BilinearSample(Result, Texcoord, AddressModeX, AddressModeY);
+		return;
+	}
 
-	const uint64_t Offsets[4] =
-	{
-		Grid2D.GetIndex({ Points[0].X, Points[0].Y }) * NumChannels,
-		Grid2D.GetIndex({ Points[0].X, Points[1].Y }) * NumChannels,
-		Grid2D.GetIndex({ Points[1].X, Points[0].Y }) * NumChannels,
-		Grid2D.GetIndex({ Points[1].X, Points[1].Y }) * NumChannels,
-	};
+	// a single sample takes the scalar path of the kernel, same float operations as FConstTex2DView::BilinearSample
+	const Details::FBilinearSampleBatchKernel Kernel = Details::GetBilinearSampleBatchKernel(ElementType, StorageLayout, AddressModeX, AddressModeY);
+	Kernel(Details::MakeBilinearSampleSource(*this), &Texcoord, 1, Result);
+}
 
-	for (uint64_t C = 0; C < NumChannels; C++)
-	{
-		float Val2[4];
-		for (uint64_t i = 0; i < 4; i++)
-		{
-			Val2[i] = GetFloat(Offsets[i] + C);
-		}
-		*Result++ = UCommon::BilinearInterpolate(Val2, Weights);
-	}
+void UCommon::FTex2D::BilinearSampleBatch(TSpan<const FVector2f> Texcoords, float* Results, ETextureAddress AddressModeX, ETextureAddress AddressModeY, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	Details::BilinearSampleBatch(Details::MakeBilinearSampleSource(*this), ElementType, StorageLayout, Texcoords, Results, AddressModeX, AddressModeY, ThreadPool);
 }
 
 void UCommon::FTex2D::BilinearSampleAlignCorner(float* Result, const FVector2f& Texcoord) const noexcept
@@ -433,51 +1987,412 @@ void UCommon::FTex2D::BilinearSampleAlignCorner(float* Result, const FVector2f&
 
 namespace UCommon
 {
-	template<typename T>
-	constexpr auto ToUpperType(const T& Value) noexcept
-	{
-		if constexpr (std::is_same_v<T, uint8_t>)
-			return static_cast<uint16_t>(Value);
-		else
-			return Value;
-	}
-	template<typename T>
-	constexpr T DivideRound(const T& Value, const uint64_t& D) noexcept
+	namespace Details
 	{
-		if constexpr (std::is_same_v<T, uint16_t>)
-			return (Value + (static_cast<T>(D) / 2)) / static_cast<T>(D);
-		else
-			return Value / static_cast<T>(D);
-	}
+		/** 2x2 average of the source texels inside SrcTex, for the rows and columns [TileMin, TileMax) of HalfTex. */
+		template<typename T>
+		static void DownSampleBoxTile(FTex2D& HalfTex, const FTex2D& SrcTex, const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			using FBoxSum = TBoxSum<T>;
+			const uint64_t NumChannels = HalfTex.GetNumChannels();
+			const FGrid2D& SrcGrid2D = SrcTex.GetGrid2D();
+			const T* SrcStorage = static_cast<const T*>(SrcTex.GetStorage());
+			T* DstStorage = static_cast<T*>(HalfTex.GetStorage());
+			if (SrcTex.GetStorageLayout() == ETex2DStorageLayout::Tiled)
+			{
+				// 2X and 2Y are even, so the 2x2 footprint is 4 consecutive texels in Morton order
+				UBPA_UCOMMON_ASSERT(HalfTex.GetStorageLayout() == ETex2DStorageLayout::Tiled);
+				const uint64_t SrcNumTilesX = GetNumTiles(SrcGrid2D.Width);
+				const uint64_t DstNumTilesX = GetNumTiles(HalfTex.GetGrid2D().Width);
+				auto Average = [&](T* Dst, const T* Src, uint64_t NumRows, uint64_t NumColumns)
+				{
+					for (uint64_t C = 0; C < NumChannels; C++)
+					{
+						typename FBoxSum::FType Sum = 0;
+						for (uint64_t LocalY = 0; LocalY < NumRows; LocalY++)
+						{
+							for (uint64_t LocalX = 0; LocalX < NumColumns; LocalX++)
+							{
+								Sum += FBoxSum::Load(Src[(2 * LocalY + LocalX) * NumChannels + C]);
+							}
+						}
+						Dst[C] = FBoxSum::Store(Sum, NumRows * NumColumns);
+					}
+				};
+				for (uint64_t TileY = TileMin.Y >> TileExtentLog2; TileY < GetNumTiles(TileMax.Y); TileY++)
+				{
+					for (uint64_t TileX = TileMin.X >> TileExtentLog2; TileX < GetNumTiles(TileMax.X); TileX++)
+					{
+						const FUint64Vector2 First(std::max(TileX * TileExtent, TileMin.X), std::max(TileY * TileExtent, TileMin.Y));
+						const FUint64Vector2 Last(std::min((TileX + 1) * TileExtent, TileMax.X), std::min((TileY + 1) * TileExtent, TileMax.Y));
+						if (Last.X - First.X == TileExtent && Last.Y - First.Y == TileExtent && 2 * Last.X <= SrcGrid2D.Width && 2 * Last.Y <= SrcGrid2D.Height)
+						{
+							// quadrant Q of the tile reads the whole source tile (2 TileX + Q % 2, 2 TileY + Q / 2), in storage order
+							T* Dst = DstStorage + (TileY * DstNumTilesX + TileX) * TileArea * NumChannels;
+							for (uint64_t Quadrant = 0; Quadrant < 4; Quadrant++)
+							{
+								const T* Src = SrcStorage + ((2 * TileY + Quadrant / 2) * SrcNumTilesX + 2 * TileX + Quadrant % 2) * TileArea * NumChannels;
+								for (uint64_t Index = 0; Index < TileArea / 4; Index++)
+								{
+									Average(Dst + Index * NumChannels, Src + 4 * Index * NumChannels, 2, 2);
+								}
+								Dst += TileArea / 4 * NumChannels;
+							}
+							continue;
+						}
+						for (uint64_t Y = First.Y; Y < Last.Y; Y++)
+						{
+							const uint64_t NumRows = 2 * Y + 1 < SrcGrid2D.Height ? 2 : 1;
+							const uint64_t DstRow = GetTiledRowIndex(Y, DstNumTilesX);
+							const uint64_t SrcRow = GetTiledRowIndex(2 * Y, SrcNumTilesX);
+							for (uint64_t X = First.X; X < Last.X; X++)
+							{
+								const uint64_t NumColumns = 2 * X + 1 < SrcGrid2D.Width ? 2 : 1;
+								Average(DstStorage + (DstRow + GetTiledColumnIndex(X)) * NumChannels, SrcStorage + (SrcRow + GetTiledColumnIndex(2 * X)) * NumChannels, NumRows, NumColumns);
+							}
+						}
+					}
+				}
+				return;
+			}
+			for (uint64_t Y = TileMin.Y; Y < TileMax.Y; Y++)
+			{
+				const uint64_t NumRows = 2 * Y + 1 < SrcGrid2D.Height ? 2 : 1;
+				T* DstRow = DstStorage + HalfTex.GetGrid2D().Width * Y * NumChannels;
+				for (uint64_t X = TileMin.X; X < TileMax.X; X++)
+				{
+					const uint64_t NumColumns = 2 * X + 1 < SrcGrid2D.Width ? 2 : 1;
+					for (uint64_t C = 0; C < NumChannels; C++)
+					{
+						// same order as iterating FGrid2D(2, 2), so float sums are unchanged
+						typename FBoxSum::FType Sum = 0;
+						for (uint64_t LocalY = 0; LocalY < NumRows; LocalY++)
+						{
+							const T* SrcRow = SrcStorage + SrcGrid2D.Width * (2 * Y + LocalY) * NumChannels;
+							for (uint64_t LocalX = 0; LocalX < NumColumns; LocalX++)
+							{
+								Sum += FBoxSum::Load(SrcRow[(2 * X + LocalX) * NumChannels + C]);
+							}
+						}
+						DstRow[X * NumChannels + C] = FBoxSum::Store(Sum, NumRows * NumColumns);
+					}
+				}
+			}
+		}
+
+		static void DownSampleBoxTile(FTex2D& HalfTex, const FTex2D& SrcTex, const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			switch (SrcTex.GetElementType())
+			{
+			case EElementType::Uint8:
+				DownSampleBoxTile<uint8_t>(HalfTex, SrcTex, TileMin, TileMax);
+				break;
+			case EElementType::Half:
+				DownSampleBoxTile<FHalf>(HalfTex, SrcTex, TileMin, TileMax);
+				break;
+			case EElementType::Float:
+				DownSampleBoxTile<float>(HalfTex, SrcTex, TileMin, TileMax);
+				break;
+			case EElementType::Double:
+				DownSampleBoxTile<double>(HalfTex, SrcTex, TileMin, TileMax);
+				break;
+			default:
+				UBPA_UCOMMON_NO_ENTRY();
+				break;
+			}
+		}
+
+		static double Sinc(double X) noexcept
+		{
+			if (std::abs(X) < 1e-6)
+			{
+				return 1.;
+			}
+			const double PiX = 3.14159265358979323846 * X;
+			return std::sin(PiX) / PiX;
+		}
+
+		/** Modified Bessel function of the first kind, order 0 (power series). */
+		static double BesselI0(double X) noexcept
+		{
+			double Sum = 1.;
+			double Term = 1.;
+			const double QuarterX2 = X * X / 4.;
+			for (uint64_t K = 1; K < 32 && Term > Sum * 1e-12; K++)
+			{
+				Term *= QuarterX2 / static_cast<double>(K * K);
+				Sum += Term;
+			}
+			return Sum;
+		}
+
+		static double KaiserFilter(double X) noexcept
+		{
+			constexpr double Width = 3.;
+			constexpr double Alpha = 4.;
+			const double T = X / Width;
+			if (T * T >= 1.)
+			{
+				return 0.;
+			}
+			return Sinc(X) * BesselI0(Alpha * std::sqrt(1. - T * T)) / BesselI0(Alpha);
+		}
+
+		static double Lanczos3Filter(double X) noexcept
+		{
+			return std::abs(X) < 3. ? Sinc(X) * Sinc(X / 3.) : 0.;
+		}
+
+		static double TriangleFilter(double X) noexcept
+		{
+			return std::max(0., 1. - std::abs(X));
+		}
+
+		/** Mitchell-Netravali cubic family, radius 2. */
+		template<int BTimes6, int CTimes6>
+		static double CubicFilter(double X) noexcept
+		{
+			constexpr double B = BTimes6 / 6.;
+			constexpr double C = CTimes6 / 6.;
+			const double AbsX = std::abs(X);
+			if (AbsX < 1.)
+			{
+				return ((12. - 9. * B - 6. * C) * AbsX * AbsX * AbsX + (-18. + 12. * B + 6. * C) * AbsX * AbsX + (6. - 2. * B)) / 6.;
+			}
+			if (AbsX < 2.)
+			{
+				return ((-B - 6. * C) * AbsX * AbsX * AbsX + (6. * B + 30. * C) * AbsX * AbsX + (-12. * B - 48. * C) * AbsX + (8. * B + 24. * C)) / 6.;
+			}
+			return 0.;
+		}
+
+		/**
+		 * Weights of a 1D resampling from SrcSize to DstSize texels, centers aligned.
+		 * Destination texel i reads the source texels [Begins[i], Begins[i] + NumTaps), clamped to the edge.
+		 */
+		struct FResampleWeights
+		{
+			uint64_t NumTaps = 0;
+			std::vector<int64_t> Begins;
+			std::vector<float> Weights; // NumTaps per destination texel
+
+			FResampleWeights(uint64_t SrcSize, uint64_t DstSize, double (*Filter)(double), double Support)
+			{
+				if (SrcSize == DstSize)
+				{
+					// an unchanged axis is copied, even by the filters that are not interpolating
+					NumTaps = 1;
+					Begins.resize(DstSize);
+					Weights.assign(DstSize, 1.f);
+					for (uint64_t Index = 0; Index < DstSize; Index++)
+					{
+						Begins[Index] = static_cast<int64_t>(Index);
+					}
+					return;
+				}
+
+				const double Scale = static_cast<double>(SrcSize) / static_cast<double>(DstSize);
+				// minification stretches the filter over the source texels
+				const double FilterScale = std::max(1., Scale);
+				const double SrcSupport = Support * FilterScale;
+				NumTaps = static_cast<uint64_t>(std::ceil(2. * SrcSupport)) + 1;
+				Begins.resize(DstSize);
+				Weights.resize(DstSize * NumTaps);
+				for (uint64_t Index = 0; Index < DstSize; Index++)
+				{
+					const double Center = (static_cast<double>(Index) + 0.5) * Scale - 0.5;
+					const int64_t Begin = static_cast<int64_t>(std::floor(Center - SrcSupport)) + 1;
+					Begins[Index] = Begin;
+					double Sum = 0.;
+					for (uint64_t Tap = 0; Tap < NumTaps; Tap++)
+					{
+						const double Weight = Filter((static_cast<double>(Begin + static_cast<int64_t>(Tap)) - Center) / FilterScale);
+						Weights[Index * NumTaps + Tap] = static_cast<float>(Weight);
+						Sum += Weight;
+					}
+					for (uint64_t Tap = 0; Tap < NumTaps; Tap++)
+					{
+						Weights[Index * NumTaps + Tap] = static_cast<float>(Weights[Index * NumTaps + Tap] / Sum);
+					}
+				}
+			}
+
+			/** Range of source texels [First, Last] read by the destination texels [DstBegin, DstEnd), before clamping. */
+			void GetSourceRange(uint64_t DstBegin, uint64_t DstEnd, uint64_t SrcSize, uint64_t& First, uint64_t& Last) const noexcept
+			{
+				const int64_t MaxIndex = static_cast<int64_t>(SrcSize) - 1;
+				First = static_cast<uint64_t>(Clamp<int64_t>(Begins[DstBegin], 0, MaxIndex));
+				Last = static_cast<uint64_t>(Clamp<int64_t>(Begins[DstEnd - 1] + static_cast<int64_t>(NumTaps) - 1, 0, MaxIndex));
+			}
+		};
+
+		/** Float rows for Uint8/Half/Float, double rows for Double. */
+		template<typename AccT>
+		static void LoadRow(AccT* Dst, const FTex2D& Tex, uint64_t Y, uint64_t XBegin, uint64_t XEnd)
+		{
+			const uint64_t NumChannels = Tex.GetNumChannels();
+			const uint8_t* Src = static_cast<const uint8_t*>(Tex.GetStorage())
+				+ (Y * Tex.GetGrid2D().Width + XBegin) * NumChannels * ElementGetSize(Tex.GetElementType());
+			ElementConvert(Dst, ElementTypeOf<AccT>, Src, Tex.GetElementType(), (XEnd - XBegin) * NumChannels);
+		}
+
+		template<typename AccT>
+		static void StoreRow(FTex2D& Tex, uint64_t Y, uint64_t XBegin, uint64_t XEnd, const AccT* Src)
+		{
+			const uint64_t NumChannels = Tex.GetNumChannels();
+			uint8_t* Dst = static_cast<uint8_t*>(Tex.GetStorage())
+				+ (Y * Tex.GetGrid2D().Width + XBegin) * NumChannels * ElementGetSize(Tex.GetElementType());
+			ElementConvert(Dst, Tex.GetElementType(), Src, ElementTypeOf<AccT>, (XEnd - XBegin) * NumChannels);
+		}
+
+		/** Horizontal pass of one source row, StaticNumChannels is 0 if not known at compile time. */
+		template<typename AccT, uint64_t StaticNumChannels>
+		static void FilterRowX(AccT* Dst, const AccT* SrcRow, const FResampleWeights& WeightsX,
+			uint64_t XBegin, uint64_t XEnd, uint64_t SrcFirstX, uint64_t SrcWidth, uint64_t DynamicNumChannels) noexcept
+		{
+			const uint64_t NumChannels = StaticNumChannels != 0 ? StaticNumChannels : DynamicNumChannels;
+			const int64_t MaxSrcX = static_cast<int64_t>(SrcWidth) - 1;
+			for (uint64_t X = XBegin; X < XEnd; X++, Dst += NumChannels)
+			{
+				AccT Sum[StaticNumChannels != 0 ? StaticNumChannels : 1] = {};
+				if (StaticNumChannels == 0)
+				{
+					std::fill(Dst, Dst + NumChannels, AccT(0));
+				}
+				const float* Weights = WeightsX.Weights.data() + X * WeightsX.NumTaps;
+				for (uint64_t Tap = 0; Tap < WeightsX.NumTaps; Tap++)
+				{
+					const AccT Weight = static_cast<AccT>(Weights[Tap]);
+					const uint64_t SrcX = static_cast<uint64_t>(Clamp<int64_t>(WeightsX.Begins[X] + static_cast<int64_t>(Tap), 0, MaxSrcX));
+					const AccT* Src = SrcRow + (SrcX - SrcFirstX) * NumChannels;
+					if (StaticNumChannels != 0)
+					{
+						for (uint64_t C = 0; C < StaticNumChannels; C++)
+						{
+							Sum[C] += Weight * Src[C];
+						}
+					}
+					else
+					{
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							Dst[C] += Weight * Src[C];
+						}
+					}
+				}
+				if (StaticNumChannels != 0)
+				{
+					std::copy(Sum, Sum + StaticNumChannels, Dst);
+				}
+			}
+		}
 
-	template<typename T>
-	static void DownSampleImpl(FTex2D& HalfTex, const FTex2D& SrcTex)
-	{
-		using UpperType = std::decay_t<decltype(ToUpperType(std::declval<T>()))>;
-		const auto Buffer = std::make_unique<UpperType[]>(HalfTex.GetNumChannels());
-		for (const FUint64Vector2& Point : HalfTex.GetGrid2D())
+		template<typename AccT>
+		static void FilterRowX(AccT* Dst, const AccT* SrcRow, const FResampleWeights& WeightsX,
+			uint64_t XBegin, uint64_t XEnd, uint64_t SrcFirstX, uint64_t SrcWidth, uint64_t NumChannels) noexcept
 		{
-			for (uint64_t C = 0; C < HalfTex.GetNumChannels(); ++C)
+			switch (NumChannels)
 			{
-				Buffer[C] = static_cast<T>(0);
+			case 1: FilterRowX<AccT, 1>(Dst, SrcRow, WeightsX, XBegin, XEnd, SrcFirstX, SrcWidth, NumChannels); break;
+			case 2: FilterRowX<AccT, 2>(Dst, SrcRow, WeightsX, XBegin, XEnd, SrcFirstX, SrcWidth, NumChannels); break;
+			case 3: FilterRowX<AccT, 3>(Dst, SrcRow, WeightsX, XBegin, XEnd, SrcFirstX, SrcWidth, NumChannels); break;
+			case 4: FilterRowX<AccT, 4>(Dst, SrcRow, WeightsX, XBegin, XEnd, SrcFirstX, SrcWidth, NumChannels); break;
+			default: FilterRowX<AccT, 0>(Dst, SrcRow, WeightsX, XBegin, XEnd, SrcFirstX, SrcWidth, NumChannels); break;
 			}
-			uint64_t Count = 0;
-			for (const FUint64Vector2& LocalPoint : FGrid2D(2, 2))
+		}
+
+		/**
+		 * Separable resampling of the tile [TileMin, TileMax) of DstTex from SrcTex:
+		 * each source row the tile reads is converted and filtered horizontally once, into a ring of
+		 * the last WeightsY.NumTaps rows indexed by source Y, then the destination rows blend the ring.
+		 * The source rows of a destination row are consecutive and only move down, so none is evicted
+		 * while still needed.
+		 */
+		template<typename AccT>
+		static void ResampleTile(FTex2D& DstTex, const FTex2D& SrcTex, const FResampleWeights& WeightsX, const FResampleWeights& WeightsY,
+			const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			const uint64_t NumChannels = SrcTex.GetNumChannels();
+			const FGrid2D& SrcGrid2D = SrcTex.GetGrid2D();
+			uint64_t SrcFirstX, SrcLastX;
+			WeightsX.GetSourceRange(TileMin.X, TileMax.X, SrcGrid2D.Width, SrcFirstX, SrcLastX);
+			const uint64_t NumSrcElements = (SrcLastX - SrcFirstX + 1) * NumChannels;
+			const uint64_t NumDstElements = (TileMax.X - TileMin.X) * NumChannels;
+			const uint64_t NumRingRows = WeightsY.NumTaps;
+
+			std::vector<AccT> Buffer(NumSrcElements + (NumRingRows + 1) * NumDstElements);
+			AccT* SrcRow = Buffer.data();
+			AccT* DstRow = SrcRow + NumSrcElements;
+			AccT* Ring = DstRow + NumDstElements;
+			std::vector<uint64_t> RingSrcY(NumRingRows, std::numeric_limits<uint64_t>::max());
+			const int64_t MaxSrcY = static_cast<int64_t>(SrcGrid2D.Height) - 1;
+			for (uint64_t Y = TileMin.Y; Y < TileMax.Y; Y++)
 			{
-				const FUint64Vector2 SrcPoint = 2 * Point + LocalPoint;
-				if (SrcTex.GetGrid2D().Contains(SrcPoint))
+				std::fill(DstRow, DstRow + NumDstElements, AccT(0));
+				for (uint64_t Tap = 0; Tap < WeightsY.NumTaps; Tap++)
 				{
-					for (uint64_t C = 0; C < HalfTex.GetNumChannels(); ++C)
+					const AccT Weight = static_cast<AccT>(WeightsY.Weights[Y * WeightsY.NumTaps + Tap]);
+					if (Weight == AccT(0))
+					{
+						continue;
+					}
+					const uint64_t SrcY = static_cast<uint64_t>(Clamp<int64_t>(WeightsY.Begins[Y] + static_cast<int64_t>(Tap), 0, MaxSrcY));
+					const uint64_t Slot = SrcY % NumRingRows;
+					AccT* FilteredRow = Ring + Slot * NumDstElements;
+					if (RingSrcY[Slot] != SrcY)
+					{
+						LoadRow(SrcRow, SrcTex, SrcY, SrcFirstX, SrcLastX + 1);
+						FilterRowX(FilteredRow, SrcRow, WeightsX, TileMin.X, TileMax.X, SrcFirstX, SrcGrid2D.Width, NumChannels);
+						RingSrcY[Slot] = SrcY;
+					}
+					for (uint64_t Index = 0; Index < NumDstElements; Index++)
 					{
-						Buffer[C] += ToUpperType(SrcTex.At<T>(SrcPoint, C));
+						DstRow[Index] += Weight * FilteredRow[Index];
 					}
-					Count += 1;
 				}
+				StoreRow(DstTex, Y, TileMin.X, TileMax.X, DstRow);
+			}
+		}
+
+		/** Run Body(TileMin, TileMax) over Grid2D, in tiles on ThreadPool if not nullptr. */
+		template<typename BodyT>
+		static void ForEachTile(const FGrid2D& Grid2D, FThreadPool* ThreadPool, BodyT&& Body)
+		{
+			if (ThreadPool)
+			{
+				ThreadPool->ParallelFor(Grid2D, FUint64Vector2(256, 16), Body);
+			}
+			else
+			{
+				Body(FUint64Vector2(0, 0), FUint64Vector2(Grid2D.Width, Grid2D.Height));
 			}
-			for (uint64_t C = 0; C < HalfTex.GetNumChannels(); ++C)
+		}
+
+		static void DownSampleMip(FTex2D& HalfTex, const FTex2D& SrcTex, EMipFilter Filter, FThreadPool* ThreadPool)
+		{
+			if (Filter == EMipFilter::Box)
 			{
-				HalfTex.At<T>(Point, C) = static_cast<T>(DivideRound(Buffer[C], Count));
+				ForEachTile(HalfTex.GetGrid2D(), ThreadPool, [&](const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+				{
+					DownSampleBoxTile(HalfTex, SrcTex, TileMin, TileMax);
+				});
+				return;
 			}
+
+			double (*FilterFunction)(double) = Filter == EMipFilter::Kaiser ? &KaiserFilter : &Lanczos3Filter;
+			const FResampleWeights WeightsX(SrcTex.GetGrid2D().Width, HalfTex.GetGrid2D().Width, FilterFunction, 3.);
+			const FResampleWeights WeightsY(SrcTex.GetGrid2D().Height, HalfTex.GetGrid2D().Height, FilterFunction, 3.);
+			ForEachTile(HalfTex.GetGrid2D(), ThreadPool, [&](const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+			{
+				if (SrcTex.GetElementType() == EElementType::Double)
+				{
+					ResampleTile<double>(HalfTex, SrcTex, WeightsX, WeightsY, TileMin, TileMax);
+				}
+				else
+				{
+					ResampleTile<float>(HalfTex, SrcTex, WeightsX, WeightsY, TileMin, TileMax);
+				}
+			});
 		}
 	}
 }
@@ -486,571 +2401,1108 @@ UCommon::FTex2D UCommon::FTex2D::DownSample() const
 {
 	const FGrid2D HalfGrid2D(std::max<uint64_t>(1, Grid2D.Width / 2), std::max<uint64_t>(1, Grid2D.Height / 2));
 
-	FTex2D HalfTex(HalfGrid2D, NumChannels, ElementType);
-
-	switch (ElementType)
+	FTex2D HalfTex(HalfGrid2D, NumChannels, ElementType, StorageLayout);
+	if (StorageLayout == ETex2DStorageLayout::Planar)
 	{
-	case UCommon::EElementType::Uint8:
-		DownSampleImpl<uint8_t>(HalfTex, *this);
-		break;
-	case UCommon::EElementType::Float:
-		DownSampleImpl<float>(HalfTex, *this);
-		break;
-	case UCommon::EElementType::Double:
-		DownSampleImpl<double>(HalfTex, *this);
-		break;
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		break;
+		// each plane is a single-channel Linear texture
+		for (uint64_t C = 0; C < NumChannels; C++)
+		{
+			const FConstTex2DView Plane = GetPlaneView(C);
+			const FTex2DView HalfPlane = HalfTex.GetPlaneView(C);
+			FTex2D HalfPlaneTex(HalfGrid2D, 1, EOwnership::DoNotTakeOwnership, ElementType, HalfPlane.GetRow(0));
+			const FTex2D PlaneTex(Grid2D, 1, EOwnership::DoNotTakeOwnership, ElementType, const_cast<void*>(Plane.GetRow(0)));
+			Details::DownSampleBoxTile(HalfPlaneTex, PlaneTex, FUint64Vector2(0, 0), FUint64Vector2(HalfGrid2D.Width, HalfGrid2D.Height));
+		}
+		return HalfTex;
 	}
+	Details::DownSampleBoxTile(HalfTex, *this, FUint64Vector2(0, 0), FUint64Vector2(HalfGrid2D.Width, HalfGrid2D.Height));
 
 	return HalfTex;
 }
 
-UCommon::FTex2D UCommon::FTex2D::Resize(const FGrid2D& InGrid2D) const
+UCommon::FTex2DMipChain UCommon::FTex2D::GenerateMips(EMipFilter Filter, FThreadPool* ThreadPool) const
 {
 	UBPA_UCOMMON_ASSERT(IsValid());
-	UBPA_UCOMMON_ASSERT(!InGrid2D.IsAreaEmpty());
-	// InGrid2D size must be >= 0.5x of current Grid2D size (no upper limit)
-	UBPA_UCOMMON_ASSERT(InGrid2D.Width >= Grid2D.Width / 2);
-	UBPA_UCOMMON_ASSERT(InGrid2D.Height >= Grid2D.Height / 2);
 
-	// If we've already reached the target size, return a copy
-	if (Grid2D == InGrid2D)
+	if (StorageLayout != ETex2DStorageLayout::Linear)
 	{
-		return FTex2D(*this);
+		return ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool).GenerateMips(Filter, ThreadPool);
 	}
 
-	// Use bilinear interpolation to resize
-	FTex2D ResultTex(InGrid2D, NumChannels, ElementType);
-	const auto SampleBuffer = std::make_unique<float[]>(NumChannels);
-
-	for (const FUint64Vector2& Point : InGrid2D)
+	FTex2DMipChain MipChain(Grid2D, NumChannels, ElementType);
+	FTex2D Mip0 = MipChain.GetMip(0);
+	std::memcpy(Mip0.GetStorage(), Storage, GetStorageSizeInBytes());
+	for (uint64_t Level = 1; Level < MipChain.GetNumMips(); Level++)
 	{
-		const FVector2f Texcoord = InGrid2D.GetTexcoord(Point);
-		BilinearSample(SampleBuffer.get(), Texcoord, ETextureAddress::Clamp, ETextureAddress::Clamp);
-
-		for (uint64_t C = 0; C < NumChannels; ++C)
-		{
-			ResultTex.SetFloat(Point, C, SampleBuffer[C]);
-		}
+		FTex2D Mip = MipChain.GetMip(Level);
+		Details::DownSampleMip(Mip, MipChain.GetMip(Level - 1), Filter, ThreadPool);
 	}
 
-	return ResultTex;
+	return MipChain;
 }
 
-UCommon::FTex2D UCommon::FTex2D::DownSample(const FGrid2D& InGrid2D) const
+UCommon::FTex2D UCommon::FTex2D::Resize(const FGrid2D& InGrid2D, EResizeFilter Filter, FThreadPool* ThreadPool) const
 {
 	UBPA_UCOMMON_ASSERT(IsValid());
 	UBPA_UCOMMON_ASSERT(!InGrid2D.IsAreaEmpty());
-	UBPA_UCOMMON_ASSERT(InGrid2D.Width <= Grid2D.Width && InGrid2D.Height <= Grid2D.Height);
 
-	// Continuously call DownSample() until the next call would make it smaller than InGrid2D
-	FTex2D CurrentTex(*this);
-	while (CurrentTex.Grid2D.Width / 2 >= InGrid2D.Width && CurrentTex.Grid2D.Height / 2 >= InGrid2D.Height)
+	// If we've already reached the target size, return a copy
+	if (Grid2D == InGrid2D)
 	{
-		CurrentTex = CurrentTex.DownSample();
+		return FTex2D(*this);
 	}
 
-	// Use Resize to reach the final target size (already handles equality case)
-	return CurrentTex.Resize(InGrid2D);
-}
-
-UCommon::FTex2D UCommon::FTex2D::ToFloat() const
-{
-	FTex2D Tex(Grid2D, NumChannels, EElementType::Float);
-	if (ElementType != EElementType::Float)
+	if (StorageLayout != ETex2DStorageLayout::Linear)
 	{
-		for (const FUint64Vector2& Point : Grid2D)
-		{
-			for (uint64_t C = 0; C < NumChannels; C++)
-			{
-				Tex.At<float>(Point, C) = GetFloat(Point, C);
-			}
-		}
+		return ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool).Resize(InGrid2D, Filter, ThreadPool).ToStorageLayout(StorageLayout, ThreadPool);
 	}
-	else
+
+	double (*FilterFunction)(double) = nullptr;
+	double Support = 0.;
+	switch (Filter)
 	{
-		std::memcpy(Tex.GetStorage(), Storage, GetStorageSizeInBytes());
+	case EResizeFilter::Triangle:
+		FilterFunction = &Details::TriangleFilter;
+		Support = 1.;
+		break;
+	case EResizeFilter::CatmullRom:
+		FilterFunction = &Details::CubicFilter<0, 3>;
+		Support = 2.;
+		break;
+	case EResizeFilter::Lanczos3:
+		FilterFunction = &Details::Lanczos3Filter;
+		Support = 3.;
+		break;
+	case EResizeFilter::Mitchell:
+		FilterFunction = &Details::CubicFilter<2, 2>;
+		Support = 2.;
+		break;
+	default:
+		UBPA_UCOMMON_NO_ENTRY();
+		return FTex2D();
 	}
-	return Tex;
-}
-
-void UCommon::FTex2D::ToUint8(FTex2D& Tex) const
-{
-	UBPA_UCOMMON_ASSERT(Tex.ElementType == EElementType::Uint8);
-	UBPA_UCOMMON_ASSERT(Tex.Grid2D == Grid2D);
-	UBPA_UCOMMON_ASSERT(Tex.NumChannels == NumChannels);
 
-	if (ElementType != EElementType::Uint8)
+	const Details::FResampleWeights WeightsX(Grid2D.Width, InGrid2D.Width, FilterFunction, Support);
+	const Details::FResampleWeights WeightsY(Grid2D.Height, InGrid2D.Height, FilterFunction, Support);
+	FTex2D ResultTex(InGrid2D, NumChannels, ElementType);
+	auto ResampleRows = [&](uint64_t RowBegin, uint64_t RowEnd)
 	{
-		for (const FUint64Vector2& Point : Grid2D)
+		const FUint64Vector2 TileMin(0, RowBegin);
+		const FUint64Vector2 TileMax(InGrid2D.Width, RowEnd);
+		if (ElementType == EElementType::Double)
 		{
-			for (uint64_t C = 0; C < NumChannels; C++)
-			{
-				Tex.At<uint8_t>(Point, C) = ElementFloatClampToUint8(GetFloat(Point, C));
-			}
+			Details::ResampleTile<double>(ResultTex, *this, WeightsX, WeightsY, TileMin, TileMax);
+		}
+		else
+		{
+			Details::ResampleTile<float>(ResultTex, *this, WeightsX, WeightsY, TileMin, TileMax);
 		}
+	};
+
+	if (ThreadPool)
+	{
+		ThreadPool->ParallelForRange(0, InGrid2D.Height, 0, ResampleRows);
 	}
 	else
 	{
-		std::memcpy(Tex.GetStorage(), Storage, GetStorageSizeInBytes());
+		ResampleRows(0, InGrid2D.Height);
 	}
+
+	return ResultTex;
 }
 
-UCommon::FTex2D UCommon::FTex2D::ToUint8() const
+UCommon::FTex2D UCommon::FTex2D::DownSample(const FGrid2D& InGrid2D, EResizeFilter Filter, FThreadPool* ThreadPool) const
 {
-	FTex2D Tex(Grid2D, NumChannels, EElementType::Uint8);
-	ToUint8(Tex);
-	return Tex;
+	UBPA_UCOMMON_ASSERT(InGrid2D.Width <= Grid2D.Width && InGrid2D.Height <= Grid2D.Height);
+	return Resize(InGrid2D, Filter, ThreadPool);
 }
 
-void UCommon::FTex2D::Clamp(float MinValue, float MaxValue) noexcept
+UCommon::FTex2D UCommon::FTex2D::BoxBlur(uint64_t Radius, FThreadPool* ThreadPool) const
 {
-	UBPA_UCOMMON_ASSERT(MinValue <= MaxValue);
+	UBPA_UCOMMON_ASSERT(IsValid());
 
-	switch (ElementType)
+	if (StorageLayout != ETex2DStorageLayout::Linear)
 	{
-	case UCommon::EElementType::Uint8:
+		return ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool).BoxBlur(Radius, ThreadPool).ToStorageLayout(StorageLayout, ThreadPool);
+	}
+
+	const FTex2DSummedAreaTable Table(*this, false, ThreadPool);
+	FTex2D Result(Grid2D, NumChannels, ElementType);
+	Table.BoxFilter(Result, Radius, ThreadPool);
+	return Result;
+}
+
+namespace UCommon
+{
+	namespace Details
 	{
-		const uint8_t MinUint8 = ElementFloatClampToUint8(MinValue);
-		const uint8_t MaxUint8 = ElementFloatClampToUint8(MaxValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+		/** Elements [Offset, Offset + Num) of a Linear texture as floats, Float storage is read in place. */
+		static const float* GetFloatElements(const FTex2D& Tex, uint64_t Offset, uint64_t Num, std::vector<float>& Buffer)
 		{
-			uint8_t& Value = reinterpret_cast<uint8_t*>(Storage)[Index];
-			Value = UCommon::Clamp(Value, MinUint8, MaxUint8);
+			if (Tex.GetElementType() == EElementType::Float)
+			{
+				return static_cast<const float*>(Tex.GetStorage()) + Offset;
+			}
+			Buffer.resize(Num);
+			ElementConvert(Buffer.data(), EElementType::Float,
+				static_cast<const uint8_t*>(Tex.GetStorage()) + Offset * ElementGetSize(Tex.GetElementType()), Tex.GetElementType(), Num);
+			return Buffer.data();
 		}
-		break;
-	}
-	case UCommon::EElementType::Half:
-	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+
+		/** Rows per block of the error reductions, about 64K elements, fixed so that the double sums do not depend on the threads. */
+		static uint64_t GetErrorBlockHeight(const FTex2D& Tex) noexcept
 		{
-			FHalf& Value = reinterpret_cast<FHalf*>(Storage)[Index];
-			Value = static_cast<FHalf>(UCommon::Clamp(static_cast<float>(Value), MinValue, MaxValue));
+			return std::max<uint64_t>(1, (uint64_t(1) << 16) / (Tex.GetGrid2D().Width * Tex.GetNumChannels()));
 		}
-		break;
-	}
-	case UCommon::EElementType::Float:
-	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+
+		/** Call Body(BlockIndex, Values, References, NumElements) for each block of BlockHeight rows, as floats. */
+		template<typename BodyT>
+		static void ForEachErrorBlock(const FTex2D& Tex, const FTex2D& Reference, uint64_t BlockHeight, FThreadPool* ThreadPool, BodyT&& Body)
 		{
-			float& Value = reinterpret_cast<float*>(Storage)[Index];
-			Value = UCommon::Clamp(Value, MinValue, MaxValue);
+			const uint64_t Height = Tex.GetGrid2D().Height;
+			const uint64_t RowNumElements = Tex.GetGrid2D().Width * Tex.GetNumChannels();
+			const uint64_t NumBlocks = (Height + BlockHeight - 1) / BlockHeight;
+			auto ProcessBlocks = [&](uint64_t BlockBegin, uint64_t BlockEnd)
+			{
+				std::vector<float> ValueBuffer;
+				std::vector<float> ReferenceBuffer;
+				for (uint64_t Block = BlockBegin; Block < BlockEnd; Block++)
+				{
+					const uint64_t RowBegin = Block * BlockHeight;
+					const uint64_t Num = (std::min(Height, RowBegin + BlockHeight) - RowBegin) * RowNumElements;
+					const float* Values = GetFloatElements(Tex, RowBegin * RowNumElements, Num, ValueBuffer);
+					const float* References = GetFloatElements(Reference, RowBegin * RowNumElements, Num, ReferenceBuffer);
+					Body(Block, Values, References, Num);
+				}
+			};
+
+			if (ThreadPool)
+			{
+				ThreadPool->ParallelForRange(0, NumBlocks, 1, ProcessBlocks);
+			}
+			else
+			{
+				ProcessBlocks(0, NumBlocks);
+			}
 		}
-		break;
-	}
-	case UCommon::EElementType::Double:
-	{
-		const double MinDouble = static_cast<double>(MinValue);
-		const double MaxDouble = static_cast<double>(MaxValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+
+		/**
+		 * Accumulate the squared error (+=), max absolute and max relative error (max) of each channel
+		 * over interleaved elements starting at a texel.
+		 * The AVX2 path keeps one lane per element of a period of lcm(8, NumChannels) elements,
+		 * sums in float over at most 64 periods before adding to double, and folds the lanes into channels at the end.
+		 */
+		static void AccumulateErrors(const float* Values, const float* References, uint64_t Num, uint64_t NumChannels, float RelativeEpsilon,
+			double* SquaredErrorSums, float* MaxAbsErrors, float* MaxRelErrors) noexcept
 		{
-			double& Value = reinterpret_cast<double*>(Storage)[Index];
-			Value = UCommon::Clamp(Value, MinDouble, MaxDouble);
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			if (NumChannels <= 8)
+			{
+				const uint64_t NumVectors = NumChannels / std::gcd<uint64_t>(NumChannels, 8);
+				const uint64_t Period = 8 * NumVectors;
+				const __m256 SignMask = _mm256_set1_ps(-0.f);
+				const __m256 Epsilon = _mm256_set1_ps(RelativeEpsilon);
+				__m256 MaxAbs[8];
+				__m256 MaxRel[8];
+				for (uint64_t V = 0; V < NumVectors; V++)
+				{
+					MaxAbs[V] = _mm256_setzero_ps();
+					MaxRel[V] = _mm256_setzero_ps();
+				}
+				double LaneSums[64] = {};
+				alignas(32) float Lanes[8];
+				while (Index + Period <= Num)
+				{
+					__m256 Sums[8];
+					for (uint64_t V = 0; V < NumVectors; V++)
+					{
+						Sums[V] = _mm256_setzero_ps();
+					}
+					const uint64_t BlockEnd = Index + std::min<uint64_t>(64, (Num - Index) / Period) * Period;
+					for (; Index < BlockEnd; Index += Period)
+					{
+						for (uint64_t V = 0; V < NumVectors; V++)
+						{
+							const __m256 Reference = _mm256_loadu_ps(References + Index + V * 8);
+							const __m256 Error = _mm256_sub_ps(_mm256_loadu_ps(Values + Index + V * 8), Reference);
+							const __m256 AbsError = _mm256_andnot_ps(SignMask, Error);
+							Sums[V] = _mm256_add_ps(Sums[V], _mm256_mul_ps(Error, Error));
+							MaxAbs[V] = _mm256_max_ps(MaxAbs[V], AbsError);
+							MaxRel[V] = _mm256_max_ps(MaxRel[V], _mm256_div_ps(AbsError, _mm256_max_ps(_mm256_andnot_ps(SignMask, Reference), Epsilon)));
+						}
+					}
+					for (uint64_t V = 0; V < NumVectors; V++)
+					{
+						_mm256_store_ps(Lanes, Sums[V]);
+						for (uint64_t Lane = 0; Lane < 8; Lane++)
+						{
+							LaneSums[V * 8 + Lane] += Lanes[Lane];
+						}
+					}
+				}
+
+				alignas(32) float AbsLanes[8];
+				for (uint64_t V = 0; V < NumVectors; V++)
+				{
+					_mm256_store_ps(AbsLanes, MaxAbs[V]);
+					_mm256_store_ps(Lanes, MaxRel[V]);
+					for (uint64_t Lane = 0; Lane < 8; Lane++)
+					{
+						const uint64_t C = (V * 8 + Lane) % NumChannels;
+						SquaredErrorSums[C] += LaneSums[V * 8 + Lane];
+						MaxAbsErrors[C] = std::max(MaxAbsErrors[C], AbsLanes[Lane]);
+						MaxRelErrors[C] = std::max(MaxRelErrors[C], Lanes[Lane]);
+					}
+				}
+			}
+#endif
+			// Index is a multiple of NumChannels here
+			for (; Index < Num; Index++)
+			{
+				const uint64_t C = Index % NumChannels;
+				const float Error = Values[Index] - References[Index];
+				const float AbsError = std::abs(Error);
+				SquaredErrorSums[C] += (double)(Error * Error);
+				MaxAbsErrors[C] = std::max(MaxAbsErrors[C], AbsError);
+				MaxRelErrors[C] = std::max(MaxRelErrors[C], AbsError / std::max(std::abs(References[Index]), RelativeEpsilon));
+			}
 		}
-		break;
-	}
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		break;
-	}
-}
 
-void UCommon::FTex2D::Min(float MinValue) noexcept
-{
-	switch (ElementType)
-	{
-	case UCommon::EElementType::Uint8:
-	{
-		const uint8_t MinUint8 = ElementFloatClampToUint8(MinValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+		static constexpr uint64_t NumErrorHistogramCopies = 4;
+
+		/**
+		 * Count |Value - Reference| * BinScale into Histograms[Copy * NumChannels * NumBins + C * NumBins + Bin],
+		 * the last bin takes the rest and NaN. The AVX2 path adds per-lane counter offsets (channel and copy, periodic over
+		 * lcm(8, NumChannels) elements) to the bins and spreads the lanes over NumErrorHistogramCopies copies,
+		 * so that runs of equal bins do not wait on the same counter.
+		 */
+		static void AccumulateErrorHistograms(const float* Values, const float* References, uint64_t Num, uint64_t NumChannels,
+			float BinScale, uint64_t NumBins, uint64_t* Histograms) noexcept
+		{
+			const float LastBin = (float)(NumBins - 1);
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			if (NumChannels <= 8 && NumErrorHistogramCopies * NumChannels * NumBins <= (uint64_t(1) << 24))
+			{
+				const uint64_t NumVectors = NumChannels / std::gcd<uint64_t>(NumChannels, 8);
+				const uint64_t Period = 8 * NumVectors;
+				__m256i Offsets[8];
+				for (uint64_t V = 0; V < NumVectors; V++)
+				{
+					alignas(32) int32_t LaneOffsets[8];
+					for (uint64_t Lane = 0; Lane < 8; Lane++)
+					{
+						LaneOffsets[Lane] = (int32_t)(((Lane % NumErrorHistogramCopies) * NumChannels + (V * 8 + Lane) % NumChannels) * NumBins);
+					}
+					Offsets[V] = _mm256_load_si256(reinterpret_cast<const __m256i*>(LaneOffsets));
+				}
+				const __m256 SignMask = _mm256_set1_ps(-0.f);
+				const __m256 Scale = _mm256_set1_ps(BinScale);
+				const __m256 Last = _mm256_set1_ps(LastBin);
+				alignas(32) int32_t Counters[8];
+				for (; Index + Period <= Num; Index += Period)
+				{
+					for (uint64_t V = 0; V < NumVectors; V++)
+					{
+						const __m256 AbsError = _mm256_andnot_ps(SignMask, _mm256_sub_ps(_mm256_loadu_ps(Values + Index + V * 8), _mm256_loadu_ps(References + Index + V * 8)));
+						// min takes the second operand for NaN
+						const __m256i Bins = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_mul_ps(AbsError, Scale), Last));
+						_mm256_store_si256(reinterpret_cast<__m256i*>(Counters), _mm256_add_epi32(Bins, Offsets[V]));
+						for (uint64_t Lane = 0; Lane < 8; Lane++)
+						{
+							Histograms[Counters[Lane]]++;
+						}
+					}
+				}
+			}
+#endif
+			// Index is a multiple of NumChannels here
+			for (; Index < Num; Index++)
+			{
+				const float Bin = std::abs(Values[Index] - References[Index]) * BinScale;
+				Histograms[(Index % NumChannels) * NumBins + (Bin < LastBin ? (uint64_t)Bin : NumBins - 1)]++;
+			}
+		}
+
+		/**
+		 * Out[i] = sum of Weights[K] * Inputs[K][i] for symmetric weights (Weights[K] == Weights[NumTaps - 1 - K]),
+		 * the center first, then the pairs of inputs added before the multiplication.
+		 */
+		template<uint64_t NumTaps>
+		static void SymmetricWeightedSum(float* Out, const float* const* Inputs, const float* Weights, uint64_t Num) noexcept
 		{
-			uint8_t& Value = reinterpret_cast<uint8_t*>(Storage)[Index];
-			if (Value < MinUint8)
+			constexpr uint64_t Center = NumTaps / 2;
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			__m256 VWeights[Center + 1];
+			for (uint64_t K = 0; K <= Center; K++)
+			{
+				VWeights[K] = _mm256_set1_ps(Weights[K]);
+			}
+			// 4 independent sums hide the latency of the chain of additions
+			for (; Index + 32 <= Num; Index += 32)
+			{
+				const float* CenterInput = Inputs[Center] + Index;
+				__m256 Sum0 = _mm256_mul_ps(VWeights[Center], _mm256_loadu_ps(CenterInput));
+				__m256 Sum1 = _mm256_mul_ps(VWeights[Center], _mm256_loadu_ps(CenterInput + 8));
+				__m256 Sum2 = _mm256_mul_ps(VWeights[Center], _mm256_loadu_ps(CenterInput + 16));
+				__m256 Sum3 = _mm256_mul_ps(VWeights[Center], _mm256_loadu_ps(CenterInput + 24));
+				for (uint64_t K = 0; K < Center; K++)
+				{
+					const float* Lower = Inputs[K] + Index;
+					const float* Upper = Inputs[NumTaps - 1 - K] + Index;
+					Sum0 = _mm256_add_ps(Sum0, _mm256_mul_ps(VWeights[K], _mm256_add_ps(_mm256_loadu_ps(Lower), _mm256_loadu_ps(Upper))));
+					Sum1 = _mm256_add_ps(Sum1, _mm256_mul_ps(VWeights[K], _mm256_add_ps(_mm256_loadu_ps(Lower + 8), _mm256_loadu_ps(Upper + 8))));
+					Sum2 = _mm256_add_ps(Sum2, _mm256_mul_ps(VWeights[K], _mm256_add_ps(_mm256_loadu_ps(Lower + 16), _mm256_loadu_ps(Upper + 16))));
+					Sum3 = _mm256_add_ps(Sum3, _mm256_mul_ps(VWeights[K], _mm256_add_ps(_mm256_loadu_ps(Lower + 24), _mm256_loadu_ps(Upper + 24))));
+				}
+				_mm256_storeu_ps(Out + Index, Sum0);
+				_mm256_storeu_ps(Out + Index + 8, Sum1);
+				_mm256_storeu_ps(Out + Index + 16, Sum2);
+				_mm256_storeu_ps(Out + Index + 24, Sum3);
+			}
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				__m256 Sum = _mm256_mul_ps(VWeights[Center], _mm256_loadu_ps(Inputs[Center] + Index));
+				for (uint64_t K = 0; K < Center; K++)
+				{
+					Sum = _mm256_add_ps(Sum, _mm256_mul_ps(VWeights[K], _mm256_add_ps(_mm256_loadu_ps(Inputs[K] + Index), _mm256_loadu_ps(Inputs[NumTaps - 1 - K] + Index))));
+				}
+				_mm256_storeu_ps(Out + Index, Sum);
+			}
+#endif
+			for (; Index < Num; Index++)
 			{
-				Value = MinUint8;
+				float Sum = Weights[Center] * Inputs[Center][Index];
+				for (uint64_t K = 0; K < Center; K++)
+				{
+					Sum += Weights[K] * (Inputs[K][Index] + Inputs[NumTaps - 1 - K][Index]);
+				}
+				Out[Index] = Sum;
 			}
 		}
-		break;
-	}
-	case UCommon::EElementType::Half:
-	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+
+		static void MultiplyElements(float* Out, const float* A, const float* B, uint64_t Num) noexcept
 		{
-			FHalf& Value = reinterpret_cast<FHalf*>(Storage)[Index];
-			const float ValueFloat = static_cast<float>(Value);
-			if (ValueFloat < MinValue)
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			for (; Index + 8 <= Num; Index += 8)
 			{
-				Value = static_cast<FHalf>(MinValue);
+				_mm256_storeu_ps(Out + Index, _mm256_mul_ps(_mm256_loadu_ps(A + Index), _mm256_loadu_ps(B + Index)));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Out[Index] = A[Index] * B[Index];
 			}
 		}
-		break;
-	}
-	case UCommon::EElementType::Float:
-	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+
+		/** Sums[i] += SSIM from the local means, mean squares and mean product of A and B. */
+		static void AccumulateSSIM(float* Sums, const float* MeanA, const float* MeanB, const float* MeanAA, const float* MeanBB, const float* MeanAB,
+			uint64_t Num, float C1, float C2) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			const __m256 VC1 = _mm256_set1_ps(C1);
+			const __m256 VC2 = _mm256_set1_ps(C2);
+			const __m256 Two = _mm256_set1_ps(2.f);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				const __m256 MA = _mm256_loadu_ps(MeanA + Index);
+				const __m256 MB = _mm256_loadu_ps(MeanB + Index);
+				const __m256 MAMB = _mm256_mul_ps(MA, MB);
+				const __m256 MAMA = _mm256_mul_ps(MA, MA);
+				const __m256 MBMB = _mm256_mul_ps(MB, MB);
+				const __m256 CovarianceAB = _mm256_sub_ps(_mm256_loadu_ps(MeanAB + Index), MAMB);
+				const __m256 VarianceA = _mm256_sub_ps(_mm256_loadu_ps(MeanAA + Index), MAMA);
+				const __m256 VarianceB = _mm256_sub_ps(_mm256_loadu_ps(MeanBB + Index), MBMB);
+				const __m256 Numerator = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(Two, MAMB), VC1), _mm256_add_ps(_mm256_mul_ps(Two, CovarianceAB), VC2));
+				const __m256 Denominator = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(MAMA, MBMB), VC1), _mm256_add_ps(_mm256_add_ps(VarianceA, VarianceB), VC2));
+				_mm256_storeu_ps(Sums + Index, _mm256_add_ps(_mm256_loadu_ps(Sums + Index), _mm256_div_ps(Numerator, Denominator)));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				const float MAMB = MeanA[Index] * MeanB[Index];
+				const float MAMA = MeanA[Index] * MeanA[Index];
+				const float MBMB = MeanB[Index] * MeanB[Index];
+				const float CovarianceAB = MeanAB[Index] - MAMB;
+				const float VarianceA = MeanAA[Index] - MAMA;
+				const float VarianceB = MeanBB[Index] - MBMB;
+				const float Numerator = (2.f * MAMB + C1) * (2.f * CovarianceAB + C2);
+				const float Denominator = ((MAMA + MBMB) + C1) * ((VarianceA + VarianceB) + C2);
+				Sums[Index] += Numerator / Denominator;
+			}
+		}
+
+		/** Texels [X0 - Radius, X1 + Radius) of row Y as floats, columns clamped to the texture. */
+		static void LoadPaddedRow(float* Out, const FTex2D& Tex, uint64_t Y, uint64_t X0, uint64_t X1, uint64_t Radius)
 		{
-			float& Value = reinterpret_cast<float*>(Storage)[Index];
-			if (Value < MinValue)
+			const uint64_t Width = Tex.GetGrid2D().Width;
+			const uint64_t NumChannels = Tex.GetNumChannels();
+			const uint64_t LoadBegin = X0 > Radius ? X0 - Radius : 0;
+			const uint64_t LoadEnd = std::min(Width, X1 + Radius);
+			const uint64_t NumLeft = LoadBegin + Radius - X0;
+			const uint64_t ElementSize = ElementGetSize(Tex.GetElementType());
+			ElementConvert(Out + NumLeft * NumChannels, EElementType::Float,
+				static_cast<const uint8_t*>(Tex.GetStorage()) + (Y * Width + LoadBegin) * NumChannels * ElementSize, Tex.GetElementType(), (LoadEnd - LoadBegin) * NumChannels);
+			for (uint64_t X = 0; X < NumLeft; X++)
+			{
+				std::memcpy(Out + X * NumChannels, Out + NumLeft * NumChannels, NumChannels * sizeof(float));
+			}
+			const uint64_t NumPadded = X1 - X0 + 2 * Radius;
+			const uint64_t LoadedEnd = NumLeft + LoadEnd - LoadBegin;
+			for (uint64_t X = LoadedEnd; X < NumPadded; X++)
 			{
-				Value = MinValue;
+				std::memcpy(Out + X * NumChannels, Out + (LoadedEnd - 1) * NumChannels, NumChannels * sizeof(float));
 			}
 		}
-		break;
 	}
-	case UCommon::EElementType::Double:
+}
+
+double UCommon::FTex2DErrorStats::GetPSNR(double Peak) const noexcept
+{
+	return MSE > 0. ? 10. * std::log10(Peak * Peak / MSE) : std::numeric_limits<double>::infinity();
+}
+
+void UCommon::FTex2D::ComputeErrorStats(const FTex2D& Reference, FTex2DErrorStats* Results, float RelativeEpsilon, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && Reference.IsValid());
+	UBPA_UCOMMON_ASSERT(Reference.Grid2D == Grid2D);
+	UBPA_UCOMMON_ASSERT(Reference.NumChannels == NumChannels);
+
+	if (StorageLayout != ETex2DStorageLayout::Linear || Reference.StorageLayout != ETex2DStorageLayout::Linear)
+	{
+		ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool).ComputeErrorStats(Reference.ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool), Results, RelativeEpsilon, ThreadPool);
+		return;
+	}
+
+	// one slot per block, added in order
+	const uint64_t BlockHeight = Details::GetErrorBlockHeight(*this);
+	const uint64_t NumBlocks = (Grid2D.Height + BlockHeight - 1) / BlockHeight;
+	std::vector<double> SquaredErrorSums(NumBlocks * NumChannels, 0.);
+	std::vector<float> MaxAbsErrors(NumBlocks * NumChannels, 0.f);
+	std::vector<float> MaxRelErrors(NumBlocks * NumChannels, 0.f);
+	Details::ForEachErrorBlock(*this, Reference, BlockHeight, ThreadPool, [&](uint64_t Block, const float* Values, const float* References, uint64_t Num)
 	{
-		const double MinDouble = static_cast<double>(MinValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+		Details::AccumulateErrors(Values, References, Num, NumChannels, RelativeEpsilon,
+			&SquaredErrorSums[Block * NumChannels], &MaxAbsErrors[Block * NumChannels], &MaxRelErrors[Block * NumChannels]);
+	});
+
+	for (uint64_t C = 0; C < NumChannels; C++)
+	{
+		double SquaredErrorSum = 0.;
+		float MaxAbsError = 0.f;
+		float MaxRelError = 0.f;
+		for (uint64_t Block = 0; Block < NumBlocks; Block++)
 		{
-			double& Value = reinterpret_cast<double*>(Storage)[Index];
-			if (Value < MinDouble)
-			{
-				Value = MinDouble;
-			}
+			SquaredErrorSum += SquaredErrorSums[Block * NumChannels + C];
+			MaxAbsError = std::max(MaxAbsError, MaxAbsErrors[Block * NumChannels + C]);
+			MaxRelError = std::max(MaxRelError, MaxRelErrors[Block * NumChannels + C]);
 		}
-		break;
+		Results[C].MSE = SquaredErrorSum / (double)Grid2D.GetArea();
+		Results[C].MaxAbsError = MaxAbsError;
+		Results[C].MaxRelError = MaxRelError;
 	}
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		break;
+}
+
+double UCommon::FTex2D::ComputeMSE(const FTex2D& Reference, FThreadPool* ThreadPool) const
+{
+	std::vector<FTex2DErrorStats> Stats(NumChannels);
+	ComputeErrorStats(Reference, Stats.data(), 1e-6f, ThreadPool);
+	double MSE = 0.;
+	for (const FTex2DErrorStats& ChannelStats : Stats)
+	{
+		MSE += ChannelStats.MSE;
 	}
+	return MSE / (double)NumChannels;
 }
 
-void UCommon::FTex2D::Max(float MaxValue) noexcept
+double UCommon::FTex2D::ComputePSNR(const FTex2D& Reference, double Peak, FThreadPool* ThreadPool) const
 {
-	switch (ElementType)
+	FTex2DErrorStats Stats;
+	Stats.MSE = ComputeMSE(Reference, ThreadPool);
+	return Stats.GetPSNR(Peak);
+}
+
+double UCommon::FTex2D::ComputeSSIM(const FTex2D& Reference, double* ChannelResults, double Peak, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && Reference.IsValid());
+	UBPA_UCOMMON_ASSERT(Reference.Grid2D == Grid2D);
+	UBPA_UCOMMON_ASSERT(Reference.NumChannels == NumChannels);
+
+	if (StorageLayout != ETex2DStorageLayout::Linear || Reference.StorageLayout != ETex2DStorageLayout::Linear)
 	{
-	case UCommon::EElementType::Uint8:
+		return ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool).ComputeSSIM(Reference.ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool), ChannelResults, Peak, ThreadPool);
+	}
+
+	constexpr uint64_t Radius = 5;
+	constexpr uint64_t NumTaps = 2 * Radius + 1;
+	constexpr uint64_t TileWidth = 64;
+	constexpr uint64_t TileHeight = 64;
+	float Weights[NumTaps];
+	float WeightSum = 0.f;
+	for (uint64_t K = 0; K < NumTaps; K++)
 	{
-		const uint8_t MaxUint8 = ElementFloatClampToUint8(MaxValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
-		{
-			uint8_t& Value = reinterpret_cast<uint8_t*>(Storage)[Index];
-			if (Value > MaxUint8)
-			{
-				Value = MaxUint8;
-			}
-		}
-		break;
+		const float Offset = (float)K - (float)Radius;
+		Weights[K] = std::exp(-Offset * Offset / (2.f * 1.5f * 1.5f));
+		WeightSum += Weights[K];
 	}
-	case UCommon::EElementType::Half:
+	for (float& Weight : Weights)
 	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
-		{
-			FHalf& Value = reinterpret_cast<FHalf*>(Storage)[Index];
-			const float ValueFloat = static_cast<float>(Value);
-			if (ValueFloat > MaxValue)
-			{
-				Value = static_cast<FHalf>(MaxValue);
-			}
-		}
-		break;
+		Weight /= WeightSum;
 	}
-	case UCommon::EElementType::Float:
+	const float C1 = (float)((0.01 * Peak) * (0.01 * Peak));
+	const float C2 = (float)((0.03 * Peak) * (0.03 * Peak));
+
+	// 5 maps (A, B, A*A, B*B, A*B) filtered horizontally over the tile rows with a halo of Radius rows, then vertically
+	const uint64_t NumTilesX = (Grid2D.Width + TileWidth - 1) / TileWidth;
+	const uint64_t NumTilesY = (Grid2D.Height + TileHeight - 1) / TileHeight;
+	std::vector<double> TileSums(NumTilesX * NumTilesY * NumChannels, 0.);
+	auto ProcessTiles = [&](uint64_t TileBegin, uint64_t TileEnd)
 	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+		const uint64_t MaxRowNumElements = TileWidth * NumChannels;
+		const uint64_t PaddedRowNumElements = (TileWidth + 2 * Radius) * NumChannels;
+		std::vector<float> Padded(5 * PaddedRowNumElements);
+		std::vector<float> Filtered(5 * (TileHeight + 2 * Radius) * MaxRowNumElements);
+		std::vector<float> Means(5 * MaxRowNumElements);
+		std::vector<float> Sums(MaxRowNumElements);
+		for (uint64_t Tile = TileBegin; Tile < TileEnd; Tile++)
 		{
-			float& Value = reinterpret_cast<float*>(Storage)[Index];
-			if (Value > MaxValue)
+			const uint64_t X0 = (Tile % NumTilesX) * TileWidth;
+			const uint64_t Y0 = (Tile / NumTilesX) * TileHeight;
+			const uint64_t X1 = std::min(Grid2D.Width, X0 + TileWidth);
+			const uint64_t Y1 = std::min(Grid2D.Height, Y0 + TileHeight);
+			const uint64_t RowNumElements = (X1 - X0) * NumChannels;
+			const uint64_t NumHaloRows = Y1 - Y0 + 2 * Radius;
+
+			for (uint64_t Row = 0; Row < NumHaloRows; Row++)
 			{
-				Value = MaxValue;
+				const uint64_t Y = std::min(Grid2D.Height - 1, (uint64_t)std::max<int64_t>(0, (int64_t)(Y0 + Row) - (int64_t)Radius));
+				float* PaddedA = Padded.data();
+				float* PaddedB = PaddedA + PaddedRowNumElements;
+				Details::LoadPaddedRow(PaddedA, *this, Y, X0, X1, Radius);
+				Details::LoadPaddedRow(PaddedB, Reference, Y, X0, X1, Radius);
+				const uint64_t NumPadded = RowNumElements + 2 * Radius * NumChannels;
+				Details::MultiplyElements(PaddedA + 2 * PaddedRowNumElements, PaddedA, PaddedA, NumPadded);
+				Details::MultiplyElements(PaddedA + 3 * PaddedRowNumElements, PaddedB, PaddedB, NumPadded);
+				Details::MultiplyElements(PaddedA + 4 * PaddedRowNumElements, PaddedA, PaddedB, NumPadded);
+				for (uint64_t Map = 0; Map < 5; Map++)
+				{
+					const float* Inputs[NumTaps];
+					for (uint64_t K = 0; K < NumTaps; K++)
+					{
+						Inputs[K] = Padded.data() + Map * PaddedRowNumElements + K * NumChannels;
+					}
+					Details::SymmetricWeightedSum<NumTaps>(Filtered.data() + (Map * (TileHeight + 2 * Radius) + Row) * MaxRowNumElements, Inputs, Weights, RowNumElements);
+				}
 			}
-		}
-		break;
-	}
-	case UCommon::EElementType::Double:
-	{
-		const double MaxDouble = static_cast<double>(MaxValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
-		{
-			double& Value = reinterpret_cast<double*>(Storage)[Index];
-			if (Value > MaxDouble)
+
+			std::fill(Sums.begin(), Sums.begin() + RowNumElements, 0.f);
+			for (uint64_t Row = 0; Row < Y1 - Y0; Row++)
 			{
-				Value = MaxDouble;
+				for (uint64_t Map = 0; Map < 5; Map++)
+				{
+					const float* Inputs[NumTaps];
+					for (uint64_t K = 0; K < NumTaps; K++)
+					{
+						Inputs[K] = Filtered.data() + (Map * (TileHeight + 2 * Radius) + Row + K) * MaxRowNumElements;
+					}
+					Details::SymmetricWeightedSum<NumTaps>(Means.data() + Map * MaxRowNumElements, Inputs, Weights, RowNumElements);
+				}
+				Details::AccumulateSSIM(Sums.data(), Means.data(), Means.data() + MaxRowNumElements, Means.data() + 2 * MaxRowNumElements,
+					Means.data() + 3 * MaxRowNumElements, Means.data() + 4 * MaxRowNumElements, RowNumElements, C1, C2);
+			}
+			for (uint64_t Index = 0; Index < RowNumElements; Index++)
+			{
+				TileSums[Tile * NumChannels + Index % NumChannels] += Sums[Index];
 			}
 		}
-		break;
+	};
+
+	if (ThreadPool)
+	{
+		ThreadPool->ParallelForRange(0, NumTilesX * NumTilesY, 1, ProcessTiles);
 	}
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		break;
+	else
+	{
+		ProcessTiles(0, NumTilesX * NumTilesY);
 	}
-}
 
-void UCommon::FTex2D::Threshold(float ThresholdValue) noexcept
-{
-	switch (ElementType)
-	{
-	case UCommon::EElementType::Uint8:
+	double SSIM = 0.;
+	for (uint64_t C = 0; C < NumChannels; C++)
 	{
-		const uint8_t ThresholdUint8 = ElementFloatClampToUint8(ThresholdValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+		double Sum = 0.;
+		for (uint64_t Tile = 0; Tile < NumTilesX * NumTilesY; Tile++)
 		{
-			uint8_t& Value = reinterpret_cast<uint8_t*>(Storage)[Index];
-			if (Value < ThresholdUint8)
-			{
-				Value = 0;
-			}
+			Sum += TileSums[Tile * NumChannels + C];
 		}
-		break;
-	}
-	case UCommon::EElementType::Half:
-	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+		const double ChannelSSIM = Sum / (double)Grid2D.GetArea();
+		if (ChannelResults)
 		{
-			FHalf& Value = reinterpret_cast<FHalf*>(Storage)[Index];
-			const float ValueFloat = static_cast<float>(Value);
-			if (ValueFloat < ThresholdValue)
-			{
-				Value = static_cast<FHalf>(0.f);
-			}
+			ChannelResults[C] = ChannelSSIM;
 		}
-		break;
+		SSIM += ChannelSSIM;
 	}
-	case UCommon::EElementType::Float:
+	return SSIM / (double)NumChannels;
+}
+
+void UCommon::FTex2D::ComputeErrorHistograms(const FTex2D& Reference, float MaxError, uint64_t NumBins, uint64_t* Histograms, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid() && Reference.IsValid());
+	UBPA_UCOMMON_ASSERT(Reference.Grid2D == Grid2D);
+	UBPA_UCOMMON_ASSERT(Reference.NumChannels == NumChannels);
+	UBPA_UCOMMON_ASSERT(MaxError > 0.f && NumBins > 0);
+
+	if (StorageLayout != ETex2DStorageLayout::Linear || Reference.StorageLayout != ETex2DStorageLayout::Linear)
 	{
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
-		{
-			float& Value = reinterpret_cast<float*>(Storage)[Index];
-			if (Value < ThresholdValue)
-			{
-				Value = 0.f;
-			}
-		}
-		break;
+		ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool).ComputeErrorHistograms(Reference.ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool), MaxError, NumBins, Histograms, ThreadPool);
+		return;
 	}
-	case UCommon::EElementType::Double:
+
+	// counts are merged under a lock, integer sums do not depend on the order
+	const uint64_t NumCounts = NumChannels * NumBins;
+	std::fill(Histograms, Histograms + NumCounts, uint64_t(0));
+	std::mutex Mutex;
+	const float BinScale = (float)NumBins / MaxError;
+	const uint64_t BlockHeight = Details::GetErrorBlockHeight(*this);
+	Details::ForEachErrorBlock(*this, Reference, BlockHeight, ThreadPool, [&](uint64_t, const float* Values, const float* References, uint64_t Num)
 	{
-		const double ThresholdDouble = static_cast<double>(ThresholdValue);
-		for (uint64_t Index = 0; Index < GetNumElements(); ++Index)
+		std::vector<uint64_t> BlockHistograms(Details::NumErrorHistogramCopies * NumCounts, 0);
+		Details::AccumulateErrorHistograms(Values, References, Num, NumChannels, BinScale, NumBins, BlockHistograms.data());
+		std::lock_guard<std::mutex> Lock(Mutex);
+		for (uint64_t Copy = 0; Copy < Details::NumErrorHistogramCopies; Copy++)
 		{
-			double& Value = reinterpret_cast<double*>(Storage)[Index];
-			if (Value < ThresholdDouble)
+			for (uint64_t Index = 0; Index < NumCounts; Index++)
 			{
-				Value = 0.0;
+				Histograms[Index] += BlockHistograms[Copy * NumCounts + Index];
 			}
 		}
-		break;
-	}
-	default:
-		UBPA_UCOMMON_NO_ENTRY();
-		break;
+	});
+}
+
+void UCommon::FTex2D::ConvertTo(FTex2D& Tex, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(Tex.Grid2D == Grid2D);
+	UBPA_UCOMMON_ASSERT(Tex.NumChannels == NumChannels);
+	UBPA_UCOMMON_ASSERT(Tex.StorageLayout == StorageLayout);
+
+	if (Tex.ElementType == ElementType)
+	{
+		std::memcpy(Tex.GetStorage(), Storage, GetStorageSizeInBytes());
+		return;
 	}
+
+	GetStorageView().ConvertTo(Tex.GetStorageView(), ThreadPool);
 }
 
-void UCommon::FTex2D::ImageInpainting(FTex2D CoverageData)
+UCommon::FTex2D UCommon::FTex2D::ConvertTo(EElementType InElementType, FThreadPool* ThreadPool) const
 {
-	UBPA_UCOMMON_ASSERT(Grid2D == CoverageData.Grid2D);
-	UBPA_UCOMMON_ASSERT(CoverageData.NumChannels == 1 || CoverageData.NumChannels == NumChannels);
-	// CoverageData stores coverage values as floats (including -1 as a "filled" marker in
-	// ImageInpainting Step 2). It must not be Uint8, which cannot represent negative values.
-	UBPA_UCOMMON_ASSERT(CoverageData.ElementType != EElementType::Uint8);
+	FTex2D Tex(Grid2D, NumChannels, InElementType, StorageLayout);
+	ConvertTo(Tex, ThreadPool);
+	return Tex;
+}
 
-	const uint64_t MaxSize = std::max(Grid2D.Width, Grid2D.Height);
+UCommon::FTex2D UCommon::FTex2D::ToFloat(FThreadPool* ThreadPool) const
+{
+	return ConvertTo(EElementType::Float, ThreadPool);
+}
 
-	uint64_t NumMips = 0;
-	while ((MaxSize >> NumMips) != 0)
+UCommon::FTex2D UCommon::FTex2D::ToHalf(FThreadPool* ThreadPool) const
+{
+	return ConvertTo(EElementType::Half, ThreadPool);
+}
+
+void UCommon::FTex2D::ToUint8(FTex2D& Tex, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(Tex.ElementType == EElementType::Uint8);
+	ConvertTo(Tex, ThreadPool);
+}
+
+UCommon::FTex2D UCommon::FTex2D::ToUint8(FThreadPool* ThreadPool) const
+{
+	return ConvertTo(EElementType::Uint8, ThreadPool);
+}
+
+UCommon::FTex2D UCommon::FTex2D::ToStorageLayout(ETex2DStorageLayout InStorageLayout, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+
+	if (InStorageLayout != ETex2DStorageLayout::Linear && StorageLayout != ETex2DStorageLayout::Linear && InStorageLayout != StorageLayout)
 	{
-		NumMips++;
+		return ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool).ToStorageLayout(InStorageLayout, ThreadPool);
 	}
 
-	std::vector<FTex2D> MipDataBuffer;
-	std::vector<FTex2D> CoverageDataBuffer;
+	FTex2D Tex(Grid2D, NumChannels, ElementType, InStorageLayout);
+	if (InStorageLayout == StorageLayout)
+	{
+		std::memcpy(Tex.Storage, Storage, GetStorageSizeInBytes());
+		return Tex;
+	}
 
-	MipDataBuffer.reserve(NumMips - 1);
-	CoverageDataBuffer.reserve(NumMips - 1);
+	if (InStorageLayout == ETex2DStorageLayout::Planar || StorageLayout == ETex2DStorageLayout::Planar)
+	{
+		const bool bPlanarizing = InStorageLayout == ETex2DStorageLayout::Planar;
+		uint8_t* PlanarStorage = static_cast<uint8_t*>(bPlanarizing ? Tex.Storage : Storage);
+		uint8_t* LinearStorage = static_cast<uint8_t*>(bPlanarizing ? Storage : Tex.Storage);
+		const uint64_t ElementSize = ElementGetSize(ElementType);
+		auto CopyRows = [&](uint64_t RowBegin, uint64_t RowEnd)
+		{
+			const uint64_t TexelBegin = RowBegin * Grid2D.Width;
+			Details::CopyPlanarTexels(PlanarStorage + TexelBegin * ElementSize, LinearStorage + TexelBegin * NumChannels * ElementSize,
+				ElementSize, Grid2D.GetArea(), NumChannels, (RowEnd - RowBegin) * Grid2D.Width, bPlanarizing);
+		};
 
-	std::vector<FTex2D*> MipDatas;
-	std::vector<FTex2D*> MipCoverageDatas;
+		if (ThreadPool)
+		{
+			ThreadPool->ParallelForRange(0, Grid2D.Height, 0, CopyRows);
+		}
+		else
+		{
+			CopyRows(0, Grid2D.Height);
+		}
+		return Tex;
+	}
 
-	MipDatas.push_back(this);
-	MipCoverageDatas.push_back(&CoverageData);
+	const bool bTiling = InStorageLayout == ETex2DStorageLayout::Tiled;
+	uint8_t* TiledStorage = static_cast<uint8_t*>(bTiling ? Tex.Storage : Storage);
+	uint8_t* LinearStorage = static_cast<uint8_t*>(bTiling ? Storage : Tex.Storage);
+	const uint64_t TexelSize = NumChannels * ElementGetSize(ElementType);
+	auto CopyTileRows = [&](uint64_t TileYBegin, uint64_t TileYEnd)
+	{
+		for (uint64_t TileY = TileYBegin; TileY < TileYEnd; TileY++)
+		{
+			uint8_t* Rows = LinearStorage + TileY * Details::TileExtent * Grid2D.Width * TexelSize;
+			Details::CopyTileRow(TiledStorage, Rows, Grid2D, TexelSize, TileY, bTiling);
+		}
+	};
 
-	// Step 1: Generate mipmap chain with coverage-aware downsampling
-	for (uint64_t MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	const uint64_t NumTilesY = Details::GetNumTiles(Grid2D.Height);
+	if (ThreadPool)
+	{
+		ThreadPool->ParallelForRange(0, NumTilesY, 0, CopyTileRows);
+	}
+	else
 	{
-		const uint64_t SourceMipSizeX = MipDatas[MipIndex - 1]->Grid2D.Width;
-		const uint64_t SourceMipSizeY = MipDatas[MipIndex - 1]->Grid2D.Height;
-		const uint64_t DestMipSizeX = (SourceMipSizeX + 1) >> 1;
-		const uint64_t DestMipSizeY = (SourceMipSizeY + 1) >> 1;
+		CopyTileRows(0, NumTilesY);
+	}
+	return Tex;
+}
 
-		MipDataBuffer.emplace_back(FGrid2D(DestMipSizeX, DestMipSizeY), NumChannels, ElementType);
-		CoverageDataBuffer.emplace_back(FGrid2D(DestMipSizeX, DestMipSizeY), CoverageData.NumChannels, CoverageData.ElementType);
+void UCommon::FTex2D::Clamp(float MinValue, float MaxValue, FThreadPool* ThreadPool)
+{
+	GetStorageView().Clamp(MinValue, MaxValue, ThreadPool);
+}
 
-		MipDatas.push_back(&MipDataBuffer.back());
-		MipCoverageDatas.push_back(&CoverageDataBuffer.back());
+void UCommon::FTex2D::Min(float MinValue, FThreadPool* ThreadPool)
+{
+	GetStorageView().Min(MinValue, ThreadPool);
+}
 
-		// Downsample the previous mip-level, taking into account which texels are mapped
-		FTex2D* NextMipData = MipDatas[MipIndex];
-		FTex2D* LastMipData = MipDatas[MipIndex - 1];
+void UCommon::FTex2D::Max(float MaxValue, FThreadPool* ThreadPool)
+{
+	GetStorageView().Max(MaxValue, ThreadPool);
+}
 
-		FTex2D* NextMipCoverageData = MipCoverageDatas[MipIndex];
-		FTex2D* LastMipCoverageData = MipCoverageDatas[MipIndex - 1];
+void UCommon::FTex2D::Threshold(float ThresholdValue, FThreadPool* ThreadPool)
+{
+	GetStorageView().Threshold(ThresholdValue, ThreadPool);
+}
 
-		for (const FUint64Vector2& Point : NextMipData->Grid2D)
+namespace UCommon
+{
+	namespace Details
+	{
+		/** A level of the ImageInpainting pyramid, levels above 0 borrow one arena. */
+		struct FInpaintingLevel
 		{
-			for (uint64_t C = 0; C < NumChannels; C++)
+			FTex2D Data;
+			FTex2D Coverage;
+			/** Per coverage element, set by the expand pass on the texels it fills. */
+			uint8_t* Filled;
+		};
+
+		/** Coverage-weighted 2x2 average of Src into the texels [TileMin, TileMax) of Dst. */
+		static void InpaintingPullTile(FInpaintingLevel& Dst, const FInpaintingLevel& Src, const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			const uint64_t NumChannels = Dst.Data.GetNumChannels();
+			const uint64_t CovNumCh = Dst.Coverage.GetNumChannels();
+			const FGrid2D& SrcGrid2D = Src.Data.GetGrid2D();
+			for (uint64_t Y = TileMin.Y; Y < TileMax.Y; Y++)
 			{
-				const uint64_t CovC = std::min(C, CoverageData.NumChannels - 1);
-				float AccumulatedColor = 0.f;
-				float Coverage = 0.f;
-
-				const uint64_t MinSourceY = (Point.Y + 0) * 2;
-				const uint64_t MaxSourceY = (Point.Y + 1) * 2;
-				for (uint64_t SourceY = MinSourceY; SourceY < MaxSourceY; SourceY++)
+				// the 2x2 footprint in the order of rows, with the edges clamped (and counted twice)
+				const uint64_t SourceYs[2] = { std::min(Y * 2, SrcGrid2D.Height - 1), std::min(Y * 2 + 1, SrcGrid2D.Height - 1) };
+				for (uint64_t X = TileMin.X; X < TileMax.X; X++)
 				{
-					const uint64_t ClampedSourceY = std::min(SourceY, LastMipData->Grid2D.Height - 1);
-					const uint64_t MinSourceX = (Point.X + 0) * 2;
-					const uint64_t MaxSourceX = (Point.X + 1) * 2;
-					for (uint64_t SourceX = MinSourceX; SourceX < MaxSourceX; SourceX++)
+					const uint64_t SourceXs[2] = { std::min(X * 2, SrcGrid2D.Width - 1), std::min(X * 2 + 1, SrcGrid2D.Width - 1) };
+					const FUint64Vector2 SourcePoints[4] =
+					{
+						FUint64Vector2(SourceXs[0], SourceYs[0]),
+						FUint64Vector2(SourceXs[1], SourceYs[0]),
+						FUint64Vector2(SourceXs[0], SourceYs[1]),
+						FUint64Vector2(SourceXs[1], SourceYs[1]),
+					};
+					const FUint64Vector2 Point(X, Y);
+					for (uint64_t CovC = 0; CovC < CovNumCh; CovC++)
 					{
-						const uint64_t ClampedSourceX = std::min(SourceX, LastMipData->Grid2D.Width - 1);
-						const float SourceColor = LastMipData->GetFloat(FUint64Vector2(ClampedSourceX, ClampedSourceY), C);
-						const float SourceCoverage = LastMipCoverageData->GetFloat(FUint64Vector2(ClampedSourceX, ClampedSourceY), CovC);
-						if (SourceCoverage > 0.f)
+						float SourceCoverages[4];
+						float Coverage = 0.f;
+						for (uint64_t i = 0; i < 4; i++)
 						{
-							AccumulatedColor += SourceColor * SourceCoverage;
-							Coverage += SourceCoverage;
+							SourceCoverages[i] = Src.Coverage.GetFloat(SourcePoints[i], CovC);
+							if (SourceCoverages[i] > 0.f)
+							{
+								Coverage += SourceCoverages[i];
+							}
 						}
-					}
-				}
 
-				float DestColor;
-				float DestCoverage;
-				if (Coverage > 0.f)
-				{
-					DestColor = AccumulatedColor / Coverage;
-					DestCoverage = Coverage / 4.f; // 2D: divide by 4 (2x2)
-				}
-				else
-				{
-					DestColor = 0.f;
-					DestCoverage = 0.f;
+						const uint64_t CStart = (CovNumCh == 1) ? 0 : CovC;
+						const uint64_t CEnd = (CovNumCh == 1) ? NumChannels : CovC + 1;
+						for (uint64_t C = CStart; C < CEnd; C++)
+						{
+							float AccumulatedColor = 0.f;
+							for (uint64_t i = 0; i < 4; i++)
+							{
+								if (SourceCoverages[i] > 0.f)
+								{
+									AccumulatedColor += Src.Data.GetFloat(SourcePoints[i], C) * SourceCoverages[i];
+								}
+							}
+							Dst.Data.SetFloat(Point, C, Coverage > 0.f ? AccumulatedColor / Coverage : 0.f);
+						}
+						Dst.Coverage.SetFloat(Point, CovC, Coverage > 0.f ? Coverage / 4.f : 0.f); // 2D: divide by 4 (2x2)
+					}
 				}
-
-				NextMipData->SetFloat(Point, C, DestColor);
-				NextMipCoverageData->SetFloat(Point, CovC, DestCoverage);
 			}
 		}
-	}
-
-	// Step 2: Expand texels which are mapped into adjacent texels which are not mapped
-	for (uint64_t MipIndex = 0; MipIndex < NumMips; MipIndex++)
-	{
-		FTex2D* MipLevelData = MipDatas[MipIndex];
-		FTex2D* MipLevelCoverageData = MipCoverageDatas[MipIndex];
 
-		// With CovNumCh==1 or CovNumCh==NumChannels constraint, iterate over coverage channels.
-		// For each coverage channel, fill all color channels that share it.
-		const uint64_t CovNumCh = MipLevelCoverageData->GetNumChannels();
-
-		for (const FUint64Vector2& Point : MipLevelData->Grid2D)
+		/**
+		 * Fill the uncovered texels in [TileMin, TileMax) of Level from their covered 3x3 neighbors.
+		 * Only uncovered texels are written and only covered ones are read, so tiles are independent.
+		 */
+		static void InpaintingExpandTile(FInpaintingLevel& Level, const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
 		{
-			for (uint64_t CovC = 0; CovC < CovNumCh; CovC++)
+			// Weight matrix: cardinal neighbors (up/down/left/right) are strongly preferred
+			// over diagonal neighbors, so the expansion prioritizes axis-aligned spreading.
+			// Center is 0 (we only fill uncovered pixels, not overwrite the current pixel).
+			static const float Weights[3][3] =
+			{
+				{ 1.f, 255.f, 1.f },
+				{ 255.f, 0.f, 255.f },
+				{ 1.f, 255.f, 1.f },
+			};
+
+			const uint64_t NumChannels = Level.Data.GetNumChannels();
+			const uint64_t CovNumCh = Level.Coverage.GetNumChannels();
+			const FGrid2D& Grid2D = Level.Data.GetGrid2D();
+			std::vector<float> AccumulatedColors(NumChannels);
+			for (uint64_t Y = TileMin.Y; Y < TileMax.Y; Y++)
 			{
-				const float DestCoverage = MipLevelCoverageData->GetFloat(Point, CovC);
-				if (DestCoverage == 0.f)
+				const uint64_t MinSourceY = Y > 0 ? Y - 1 : 0;
+				const uint64_t MaxSourceY = std::min(Y + 1, Grid2D.Height - 1);
+				for (uint64_t X = TileMin.X; X < TileMax.X; X++)
 				{
-					// Determine which color channels share this CovC
-					// CovNumCh==1: all color channels; CovNumCh==NumChannels: only C==CovC
-					const uint64_t CStart = (CovNumCh == 1) ? 0 : CovC;
-					const uint64_t CEnd   = (CovNumCh == 1) ? NumChannels : CovC + 1;
-
-					// Accumulate per-channel color sums from covered neighbors
-					std::vector<float> AccumulatedColors(CEnd - CStart, 0.f);
-					float Coverage = 0.f;
-
-					const uint64_t MinSourceY = static_cast<uint64_t>(std::max(static_cast<int64_t>(Point.Y) - 1, static_cast<int64_t>(0)));
-					const uint64_t MaxSourceY = static_cast<uint64_t>(std::min(static_cast<int64_t>(Point.Y) + 1, static_cast<int64_t>(MipLevelData->Grid2D.Height - 1)));
-					for (uint64_t SourceY = MinSourceY; SourceY <= MaxSourceY; SourceY++)
+					const uint64_t MinSourceX = X > 0 ? X - 1 : 0;
+					const uint64_t MaxSourceX = std::min(X + 1, Grid2D.Width - 1);
+					const FUint64Vector2 Point(X, Y);
+					// With CovNumCh==1 or CovNumCh==NumChannels constraint, iterate over coverage channels.
+					// For each coverage channel, fill all color channels that share it.
+					for (uint64_t CovC = 0; CovC < CovNumCh; CovC++)
 					{
-						const uint64_t MinSourceX = static_cast<uint64_t>(std::max(static_cast<int64_t>(Point.X) - 1, static_cast<int64_t>(0)));
-						const uint64_t MaxSourceX = static_cast<uint64_t>(std::min(static_cast<int64_t>(Point.X) + 1, static_cast<int64_t>(MipLevelData->Grid2D.Width - 1)));
-						for (uint64_t SourceX = MinSourceX; SourceX <= MaxSourceX; SourceX++)
+						if (Level.Coverage.GetFloat(Point, CovC) != 0.f)
 						{
-							const float SourceCoverage = MipLevelCoverageData->GetFloat(FUint64Vector2(SourceX, SourceY), CovC);
-							if (SourceCoverage > 0.f)
+							continue;
+						}
+
+						const uint64_t CStart = (CovNumCh == 1) ? 0 : CovC;
+						const uint64_t CEnd = (CovNumCh == 1) ? NumChannels : CovC + 1;
+						std::fill(AccumulatedColors.begin() + CStart, AccumulatedColors.begin() + CEnd, 0.f);
+						float Coverage = 0.f;
+						for (uint64_t SourceY = MinSourceY; SourceY <= MaxSourceY; SourceY++)
+						{
+							for (uint64_t SourceX = MinSourceX; SourceX <= MaxSourceX; SourceX++)
 							{
-								// Weight matrix: cardinal neighbors (up/down/left/right) are strongly preferred
-								// over diagonal neighbors, so the expansion prioritizes axis-aligned spreading.
-								// Center is 0 (we only fill uncovered pixels, not overwrite the current pixel).
-								static const float Weights[3][3] =
-								{
-									{ 1.f, 255.f, 1.f },
-									{ 255.f, 0.f, 255.f },
-									{ 1.f, 255.f, 1.f },
-								};
-								const float Weight = Weights[SourceY - Point.Y + 1][SourceX - Point.X + 1];
-								Coverage += SourceCoverage * Weight;
-								for (uint64_t C = CStart; C < CEnd; C++)
+								const FUint64Vector2 SourcePoint(SourceX, SourceY);
+								const float SourceCoverage = Level.Coverage.GetFloat(SourcePoint, CovC);
+								if (SourceCoverage > 0.f)
 								{
-									const float SourceColor = MipLevelData->GetFloat(FUint64Vector2(SourceX, SourceY), C);
-									AccumulatedColors[C - CStart] += SourceColor * SourceCoverage * Weight;
+									const float Weight = Weights[SourceY - Y + 1][SourceX - X + 1];
+									Coverage += SourceCoverage * Weight;
+									for (uint64_t C = CStart; C < CEnd; C++)
+									{
+										AccumulatedColors[C] += Level.Data.GetFloat(SourcePoint, C) * SourceCoverage * Weight;
+									}
 								}
 							}
 						}
+
+						if (Coverage > 0.f)
+						{
+							for (uint64_t C = CStart; C < CEnd; C++)
+							{
+								Level.Data.SetFloat(Point, C, AccumulatedColors[C] / Coverage);
+							}
+							Level.Filled[Level.Coverage.GetIndex(Point, CovC)] = 1;
+						}
 					}
+				}
+			}
+		}
 
-					if (Coverage > 0.f)
+		/** Fill the texels in [TileMin, TileMax) of Dst still uncovered after the expand pass by bilinear upsampling of Src. */
+		static void InpaintingPushTile(FInpaintingLevel& Dst, const FInpaintingLevel& Src, const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			const uint64_t NumChannels = Dst.Data.GetNumChannels();
+			const uint64_t CovNumCh = Dst.Coverage.GetNumChannels();
+			const FGrid2D& Grid2D = Dst.Data.GetGrid2D();
+			std::vector<float> SampleBuffer(NumChannels);
+			for (uint64_t Y = TileMin.Y; Y < TileMax.Y; Y++)
+			{
+				for (uint64_t X = TileMin.X; X < TileMax.X; X++)
+				{
+					const FUint64Vector2 Point(X, Y);
+					bool bSampled = false;
+					// Iterate over coverage channels; each CovC governs a range of color channels.
+					// CovNumCh==1: CovC=0 covers all; CovNumCh==NumChannels: CovC covers only C==CovC.
+					for (uint64_t CovC = 0; CovC < CovNumCh; CovC++)
 					{
+						if (Dst.Coverage.GetFloat(Point, CovC) != 0.f || Dst.Filled[Dst.Coverage.GetIndex(Point, CovC)])
+						{
+							continue;
+						}
+
+						if (!bSampled)
+						{
+							// Use bilinear sampling for smoother results
+							Src.Data.BilinearSample(SampleBuffer.data(), Grid2D.GetTexcoord(Point), ETextureAddress::Clamp, ETextureAddress::Clamp);
+							bSampled = true;
+						}
+						const uint64_t CStart = (CovNumCh == 1) ? 0 : CovC;
+						const uint64_t CEnd = (CovNumCh == 1) ? NumChannels : CovC + 1;
 						for (uint64_t C = CStart; C < CEnd; C++)
 						{
-							MipLevelData->SetFloat(Point, C, AccumulatedColors[C - CStart] / Coverage);
+							Dst.Data.SetFloat(Point, C, SampleBuffer[C]);
 						}
-						MipLevelCoverageData->SetFloat(Point, CovC, -1.f); // Mark as filled
 					}
 				}
 			}
 		}
 	}
+}
 
-	// Step 3: Fill zero coverage texels with closest colors using mips
-	for (uint64_t MipIndexOffset = 2; MipIndexOffset <= NumMips; MipIndexOffset++)
+void UCommon::FTex2D::ImageInpainting(const FTex2D& CoverageData, FThreadPool* ThreadPool)
+{
+	UBPA_UCOMMON_ASSERT(Grid2D == CoverageData.Grid2D);
+	UBPA_UCOMMON_ASSERT(CoverageData.NumChannels == 1 || CoverageData.NumChannels == NumChannels);
+
+	if (StorageLayout != ETex2DStorageLayout::Linear || CoverageData.StorageLayout != ETex2DStorageLayout::Linear)
 	{
-		const uint64_t MipIndex = NumMips - MipIndexOffset;
+		FTex2D LinearTex = ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool);
+		if (CoverageData.StorageLayout == ETex2DStorageLayout::Linear)
+		{
+			LinearTex.ImageInpainting(CoverageData, ThreadPool);
+		}
+		else
+		{
+			LinearTex.ImageInpainting(CoverageData.ToStorageLayout(ETex2DStorageLayout::Linear, ThreadPool), ThreadPool);
+		}
+		// same layout, the copy assignment writes into the current storage
+		const FTex2D Result = LinearTex.ToStorageLayout(StorageLayout, ThreadPool);
+		*this = Result;
+		return;
+	}
 
-		// Source from higher mip, taking into account which texels are mapped
-		FTex2D* DstMipData = MipDatas[MipIndex];
-		FTex2D* SrcMipData = MipDatas[MipIndex + 1];
+	const uint64_t MaxSize = std::max(Grid2D.Width, Grid2D.Height);
 
-		FTex2D* DstMipCoverageData = MipCoverageDatas[MipIndex];
-		FTex2D* SrcMipCoverageData = MipCoverageDatas[MipIndex + 1];
+	uint64_t NumMips = 0;
+	while ((MaxSize >> NumMips) != 0)
+	{
+		NumMips++;
+	}
 
-		const std::unique_ptr<float[]> SampleBuffer = std::make_unique<float[]>(NumChannels);
-		const std::unique_ptr<float[]> CoverageSampleBuffer = std::make_unique<float[]>(SrcMipCoverageData->GetNumChannels());
-		const uint64_t CovNumCh = DstMipCoverageData->GetNumChannels();
+	// Levels above 0 keep the element types of the data and the coverage, so that the results don't change
+	// with the storage; Uint8 coverage can't hold the averaged coverage and uses Float there.
+	const uint64_t CovNumCh = CoverageData.NumChannels;
+	const EElementType PyramidCoverageType = CoverageData.ElementType == EElementType::Uint8 ? EElementType::Float : CoverageData.ElementType;
 
-		for (const FUint64Vector2& Point : DstMipData->Grid2D)
+	// One arena for the data, coverage and filled flags of all levels
+	constexpr uint64_t ArenaAlignment = Tex2DStorageAlignment;
+	auto AlignUp = [](uint64_t Size) { return (Size + ArenaAlignment - 1) / ArenaAlignment * ArenaAlignment; };
+	std::vector<FGrid2D> MipGrid2Ds{ Grid2D };
+	for (uint64_t MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	{
+		const FGrid2D& Last = MipGrid2Ds.back();
+		MipGrid2Ds.emplace_back((Last.Width + 1) >> 1, (Last.Height + 1) >> 1);
+	}
+	uint64_t ArenaSize = 0;
+	for (uint64_t MipIndex = 0; MipIndex < NumMips; MipIndex++)
+	{
+		const uint64_t NumTexels = MipGrid2Ds[MipIndex].Width * MipGrid2Ds[MipIndex].Height;
+		if (MipIndex > 0)
 		{
-			const FVector2f Texcoord = DstMipData->Grid2D.GetTexcoord(Point);
+			ArenaSize += AlignUp(GetRequiredStorageSizeInBytes(MipGrid2Ds[MipIndex], NumChannels, ElementType));
+			ArenaSize += AlignUp(GetRequiredStorageSizeInBytes(MipGrid2Ds[MipIndex], CovNumCh, PyramidCoverageType));
+		}
+		ArenaSize += AlignUp(NumTexels * CovNumCh);
+	}
+	// a texture so that the arena comes from the current storage pool
+	FTex2D Arena(FGrid2D(ArenaSize, 1), 1, EElementType::Uint8);
+	uint8_t* ArenaCursor = static_cast<uint8_t*>(Arena.GetStorage());
+	auto Allocate = [&](uint64_t Size)
+	{
+		uint8_t* Block = ArenaCursor;
+		ArenaCursor += AlignUp(Size);
+		return Block;
+	};
 
-			// Iterate over coverage channels; each CovC governs a range of color channels.
-			// CovNumCh==1: CovC=0 covers all; CovNumCh==NumChannels: CovC covers only C==CovC.
-			for (uint64_t CovC = 0; CovC < CovNumCh; CovC++)
-			{
-				const float DstCoverage = DstMipCoverageData->GetFloat(Point, CovC);
+	std::vector<Details::FInpaintingLevel> Levels(NumMips);
+	for (uint64_t MipIndex = 0; MipIndex < NumMips; MipIndex++)
+	{
+		Details::FInpaintingLevel& Level = Levels[MipIndex];
+		const FGrid2D& MipGrid2D = MipGrid2Ds[MipIndex];
+		if (MipIndex == 0)
+		{
+			// coverage is only read, so level 0 borrows CoverageData
+			Level.Data = FTex2D(Grid2D, NumChannels, EOwnership::DoNotTakeOwnership, ElementType, Storage);
+			Level.Coverage = FTex2D(Grid2D, CovNumCh, EOwnership::DoNotTakeOwnership, CoverageData.ElementType, CoverageData.Storage);
+		}
+		else
+		{
+			Level.Data = FTex2D(MipGrid2D, NumChannels, EOwnership::DoNotTakeOwnership, ElementType, Allocate(GetRequiredStorageSizeInBytes(MipGrid2D, NumChannels, ElementType)));
+			Level.Coverage = FTex2D(MipGrid2D, CovNumCh, EOwnership::DoNotTakeOwnership, PyramidCoverageType, Allocate(GetRequiredStorageSizeInBytes(MipGrid2D, CovNumCh, PyramidCoverageType)));
+		}
+		const uint64_t NumFlags = MipGrid2D.Width * MipGrid2D.Height * CovNumCh;
+		Level.Filled = Allocate(NumFlags);
+		std::memset(Level.Filled, 0, NumFlags);
+	}
 
-				// Point upsample mip data for zero coverage texels
-				if (DstCoverage == 0.f)
-				{
-					const uint64_t CStart = (CovNumCh == 1) ? 0 : CovC;
-					const uint64_t CEnd   = (CovNumCh == 1) ? NumChannels : CovC + 1;
+	// Step 1: Generate mipmap chain with coverage-aware downsampling
+	for (uint64_t MipIndex = 1; MipIndex < NumMips; MipIndex++)
+	{
+		Details::ForEachTile(MipGrid2Ds[MipIndex], ThreadPool, [&](const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			Details::InpaintingPullTile(Levels[MipIndex], Levels[MipIndex - 1], TileMin, TileMax);
+		});
+	}
 
-					// Use bilinear sampling for smoother results
-					SrcMipData->BilinearSample(SampleBuffer.get(), Texcoord, ETextureAddress::Clamp, ETextureAddress::Clamp);
-					for (uint64_t C = CStart; C < CEnd; C++)
-					{
-						DstMipData->SetFloat(Point, C, SampleBuffer[C]);
-					}
+	// Step 2: Expand texels which are mapped into adjacent texels which are not mapped
+	for (uint64_t MipIndex = 0; MipIndex < NumMips; MipIndex++)
+	{
+		Details::ForEachTile(MipGrid2Ds[MipIndex], ThreadPool, [&](const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			Details::InpaintingExpandTile(Levels[MipIndex], TileMin, TileMax);
+		});
+	}
 
-					// Also sample coverage
-					SrcMipCoverageData->BilinearSample(CoverageSampleBuffer.get(), Texcoord, ETextureAddress::Clamp, ETextureAddress::Clamp);
-					DstMipCoverageData->SetFloat(Point, CovC, CoverageSampleBuffer[CovC]);
-				}
-			}
-		}
+	// Step 3: Fill zero coverage texels with closest colors using mips
+	for (uint64_t MipIndexOffset = 2; MipIndexOffset <= NumMips; MipIndexOffset++)
+	{
+		const uint64_t MipIndex = NumMips - MipIndexOffset;
+		Details::ForEachTile(MipGrid2Ds[MipIndex], ThreadPool, [&](const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			Details::InpaintingPushTile(Levels[MipIndex], Levels[MipIndex + 1], TileMin, TileMax);
+		});
 	}
 }
 
@@ -1083,24 +3535,25 @@ UCommon::FTexCube UCommon::FTex2D::ToTexCube() const
 
 UCommon::FTex2D& UCommon::FTex2D::operator=(FTex2D&& Rhs) noexcept
 {
-	if (this != &Rhs)
-	{
-		if (Ownership == EOwnership::TakeOwnership)
-		{
-			UBPA_UCOMMON_FREE(Storage);
-		}
+	if (this != &Rhs)
+	{
+		FreeStorage();
 
 		Grid2D = Rhs.Grid2D;
 		NumChannels = Rhs.NumChannels;
 		Ownership = Rhs.Ownership;
 		ElementType = Rhs.ElementType;
 		Storage = Rhs.Storage;
+		StorageLayout = Rhs.StorageLayout;
+		bInternalStorage = Rhs.bInternalStorage;
 
 		Rhs.Grid2D = FGrid2D();
 		Rhs.NumChannels = 0;
 		Rhs.Ownership = EOwnership::DoNotTakeOwnership;
 		Rhs.ElementType = EElementType();
 		Rhs.Storage = nullptr;
+		Rhs.StorageLayout = ETex2DStorageLayout::Linear;
+		Rhs.bInternalStorage = false;
 	}
 	return *this;
 }
@@ -1117,21 +3570,20 @@ UCommon::FTex2D& UCommon::FTex2D::operator=(const FTex2D& Rhs)
 			}
 			else
 			{
-				if (Ownership == EOwnership::TakeOwnership)
-				{
-					UBPA_UCOMMON_FREE(Storage);
-				}
+				FreeStorage();
 
 				Grid2D = Rhs.Grid2D;
 				NumChannels = Rhs.NumChannels;
 				ElementType = Rhs.ElementType;
+				StorageLayout = Rhs.StorageLayout;
 
 				if (Rhs.Ownership == EOwnership::TakeOwnership)
 				{
 					UBPA_UCOMMON_ASSERT(Rhs.Storage);
 
 					Ownership = EOwnership::TakeOwnership;
-					Storage = UBPA_UCOMMON_MALLOC(Rhs.GetStorageSizeInBytes());
+					Storage = AllocateTex2DStorage(Rhs.GetStorageSizeInBytes());
+					bInternalStorage = Storage != nullptr;
 					if (Storage)
 					{
 						memcpy(Storage, Rhs.Storage, Rhs.GetStorageSizeInBytes());
@@ -1142,6 +3594,7 @@ UCommon::FTex2D& UCommon::FTex2D::operator=(const FTex2D& Rhs)
 						NumChannels = 0;
 						ElementType = EElementType();
 						Ownership = EOwnership::DoNotTakeOwnership;
+						StorageLayout = ETex2DStorageLayout::Linear;
 						UBPA_UCOMMON_ASSERT(!Storage);
 					}
 				}
@@ -1149,6 +3602,7 @@ UCommon::FTex2D& UCommon::FTex2D::operator=(const FTex2D& Rhs)
 				{
 					Ownership = EOwnership::DoNotTakeOwnership;
 					Storage = Rhs.Storage;
+					bInternalStorage = false;
 				}
 			}
 		}
@@ -1162,24 +3616,62 @@ UCommon::FTex2D& UCommon::FTex2D::operator=(const FTex2D& Rhs)
 
 void UCommon::FTex2D::Copy(FTex2D& Dst, const FUint64Vector2& DstPoint, const FTex2D& Src, const FUint64Vector2& SrcPoint, const FUint64Vector2& Range)
 {
-	UBPA_UCOMMON_ASSERT(Dst.ElementType == Src.ElementType);
-	UBPA_UCOMMON_ASSERT(Dst.NumChannels == Src.NumChannels);
 	const FGrid2D RangeGrid2D(Range);
-	const uint64_t PixelSize = ElementGetSize(Dst.ElementType) * Dst.NumChannels;
-	for (const auto& RangePoint : RangeGrid2D)
+	if (RangeGrid2D.IsAreaEmpty())
 	{
-		uint8_t* DstBuffer = reinterpret_cast<uint8_t*>(Dst.Storage) + Dst.GetGrid2D().GetIndex(DstPoint + RangePoint) * PixelSize;
-		const uint8_t* SrcBuffer = reinterpret_cast<uint8_t*>(Src.Storage) + Src.GetGrid2D().GetIndex(SrcPoint + RangePoint) * PixelSize;
-		std::memcpy(DstBuffer, SrcBuffer, PixelSize);
+		return;
 	}
+	Copy(Dst.GetView(DstPoint, RangeGrid2D), Src.GetView(SrcPoint, RangeGrid2D));
+}
+
+void UCommon::FTex2D::Copy(const FTex2DView& Dst, const FConstTex2DView& Src) noexcept
+{
+	Dst.CopyFrom(Src);
+}
+
+void UCommon::FTex2D::SerializeLayout(IArchive& Archive)
+{
+	Details::SerializeLayout(Archive, Grid2D, NumChannels, Ownership, ElementType);
 }
 
 void UCommon::FTex2D::Serialize(IArchive& Archive)
 {
-	Archive.ByteSerialize(Grid2D);
-	Archive.ByteSerialize(NumChannels);
-	Archive.ByteSerialize(Ownership);
-	Archive.ByteSerialize(ElementType);
+	SerializeLayout(Archive);
+	if (Archive.GetState() == IArchive::EState::Loading)
+	{
+		// the texels are saved in Linear order
+		StorageLayout = ETex2DStorageLayout::Linear;
+	}
+	if (StorageLayout == ETex2DStorageLayout::Tiled)
+	{
+		// saved in Linear order, one row of tiles at a time
+		const uint64_t TexelSize = NumChannels * ElementGetSize(ElementType);
+		const uint64_t RowSize = Grid2D.Width * TexelSize;
+		std::vector<uint8_t> Rows(Details::TileExtent * RowSize);
+		for (uint64_t TileY = 0; TileY < Details::GetNumTiles(Grid2D.Height); TileY++)
+		{
+			Details::CopyTileRow(static_cast<uint8_t*>(Storage), Rows.data(), Grid2D, TexelSize, TileY, false);
+			const uint64_t NumRows = std::min(Details::TileExtent, Grid2D.Height - TileY * Details::TileExtent);
+			Archive.Serialize(Rows.data(), NumRows * RowSize);
+		}
+		return;
+	}
+	if (StorageLayout == ETex2DStorageLayout::Planar)
+	{
+		// saved interleaved, one band of rows at a time
+		const uint64_t ElementSize = ElementGetSize(ElementType);
+		const uint64_t RowSize = Grid2D.Width * NumChannels * ElementSize;
+		const uint64_t BandHeight = GetDefaultBandHeight();
+		std::vector<uint8_t> Rows(std::min(BandHeight, Grid2D.Height) * RowSize);
+		for (uint64_t RowBegin = 0; RowBegin < Grid2D.Height; RowBegin += BandHeight)
+		{
+			const uint64_t NumRows = std::min(BandHeight, Grid2D.Height - RowBegin);
+			Details::CopyPlanarTexels(static_cast<uint8_t*>(Storage) + RowBegin * Grid2D.Width * ElementSize, Rows.data(),
+				ElementSize, Grid2D.GetArea(), NumChannels, NumRows * Grid2D.Width, false);
+			Archive.Serialize(Rows.data(), NumRows * RowSize);
+		}
+		return;
+	}
 	if (Archive.GetState() == IArchive::EState::Loading)
 	{
 		UBPA_UCOMMON_ASSERT(Storage == nullptr);
@@ -1187,12 +3679,534 @@ void UCommon::FTex2D::Serialize(IArchive& Archive)
 		if (Size == 0)
 		{
 			Storage = nullptr;
+			Ownership = EOwnership::TakeOwnership;
+			return;
+		}
+
+		// zero-copy when the archive exposes its storage (e.g. FMappedFileArchive)
+		const void* View = Archive.SerializeView(Size);
+		if (!View && Archive.CanSerializeView())
+		{
+			// truncated or corrupt archive
+			Reset();
+			return;
+		}
+		if (View && reinterpret_cast<uintptr_t>(View) % ElementGetSize(ElementType) == 0)
+		{
+			Storage = const_cast<void*>(View);
+			Ownership = EOwnership::DoNotTakeOwnership;
+			return;
+		}
+
+		Storage = AllocateTex2DStorage(Size);
+		UBPA_UCOMMON_ASSERT(Storage);
+		Ownership = EOwnership::TakeOwnership;
+		bInternalStorage = true;
+		if (View)
+		{
+			// misaligned for the element type
+			std::memcpy(Storage, View, Size);
+			return;
+		}
+	}
+	Archive.Serialize(Storage, GetStorageSizeInBytes());
+}
+
+uint64_t UCommon::FTex2D::GetDefaultBandHeight() const noexcept
+{
+	const uint64_t RowSize = Grid2D.Width * NumChannels * ElementGetSize(ElementType);
+	return RowSize > 0 ? std::max<uint64_t>(1, (uint64_t(4) << 20) / RowSize) : 1;
+}
+
+void UCommon::FTex2D::SerializeBandsImpl(IArchive& Archive, uint64_t BandHeight, FBandFunction Function, void* Context, FThreadPool* ThreadPool)
+{
+	const bool bLoading = Archive.GetState() == IArchive::EState::Loading;
+	UBPA_UCOMMON_ASSERT(bLoading || StorageLayout == ETex2DStorageLayout::Linear);
+	SerializeLayout(Archive);
+	bool bStreaming = true;
+	if (bLoading)
+	{
+		UBPA_UCOMMON_ASSERT(Storage == nullptr);
+		StorageLayout = ETex2DStorageLayout::Linear;
+		const uint64_t Size = GetStorageSizeInBytes();
+		Ownership = EOwnership::TakeOwnership;
+		if (Size == 0)
+		{
+			Storage = nullptr;
+			return;
+		}
+
+		const void* View = Archive.SerializeView(Size);
+		if (!View && Archive.CanSerializeView())
+		{
+			Reset();
+			return;
+		}
+		if (View && reinterpret_cast<uintptr_t>(View) % ElementGetSize(ElementType) == 0)
+		{
+			Storage = const_cast<void*>(View);
+			Ownership = EOwnership::DoNotTakeOwnership;
 		}
 		else
 		{
-			Storage = UBPA_UCOMMON_MALLOC(Size);
+			Storage = AllocateTex2DStorage(Size);
 			UBPA_UCOMMON_ASSERT(Storage);
+			bInternalStorage = true;
+			if (View)
+			{
+				std::memcpy(Storage, View, Size);
+			}
 		}
+		bStreaming = View == nullptr;
+	}
+
+	if (BandHeight == 0)
+	{
+		BandHeight = GetDefaultBandHeight();
+	}
+	const uint64_t RowSize = Grid2D.Width * NumChannels * ElementGetSize(ElementType);
+	const uint64_t NumBands = (Grid2D.Height + BandHeight - 1) / BandHeight;
+
+	auto SerializeBand = [&](uint64_t Band)
+	{
+		const uint64_t RowBegin = Band * BandHeight;
+		const uint64_t RowEnd = std::min(RowBegin + BandHeight, Grid2D.Height);
+		if (bStreaming && RowEnd > RowBegin && RowSize > 0)
+		{
+			Archive.Serialize(static_cast<uint8_t*>(Storage) + RowBegin * RowSize, (RowEnd - RowBegin) * RowSize);
+		}
+	};
+	auto ProcessBand = [=](uint64_t Band)
+	{
+		const uint64_t RowBegin = Band * BandHeight;
+		Function(Context, RowBegin, std::min(RowBegin + BandHeight, Grid2D.Height));
+	};
+
+	if (!ThreadPool)
+	{
+		for (uint64_t Band = 0; Band < NumBands; Band++)
+		{
+			if (bLoading)
+			{
+				SerializeBand(Band);
+				ProcessBand(Band);
+			}
+			else
+			{
+				ProcessBand(Band);
+				SerializeBand(Band);
+			}
+		}
+		return;
+	}
+
+	// one band in flight on the pool while the caller serializes the neighbouring band
+	TTaskFuture<void> Pending;
+	if (bLoading)
+	{
+		for (uint64_t Band = 0; Band < NumBands; Band++)
+		{
+			SerializeBand(Band);
+			if (Pending.IsValid())
+			{
+				Pending.Wait();
+			}
+			Pending = ThreadPool->EnqueueTask([ProcessBand, Band] { ProcessBand(Band); });
+		}
+	}
+	else if (NumBands > 0)
+	{
+		Pending = ThreadPool->EnqueueTask([ProcessBand] { ProcessBand(0); });
+		for (uint64_t Band = 0; Band < NumBands; Band++)
+		{
+			Pending.Wait();
+			if (Band + 1 < NumBands)
+			{
+				Pending = ThreadPool->EnqueueTask([ProcessBand, Band] { ProcessBand(Band + 1); });
+			}
+			else
+			{
+				Pending.Reset();
+			}
+			SerializeBand(Band);
+		}
+	}
+	if (Pending.IsValid())
+	{
+		Pending.Wait();
+	}
+}
+
+bool UCommon::FTex2D::SaveFileParallel(const char* FilePath, FThreadPool& ThreadPool, uint64_t BandHeight) const
+{
+	if (StorageLayout != ETex2DStorageLayout::Linear)
+	{
+		return ToStorageLayout(ETex2DStorageLayout::Linear, &ThreadPool).SaveFileParallel(FilePath, ThreadPool, BandHeight);
+	}
+	const uint64_t Size = GetStorageSizeInBytes();
+	uint64_t DataOffset = 0;
+	{
+		FFileArchive Archive(IArchive::EState::Saving, FilePath);
+		if (!Archive.IsValid())
+		{
+			return false;
+		}
+		// Saving doesn't modify the layout
+		const_cast<FTex2D*>(this)->SerializeLayout(Archive);
+		DataOffset = Archive.Tell();
+		// the (empty) version map goes after the storage, written below
+		Archive.Seek(DataOffset + Size);
+	}
+	if (Size == 0)
+	{
+		return true;
+	}
+
+	FRandomAccessFile File(IArchive::EState::Saving, FilePath);
+	if (!File.IsValid())
+	{
+		return false;
+	}
+
+	if (BandHeight == 0)
+	{
+		BandHeight = GetDefaultBandHeight();
+	}
+	const uint64_t RowSize = Size / Grid2D.Height;
+	const uint64_t NumBands = (Grid2D.Height + BandHeight - 1) / BandHeight;
+	std::atomic<bool> bSucceeded{ true };
+	ThreadPool.ParallelFor(0, NumBands, 1, [&](uint64_t Band)
+	{
+		const uint64_t RowBegin = Band * BandHeight;
+		const uint64_t RowEnd = std::min(RowBegin + BandHeight, Grid2D.Height);
+		if (!File.WriteAt(DataOffset + RowBegin * RowSize, static_cast<const uint8_t*>(Storage) + RowBegin * RowSize, (RowEnd - RowBegin) * RowSize))
+		{
+			bSucceeded.store(false, std::memory_order_relaxed);
+		}
+	});
+	return bSucceeded.load(std::memory_order_relaxed);
+}
+
+bool UCommon::FTex2D::LoadFileParallel(const char* FilePath, FThreadPool& ThreadPool, uint64_t BandHeight)
+{
+	UBPA_UCOMMON_ASSERT(Storage == nullptr);
+	uint64_t DataOffset = 0;
+	{
+		FFileArchive Archive(IArchive::EState::Loading, FilePath);
+		if (!Archive.IsValid())
+		{
+			return false;
+		}
+		SerializeLayout(Archive);
+		DataOffset = Archive.Tell();
+	}
+	Ownership = EOwnership::TakeOwnership;
+	const uint64_t Size = GetStorageSizeInBytes();
+	if (Size == 0)
+	{
+		Storage = nullptr;
+		return true;
+	}
+
+	FRandomAccessFile File(IArchive::EState::Loading, FilePath);
+	if (!File.IsValid())
+	{
+		*this = FTex2D();
+		return false;
+	}
+
+	Storage = AllocateTex2DStorage(Size);
+	UBPA_UCOMMON_ASSERT(Storage);
+	bInternalStorage = true;
+	if (BandHeight == 0)
+	{
+		BandHeight = GetDefaultBandHeight();
+	}
+	const uint64_t RowSize = Size / Grid2D.Height;
+	const uint64_t NumBands = (Grid2D.Height + BandHeight - 1) / BandHeight;
+	std::atomic<bool> bSucceeded{ true };
+	ThreadPool.ParallelFor(0, NumBands, 1, [&](uint64_t Band)
+	{
+		const uint64_t RowBegin = Band * BandHeight;
+		const uint64_t RowEnd = std::min(RowBegin + BandHeight, Grid2D.Height);
+		if (!File.ReadAt(DataOffset + RowBegin * RowSize, static_cast<uint8_t*>(Storage) + RowBegin * RowSize, (RowEnd - RowBegin) * RowSize))
+		{
+			bSucceeded.store(false, std::memory_order_relaxed);
+		}
+	});
+	if (!bSucceeded.load(std::memory_order_relaxed))
+	{
+		*this = FTex2D();
+		return false;
+	}
+	return true;
+}
+
+//
+// FTex2DMipChain
+///////////
+
+UCommon::FTex2DMipChain::FTex2DMipChain() noexcept :
+	NumMips(0) {}
+
+UCommon::FTex2DMipChain::FTex2DMipChain(const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType, uint64_t InNumMips) :
+	Grid2D(InGrid2D),
+	NumMips(InNumMips != 0 ? InNumMips : InGrid2D.GetNumMips())
+{
+	UBPA_UCOMMON_ASSERT(NumMips <= InGrid2D.GetNumMips());
+	FlatTex2D = FTex2D(FGrid2D(GetMipOffset(NumMips), 1), InNumChannels, InElementType);
+}
+
+bool UCommon::FTex2DMipChain::IsValid() const noexcept { return NumMips > 0 && FlatTex2D.IsValid(); }
+uint64_t UCommon::FTex2DMipChain::GetNumMips() const noexcept { return NumMips; }
+uint64_t UCommon::FTex2DMipChain::GetNumChannels() const noexcept { return FlatTex2D.GetNumChannels(); }
+UCommon::EElementType UCommon::FTex2DMipChain::GetElementType() const noexcept { return FlatTex2D.GetElementType(); }
+const UCommon::FTex2D& UCommon::FTex2DMipChain::GetFlatTex2D() const noexcept { return FlatTex2D; }
+
+UCommon::FGrid2D UCommon::FTex2DMipChain::GetMipGrid2D(uint64_t Level) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Level < NumMips);
+	return FGrid2D(std::max<uint64_t>(1, Grid2D.Width >> Level), std::max<uint64_t>(1, Grid2D.Height >> Level));
+}
+
+uint64_t UCommon::FTex2DMipChain::GetMipOffset(uint64_t Level) const noexcept
+{
+	uint64_t Offset = 0;
+	for (uint64_t Index = 0; Index < Level; Index++)
+	{
+		Offset += GetMipGrid2D(Index).GetArea();
+	}
+	return Offset;
+}
+
+UCommon::FTex2D UCommon::FTex2DMipChain::GetMip(uint64_t Level) noexcept
+{
+	void* MipStorage = static_cast<uint8_t*>(FlatTex2D.GetStorage())
+		+ GetMipOffset(Level) * FlatTex2D.GetNumChannels() * ElementGetSize(FlatTex2D.GetElementType());
+	return FTex2D(GetMipGrid2D(Level), FlatTex2D.GetNumChannels(), EOwnership::DoNotTakeOwnership, FlatTex2D.GetElementType(), MipStorage);
+}
+
+const UCommon::FTex2D UCommon::FTex2DMipChain::GetMip(uint64_t Level) const noexcept
+{
+	return const_cast<FTex2DMipChain*>(this)->GetMip(Level);
+}
+
+//
+// FTex2DSummedAreaTable
+///////////
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/** Inclusive prefix sum of each channel along an interleaved row, one running sum per channel. */
+		static void PrefixSumRow(double* Row, uint64_t NumTexels, uint64_t NumChannels) noexcept
+		{
+			for (uint64_t C = 0; C < NumChannels; C++)
+			{
+				double Sum = 0.;
+				for (uint64_t X = 0; X < NumTexels; X++)
+				{
+					Sum += Row[X * NumChannels + C];
+					Row[X * NumChannels + C] = Sum;
+				}
+			}
+		}
+
+		static void AccumulateRow(double* Dst, const double* Src, uint64_t NumElements) noexcept
+		{
+			for (uint64_t Index = 0; Index < NumElements; Index++)
+			{
+				Dst[Index] += Src[Index];
+			}
+		}
+	}
+}
+
+UCommon::FTex2DSummedAreaTable::FTex2DSummedAreaTable() noexcept :
+	NumChannels(0) {}
+
+UCommon::FTex2DSummedAreaTable::FTex2DSummedAreaTable(const FConstTex2DView& View, bool bWithSquaredSums, FThreadPool* ThreadPool) :
+	Grid2D(View.GetGrid2D()),
+	NumChannels(View.GetNumChannels())
+{
+	UBPA_UCOMMON_ASSERT(View.IsValid());
+
+	const FGrid2D TableGrid2D(Grid2D.Width + 1, Grid2D.Height + 1);
+	Sums = FTex2D(TableGrid2D, NumChannels, EElementType::Double);
+	if (bWithSquaredSums)
+	{
+		SquaredSums = FTex2D(TableGrid2D, NumChannels, EElementType::Double);
+	}
+
+	const uint64_t TableRowNumElements = TableGrid2D.Width * NumChannels;
+	double* SumStorage = static_cast<double*>(Sums.GetStorage());
+	double* SquaredSumStorage = bWithSquaredSums ? static_cast<double*>(SquaredSums.GetStorage()) : nullptr;
+
+	// the first row and the first column stay zero
+	std::memset(SumStorage, 0, TableRowNumElements * sizeof(double));
+	if (SquaredSumStorage)
+	{
+		std::memset(SquaredSumStorage, 0, TableRowNumElements * sizeof(double));
+	}
+
+	// pass 1: prefix sums along each row, rows are independent
+	auto ScanRows = [&](uint64_t RowBegin, uint64_t RowEnd)
+	{
+		for (uint64_t Y = RowBegin; Y < RowEnd; Y++)
+		{
+			double* SumRow = SumStorage + (Y + 1) * TableRowNumElements;
+			std::fill(SumRow, SumRow + NumChannels, 0.);
+			ElementConvert(SumRow + NumChannels, EElementType::Double, View.GetRow(Y), View.GetElementType(), Grid2D.Width * NumChannels);
+			if (SquaredSumStorage)
+			{
+				double* SquaredSumRow = SquaredSumStorage + (Y + 1) * TableRowNumElements;
+				std::fill(SquaredSumRow, SquaredSumRow + NumChannels, 0.);
+				for (uint64_t Index = NumChannels; Index < TableRowNumElements; Index++)
+				{
+					SquaredSumRow[Index] = SumRow[Index] * SumRow[Index];
+				}
+				Details::PrefixSumRow(SquaredSumRow + NumChannels, Grid2D.Width, NumChannels);
+			}
+			Details::PrefixSumRow(SumRow + NumChannels, Grid2D.Width, NumChannels);
+		}
+	};
+
+	// pass 2: add each row to the next one top-down, columns are independent
+	auto ScanColumns = [&](uint64_t Begin, uint64_t End)
+	{
+		for (uint64_t Y = 2; Y <= Grid2D.Height; Y++)
+		{
+			Details::AccumulateRow(SumStorage + Y * TableRowNumElements + Begin, SumStorage + (Y - 1) * TableRowNumElements + Begin, End - Begin);
+			if (SquaredSumStorage)
+			{
+				Details::AccumulateRow(SquaredSumStorage + Y * TableRowNumElements + Begin, SquaredSumStorage + (Y - 1) * TableRowNumElements + Begin, End - Begin);
+			}
+		}
+	};
+
+	if (ThreadPool)
+	{
+		ThreadPool->ParallelForRange(0, Grid2D.Height, 0, ScanRows);
+		ThreadPool->ParallelForRange(0, TableRowNumElements, 0, ScanColumns);
+	}
+	else
+	{
+		ScanRows(0, Grid2D.Height);
+		ScanColumns(0, TableRowNumElements);
+	}
+}
+
+bool UCommon::FTex2DSummedAreaTable::IsValid() const noexcept { return Sums.IsValid(); }
+const UCommon::FGrid2D& UCommon::FTex2DSummedAreaTable::GetGrid2D() const noexcept { return Grid2D; }
+uint64_t UCommon::FTex2DSummedAreaTable::GetNumChannels() const noexcept { return NumChannels; }
+bool UCommon::FTex2DSummedAreaTable::HasSquaredSums() const noexcept { return SquaredSums.IsValid(); }
+const UCommon::FTex2D& UCommon::FTex2DSummedAreaTable::GetSums() const noexcept { return Sums; }
+const UCommon::FTex2D& UCommon::FTex2DSummedAreaTable::GetSquaredSums() const noexcept { return SquaredSums; }
+
+double UCommon::FTex2DSummedAreaTable::GetRectangleSum(const FTex2D& Table, const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Table.IsValid());
+	UBPA_UCOMMON_ASSERT(Min.X <= Max.X && Max.X <= Grid2D.Width);
+	UBPA_UCOMMON_ASSERT(Min.Y <= Max.Y && Max.Y <= Grid2D.Height);
+	UBPA_UCOMMON_ASSERT(C < NumChannels);
+
+	const uint64_t TableRowNumElements = (Grid2D.Width + 1) * NumChannels;
+	const double* Top = static_cast<const double*>(Table.GetStorage()) + Min.Y * TableRowNumElements + C;
+	const double* Bottom = static_cast<const double*>(Table.GetStorage()) + Max.Y * TableRowNumElements + C;
+	return (Bottom[Max.X * NumChannels] - Bottom[Min.X * NumChannels]) - (Top[Max.X * NumChannels] - Top[Min.X * NumChannels]);
+}
+
+double UCommon::FTex2DSummedAreaTable::GetSum(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept
+{
+	return GetRectangleSum(Sums, Min, Max, C);
+}
+
+double UCommon::FTex2DSummedAreaTable::GetSquaredSum(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept
+{
+	return GetRectangleSum(SquaredSums, Min, Max, C);
+}
+
+double UCommon::FTex2DSummedAreaTable::GetMean(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept
+{
+	const uint64_t Count = (Max.X - Min.X) * (Max.Y - Min.Y);
+	UBPA_UCOMMON_ASSERT(Count > 0);
+	return GetSum(Min, Max, C) / (double)Count;
+}
+
+UCommon::FTex2DSummedAreaTable::FStats UCommon::FTex2DSummedAreaTable::GetStats(const FUint64Vector2& Min, const FUint64Vector2& Max, uint64_t C) const noexcept
+{
+	FStats Stats;
+	Stats.Count = (Max.X - Min.X) * (Max.Y - Min.Y);
+	Stats.Sum = GetSum(Min, Max, C);
+	if (Stats.Count == 0)
+	{
+		return Stats;
+	}
+	Stats.Mean = Stats.Sum / (double)Stats.Count;
+	if (HasSquaredSums())
+	{
+		// E[x^2] - E[x]^2 may round slightly below zero
+		Stats.Variance = std::max(0., GetSquaredSum(Min, Max, C) / (double)Stats.Count - Stats.Mean * Stats.Mean);
+	}
+	return Stats;
+}
+
+UCommon::FTex2DSummedAreaTable::FStats UCommon::FTex2DSummedAreaTable::GetWindowStats(const FUint64Vector2& Point, uint64_t Radius, uint64_t C) const noexcept
+{
+	FUint64Vector2 Min, Max;
+	GetWindow(Point, Radius, Min, Max);
+	return GetStats(Min, Max, C);
+}
+
+void UCommon::FTex2DSummedAreaTable::GetWindow(const FUint64Vector2& Point, uint64_t Radius, FUint64Vector2& Min, FUint64Vector2& Max) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point));
+	Min.X = Point.X > Radius ? Point.X - Radius : 0;
+	Min.Y = Point.Y > Radius ? Point.Y - Radius : 0;
+	Max.X = Point.X + std::min(Radius, Grid2D.Width - Point.X - 1) + 1;
+	Max.Y = Point.Y + std::min(Radius, Grid2D.Height - Point.Y - 1) + 1;
+}
+
+void UCommon::FTex2DSummedAreaTable::BoxFilter(const FTex2DView& Dst, uint64_t Radius, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	UBPA_UCOMMON_ASSERT(Dst.GetGrid2D() == Grid2D);
+	UBPA_UCOMMON_ASSERT(Dst.GetNumChannels() == NumChannels);
+
+	const uint64_t TableRowNumElements = (Grid2D.Width + 1) * NumChannels;
+	const double* SumStorage = static_cast<const double*>(Sums.GetStorage());
+	auto FilterRows = [&](uint64_t RowBegin, uint64_t RowEnd)
+	{
+		std::vector<double> Means(Grid2D.Width * NumChannels);
+		for (uint64_t Y = RowBegin; Y < RowEnd; Y++)
+		{
+			const uint64_t MinY = Y > Radius ? Y - Radius : 0;
+			const uint64_t MaxY = Y + std::min(Radius, Grid2D.Height - Y - 1) + 1;
+			const double* Top = SumStorage + MinY * TableRowNumElements;
+			const double* Bottom = SumStorage + MaxY * TableRowNumElements;
+			for (uint64_t X = 0; X < Grid2D.Width; X++)
+			{
+				const uint64_t MinX = X > Radius ? X - Radius : 0;
+				const uint64_t MaxX = X + std::min(Radius, Grid2D.Width - X - 1) + 1;
+				const double InvCount = 1. / (double)((MaxX - MinX) * (MaxY - MinY));
+				const uint64_t Left = MinX * NumChannels;
+				const uint64_t Right = MaxX * NumChannels;
+				for (uint64_t C = 0; C < NumChannels; C++)
+				{
+					Means[X * NumChannels + C] = ((Bottom[Right + C] - Bottom[Left + C]) - (Top[Right + C] - Top[Left + C])) * InvCount;
+				}
+			}
+			ElementConvert(Dst.GetRow(Y), Dst.GetElementType(), Means.data(), EElementType::Double, Means.size());
+		}
+	};
+
+	if (ThreadPool)
+	{
+		ThreadPool->ParallelForRange(0, Grid2D.Height, 0, FilterRows);
+	}
+	else
+	{
+		FilterRows(0, Grid2D.Height);
 	}
-	Archive.Serialize(Storage, GetStorageSizeInBytes());
 }
@@ -0,0 +1,1056 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex3D.h>
+#include <UCommon/ThreadPool.h>
+
+#include <climits>
+#include <cstring>
+#include <vector>
+
+#if defined(UBPA_UCOMMON_SIMD_SSE2) || defined(UBPA_UCOMMON_SIMD_AVX2) || defined(UBPA_UCOMMON_SIMD_F16C)
+#include <immintrin.h>
+#endif
+
+//
+// FGrid3D
+///////////
+
+UCommon::FGrid3D::FGrid3D(uint64_t InWidth, uint64_t InHeight, uint64_t InDepth) noexcept :
+	Width(InWidth), Height(InHeight), Depth(InDepth) {}
+
+UCommon::FGrid3D::FGrid3D(const FUint64Vector& Size) noexcept : FGrid3D(Size.X, Size.Y, Size.Z) {}
+
+UCommon::FGrid3D::FGrid3D() noexcept :
+	Width(0), Height(0), Depth(0) {
+}
+
+uint64_t UCommon::FGrid3D::GetVolume() const noexcept { return Width * Height * Depth; }
+
+bool UCommon::FGrid3D::IsVolumeEmpty() const noexcept { return Width == 0 || Height == 0 || Depth == 0; }
+
+UCommon::FGrid2D UCommon::FGrid3D::GetSliceGrid2D() const noexcept { return FGrid2D(Width, Height); }
+
+bool UCommon::FGrid3D::Contains(const FUint64Vector& Point) const noexcept { return Point.X < Width && Point.Y < Height && Point.Z < Depth; }
+
+uint64_t UCommon::FGrid3D::GetIndex(const FUint64Vector& Point) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Contains(Point));
+	return (Point.Z * Height + Point.Y) * Width + Point.X;
+}
+
+UCommon::FVector3f UCommon::FGrid3D::GetTexcoord(const FUint64Vector& Point) const noexcept
+{
+	return (FVector3f(Point) + 0.5f) / FVector3f(GetExtent());
+}
+
+UCommon::FUint64Vector UCommon::FGrid3D::GetPoint(const FVector3f& Texcoord) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(FVector3f(0.f) <= Texcoord && Texcoord <= FVector3f(1.f));
+	UBPA_UCOMMON_ASSERT(!IsVolumeEmpty());
+
+	const FVector3f PointT = Texcoord * FVector3f(GetExtent());
+	return FUint64Vector(FInt64Vector((PointT - 0.5f).Floor()).Clamp(FInt64Vector(0), FInt64Vector(GetExtent() - 1)));
+}
+
+UCommon::FUint64Vector UCommon::FGrid3D::GetPoint(uint64_t Index) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Index < GetVolume());
+
+	const uint64_t X = Index % Width;
+	const uint64_t Y = (Index / Width) % Height;
+	const uint64_t Z = Index / (Width * Height);
+
+	return FUint64Vector{ X, Y, Z };
+}
+
+UCommon::FUint64Vector UCommon::FGrid3D::GetExtent() const noexcept
+{
+	return FUint64Vector(Width, Height, Depth);
+}
+
+uint64_t UCommon::FGrid3D::GetNumMips() const noexcept
+{
+	return std::min({ MSB64(Width), MSB64(Height), MSB64(Depth) }) + TypedOne<uint8_t>;
+}
+
+uint64_t& UCommon::FGrid3D::operator[](uint64_t Index) noexcept
+{
+	UBPA_UCOMMON_ASSERT(Index < 3);
+	return reinterpret_cast<uint64_t*>(this)[Index];
+}
+
+const uint64_t& UCommon::FGrid3D::operator[](uint64_t Index) const noexcept
+{
+	return const_cast<FGrid3D*>(this)->operator[](Index);
+}
+
+UCommon::FGrid3DIterator UCommon::FGrid3D::GetIterator(const FUint64Vector& Point) const noexcept
+{
+	FGrid3DIterator Iterator;
+	Iterator.Grid3D = *this;
+	Iterator.Point = Point;
+	return Iterator;
+}
+
+UCommon::FGrid3DIterator UCommon::FGrid3D::GetIterator(uint64_t Index) const noexcept { return GetIterator(GetPoint(Index)); }
+
+UCommon::FGrid3DIterator UCommon::FGrid3D::begin() const noexcept { return GetIterator(FUint64Vector(0)); }
+UCommon::FGrid3DIterator UCommon::FGrid3D::end() const noexcept { return GetIterator({ 0, 0, Depth }); }
+
+namespace UCommon
+{
+	bool operator==(const FGrid3D& Lhs, const FGrid3D& Rhs) noexcept
+	{
+		return Lhs.Width == Rhs.Width
+			&& Lhs.Height == Rhs.Height
+			&& Lhs.Depth == Rhs.Depth;
+	}
+
+	bool operator!=(const FGrid3D& Lhs, const FGrid3D& Rhs) noexcept
+	{
+		return !(Lhs == Rhs);
+	}
+}
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/** Bricks of ETex3DStorageLayout::Bricked are BrickExtent x BrickExtent x BrickExtent texels. */
+		static constexpr uint64_t BrickExtentLog2 = 2;
+		static constexpr uint64_t BrickExtent = uint64_t(1) << BrickExtentLog2;
+		static constexpr uint64_t BrickVolume = BrickExtent * BrickExtent * BrickExtent;
+
+		static inline uint64_t GetNumBricks(uint64_t Extent) noexcept
+		{
+			return (Extent + BrickExtent - 1) >> BrickExtentLog2;
+		}
+
+		/** Spread the bits of Coord (< BrickExtent) to every third bit, X of a 3D Morton code. */
+		static inline uint64_t MortonSpread3(uint64_t Coord) noexcept
+		{
+			return (Coord & 1) | ((Coord & 2) << 2);
+		}
+
+		/**
+		 * The texel index is separable: GetColumnIndex(X) + GetRowIndex(Y, RowStride) + GetSliceIndex(Z, SliceStride),
+		 * the strides are in texels, between two rows and two slices if Linear, two rows and two slices of bricks if Bricked.
+		 */
+		template<ETex3DStorageLayout StorageLayout>
+		static inline uint64_t GetColumnIndex(uint64_t X) noexcept
+		{
+			if constexpr (StorageLayout == ETex3DStorageLayout::Linear)
+			{
+				return X;
+			}
+			else
+			{
+				return ((X >> BrickExtentLog2) * BrickVolume) + MortonSpread3(X & (BrickExtent - 1));
+			}
+		}
+
+		template<ETex3DStorageLayout StorageLayout>
+		static inline uint64_t GetRowIndex(uint64_t Y, uint64_t RowStride) noexcept
+		{
+			if constexpr (StorageLayout == ETex3DStorageLayout::Linear)
+			{
+				return Y * RowStride;
+			}
+			else
+			{
+				return (Y >> BrickExtentLog2) * RowStride + (MortonSpread3(Y & (BrickExtent - 1)) << 1);
+			}
+		}
+
+		template<ETex3DStorageLayout StorageLayout>
+		static inline uint64_t GetSliceIndex(uint64_t Z, uint64_t SliceStride) noexcept
+		{
+			if constexpr (StorageLayout == ETex3DStorageLayout::Linear)
+			{
+				return Z * SliceStride;
+			}
+			else
+			{
+				return (Z >> BrickExtentLog2) * SliceStride + (MortonSpread3(Z & (BrickExtent - 1)) << 2);
+			}
+		}
+
+		/** { RowStride, SliceStride } of GetRowIndex and GetSliceIndex. */
+		static FUint64Vector2 GetTexelStrides(const FGrid3D& Grid3D, ETex3DStorageLayout StorageLayout) noexcept
+		{
+			if (StorageLayout == ETex3DStorageLayout::Linear)
+			{
+				return { Grid3D.Width, Grid3D.Width * Grid3D.Height };
+			}
+			const uint64_t RowStride = GetNumBricks(Grid3D.Width) * BrickVolume;
+			return { RowStride, RowStride * GetNumBricks(Grid3D.Height) };
+		}
+
+		/** The texel indices of the columns, rows and slices of Tex, texel (X, Y, Z) is at Indices[0][X] + Indices[1][Y] + Indices[2][Z]. */
+		struct FTex3DAxisIndices
+		{
+			std::vector<uint64_t> Indices[3];
+
+			explicit FTex3DAxisIndices(const FTex3D& Tex)
+			{
+				const FGrid3D& Grid3D = Tex.GetGrid3D();
+				for (uint64_t Axis = 0; Axis < 3; Axis++)
+				{
+					Indices[Axis].resize(Grid3D[Axis]);
+					for (uint64_t Coord = 0; Coord < Grid3D[Axis]; Coord++)
+					{
+						FUint64Vector Point(0);
+						Point[Axis] = Coord;
+						Indices[Axis][Coord] = Tex.GetTexelIndex(Point);
+					}
+				}
+			}
+		};
+
+		/** Run Body(SliceBegin, SliceEnd) over [0, Depth), split across ThreadPool if not nullptr. */
+		template<typename BodyT>
+		static void ForEachSlices(uint64_t Depth, FThreadPool* ThreadPool, BodyT&& Body)
+		{
+			if (ThreadPool)
+			{
+				ThreadPool->ParallelForRange(0, Depth, 0, Body);
+			}
+			else
+			{
+				Body(0, Depth);
+			}
+		}
+	}
+}
+
+//
+// FTex3D
+///////////
+
+uint64_t UCommon::FTex3D::GetRequiredStorageSizeInBytes(const FGrid3D& Grid3D, uint64_t NumChannels, EElementType ElementType, ETex3DStorageLayout StorageLayout) noexcept
+{
+	return GetNumElements(Grid3D, NumChannels, StorageLayout) * ElementGetSize(ElementType);
+}
+
+uint64_t UCommon::FTex3D::GetNumElements(const FGrid3D& Grid3D, uint64_t NumChannels, ETex3DStorageLayout StorageLayout) noexcept
+{
+	return GetStorageGrid3D(Grid3D, StorageLayout).GetVolume() * NumChannels;
+}
+
+UCommon::FGrid3D UCommon::FTex3D::GetStorageGrid3D(const FGrid3D& Grid3D, ETex3DStorageLayout StorageLayout) noexcept
+{
+	if (StorageLayout != ETex3DStorageLayout::Bricked)
+	{
+		return Grid3D;
+	}
+	return FGrid3D(
+		Details::GetNumBricks(Grid3D.Width) * Details::BrickExtent,
+		Details::GetNumBricks(Grid3D.Height) * Details::BrickExtent,
+		Details::GetNumBricks(Grid3D.Depth) * Details::BrickExtent);
+}
+
+UCommon::FGrid2D UCommon::FTex3D::GetFlatGrid2D(const FGrid3D& Grid3D, ETex3DStorageLayout StorageLayout) noexcept
+{
+	if (StorageLayout != ETex3DStorageLayout::Bricked)
+	{
+		return FGrid2D(Grid3D.Width, Grid3D.Height * Grid3D.Depth);
+	}
+	return FGrid2D(Details::BrickVolume, GetStorageGrid3D(Grid3D, StorageLayout).GetVolume() / Details::BrickVolume);
+}
+
+UCommon::FTex3D::FTex3D() noexcept :
+	StorageLayout(ETex3DStorageLayout::Linear) {}
+
+UCommon::FTex3D::FTex3D(const FGrid3D& InGrid3D, uint64_t InNumChannels, EOwnership InOwnership, EElementType InElementType, void* InStorage, ETex3DStorageLayout InStorageLayout) noexcept :
+	Grid3D(InGrid3D),
+	StorageLayout(InStorageLayout),
+	FlatTex2D(GetFlatGrid2D(InGrid3D, InStorageLayout), InNumChannels, InOwnership, InElementType, InStorage)
+{
+	UBPA_UCOMMON_ASSERT(!InGrid3D.IsVolumeEmpty());
+}
+
+UCommon::FTex3D::FTex3D(const FGrid3D& InGrid3D, uint64_t InNumChannels, EElementType InElementType, ETex3DStorageLayout InStorageLayout) :
+	Grid3D(InGrid3D),
+	StorageLayout(InStorageLayout),
+	FlatTex2D(GetFlatGrid2D(InGrid3D, InStorageLayout), InNumChannels, InElementType)
+{
+	UBPA_UCOMMON_ASSERT(!InGrid3D.IsVolumeEmpty());
+}
+
+UCommon::FTex3D::FTex3D(FTex2D InFlatTex2D, uint64_t InDepth) noexcept :
+	StorageLayout(ETex3DStorageLayout::Linear),
+	FlatTex2D(std::move(InFlatTex2D))
+{
+	UBPA_UCOMMON_ASSERT(FlatTex2D.IsValid() && FlatTex2D.GetStorageLayout() == ETex2DStorageLayout::Linear);
+	UBPA_UCOMMON_ASSERT(InDepth > 0 && FlatTex2D.GetGrid2D().Height % InDepth == 0);
+	Grid3D = FGrid3D(FlatTex2D.GetGrid2D().Width, FlatTex2D.GetGrid2D().Height / InDepth, InDepth);
+}
+
+UCommon::FTex3D::FTex3D(const FTex3D& Other, EOwnership InOwnership, void* InEmptyStorage) :
+	Grid3D(Other.Grid3D),
+	StorageLayout(Other.StorageLayout),
+	FlatTex2D(Other.FlatTex2D, InOwnership, InEmptyStorage) {}
+
+UCommon::FTex3D::FTex3D(const FTex3D& Other) :
+	Grid3D(Other.Grid3D),
+	StorageLayout(Other.StorageLayout),
+	FlatTex2D(Other.FlatTex2D) {}
+
+UCommon::FTex3D::FTex3D(FTex3D&& Other) noexcept :
+	Grid3D(Other.Grid3D),
+	StorageLayout(Other.StorageLayout),
+	FlatTex2D(std::move(Other.FlatTex2D))
+{
+	Other.Grid3D = FGrid3D();
+	Other.StorageLayout = ETex3DStorageLayout::Linear;
+}
+
+UCommon::FTex3D::~FTex3D() = default;
+
+bool UCommon::FTex3D::IsValid() const noexcept
+{
+	return !Grid3D.IsVolumeEmpty() && FlatTex2D.IsValid();
+}
+
+const UCommon::FGrid3D& UCommon::FTex3D::GetGrid3D() const noexcept { return Grid3D; }
+uint64_t UCommon::FTex3D::GetNumChannels() const noexcept { return FlatTex2D.GetNumChannels(); }
+uint64_t UCommon::FTex3D::GetNumElements() const noexcept { return FlatTex2D.GetNumElements(); }
+UCommon::EOwnership UCommon::FTex3D::GetStorageOwnership() const noexcept { return FlatTex2D.GetStorageOwnership(); }
+UCommon::ETex3DStorageLayout UCommon::FTex3D::GetStorageLayout() const noexcept { return StorageLayout; }
+UCommon::EElementType UCommon::FTex3D::GetElementType() const noexcept { return FlatTex2D.GetElementType(); }
+uint64_t UCommon::FTex3D::GetStorageSizeInBytes() const noexcept { return FlatTex2D.GetStorageSizeInBytes(); }
+
+void* UCommon::FTex3D::GetStorage() noexcept { return FlatTex2D.GetStorage(); }
+const void* UCommon::FTex3D::GetStorage() const noexcept { return FlatTex2D.GetStorage(); }
+const UCommon::FTex2D& UCommon::FTex3D::GetFlatTex2D() const noexcept { return FlatTex2D; }
+
+uint64_t UCommon::FTex3D::GetTexelIndex(const FUint64Vector& Point) const noexcept
+{
+	if (StorageLayout == ETex3DStorageLayout::Linear)
+	{
+		return Grid3D.GetIndex(Point);
+	}
+	UBPA_UCOMMON_ASSERT(Grid3D.Contains(Point));
+	const FUint64Vector2 Strides = Details::GetTexelStrides(Grid3D, StorageLayout);
+	return Details::GetColumnIndex<ETex3DStorageLayout::Bricked>(Point.X)
+		+ Details::GetRowIndex<ETex3DStorageLayout::Bricked>(Point.Y, Strides.X)
+		+ Details::GetSliceIndex<ETex3DStorageLayout::Bricked>(Point.Z, Strides.Y);
+}
+
+uint64_t UCommon::FTex3D::GetIndex(const FUint64Vector& Point, uint64_t C) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(C < GetNumChannels());
+	return GetTexelIndex(Point) * GetNumChannels() + C;
+}
+
+UCommon::FTex2DView UCommon::FTex3D::GetSliceView(uint64_t Z) noexcept
+{
+	UBPA_UCOMMON_ASSERT(StorageLayout == ETex3DStorageLayout::Linear && Z < Grid3D.Depth);
+	return FlatTex2D.GetView(FUint64Vector2(0, Z * Grid3D.Height), Grid3D.GetSliceGrid2D());
+}
+
+UCommon::FConstTex2DView UCommon::FTex3D::GetSliceView(uint64_t Z) const noexcept
+{
+	return const_cast<FTex3D*>(this)->GetSliceView(Z);
+}
+
+float UCommon::FTex3D::GetFloat(uint64_t Index) const noexcept
+{
+	return FlatTex2D.GetFloat(Index);
+}
+
+float UCommon::FTex3D::GetFloat(const FUint64Vector& Point, uint64_t C) const noexcept
+{
+	return GetFloat(GetIndex(Point, C));
+}
+
+void UCommon::FTex3D::SetFloat(uint64_t Index, float Value) noexcept
+{
+	FlatTex2D.SetFloat(Index, Value);
+}
+
+void UCommon::FTex3D::SetFloat(const FUint64Vector& Point, uint64_t C, float Value) noexcept
+{
+	SetFloat(GetIndex(Point, C), Value);
+}
+
+void UCommon::FTex3D::Reset() noexcept
+{
+	FlatTex2D.Reset();
+	Grid3D = FGrid3D();
+	StorageLayout = ETex3DStorageLayout::Linear;
+}
+
+bool UCommon::FTex3D::IsLayoutSameWith(const FTex3D& Other) const noexcept
+{
+	return Grid3D == Other.Grid3D
+		&& StorageLayout == Other.StorageLayout
+		&& FlatTex2D.IsLayoutSameWith(Other.FlatTex2D);
+}
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/** The texels read by the TrilinearSampleBatch kernels. */
+		struct FTrilinearSampleSource
+		{
+			const uint8_t* Storage;
+			FUint64Vector Extent;
+			uint64_t NumChannels;
+			/** { RowStride, SliceStride } in texels, see GetTexelStrides. */
+			FUint64Vector2 Strides;
+			ETextureAddress AddressModes[3];
+		};
+
+		/**
+		 * The eight taps of FTex3D::TrilinearSample at Texcoord, as byte offsets of the texels from Source.Storage,
+		 * in the order of TrilinearInterpolate (tap bits are XYZ, Z lowest).
+		 */
+		template<ETex3DStorageLayout StorageLayout>
+		static inline void ComputeTrilinearTaps(const FTrilinearSampleSource& Source, const FVector3f& Texcoord, uint64_t TexelSize, uint64_t Offsets[8], float Weights[8]) noexcept
+		{
+			const FUint64Vector Extent = Source.Extent;
+			const FVector3f PointT = Texcoord * FVector3f(Extent);
+			const FVector3f PointTOffset = PointT - 0.5f;
+			const FInt64Vector IntPoint0 = FInt64Vector(PointTOffset.Floor());
+
+			const FVector3f LocalTexcoord = (PointT - (FVector3f(IntPoint0) + 0.5f)).Clamp(0.f, 1.f);
+			const FVector3f OneMinusLocalTexcoord = FVector3f(1.f) - LocalTexcoord;
+
+			uint64_t Coords[3][2];
+			for (uint64_t Axis = 0; Axis < 3; Axis++)
+			{
+				Coords[Axis][0] = ApplyAddressMode(IntPoint0[Axis], Extent[Axis], Source.AddressModes[Axis]);
+				Coords[Axis][1] = ApplyAddressMode(IntPoint0[Axis] + 1, Extent[Axis], Source.AddressModes[Axis]);
+			}
+
+			const uint64_t Columns[2] = { GetColumnIndex<StorageLayout>(Coords[0][0]), GetColumnIndex<StorageLayout>(Coords[0][1]) };
+			const uint64_t Rows[2] = { GetRowIndex<StorageLayout>(Coords[1][0], Source.Strides.X), GetRowIndex<StorageLayout>(Coords[1][1], Source.Strides.X) };
+			const uint64_t Slices[2] = { GetSliceIndex<StorageLayout>(Coords[2][0], Source.Strides.Y), GetSliceIndex<StorageLayout>(Coords[2][1], Source.Strides.Y) };
+			const float WeightsX[2] = { OneMinusLocalTexcoord.X, LocalTexcoord.X };
+			const float WeightsY[2] = { OneMinusLocalTexcoord.Y, LocalTexcoord.Y };
+			const float WeightsZ[2] = { OneMinusLocalTexcoord.Z, LocalTexcoord.Z };
+			for (uint64_t Tap = 0; Tap < 8; Tap++)
+			{
+				const uint64_t X = Tap >> 2;
+				const uint64_t Y = (Tap >> 1) & 1;
+				const uint64_t Z = Tap & 1;
+				Offsets[Tap] = (Columns[X] + Rows[Y] + Slices[Z]) * TexelSize;
+				Weights[Tap] = WeightsX[X] * WeightsY[Y] * WeightsZ[Z];
+			}
+		}
+
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+		/** TrilinearInterpolate on 8 lanes, the same operation order. */
+		static inline __m256 TrilinearInterpolate8(const __m256 Values[8], const __m256 Weights[8]) noexcept
+		{
+			const __m256 Value00 = _mm256_add_ps(_mm256_mul_ps(Values[1], Weights[1]), _mm256_mul_ps(Values[0], Weights[0]));
+			const __m256 Value01 = _mm256_add_ps(_mm256_mul_ps(Values[3], Weights[3]), _mm256_mul_ps(Values[2], Weights[2]));
+			const __m256 Value10 = _mm256_add_ps(_mm256_mul_ps(Values[5], Weights[5]), _mm256_mul_ps(Values[4], Weights[4]));
+			const __m256 Value11 = _mm256_add_ps(_mm256_mul_ps(Values[7], Weights[7]), _mm256_mul_ps(Values[6], Weights[6]));
+			return _mm256_add_ps(_mm256_add_ps(Value11, Value10), _mm256_add_ps(Value01, Value00));
+		}
+
+		template<typename T>
+		static inline __m256 LoadElements8(const T* Elements) noexcept
+		{
+			if constexpr (std::is_same_v<T, float>)
+			{
+				return _mm256_loadu_ps(Elements);
+			}
+#if defined(UBPA_UCOMMON_SIMD_F16C)
+			else if constexpr (std::is_same_v<T, FHalf>)
+			{
+				return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Elements)));
+			}
+#endif
+			else
+			{
+				return _mm256_setr_ps(
+					LoadElementFloat(Elements + 0), LoadElementFloat(Elements + 1), LoadElementFloat(Elements + 2), LoadElementFloat(Elements + 3),
+					LoadElementFloat(Elements + 4), LoadElementFloat(Elements + 5), LoadElementFloat(Elements + 6), LoadElementFloat(Elements + 7));
+			}
+		}
+#endif
+
+		template<typename T>
+		static inline void TrilinearInterpolateTexels(const uint8_t* Storage, const uint64_t Offsets[8], const float Weights[8], uint64_t NumChannels, float* Result) noexcept
+		{
+			const T* Texels[8];
+			for (uint64_t Tap = 0; Tap < 8; Tap++)
+			{
+				Texels[Tap] = reinterpret_cast<const T*>(Storage + Offsets[Tap]);
+			}
+			uint64_t C = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			if constexpr (std::is_same_v<T, float> || std::is_same_v<T, FHalf>)
+			{
+				// 8 channels at a time, e.g. the coefficients of a SH probe
+				__m256 W[8];
+				for (uint64_t Tap = 0; Tap < 8; Tap++)
+				{
+					W[Tap] = _mm256_set1_ps(Weights[Tap]);
+				}
+				for (; C + 8 <= NumChannels; C += 8)
+				{
+					__m256 V[8];
+					for (uint64_t Tap = 0; Tap < 8; Tap++)
+					{
+						V[Tap] = LoadElements8(Texels[Tap] + C);
+					}
+					_mm256_storeu_ps(Result + C, TrilinearInterpolate8(V, W));
+				}
+			}
+#endif
+			for (; C < NumChannels; C++)
+			{
+				float Val3[8];
+				for (uint64_t Tap = 0; Tap < 8; Tap++)
+				{
+					Val3[Tap] = LoadElementFloat(Texels[Tap] + C);
+				}
+				Result[C] = UCommon::TrilinearInterpolate(Val3, Weights);
+			}
+		}
+
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+		/** ApplyAddressMode on 8 lanes of coordinates in [-1, Size]. */
+		static inline __m256i ApplyAddressModeNear8(__m256i Coords, int32_t Size, ETextureAddress AddressMode) noexcept
+		{
+			const __m256i Zero = _mm256_setzero_si256();
+			const __m256i Last = _mm256_set1_epi32(Size - 1);
+			if (AddressMode == ETextureAddress::Wrap)
+			{
+				Coords = _mm256_blendv_epi8(Coords, Last, _mm256_cmpgt_epi32(Zero, Coords));
+				return _mm256_blendv_epi8(Coords, Zero, _mm256_cmpgt_epi32(Coords, Last));
+			}
+			// Clamp and Mirror agree on [-1, Size]
+			return _mm256_min_epi32(_mm256_max_epi32(Coords, Zero), Last);
+		}
+
+		/** MortonSpread3 on 8 lanes. */
+		static inline __m256i MortonSpread3x8(__m256i Coords) noexcept
+		{
+			const __m256i Bit0 = _mm256_and_si256(Coords, _mm256_set1_epi32(1));
+			const __m256i Bit1 = _mm256_and_si256(Coords, _mm256_set1_epi32(2));
+			return _mm256_or_si256(Bit0, _mm256_slli_epi32(Bit1, 2));
+		}
+
+		/** GetColumnIndex, GetRowIndex (Axis 1) and GetSliceIndex (Axis 2) on 8 lanes. */
+		template<ETex3DStorageLayout StorageLayout>
+		static inline __m256i GetAxisIndex8(__m256i Coords, uint64_t Axis, __m256i Stride) noexcept
+		{
+			if constexpr (StorageLayout == ETex3DStorageLayout::Linear)
+			{
+				return Axis == 0 ? Coords : _mm256_mullo_epi32(Coords, Stride);
+			}
+			else
+			{
+				const __m256i Brick = _mm256_srli_epi32(Coords, BrickExtentLog2);
+				const __m256i Local = MortonSpread3x8(_mm256_and_si256(Coords, _mm256_set1_epi32(BrickExtent - 1)));
+				const __m256i Base = Axis == 0 ? _mm256_slli_epi32(Brick, 3 * BrickExtentLog2) : _mm256_mullo_epi32(Brick, Stride);
+				return _mm256_add_epi32(Base, _mm256_sllv_epi32(Local, _mm256_set1_epi32(static_cast<int32_t>(Axis))));
+			}
+		}
+
+		/**
+		 * ComputeTrilinearTaps for Texcoords[0, 8) with the same float operations,
+		 * false if a coordinate is too far outside the texture, then the lanes are left for the scalar path.
+		 */
+		template<ETex3DStorageLayout StorageLayout>
+		static inline bool ComputeTrilinearTaps8(const FTrilinearSampleSource& Source, const FVector3f* Texcoords, const __m256 Extent[3], const int32_t Size[3], const __m256i Strides[3], __m256i TexelSize, __m256i Offsets[8], __m256 Weights[8]) noexcept
+		{
+			alignas(32) float Lanes[3][8];
+			for (uint64_t Lane = 0; Lane < 8; Lane++)
+			{
+				Lanes[0][Lane] = Texcoords[Lane].X;
+				Lanes[1][Lane] = Texcoords[Lane].Y;
+				Lanes[2][Lane] = Texcoords[Lane].Z;
+			}
+
+			__m256i Indices[3][2];
+			__m256 AxisWeights[3][2];
+			for (uint64_t Axis = 0; Axis < 3; Axis++)
+			{
+				const ETextureAddress AddressMode = Source.AddressModes[Axis];
+				const __m256 PointT = _mm256_mul_ps(_mm256_load_ps(Lanes[Axis]), Extent[Axis]);
+				const __m256 Floor = _mm256_floor_ps(_mm256_sub_ps(PointT, _mm256_set1_ps(0.5f)));
+				const float MinCoord = AddressMode == ETextureAddress::Clamp ? -1073741824.f : -1.f;
+				const float MaxCoord = AddressMode == ETextureAddress::Clamp ? 1073741824.f : static_cast<float>(Size[Axis] - 1);
+				const __m256 InRange = _mm256_and_ps(
+					_mm256_cmp_ps(Floor, _mm256_set1_ps(MinCoord), _CMP_GE_OQ),
+					_mm256_cmp_ps(Floor, _mm256_set1_ps(MaxCoord), _CMP_LE_OQ));
+				if (_mm256_movemask_ps(InRange) != 0xFF)
+				{
+					return false;
+				}
+
+				const __m256i Coord0 = _mm256_cvttps_epi32(Floor);
+				const __m256i Coord1 = _mm256_add_epi32(Coord0, _mm256_set1_epi32(1));
+				Indices[Axis][0] = GetAxisIndex8<StorageLayout>(ApplyAddressModeNear8(Coord0, Size[Axis], AddressMode), Axis, Strides[Axis]);
+				Indices[Axis][1] = GetAxisIndex8<StorageLayout>(ApplyAddressModeNear8(Coord1, Size[Axis], AddressMode), Axis, Strides[Axis]);
+
+				const __m256 Local = _mm256_sub_ps(PointT, _mm256_add_ps(Floor, _mm256_set1_ps(0.5f)));
+				AxisWeights[Axis][1] = _mm256_min_ps(_mm256_max_ps(Local, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+				AxisWeights[Axis][0] = _mm256_sub_ps(_mm256_set1_ps(1.f), AxisWeights[Axis][1]);
+			}
+
+			for (uint64_t Tap = 0; Tap < 8; Tap++)
+			{
+				const uint64_t X = Tap >> 2;
+				const uint64_t Y = (Tap >> 1) & 1;
+				const uint64_t Z = Tap & 1;
+				const __m256i TexelIndex = _mm256_add_epi32(_mm256_add_epi32(Indices[0][X], Indices[1][Y]), Indices[2][Z]);
+				Offsets[Tap] = _mm256_mullo_epi32(TexelIndex, TexelSize);
+				Weights[Tap] = _mm256_mul_ps(_mm256_mul_ps(AxisWeights[0][X], AxisWeights[1][Y]), AxisWeights[2][Z]);
+			}
+			return true;
+		}
+#endif
+
+		/** Sample Texcoords[0, NumTexcoords) of Source, which has ElementType T. */
+		template<typename T, ETex3DStorageLayout StorageLayout>
+		static void TrilinearSampleBatchKernel(const FTrilinearSampleSource& Source, const FVector3f* Texcoords, uint64_t NumTexcoords, float* Results) noexcept
+		{
+			const uint8_t* Storage = Source.Storage;
+			const uint64_t NumChannels = Source.NumChannels;
+			const uint64_t TexelSize = NumChannels * sizeof(T);
+
+			auto SampleOne = [&](uint64_t Index)
+			{
+				uint64_t Offsets[8];
+				float Weights[8];
+				ComputeTrilinearTaps<StorageLayout>(Source, Texcoords[Index], TexelSize, Offsets, Weights);
+				TrilinearInterpolateTexels<T>(Storage, Offsets, Weights, NumChannels, Results + Index * NumChannels);
+			};
+
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			// 8 samples at a time, gather offsets are int32 and the extent is exact in float
+			const FUint64Vector Extent = Source.Extent;
+			const uint64_t NumSliceStrides = StorageLayout == ETex3DStorageLayout::Bricked ? GetNumBricks(Extent.Z) : Extent.Z;
+			if (Source.Strides.Y * NumSliceStrides * TexelSize <= static_cast<uint64_t>(INT32_MAX)
+				&& Extent.X < (1u << 24) && Extent.Y < (1u << 24) && Extent.Z < (1u << 24))
+			{
+				const __m256 ExtentF[3] = { _mm256_set1_ps(static_cast<float>(Extent.X)), _mm256_set1_ps(static_cast<float>(Extent.Y)), _mm256_set1_ps(static_cast<float>(Extent.Z)) };
+				const int32_t Size[3] = { static_cast<int32_t>(Extent.X), static_cast<int32_t>(Extent.Y), static_cast<int32_t>(Extent.Z) };
+				const __m256i Strides[3] = { _mm256_setzero_si256(), _mm256_set1_epi32(static_cast<int32_t>(Source.Strides.X)), _mm256_set1_epi32(static_cast<int32_t>(Source.Strides.Y)) };
+				const __m256i TexelSize8 = _mm256_set1_epi32(static_cast<int32_t>(TexelSize));
+				for (; Index + 8 <= NumTexcoords; Index += 8)
+				{
+					__m256i Offsets[8];
+					__m256 Weights[8];
+					if (!ComputeTrilinearTaps8<StorageLayout>(Source, Texcoords + Index, ExtentF, Size, Strides, TexelSize8, Offsets, Weights))
+					{
+						for (uint64_t Lane = 0; Lane < 8; Lane++)
+						{
+							SampleOne(Index + Lane);
+						}
+						continue;
+					}
+
+					if (NumChannels == 1)
+					{
+						__m256 Values[8];
+						for (uint64_t Tap = 0; Tap < 8; Tap++)
+						{
+							if constexpr (std::is_same_v<T, float>)
+							{
+								Values[Tap] = _mm256_i32gather_ps(reinterpret_cast<const float*>(Storage), Offsets[Tap], 1);
+							}
+							else
+							{
+								alignas(32) int32_t LaneOffsets[8];
+								_mm256_store_si256(reinterpret_cast<__m256i*>(LaneOffsets), Offsets[Tap]);
+								alignas(32) float Lanes[8];
+								for (uint64_t Lane = 0; Lane < 8; Lane++)
+								{
+									Lanes[Lane] = LoadElementFloat(reinterpret_cast<const T*>(Storage + LaneOffsets[Lane]));
+								}
+								Values[Tap] = _mm256_load_ps(Lanes);
+							}
+						}
+						_mm256_storeu_ps(Results + Index, TrilinearInterpolate8(Values, Weights));
+						continue;
+					}
+
+					alignas(32) int32_t LaneOffsets[8][8];
+					alignas(32) float LaneWeights[8][8];
+					for (uint64_t Tap = 0; Tap < 8; Tap++)
+					{
+						_mm256_store_si256(reinterpret_cast<__m256i*>(LaneOffsets[Tap]), Offsets[Tap]);
+						_mm256_store_ps(LaneWeights[Tap], Weights[Tap]);
+					}
+					for (uint64_t Lane = 0; Lane < 8; Lane++)
+					{
+						uint64_t SampleOffsets[8];
+						float SampleWeights[8];
+						for (uint64_t Tap = 0; Tap < 8; Tap++)
+						{
+							SampleOffsets[Tap] = static_cast<uint64_t>(LaneOffsets[Tap][Lane]);
+							SampleWeights[Tap] = LaneWeights[Tap][Lane];
+						}
+						TrilinearInterpolateTexels<T>(Storage, SampleOffsets, SampleWeights, NumChannels, Results + (Index + Lane) * NumChannels);
+					}
+				}
+			}
+#endif
+
+			for (; Index < NumTexcoords; Index++)
+			{
+				SampleOne(Index);
+			}
+		}
+
+		using FTrilinearSampleBatchKernel = void(*)(const FTrilinearSampleSource&, const FVector3f*, uint64_t, float*) noexcept;
+
+		template<typename T>
+		static FTrilinearSampleBatchKernel GetTrilinearSampleBatchKernel(ETex3DStorageLayout StorageLayout) noexcept
+		{
+			switch (StorageLayout)
+			{
+			case ETex3DStorageLayout::Linear: return &TrilinearSampleBatchKernel<T, ETex3DStorageLayout::Linear>;
+			case ETex3DStorageLayout::Bricked: return &TrilinearSampleBatchKernel<T, ETex3DStorageLayout::Bricked>;
+			default: UBPA_UCOMMON_NO_ENTRY(); return nullptr;
+			}
+		}
+
+		static FTrilinearSampleBatchKernel GetTrilinearSampleBatchKernel(EElementType ElementType, ETex3DStorageLayout StorageLayout) noexcept
+		{
+			switch (ElementType)
+			{
+			case EElementType::Uint8: return GetTrilinearSampleBatchKernel<uint8_t>(StorageLayout);
+			case EElementType::Half: return GetTrilinearSampleBatchKernel<FHalf>(StorageLayout);
+			case EElementType::Float: return GetTrilinearSampleBatchKernel<float>(StorageLayout);
+			case EElementType::Double: return GetTrilinearSampleBatchKernel<double>(StorageLayout);
+			default: UBPA_UCOMMON_NO_ENTRY(); return nullptr;
+			}
+		}
+
+		static FTrilinearSampleSource MakeTrilinearSampleSource(const FTex3D& Tex, ETextureAddress AddressModeX, ETextureAddress AddressModeY, ETextureAddress AddressModeZ) noexcept
+		{
+			return
+			{
+				static_cast<const uint8_t*>(Tex.GetStorage()),
+				Tex.GetGrid3D().GetExtent(),
+				Tex.GetNumChannels(),
+				GetTexelStrides(Tex.GetGrid3D(), Tex.GetStorageLayout()),
+				{ AddressModeX, AddressModeY, AddressModeZ },
+			};
+		}
+	}
+}
+
+void UCommon::FTex3D::TrilinearSample(float* Result, const FVector3f& Texcoord, ETextureAddress AddressModeX, ETextureAddress AddressModeY, ETextureAddress AddressModeZ) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	// a single sample takes the scalar path of the kernel
+	const Details::FTrilinearSampleBatchKernel Kernel = Details::GetTrilinearSampleBatchKernel(GetElementType(), StorageLayout);
+	Kernel(Details::MakeTrilinearSampleSource(*this, AddressModeX, AddressModeY, AddressModeZ), &Texcoord, 1, Result);
+}
+
+void UCommon::FTex3D::TrilinearSampleBatch(TSpan<const FVector3f> Texcoords, float* Results, ETextureAddress AddressModeX, ETextureAddress AddressModeY, ETextureAddress AddressModeZ, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	UBPA_UCOMMON_ASSERT(Results || Texcoords.Empty());
+
+	const Details::FTrilinearSampleSource Source = Details::MakeTrilinearSampleSource(*this, AddressModeX, AddressModeY, AddressModeZ);
+	const Details::FTrilinearSampleBatchKernel Kernel = Details::GetTrilinearSampleBatchKernel(GetElementType(), StorageLayout);
+	auto SampleRange = [&](uint64_t Begin, uint64_t End)
+	{
+		Kernel(Source, Texcoords.GetData() + Begin, End - Begin, Results + Begin * Source.NumChannels);
+	};
+
+	if (ThreadPool)
+	{
+		// Chunks of whole 8-sample groups, so each sample takes the same path as without ThreadPool.
+		const uint64_t NumGroups = (Texcoords.Num() + 7) / 8;
+		ThreadPool->ParallelForRange(0, NumGroups, 0, [&](uint64_t GroupBegin, uint64_t GroupEnd)
+		{
+			SampleRange(GroupBegin * 8, std::min(GroupEnd * 8, Texcoords.Num()));
+		});
+	}
+	else
+	{
+		SampleRange(0, Texcoords.Num());
+	}
+}
+
+namespace UCommon
+{
+	namespace Details
+	{
+		/** 2x2x2 average of the texels of SrcTex, for the slices [SliceBegin, SliceEnd) of HalfTex. */
+		template<typename T>
+		static void DownSampleBoxSlices(FTex3D& HalfTex, const FTex3D& SrcTex, const FTex3DAxisIndices& HalfIndices, const FTex3DAxisIndices& SrcIndices, uint64_t SliceBegin, uint64_t SliceEnd)
+		{
+			using FBoxSum = TBoxSum<T>;
+			const uint64_t NumChannels = HalfTex.GetNumChannels();
+			const FGrid3D& HalfGrid3D = HalfTex.GetGrid3D();
+			const FGrid3D& SrcGrid3D = SrcTex.GetGrid3D();
+			const T* SrcStorage = static_cast<const T*>(SrcTex.GetStorage());
+			T* DstStorage = static_cast<T*>(HalfTex.GetStorage());
+
+			// an extent of 1 is not filtered
+			const FUint64Vector Footprint(SrcGrid3D.Width > 1 ? 2 : 1, SrcGrid3D.Height > 1 ? 2 : 1, SrcGrid3D.Depth > 1 ? 2 : 1);
+			const uint64_t Count = Footprint.X * Footprint.Y * Footprint.Z;
+			for (uint64_t Z = SliceBegin; Z < SliceEnd; Z++)
+			{
+				for (uint64_t Y = 0; Y < HalfGrid3D.Height; Y++)
+				{
+					for (uint64_t X = 0; X < HalfGrid3D.Width; X++)
+					{
+						const T* Texels[8];
+						uint64_t NumTexels = 0;
+						for (uint64_t LocalZ = 0; LocalZ < Footprint.Z; LocalZ++)
+						{
+							for (uint64_t LocalY = 0; LocalY < Footprint.Y; LocalY++)
+							{
+								for (uint64_t LocalX = 0; LocalX < Footprint.X; LocalX++)
+								{
+									const uint64_t SrcIndex = SrcIndices.Indices[0][Footprint.X * X + LocalX]
+										+ SrcIndices.Indices[1][Footprint.Y * Y + LocalY]
+										+ SrcIndices.Indices[2][Footprint.Z * Z + LocalZ];
+									Texels[NumTexels++] = SrcStorage + SrcIndex * NumChannels;
+								}
+							}
+						}
+
+						T* Dst = DstStorage + (HalfIndices.Indices[0][X] + HalfIndices.Indices[1][Y] + HalfIndices.Indices[2][Z]) * NumChannels;
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							typename FBoxSum::FType Sum = 0;
+							for (uint64_t Index = 0; Index < Count; Index++)
+							{
+								Sum += FBoxSum::Load(Texels[Index][C]);
+							}
+							Dst[C] = FBoxSum::Store(Sum, Count);
+						}
+					}
+				}
+			}
+		}
+
+		/** HalfTex = SrcTex.DownSample(), in place, the padding texels of a Bricked HalfTex are zeroed. */
+		static void DownSampleBox(FTex3D& HalfTex, const FTex3D& SrcTex, FThreadPool* ThreadPool)
+		{
+			UBPA_UCOMMON_ASSERT(HalfTex.GetElementType() == SrcTex.GetElementType() && HalfTex.GetNumChannels() == SrcTex.GetNumChannels());
+			if (HalfTex.GetStorageLayout() == ETex3DStorageLayout::Bricked
+				&& FTex3D::GetStorageGrid3D(HalfTex.GetGrid3D(), ETex3DStorageLayout::Bricked) != HalfTex.GetGrid3D())
+			{
+				std::memset(HalfTex.GetStorage(), 0, HalfTex.GetStorageSizeInBytes());
+			}
+
+			const FTex3DAxisIndices HalfIndices(HalfTex);
+			const FTex3DAxisIndices SrcIndices(SrcTex);
+			ForEachSlices(HalfTex.GetGrid3D().Depth, ThreadPool, [&](uint64_t SliceBegin, uint64_t SliceEnd)
+			{
+				switch (SrcTex.GetElementType())
+				{
+				case EElementType::Uint8:
+					DownSampleBoxSlices<uint8_t>(HalfTex, SrcTex, HalfIndices, SrcIndices, SliceBegin, SliceEnd);
+					break;
+				case EElementType::Half:
+					DownSampleBoxSlices<FHalf>(HalfTex, SrcTex, HalfIndices, SrcIndices, SliceBegin, SliceEnd);
+					break;
+				case EElementType::Float:
+					DownSampleBoxSlices<float>(HalfTex, SrcTex, HalfIndices, SrcIndices, SliceBegin, SliceEnd);
+					break;
+				case EElementType::Double:
+					DownSampleBoxSlices<double>(HalfTex, SrcTex, HalfIndices, SrcIndices, SliceBegin, SliceEnd);
+					break;
+				default:
+					UBPA_UCOMMON_NO_ENTRY();
+					break;
+				}
+			});
+		}
+	}
+}
+
+UCommon::FTex3D UCommon::FTex3D::DownSample(FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+	const FGrid3D HalfGrid3D(std::max<uint64_t>(1, Grid3D.Width / 2), std::max<uint64_t>(1, Grid3D.Height / 2), std::max<uint64_t>(1, Grid3D.Depth / 2));
+
+	FTex3D HalfTex(HalfGrid3D, GetNumChannels(), GetElementType(), StorageLayout);
+	Details::DownSampleBox(HalfTex, *this, ThreadPool);
+
+	return HalfTex;
+}
+
+UCommon::FTex3DMipChain UCommon::FTex3D::GenerateMips(FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+
+	FTex3DMipChain MipChain(Grid3D, GetNumChannels(), GetElementType(), StorageLayout);
+	FTex3D Mip0 = MipChain.GetMip(0);
+	std::memcpy(Mip0.GetStorage(), GetStorage(), GetStorageSizeInBytes());
+	for (uint64_t Level = 1; Level < MipChain.GetNumMips(); Level++)
+	{
+		FTex3D Mip = MipChain.GetMip(Level);
+		Details::DownSampleBox(Mip, MipChain.GetMip(Level - 1), ThreadPool);
+	}
+
+	return MipChain;
+}
+
+UCommon::FTex3D UCommon::FTex3D::ToStorageLayout(ETex3DStorageLayout InStorageLayout, FThreadPool* ThreadPool) const
+{
+	UBPA_UCOMMON_ASSERT(IsValid());
+
+	FTex3D Result(Grid3D, GetNumChannels(), GetElementType(), InStorageLayout);
+	if (InStorageLayout == StorageLayout)
+	{
+		std::memcpy(Result.GetStorage(), GetStorage(), GetStorageSizeInBytes());
+		return Result;
+	}
+	if (GetStorageGrid3D(Grid3D, InStorageLayout) != Grid3D)
+	{
+		std::memset(Result.GetStorage(), 0, Result.GetStorageSizeInBytes());
+	}
+
+	const uint64_t TexelSize = GetNumChannels() * ElementGetSize(GetElementType());
+	const Details::FTex3DAxisIndices SrcIndices(*this);
+	const Details::FTex3DAxisIndices DstIndices(Result);
+	const uint8_t* Src = static_cast<const uint8_t*>(GetStorage());
+	uint8_t* Dst = static_cast<uint8_t*>(Result.GetStorage());
+	Details::ForEachSlices(Grid3D.Depth, ThreadPool, [&](uint64_t SliceBegin, uint64_t SliceEnd)
+	{
+		for (uint64_t Z = SliceBegin; Z < SliceEnd; Z++)
+		{
+			for (uint64_t Y = 0; Y < Grid3D.Height; Y++)
+			{
+				const uint64_t SrcRow = SrcIndices.Indices[1][Y] + SrcIndices.Indices[2][Z];
+				const uint64_t DstRow = DstIndices.Indices[1][Y] + DstIndices.Indices[2][Z];
+				for (uint64_t X = 0; X < Grid3D.Width; X++)
+				{
+					std::memcpy(Dst + (DstRow + DstIndices.Indices[0][X]) * TexelSize, Src + (SrcRow + SrcIndices.Indices[0][X]) * TexelSize, TexelSize);
+				}
+			}
+		}
+	});
+
+	return Result;
+}
+
+UCommon::FTex3D& UCommon::FTex3D::operator=(const FTex3D& Rhs)
+{
+	if (std::addressof(Rhs) != this)
+	{
+		FlatTex2D = Rhs.FlatTex2D;
+		Grid3D = FlatTex2D.IsValid() ? Rhs.Grid3D : FGrid3D();
+		StorageLayout = FlatTex2D.IsValid() ? Rhs.StorageLayout : ETex3DStorageLayout::Linear;
+	}
+	return *this;
+}
+
+UCommon::FTex3D& UCommon::FTex3D::operator=(FTex3D&& Rhs) noexcept
+{
+	if (this != &Rhs)
+	{
+		FlatTex2D = std::move(Rhs.FlatTex2D);
+		Grid3D = Rhs.Grid3D;
+		StorageLayout = Rhs.StorageLayout;
+
+		Rhs.Grid3D = FGrid3D();
+		Rhs.StorageLayout = ETex3DStorageLayout::Linear;
+	}
+	return *this;
+}
+
+void UCommon::FTex3D::Serialize(IArchive& Archive)
+{
+	if (Archive.GetState() == IArchive::EState::Saving && StorageLayout != ETex3DStorageLayout::Linear)
+	{
+		ToStorageLayout(ETex3DStorageLayout::Linear).Serialize(Archive);
+		return;
+	}
+
+	Archive.ByteSerialize(Grid3D);
+	FlatTex2D.Serialize(Archive);
+	if (Archive.GetState() == IArchive::EState::Loading)
+	{
+		StorageLayout = ETex3DStorageLayout::Linear;
+		if (FlatTex2D.GetGrid2D() != GetFlatGrid2D(Grid3D, StorageLayout))
+		{
+			// truncated or corrupt archive
+			Reset();
+		}
+	}
+}
+
+//
+// FTex3DMipChain
+///////////
+
+UCommon::FTex3DMipChain::FTex3DMipChain() noexcept :
+	NumMips(0),
+	StorageLayout(ETex3DStorageLayout::Linear) {}
+
+UCommon::FTex3DMipChain::FTex3DMipChain(const FGrid3D& InGrid3D, uint64_t InNumChannels, EElementType InElementType, ETex3DStorageLayout InStorageLayout, uint64_t InNumMips) :
+	Grid3D(InGrid3D),
+	NumMips(InNumMips != 0 ? InNumMips : InGrid3D.GetNumMips()),
+	StorageLayout(InStorageLayout)
+{
+	UBPA_UCOMMON_ASSERT(NumMips <= InGrid3D.GetNumMips());
+	FlatTex2D = FTex2D(FGrid2D(GetMipOffset(NumMips), 1), InNumChannels, InElementType);
+}
+
+bool UCommon::FTex3DMipChain::IsValid() const noexcept { return NumMips > 0 && FlatTex2D.IsValid(); }
+uint64_t UCommon::FTex3DMipChain::GetNumMips() const noexcept { return NumMips; }
+uint64_t UCommon::FTex3DMipChain::GetNumChannels() const noexcept { return FlatTex2D.GetNumChannels(); }
+UCommon::EElementType UCommon::FTex3DMipChain::GetElementType() const noexcept { return FlatTex2D.GetElementType(); }
+UCommon::ETex3DStorageLayout UCommon::FTex3DMipChain::GetStorageLayout() const noexcept { return StorageLayout; }
+const UCommon::FTex2D& UCommon::FTex3DMipChain::GetFlatTex2D() const noexcept { return FlatTex2D; }
+
+UCommon::FGrid3D UCommon::FTex3DMipChain::GetMipGrid3D(uint64_t Level) const noexcept
+{
+	UBPA_UCOMMON_ASSERT(Level < NumMips);
+	return FGrid3D(std::max<uint64_t>(1, Grid3D.Width >> Level), std::max<uint64_t>(1, Grid3D.Height >> Level), std::max<uint64_t>(1, Grid3D.Depth >> Level));
+}
+
+uint64_t UCommon::FTex3DMipChain::GetMipOffset(uint64_t Level) const noexcept
+{
+	uint64_t Offset = 0;
+	for (uint64_t Index = 0; Index < Level; Index++)
+	{
+		Offset += FTex3D::GetStorageGrid3D(GetMipGrid3D(Index), StorageLayout).GetVolume();
+	}
+	return Offset;
+}
+
+UCommon::FTex3D UCommon::FTex3DMipChain::GetMip(uint64_t Level) noexcept
+{
+	void* MipStorage = static_cast<uint8_t*>(FlatTex2D.GetStorage())
+		+ GetMipOffset(Level) * FlatTex2D.GetNumChannels() * ElementGetSize(FlatTex2D.GetElementType());
+	return FTex3D(GetMipGrid3D(Level), FlatTex2D.GetNumChannels(), EOwnership::DoNotTakeOwnership, FlatTex2D.GetElementType(), MipStorage, StorageLayout);
+}
+
+const UCommon::FTex3D UCommon::FTex3DMipChain::GetMip(uint64_t Level) const noexcept
+{
+	return const_cast<FTex3DMipChain*>(this)->GetMip(Level);
+}
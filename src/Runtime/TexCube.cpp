@@ -206,14 +206,22 @@ UCommon::FGridCube UCommon::FTexCube::GetGridCube() const noexcept
 	return FGridCube{ FGrid2D{ Grid2D.Width, Grid2D.Height / (uint64_t)ECubeFace::NumCubeFaces } };
 }
 
+UCommon::FTex2DView UCommon::FTexCube::GetFaceView(ECubeFace Face) noexcept
+{
+	const FGrid2D FaceGrid2D = GetGridCube().Grid2D;
+	return FlatTex2D.GetView(FUint64Vector2(0, FaceGrid2D.Height * (uint64_t)Face), FaceGrid2D);
+}
+
+UCommon::FConstTex2DView UCommon::FTexCube::GetFaceView(ECubeFace Face) const noexcept
+{
+	const FGrid2D FaceGrid2D = GetGridCube().Grid2D;
+	return FlatTex2D.GetView(FUint64Vector2(0, FaceGrid2D.Height * (uint64_t)Face), FaceGrid2D);
+}
+
 void UCommon::FTexCube::BilinearSample(float* Result, const FCubeTexcoord& CubeTexcoord) const noexcept
 {
-	const void* Storage = FlatTex2D.GetStorage();
-	const uint64_t Offset = FlatTex2D.GetStorageSizeInBytes() / (uint64_t)ECubeFace::NumCubeFaces * (uint64_t)CubeTexcoord.Face;
-	const void* OffsetedStorage = (const uint8_t*)Storage + Offset;
-	const FTex2D FaceTex2D(GetGridCube().Grid2D, FlatTex2D.GetNumChannels(), EOwnership::DoNotTakeOwnership, FlatTex2D.GetElementType(), const_cast<void*>(OffsetedStorage));
 	// Cube map faces are discontinuous at edges, so we must use Clamp mode
-	FaceTex2D.BilinearSample(Result, CubeTexcoord.Texcoord, ETextureAddress::Clamp, ETextureAddress::Clamp);
+	GetFaceView(CubeTexcoord.Face).BilinearSample(Result, CubeTexcoord.Texcoord, ETextureAddress::Clamp, ETextureAddress::Clamp);
 }
 
 void UCommon::FTexCube::ToEquirectangular(FTex2D& Equirectangular) const
@@ -23,52 +23,180 @@ SOFTWARE.
 */
 
 #include <UCommon/ThreadPool.h>
+#include <UCommon/Tex2D.h>
 
 #include <vector>
-#include <queue>
+#include <memory>
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <stdexcept>
 
+namespace UCommon
+{
+    static std::atomic<uint64_t> NumTaskAllocations{ 0 };
+
+    /**
+     * Growable ring buffer of tasks, usable as a FIFO and a deque.
+     * Its storage is only reallocated when it is full, so a queue in steady state doesn't allocate.
+     */
+    class FTaskQueue
+    {
+    public:
+        FTaskQueue() noexcept : Tasks(nullptr), Capacity(0), Head(0), Count(0) {}
+
+        ~FTaskQueue()
+        {
+            for (uint64_t i = 0; i < Count; ++i)
+            {
+                Tasks[(Head + i) & (Capacity - 1)].~FTask();
+            }
+            FTask::Free(Tasks);
+        }
+
+        bool IsEmpty() const noexcept { return Count == 0; }
+
+        void PushBack(FTask&& Task)
+        {
+            if (Count == Capacity)
+            {
+                Grow();
+            }
+            new(&Tasks[(Head + Count) & (Capacity - 1)]) FTask(std::move(Task));
+            ++Count;
+        }
+
+        FTask PopFront() noexcept
+        {
+            UBPA_UCOMMON_ASSERT(Count > 0);
+            FTask& Slot = Tasks[Head];
+            FTask Task(std::move(Slot));
+            Slot.~FTask();
+            Head = (Head + 1) & (Capacity - 1);
+            --Count;
+            return Task;
+        }
+
+        FTask PopBack() noexcept
+        {
+            UBPA_UCOMMON_ASSERT(Count > 0);
+            --Count;
+            FTask& Slot = Tasks[(Head + Count) & (Capacity - 1)];
+            FTask Task(std::move(Slot));
+            Slot.~FTask();
+            return Task;
+        }
+
+        FTaskQueue(const FTaskQueue&) = delete;
+        FTaskQueue& operator=(const FTaskQueue&) = delete;
+
+    private:
+        void Grow()
+        {
+            const uint64_t NewCapacity = Capacity == 0 ? 64 : 2 * Capacity;
+            FTask* NewTasks = static_cast<FTask*>(FTask::Allocate(NewCapacity * sizeof(FTask)));
+            for (uint64_t i = 0; i < Count; ++i)
+            {
+                FTask& Slot = Tasks[(Head + i) & (Capacity - 1)];
+                new(&NewTasks[i]) FTask(std::move(Slot));
+                Slot.~FTask();
+            }
+            FTask::Free(Tasks);
+            Tasks = NewTasks;
+            Capacity = NewCapacity;
+            Head = 0;
+        }
+
+        FTask* Tasks;
+        /** power of 2 */
+        uint64_t Capacity;
+        uint64_t Head;
+        uint64_t Count;
+    };
+}
+
+void* UCommon::FTask::Allocate(uint64_t Size)
+{
+    NumTaskAllocations.fetch_add(1, std::memory_order_relaxed);
+    return UBPA_UCOMMON_MALLOC(Size);
+}
+
+void UCommon::FTask::Free(void* Pointer) noexcept
+{
+    UBPA_UCOMMON_FREE(Pointer);
+}
+
 struct UCommon::FThreadPool::FImpl
 {
+    /** per-worker deque of the work-stealing scheduler */
+    struct alignas(64) FWorkerQueue
+    {
+        std::mutex Mutex;
+        FTaskQueue Tasks;
+    };
+
     /** need to keep track of threads so we can join them. */
     std::vector< std::thread > Workers;
-    /** the task queue */
-    std::queue< std::function<void()> > Tasks;
+    /** the task queue (SharedQueue) */
+    FTaskQueue Tasks;
+    /** the worker deques (WorkStealing) */
+    std::vector< std::unique_ptr<FWorkerQueue> > WorkerQueues;
 
     /** synchronization */
     std::mutex QueueMutex;
     std::condition_variable Condition;
-    bool bStop;
+    std::atomic<bool> bStop;
+
+    EScheduler Scheduler;
+
+    /** WorkStealing: number of tasks enqueued but not yet popped */
+    std::atomic<uint64_t> NumPendingTasks{ 0 };
+    /** WorkStealing: number of workers blocked on Condition */
+    std::atomic<uint64_t> NumSleepingWorkers{ 0 };
+    /** WorkStealing: round-robin cursor for tasks enqueued from outside the pool */
+    std::atomic<uint64_t> NextQueueIndex{ 0 };
+
+    /** a thread blocked in WaitUntil, its Condition is notified when a task is enqueued */
+    struct FWaiter
+    {
+        std::mutex* Mutex;
+        std::condition_variable* Condition;
+        FWaiter* Prev = nullptr;
+        FWaiter* Next = nullptr;
+    };
+    /** intrusive list of the waiters, the nodes live on their stacks */
+    std::mutex WaitersMutex;
+    FWaiter* Waiters = nullptr;
+    std::atomic<uint64_t> NumWaiters{ 0 };
+
+    /** the pool and the worker index of the current thread, if it is a worker */
+    static thread_local FImpl* CurrentImpl;
+    static thread_local uint64_t CurrentWorkerIndex;
 
-    FImpl(uint64_t NumThread)
+    FImpl(uint64_t NumThread, EScheduler InScheduler)
         : bStop(false)
+        , Scheduler(NumThread > 0 ? InScheduler : EScheduler::SharedQueue)
     {
+        if (Scheduler == EScheduler::WorkStealing)
+        {
+            WorkerQueues.reserve(NumThread);
+            for (uint64_t i = 0; i < NumThread; ++i)
+            {
+                WorkerQueues.emplace_back(new FWorkerQueue);
+            }
+        }
+
         for (uint64_t i = 0; i < NumThread; ++i)
         {
-            Workers.emplace_back(
-            [this]
+            if (Scheduler == EScheduler::WorkStealing)
             {
-                for (;;)
-                {
-                    std::function<void()> task;
-
-                    {
-                        std::unique_lock<std::mutex> lock(this->QueueMutex);
-                        this->Condition.wait(lock, [this] { return this->bStop || !this->Tasks.empty(); });
-                        if (this->bStop && this->Tasks.empty())
-                        {
-                            return;
-                        }
-                        task = std::move(this->Tasks.front());
-                        this->Tasks.pop();
-                    }
-
-                    task();
-                }
-            });
+                Workers.emplace_back([this, i] { WorkStealingLoop(i); });
+            }
+            else
+            {
+                Workers.emplace_back([this] { SharedQueueLoop(); });
+            }
         }
     }
 
@@ -84,10 +212,215 @@ struct UCommon::FThreadPool::FImpl
             worker.join();
         }
     }
+
+    void SharedQueueLoop()
+    {
+        for (;;)
+        {
+            FTask task;
+
+            {
+                std::unique_lock<std::mutex> lock(QueueMutex);
+                Condition.wait(lock, [this] { return bStop || !Tasks.IsEmpty(); });
+                if (bStop && Tasks.IsEmpty())
+                {
+                    return;
+                }
+                task = Tasks.PopFront();
+            }
+
+            task();
+        }
+    }
+
+    void WorkStealingLoop(uint64_t WorkerIndex)
+    {
+        CurrentImpl = this;
+        CurrentWorkerIndex = WorkerIndex;
+
+        for (;;)
+        {
+            FTask task;
+            if (PopLocal(WorkerIndex, task) || Steal(WorkerIndex + 1, WorkerQueues.size() - 1, task))
+            {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(QueueMutex);
+            ++NumSleepingWorkers;
+            Condition.wait(lock, [this] { return bStop || NumPendingTasks > 0; });
+            --NumSleepingWorkers;
+            if (bStop && NumPendingTasks == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    /** LIFO pop from the back of the own deque: the most recently pushed task is still hot in cache. */
+    bool PopLocal(uint64_t WorkerIndex, FTask& Task)
+    {
+        FWorkerQueue& Queue = *WorkerQueues[WorkerIndex];
+        std::lock_guard<std::mutex> lock(Queue.Mutex);
+        if (Queue.Tasks.IsEmpty())
+        {
+            return false;
+        }
+        Task = Queue.Tasks.PopBack();
+        --NumPendingTasks;
+        return true;
+    }
+
+    /**
+     * FIFO steal from the front of NumVictims deques starting at FirstVictim (wrapping around):
+     * the oldest tasks tend to be the largest.
+     */
+    bool Steal(uint64_t FirstVictim, uint64_t NumVictims, FTask& Task)
+    {
+        const uint64_t NumQueues = WorkerQueues.size();
+        for (uint64_t Offset = 0; Offset < NumVictims; ++Offset)
+        {
+            FWorkerQueue& Queue = *WorkerQueues[(FirstVictim + Offset) % NumQueues];
+            std::unique_lock<std::mutex> lock(Queue.Mutex, std::try_to_lock);
+            if (!lock.owns_lock() || Queue.Tasks.IsEmpty())
+            {
+                continue;
+            }
+            Task = Queue.Tasks.PopFront();
+            --NumPendingTasks;
+            return true;
+        }
+        return false;
+    }
+
+    bool EnqueueWorkStealing(FTask&& Task)
+    {
+        // Count the task before checking bStop and publishing it, all seq_cst. A worker only
+        // exits once it saw bStop with no pending task, so either this enqueue sees bStop and
+        // backs out, or the count keeps a worker alive until the task ran. Pops never run
+        // ahead of the count.
+        ++NumPendingTasks;
+        // don't allow enqueueing after stopping the pool
+        if (bStop)
+        {
+            --NumPendingTasks;
+            return false;
+        }
+
+        const uint64_t QueueIndex = CurrentImpl == this
+            ? CurrentWorkerIndex
+            : NextQueueIndex.fetch_add(1, std::memory_order_relaxed) % WorkerQueues.size();
+
+        {
+            FWorkerQueue& Queue = *WorkerQueues[QueueIndex];
+            std::lock_guard<std::mutex> lock(Queue.Mutex);
+            Queue.Tasks.PushBack(std::move(Task));
+        }
+
+        // A sleeper increments NumSleepingWorkers before checking NumPendingTasks, both under
+        // QueueMutex: either it sees the task or we see it. Taking QueueMutex once makes sure
+        // it is really waiting before the notification.
+        if (NumSleepingWorkers > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(QueueMutex);
+            }
+            Condition.notify_one();
+        }
+        NotifyWaiters();
+        return true;
+    }
+
+    /** Whether a task is queued, WaitUntil stops sleeping to help with it. */
+    bool HasQueuedTasks()
+    {
+        if (Scheduler == EScheduler::WorkStealing)
+        {
+            return NumPendingTasks > 0;
+        }
+        std::lock_guard<std::mutex> lock(QueueMutex);
+        return !Tasks.IsEmpty();
+    }
+
+    void AddWaiter(FWaiter& Waiter)
+    {
+        {
+            std::lock_guard<std::mutex> lock(WaitersMutex);
+            Waiter.Next = Waiters;
+            if (Waiters)
+            {
+                Waiters->Prev = &Waiter;
+            }
+            Waiters = &Waiter;
+            ++NumWaiters;
+        }
+        // pairs with the fence in NotifyWaiters: either the waiter sees the task or the enqueuer sees the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void RemoveWaiter(FWaiter& Waiter)
+    {
+        std::lock_guard<std::mutex> lock(WaitersMutex);
+        (Waiter.Prev ? Waiter.Prev->Next : Waiters) = Waiter.Next;
+        if (Waiter.Next)
+        {
+            Waiter.Next->Prev = Waiter.Prev;
+        }
+        --NumWaiters;
+    }
+
+    /** Called after a task is published, one fence and load when nobody waits. */
+    void NotifyWaiters()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (NumWaiters.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+        // a waiter unregisters under WaitersMutex, so its Mutex and Condition outlive the notification
+        std::lock_guard<std::mutex> lock(WaitersMutex);
+        for (FWaiter* Waiter = Waiters; Waiter; Waiter = Waiter->Next)
+        {
+            {
+                std::lock_guard<std::mutex> WaiterLock(*Waiter->Mutex);
+            }
+            Waiter->Condition->notify_all();
+        }
+    }
+
+    bool TryRunOneTask()
+    {
+        FTask task;
+        if (Scheduler == EScheduler::WorkStealing)
+        {
+            const bool bIsWorker = CurrentImpl == this;
+            if (bIsWorker ? !(PopLocal(CurrentWorkerIndex, task) || Steal(CurrentWorkerIndex + 1, WorkerQueues.size() - 1, task))
+                : !Steal(0, WorkerQueues.size(), task))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(QueueMutex);
+            if (Tasks.IsEmpty())
+            {
+                return false;
+            }
+            task = Tasks.PopFront();
+        }
+
+        task();
+        return true;
+    }
 };
 
-UCommon::FThreadPool::FThreadPool(uint64_t NumThread)
-    : Impl(new UBPA_UCOMMON_MALLOC(sizeof(FImpl))FImpl(NumThread))
+thread_local UCommon::FThreadPool::FImpl* UCommon::FThreadPool::FImpl::CurrentImpl = nullptr;
+thread_local uint64_t UCommon::FThreadPool::FImpl::CurrentWorkerIndex = 0;
+
+UCommon::FThreadPool::FThreadPool(uint64_t NumThread, EScheduler Scheduler)
+    : Impl(new UBPA_UCOMMON_MALLOC(sizeof(FImpl))FImpl(NumThread, Scheduler))
 {
 }
 
@@ -100,6 +433,18 @@ UCommon::FThreadPool::~FThreadPool()
 
 bool UCommon::FThreadPool::Enqueue(std::function<void()> Function)
 {
+    return Enqueue(FTask(std::move(Function)));
+}
+
+bool UCommon::FThreadPool::Enqueue(FTask Task)
+{
+    UBPA_UCOMMON_ASSERT(Task.IsValid());
+
+    if (Impl->Scheduler == EScheduler::WorkStealing)
+    {
+        return Impl->EnqueueWorkStealing(std::move(Task));
+    }
+
     {
         std::unique_lock<std::mutex> lock(Impl->QueueMutex);
 
@@ -110,14 +455,179 @@ bool UCommon::FThreadPool::Enqueue(std::function<void()> Function)
             return false;
         }
 
-        Impl->Tasks.emplace(std::move(Function));
+        Impl->Tasks.PushBack(std::move(Task));
     }
     Impl->Condition.notify_one();
+    Impl->NotifyWaiters();
     return true;
 }
 
+bool UCommon::FThreadPool::TryRunOneTask()
+{
+    return Impl->TryRunOneTask();
+}
+
+void UCommon::FThreadPool::WaitUntilImpl(std::mutex& Mutex, std::condition_variable& Condition, FPredicateFunction Predicate, void* Context)
+{
+    while (!Predicate(Context))
+    {
+        if (Impl->TryRunOneTask())
+        {
+            continue;
+        }
+
+        // register before sleeping, a task enqueued from now on wakes this thread
+        FImpl::FWaiter Waiter;
+        Waiter.Mutex = &Mutex;
+        Waiter.Condition = &Condition;
+        Impl->AddWaiter(Waiter);
+        {
+            std::unique_lock<std::mutex> lock(Mutex);
+            Condition.wait(lock, [&] { return Predicate(Context) || Impl->HasQueuedTasks(); });
+        }
+        Impl->RemoveWaiter(Waiter);
+    }
+}
+
+namespace UCommon
+{
+    /** Shared by the caller and the helper tasks of one ParallelFor, lives on the caller's stack. */
+    struct FParallelForContext
+    {
+        void (*Function)(void*, uint64_t, uint64_t);
+        void* Context;
+        uint64_t Begin;
+        uint64_t End;
+        uint64_t GrainSize;
+        uint64_t NumChunks;
+        std::atomic<uint64_t> NextChunk{ 0 };
+        /** written under Mutex, the last helper to exit notifies Condition */
+        std::atomic<uint64_t> NumExitedHelpers{ 0 };
+        std::mutex Mutex;
+        std::condition_variable Condition;
+
+        /** Claim and run chunks until none is left. */
+        void RunChunks()
+        {
+            for (uint64_t Chunk = NextChunk.fetch_add(1, std::memory_order_relaxed); Chunk < NumChunks; Chunk = NextChunk.fetch_add(1, std::memory_order_relaxed))
+            {
+                const uint64_t ChunkBegin = Begin + Chunk * GrainSize;
+                const uint64_t ChunkEnd = std::min(End, ChunkBegin + GrainSize);
+                Function(Context, ChunkBegin, ChunkEnd);
+            }
+        }
+    };
+
+    struct FParallelFor2DContext
+    {
+        void (*Function)(void*, const FUint64Vector2&, const FUint64Vector2&);
+        void* Context;
+        FUint64Vector2 Extent;
+        FUint64Vector2 TileSize;
+        uint64_t NumTilesX;
+    };
+}
+
+void UCommon::FThreadPool::ParallelForImpl(uint64_t Begin, uint64_t End, uint64_t GrainSize, FRangeFunction Function, void* Context)
+{
+    if (End <= Begin)
+    {
+        return;
+    }
+
+    const uint64_t Count = End - Begin;
+    const uint64_t NumWorkers = Impl->Workers.size();
+
+    if (GrainSize == 0)
+    {
+        // a few chunks per thread (the caller included) to balance uneven work
+        const uint64_t NumChunksHint = 4 * (NumWorkers + 1);
+        GrainSize = (Count + NumChunksHint - 1) / NumChunksHint;
+    }
+
+    if (NumWorkers == 0 || Count <= GrainSize)
+    {
+        Function(Context, Begin, End);
+        return;
+    }
+
+    FParallelForContext ParallelForContext;
+    ParallelForContext.Function = Function;
+    ParallelForContext.Context = Context;
+    ParallelForContext.Begin = Begin;
+    ParallelForContext.End = End;
+    ParallelForContext.GrainSize = GrainSize;
+    ParallelForContext.NumChunks = (Count + GrainSize - 1) / GrainSize;
+
+    // one helper per worker at most, the caller takes the remaining chunks
+    const uint64_t NumHelpers = std::min(NumWorkers, ParallelForContext.NumChunks - 1);
+    uint64_t NumEnqueuedHelpers = 0;
+    for (uint64_t i = 0; i < NumHelpers; ++i)
+    {
+        FParallelForContext* SharedContext = &ParallelForContext;
+        if (!Enqueue(FTask([SharedContext]
+            {
+                SharedContext->RunChunks();
+                // notify under the lock, the caller may destroy the context as soon as it sees the count
+                std::lock_guard<std::mutex> lock(SharedContext->Mutex);
+                SharedContext->NumExitedHelpers.fetch_add(1, std::memory_order_release);
+                SharedContext->Condition.notify_one();
+            })))
+        {
+            break;
+        }
+        ++NumEnqueuedHelpers;
+    }
+
+    ParallelForContext.RunChunks();
+
+    // Helpers still reference the context. Run queued tasks (possibly our own helpers)
+    // while waiting, so a worker waiting here can't starve the pool, and sleep otherwise.
+    WaitUntil(ParallelForContext.Mutex, ParallelForContext.Condition, [&]
+        {
+            return ParallelForContext.NumExitedHelpers.load(std::memory_order_acquire) == NumEnqueuedHelpers;
+        });
+    // the last helper may still hold the lock to notify
+    std::lock_guard<std::mutex> lock(ParallelForContext.Mutex);
+}
+
+void UCommon::FThreadPool::ParallelFor2DImpl(const FGrid2D& Grid, const FUint64Vector2& TileSize, FTileFunction Function, void* Context)
+{
+    UBPA_UCOMMON_ASSERT(TileSize.X > 0 && TileSize.Y > 0);
+
+    if (Grid.IsAreaEmpty())
+    {
+        return;
+    }
+
+    FParallelFor2DContext ParallelFor2DContext;
+    ParallelFor2DContext.Function = Function;
+    ParallelFor2DContext.Context = Context;
+    ParallelFor2DContext.Extent = Grid.GetExtent();
+    ParallelFor2DContext.TileSize = TileSize;
+    ParallelFor2DContext.NumTilesX = (Grid.Width + TileSize.X - 1) / TileSize.X;
+    const uint64_t NumTilesY = (Grid.Height + TileSize.Y - 1) / TileSize.Y;
+
+    ParallelForImpl(0, ParallelFor2DContext.NumTilesX * NumTilesY, 1, [](void* Context, uint64_t ChunkBegin, uint64_t ChunkEnd)
+    {
+        const FParallelFor2DContext& ParallelFor2DContext = *static_cast<const FParallelFor2DContext*>(Context);
+        for (uint64_t TileIndex = ChunkBegin; TileIndex < ChunkEnd; TileIndex++)
+        {
+            const FUint64Vector2 TileMin(
+                (TileIndex % ParallelFor2DContext.NumTilesX) * ParallelFor2DContext.TileSize.X,
+                (TileIndex / ParallelFor2DContext.NumTilesX) * ParallelFor2DContext.TileSize.Y);
+            const FUint64Vector2 TileMax = FUint64Vector2::Min(TileMin + ParallelFor2DContext.TileSize, ParallelFor2DContext.Extent);
+            ParallelFor2DContext.Function(ParallelFor2DContext.Context, TileMin, TileMax);
+        }
+    }, &ParallelFor2DContext);
+}
+
 size_t UCommon::FThreadPool::GetNumThreads() const noexcept { return Impl->Workers.size(); }
 
+UCommon::FThreadPool::EScheduler UCommon::FThreadPool::GetScheduler() const noexcept { return Impl->Scheduler; }
+
+uint64_t UCommon::FThreadPool::GetNumTaskAllocations() noexcept { return NumTaskAllocations.load(std::memory_order_relaxed); }
+
 UCommon::FThreadPoolRegistry UCommon::FThreadPoolRegistry::ThreadPoolRegistry;
 
 UCommon::FThreadPoolRegistry& UCommon::FThreadPoolRegistry::GetInstance() { return ThreadPoolRegistry; }
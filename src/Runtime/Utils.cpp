@@ -25,8 +25,16 @@ SOFTWARE.
 #include <UCommon/Utils.h>
 #include <UCommon/Config.h>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
+#if defined(UBPA_UCOMMON_SIMD_SSE2) || defined(UBPA_UCOMMON_SIMD_AVX2) || defined(UBPA_UCOMMON_SIMD_F16C)
+#include <immintrin.h>
+#endif
+#if defined(UBPA_UCOMMON_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
 float UCommon::ApplyAddressMode(float Coord, ETextureAddress AddressMode)
 {
 	switch (AddressMode)
@@ -128,3 +136,314 @@ void UCommon::MatrixMulVec(float* Result, const float* Matrix, const float* Vect
 		Result[RowIndex] = Acc;
 	}
 }
+
+namespace UCommon
+{
+	namespace Details
+	{
+		// Kernels from and to float, the other pairs go through a float buffer.
+		// Each one has a vectorized main loop and a scalar tail with the reference helpers.
+
+		static void ConvertUint8ToFloat(float* Dst, const uint8_t* Src, uint64_t Num) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			const __m256 Scale = _mm256_set1_ps(255.f);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				const __m256i Ints = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src + Index)));
+				_mm256_storeu_ps(Dst + Index, _mm256_div_ps(_mm256_cvtepi32_ps(Ints), Scale));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_SSE2)
+			const __m128 Scale = _mm_set1_ps(255.f);
+			const __m128i Zero = _mm_setzero_si128();
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				const __m128i Shorts = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src + Index)), Zero);
+				_mm_storeu_ps(Dst + Index, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Shorts, Zero)), Scale));
+				_mm_storeu_ps(Dst + Index + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Shorts, Zero)), Scale));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_NEON)
+			const float32x4_t Scale = vdupq_n_f32(255.f);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				const uint16x8_t Shorts = vmovl_u8(vld1_u8(Src + Index));
+				vst1q_f32(Dst + Index, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(Shorts))), Scale));
+				vst1q_f32(Dst + Index + 4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(Shorts))), Scale));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Dst[Index] = ElementUint8ToFloat(Src[Index]);
+			}
+		}
+
+		static void ConvertFloatToUint8(uint8_t* Dst, const float* Src, uint64_t Num) noexcept
+		{
+			uint64_t Index = 0;
+			// roundf(Clamp(x * 255, 0, 255)): truncate, then round half away from zero with the exact fraction
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			const __m256 Scale = _mm256_set1_ps(255.f);
+			const __m256 Zero = _mm256_setzero_ps();
+			const __m256 Half = _mm256_set1_ps(0.5f);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				const __m256 Value = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(Src + Index), Scale), Zero), Scale);
+				const __m256i Truncated = _mm256_cvttps_epi32(Value);
+				const __m256 Fraction = _mm256_sub_ps(Value, _mm256_cvtepi32_ps(Truncated));
+				// the mask is -1 where the fraction is >= 0.5
+				const __m256i Rounded = _mm256_sub_epi32(Truncated, _mm256_castps_si256(_mm256_cmp_ps(Fraction, Half, _CMP_GE_OQ)));
+				const __m128i Shorts = _mm_packs_epi32(_mm256_castsi256_si128(Rounded), _mm256_extracti128_si256(Rounded, 1));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(Dst + Index), _mm_packus_epi16(Shorts, Shorts));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_SSE2)
+			const __m128 Scale = _mm_set1_ps(255.f);
+			const __m128 Zero = _mm_setzero_ps();
+			const __m128 Half = _mm_set1_ps(0.5f);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				__m128i Rounded[2];
+				for (uint64_t Part = 0; Part < 2; Part++)
+				{
+					const __m128 Value = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(Src + Index + 4 * Part), Scale), Zero), Scale);
+					const __m128i Truncated = _mm_cvttps_epi32(Value);
+					const __m128 Fraction = _mm_sub_ps(Value, _mm_cvtepi32_ps(Truncated));
+					Rounded[Part] = _mm_sub_epi32(Truncated, _mm_castps_si128(_mm_cmpge_ps(Fraction, Half)));
+				}
+				const __m128i Shorts = _mm_packs_epi32(Rounded[0], Rounded[1]);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(Dst + Index), _mm_packus_epi16(Shorts, Shorts));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_NEON)
+			const float32x4_t Scale = vdupq_n_f32(255.f);
+			const float32x4_t Zero = vdupq_n_f32(0.f);
+			const float32x4_t Half = vdupq_n_f32(0.5f);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				uint32x4_t Rounded[2];
+				for (uint64_t Part = 0; Part < 2; Part++)
+				{
+					const float32x4_t Value = vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(Src + Index + 4 * Part), Scale), Zero), Scale);
+					const uint32x4_t Truncated = vcvtq_u32_f32(Value);
+					const float32x4_t Fraction = vsubq_f32(Value, vcvtq_f32_u32(Truncated));
+					// the mask is all ones (-1) where the fraction is >= 0.5
+					Rounded[Part] = vsubq_u32(Truncated, vcgeq_f32(Fraction, Half));
+				}
+				const uint16x8_t Shorts = vcombine_u16(vmovn_u32(Rounded[0]), vmovn_u32(Rounded[1]));
+				vst1_u8(Dst + Index, vmovn_u16(Shorts));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Dst[Index] = ElementFloatClampToUint8(Src[Index]);
+			}
+		}
+
+		static void ConvertHalfToFloat(float* Dst, const FHalf* Src, uint64_t Num) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_F16C)
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				_mm256_storeu_ps(Dst + Index, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Index))));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_NEON)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				vst1q_f32(Dst + Index, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const uint16_t*>(Src + Index)))));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Dst[Index] = ElementHalfToFloat(Src[Index]);
+			}
+		}
+
+		static void ConvertFloatToHalf(FHalf* Dst, const float* Src, uint64_t Num) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_F16C)
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Index), _mm256_cvtps_ph(_mm256_loadu_ps(Src + Index), _MM_FROUND_TO_NEAREST_INT));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_NEON)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				vst1_u16(reinterpret_cast<uint16_t*>(Dst + Index), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(Src + Index))));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Dst[Index] = ElementFloatToHalf(Src[Index]);
+			}
+		}
+
+		static void ConvertDoubleToFloat(float* Dst, const double* Src, uint64_t Num) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				_mm_storeu_ps(Dst + Index, _mm256_cvtpd_ps(_mm256_loadu_pd(Src + Index)));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_SSE2)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				const __m128 Low = _mm_cvtpd_ps(_mm_loadu_pd(Src + Index));
+				const __m128 High = _mm_cvtpd_ps(_mm_loadu_pd(Src + Index + 2));
+				_mm_storeu_ps(Dst + Index, _mm_movelh_ps(Low, High));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_NEON)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				vst1q_f32(Dst + Index, vcombine_f32(vcvt_f32_f64(vld1q_f64(Src + Index)), vcvt_f32_f64(vld1q_f64(Src + Index + 2))));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Dst[Index] = static_cast<float>(Src[Index]);
+			}
+		}
+
+		static void ConvertFloatToDouble(double* Dst, const float* Src, uint64_t Num) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				_mm256_storeu_pd(Dst + Index, _mm256_cvtps_pd(_mm_loadu_ps(Src + Index)));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_SSE2)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				const __m128 Value = _mm_loadu_ps(Src + Index);
+				_mm_storeu_pd(Dst + Index, _mm_cvtps_pd(Value));
+				_mm_storeu_pd(Dst + Index + 2, _mm_cvtps_pd(_mm_movehl_ps(Value, Value)));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_NEON)
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				const float32x4_t Value = vld1q_f32(Src + Index);
+				vst1q_f64(Dst + Index, vcvt_f64_f32(vget_low_f32(Value)));
+				vst1q_f64(Dst + Index + 2, vcvt_high_f64_f32(Value));
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Dst[Index] = static_cast<double>(Src[Index]);
+			}
+		}
+
+		/** Element / 255. in double, not through float. */
+		static void ConvertUint8ToDouble(double* Dst, const uint8_t* Src, uint64_t Num) noexcept
+		{
+			uint64_t Index = 0;
+#if defined(UBPA_UCOMMON_SIMD_AVX2)
+			const __m256d Scale = _mm256_set1_pd(255.);
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				uint32_t Bytes;
+				std::memcpy(&Bytes, Src + Index, sizeof(uint32_t));
+				const __m128i Ints = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(static_cast<int>(Bytes)));
+				_mm256_storeu_pd(Dst + Index, _mm256_div_pd(_mm256_cvtepi32_pd(Ints), Scale));
+			}
+#elif defined(UBPA_UCOMMON_SIMD_NEON)
+			const float64x2_t Scale = vdupq_n_f64(255.);
+			for (; Index + 8 <= Num; Index += 8)
+			{
+				const uint16x8_t Shorts = vmovl_u8(vld1_u8(Src + Index));
+				const uint32x4_t Ints[2] = { vmovl_u16(vget_low_u16(Shorts)), vmovl_u16(vget_high_u16(Shorts)) };
+				for (uint64_t Part = 0; Part < 2; Part++)
+				{
+					vst1q_f64(Dst + Index + 4 * Part, vdivq_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(Ints[Part]))), Scale));
+					vst1q_f64(Dst + Index + 4 * Part + 2, vdivq_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(Ints[Part]))), Scale));
+				}
+			}
+#endif
+			for (; Index < Num; Index++)
+			{
+				Dst[Index] = ElementUint8ToDouble(Src[Index]);
+			}
+		}
+
+		static void ConvertToFloat(float* Dst, const void* Src, EElementType SrcType, uint64_t Num) noexcept
+		{
+			switch (SrcType)
+			{
+			case EElementType::Uint8:
+				ConvertUint8ToFloat(Dst, static_cast<const uint8_t*>(Src), Num);
+				break;
+			case EElementType::Half:
+				ConvertHalfToFloat(Dst, static_cast<const FHalf*>(Src), Num);
+				break;
+			case EElementType::Float:
+				std::memcpy(Dst, Src, Num * sizeof(float));
+				break;
+			case EElementType::Double:
+				ConvertDoubleToFloat(Dst, static_cast<const double*>(Src), Num);
+				break;
+			default:
+				UBPA_UCOMMON_NO_ENTRY();
+				break;
+			}
+		}
+
+		static void ConvertFromFloat(void* Dst, EElementType DstType, const float* Src, uint64_t Num) noexcept
+		{
+			switch (DstType)
+			{
+			case EElementType::Uint8:
+				ConvertFloatToUint8(static_cast<uint8_t*>(Dst), Src, Num);
+				break;
+			case EElementType::Half:
+				ConvertFloatToHalf(static_cast<FHalf*>(Dst), Src, Num);
+				break;
+			case EElementType::Float:
+				std::memcpy(Dst, Src, Num * sizeof(float));
+				break;
+			case EElementType::Double:
+				ConvertFloatToDouble(static_cast<double*>(Dst), Src, Num);
+				break;
+			default:
+				UBPA_UCOMMON_NO_ENTRY();
+				break;
+			}
+		}
+	}
+}
+
+void UCommon::ElementConvert(void* Dst, EElementType DstType, const void* Src, EElementType SrcType, uint64_t NumElements) noexcept
+{
+	if (DstType == SrcType)
+	{
+		std::memcpy(Dst, Src, NumElements * ElementGetSize(SrcType));
+		return;
+	}
+	if (SrcType == EElementType::Float)
+	{
+		Details::ConvertFromFloat(Dst, DstType, static_cast<const float*>(Src), NumElements);
+		return;
+	}
+	if (DstType == EElementType::Float)
+	{
+		Details::ConvertToFloat(static_cast<float*>(Dst), Src, SrcType, NumElements);
+		return;
+	}
+	if (SrcType == EElementType::Uint8 && DstType == EElementType::Double)
+	{
+		Details::ConvertUint8ToDouble(static_cast<double*>(Dst), static_cast<const uint8_t*>(Src), NumElements);
+		return;
+	}
+
+	// through a float buffer small enough to stay in L1
+	constexpr uint64_t BatchSize = 256;
+	float Buffer[BatchSize];
+	const uint64_t SrcElementSize = ElementGetSize(SrcType);
+	const uint64_t DstElementSize = ElementGetSize(DstType);
+	for (uint64_t Offset = 0; Offset < NumElements; Offset += BatchSize)
+	{
+		const uint64_t Num = std::min(BatchSize, NumElements - Offset);
+		Details::ConvertToFloat(Buffer, static_cast<const uint8_t*>(Src) + Offset * SrcElementSize, SrcType, Num);
+		Details::ConvertFromFloat(static_cast<uint8_t*>(Dst) + Offset * DstElementSize, DstType, Buffer, Num);
+	}
+}
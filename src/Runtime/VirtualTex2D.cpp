@@ -0,0 +1,582 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/VirtualTex2D.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace UCommon
+{
+	namespace Details
+	{
+		static constexpr uint64_t NoVirtualTex2DSlot = ~uint64_t(0);
+
+		static uint64_t DivideUp(uint64_t Value, uint64_t Divisor) noexcept { return (Value + Divisor - 1) / Divisor; }
+
+		/** Bytes of the tiles of the file, false if the layout is invalid or the size overflows (e.g. a damaged header). */
+		static bool GetVirtualTex2DDataSize(const FGrid2D& Grid2D, uint64_t NumChannels, EElementType ElementType, uint64_t TileSize, uint64_t& DataSize) noexcept
+		{
+			if (Grid2D.IsAreaEmpty() || NumChannels == 0 || TileSize == 0
+				|| (ElementType != EElementType::Uint8 && ElementType != EElementType::Half && ElementType != EElementType::Float && ElementType != EElementType::Double))
+			{
+				return false;
+			}
+			const uint64_t Factors[] = { DivideUp(Grid2D.Width, TileSize), DivideUp(Grid2D.Height, TileSize), TileSize, TileSize, NumChannels, ElementGetSize(ElementType) };
+			DataSize = 1;
+			for (uint64_t Factor : Factors)
+			{
+				if (Factor > ~uint64_t(0) / DataSize)
+				{
+					return false;
+				}
+				DataSize *= Factor;
+			}
+			return true;
+		}
+
+		static void SerializeVirtualTex2DLayout(IArchive& Archive, FGrid2D& Grid2D, uint64_t& NumChannels, EElementType& ElementType, uint64_t& TileSize)
+		{
+			Archive.ByteSerialize(Grid2D);
+			Archive.ByteSerialize(NumChannels);
+			Archive.ByteSerialize(ElementType);
+			Archive.ByteSerialize(TileSize);
+		}
+	}
+}
+
+/**
+ * The cache is one FTex2D of NumSlots tiles stacked vertically, so a slot is TileSizeInBytes contiguous bytes.
+ * Slots form a doubly linked list in recency order (Head is the most recent), without allocation on access.
+ */
+struct UCommon::FVirtualTex2D::FImpl
+{
+	struct FSlot
+	{
+		uint64_t Tile = 0;
+		uint64_t Prev = Details::NoVirtualTex2DSlot;
+		uint64_t Next = Details::NoVirtualTex2DSlot;
+		bool bDirty = false;
+	};
+
+	FRandomAccessFile Reader;
+	/** nullptr if not writable. */
+	std::unique_ptr<FRandomAccessFile> Writer;
+	bool bWritable = false;
+	bool bFailed = false;
+	uint64_t DataOffset = 0;
+
+	FGrid2D Grid2D;
+	uint64_t NumChannels = 0;
+	EElementType ElementType = EElementType::Unknown;
+	uint64_t TileSize = 0;
+	FGrid2D TileGrid2D;
+	uint64_t TileSizeInBytes = 0;
+	uint64_t CacheSizeInBytes = 0;
+
+	FTex2D Slots;
+	std::vector<FSlot> SlotInfos;
+	/** Slot of each tile, NoVirtualTex2DSlot if not resident. */
+	std::vector<uint64_t> TileSlots;
+	uint64_t NumUsedSlots = 0;
+	uint64_t Head = Details::NoVirtualTex2DSlot;
+	uint64_t Tail = Details::NoVirtualTex2DSlot;
+
+	FStats Stats;
+
+	FImpl(const char* FilePath, bool bInWritable)
+		: Reader(IArchive::EState::Loading, FilePath)
+		, Writer(bInWritable ? std::make_unique<FRandomAccessFile>(IArchive::EState::Saving, FilePath) : nullptr)
+		, bWritable(bInWritable) {}
+
+	void Init(uint64_t InCacheSizeInBytes)
+	{
+		TileGrid2D = FGrid2D(Details::DivideUp(Grid2D.Width, TileSize), Details::DivideUp(Grid2D.Height, TileSize));
+		TileSizeInBytes = TileSize * TileSize * NumChannels * ElementGetSize(ElementType);
+		CacheSizeInBytes = InCacheSizeInBytes;
+		const uint64_t NumTiles = TileGrid2D.GetArea();
+		const uint64_t NumSlots = std::min(GetNumCachedTiles(TileSize, NumChannels, ElementType, CacheSizeInBytes), NumTiles);
+		Slots = FTex2D(FGrid2D(TileSize, TileSize * NumSlots), NumChannels, ElementType);
+		SlotInfos.resize(NumSlots);
+		TileSlots.assign(NumTiles, Details::NoVirtualTex2DSlot);
+	}
+
+	FTex2DView GetSlotView(uint64_t Slot) noexcept
+	{
+		return Slots.GetView(FUint64Vector2(0, Slot * TileSize), FGrid2D(TileSize, TileSize));
+	}
+
+	uint64_t GetTileOffset(uint64_t Tile) const noexcept { return DataOffset + Tile * TileSizeInBytes; }
+
+	void Unlink(uint64_t Slot) noexcept
+	{
+		FSlot& Info = SlotInfos[Slot];
+		(Info.Prev != Details::NoVirtualTex2DSlot ? SlotInfos[Info.Prev].Next : Head) = Info.Next;
+		(Info.Next != Details::NoVirtualTex2DSlot ? SlotInfos[Info.Next].Prev : Tail) = Info.Prev;
+	}
+
+	void PushFront(uint64_t Slot) noexcept
+	{
+		FSlot& Info = SlotInfos[Slot];
+		Info.Prev = Details::NoVirtualTex2DSlot;
+		Info.Next = Head;
+		(Head != Details::NoVirtualTex2DSlot ? SlotInfos[Head].Prev : Tail) = Slot;
+		Head = Slot;
+	}
+
+	void WriteBack(uint64_t Slot)
+	{
+		FSlot& Info = SlotInfos[Slot];
+		if (!Info.bDirty || !Writer)
+		{
+			return;
+		}
+		if (!Writer->WriteAt(GetTileOffset(Info.Tile), GetSlotView(Slot).GetRow(0), TileSizeInBytes))
+		{
+			bFailed = true;
+		}
+		Info.bDirty = false;
+		Stats.NumWriteBacks++;
+	}
+
+	/**
+	 * Page the tile in and make it the most recent one.
+	 * @param bOverwrite the caller writes the whole tile, so it isn't read.
+	 */
+	FTex2DView GetTile(uint64_t Tile, bool bDirty, bool bOverwrite = false)
+	{
+		UBPA_UCOMMON_ASSERT(Tile < TileSlots.size());
+		UBPA_UCOMMON_ASSERT(!bDirty || bWritable);
+		uint64_t Slot = TileSlots[Tile];
+		if (Slot != Details::NoVirtualTex2DSlot)
+		{
+			Stats.NumHits++;
+			if (Slot != Head)
+			{
+				Unlink(Slot);
+				PushFront(Slot);
+			}
+		}
+		else
+		{
+			Stats.NumMisses++;
+			if (NumUsedSlots < SlotInfos.size())
+			{
+				Slot = NumUsedSlots++;
+			}
+			else
+			{
+				Slot = Tail;
+				WriteBack(Slot);
+				TileSlots[SlotInfos[Slot].Tile] = Details::NoVirtualTex2DSlot;
+				Unlink(Slot);
+			}
+			SlotInfos[Slot].Tile = Tile;
+			TileSlots[Tile] = Slot;
+			PushFront(Slot);
+			if (!bOverwrite)
+			{
+				Stats.NumReads++;
+				void* Storage = GetSlotView(Slot).GetRow(0);
+				if (!Reader.ReadAt(GetTileOffset(Tile), Storage, TileSizeInBytes))
+				{
+					bFailed = true;
+					std::memset(Storage, 0, TileSizeInBytes);
+				}
+			}
+		}
+		SlotInfos[Slot].bDirty |= bDirty;
+		return GetSlotView(Slot);
+	}
+
+	/** The tile of Point, and Point in the tile. */
+	uint64_t GetTileIndex(const FUint64Vector2& Point, FUint64Vector2& LocalPoint) const noexcept
+	{
+		UBPA_UCOMMON_ASSERT(Grid2D.Contains(Point));
+		LocalPoint = FUint64Vector2(Point.X % TileSize, Point.Y % TileSize);
+		return (Point.Y / TileSize) * TileGrid2D.Width + Point.X / TileSize;
+	}
+
+	/**
+	 * Call Function(TileView, First) for each tile intersecting [Min, Max), with the tile view clipped to the rectangle,
+	 * First is the texel at the origin of the clipped view.
+	 * @param bOverwrite Function writes every texel without reading it, so whole tiles aren't read.
+	 */
+	template<typename FunctionT>
+	void ForEachTile(const FUint64Vector2& Min, const FUint64Vector2& Max, bool bDirty, bool bOverwrite, FunctionT&& Function)
+	{
+		for (uint64_t TileY = Min.Y / TileSize; TileY < Details::DivideUp(Max.Y, TileSize); TileY++)
+		{
+			for (uint64_t TileX = Min.X / TileSize; TileX < Details::DivideUp(Max.X, TileSize); TileX++)
+			{
+				const FUint64Vector2 TileOrigin(TileX * TileSize, TileY * TileSize);
+				const FUint64Vector2 First(std::max(TileOrigin.X, Min.X), std::max(TileOrigin.Y, Min.Y));
+				const FUint64Vector2 Last(std::min(TileOrigin.X + TileSize, Max.X), std::min(TileOrigin.Y + TileSize, Max.Y));
+				const bool bWholeTile = Last.X - First.X == TileSize && Last.Y - First.Y == TileSize;
+				const FTex2DView TileView = GetTile(TileY * TileGrid2D.Width + TileX, bDirty, bOverwrite && bWholeTile);
+				Function(TileView.GetSubView(First - TileOrigin, FGrid2D(Last - First)), First);
+			}
+		}
+	}
+
+	/** Writes need a writable file, otherwise they are dropped and recorded as a failure (see Flush). */
+	bool CheckWritable() noexcept
+	{
+		if (!bWritable)
+		{
+			bFailed = true;
+		}
+		return bWritable;
+	}
+
+	void Flush()
+	{
+		for (uint64_t Slot = 0; Slot < NumUsedSlots; Slot++)
+		{
+			WriteBack(Slot);
+		}
+	}
+};
+
+//
+// FVirtualTex2D
+///////////
+
+uint64_t UCommon::FVirtualTex2D::GetNumCachedTiles(uint64_t TileSize, uint64_t NumChannels, EElementType ElementType, uint64_t CacheSizeInBytes) noexcept
+{
+	const uint64_t TileSizeInBytes = TileSize * TileSize * NumChannels * ElementGetSize(ElementType);
+	return std::max<uint64_t>(4, CacheSizeInBytes / std::max<uint64_t>(1, TileSizeInBytes));
+}
+
+UCommon::FVirtualTex2D::FVirtualTex2D() noexcept
+	: Impl(nullptr) {}
+
+UCommon::FVirtualTex2D::FVirtualTex2D(const char* FilePath, const FGrid2D& InGrid2D, uint64_t InNumChannels, EElementType InElementType, uint64_t InTileSize, uint64_t CacheSizeInBytes)
+	: Impl(nullptr)
+{
+	UBPA_UCOMMON_ASSERT(!InGrid2D.IsAreaEmpty() && InNumChannels > 0 && InTileSize > 0);
+	UBPA_UCOMMON_ASSERT(InElementType == EElementType::Uint8 || InElementType == EElementType::Half || InElementType == EElementType::Float || InElementType == EElementType::Double);
+
+	FGrid2D Grid2D = InGrid2D;
+	uint64_t NumChannels = InNumChannels;
+	EElementType ElementType = InElementType;
+	uint64_t TileSize = InTileSize;
+	uint64_t DataOffset = 0;
+	uint64_t DataSize = 0;
+	{
+		FFileArchive Archive(IArchive::EState::Saving, FilePath);
+		if (!Archive.IsValid())
+		{
+			return;
+		}
+		Details::SerializeVirtualTex2DLayout(Archive, Grid2D, NumChannels, ElementType, TileSize);
+		DataOffset = Archive.Tell();
+		// the (empty) version map goes after the tiles
+		const uint64_t NumTiles = Details::DivideUp(Grid2D.Width, TileSize) * Details::DivideUp(Grid2D.Height, TileSize);
+		DataSize = NumTiles * TileSize * TileSize * NumChannels * ElementGetSize(ElementType);
+		Archive.Seek(DataOffset + DataSize);
+	}
+
+	Impl = new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(FilePath, true);
+	// the empty version map writes nothing, so extend the file over the tiles, which read as 0 until written
+	const uint8_t Zero = 0;
+	if (!Impl->Reader.IsValid() || !Impl->Writer->IsValid() || !Impl->Writer->WriteAt(DataOffset + DataSize - 1, &Zero, 1))
+	{
+		*this = FVirtualTex2D();
+		return;
+	}
+	Impl->DataOffset = DataOffset;
+	Impl->Grid2D = Grid2D;
+	Impl->NumChannels = NumChannels;
+	Impl->ElementType = ElementType;
+	Impl->TileSize = TileSize;
+	Impl->Init(CacheSizeInBytes);
+}
+
+UCommon::FVirtualTex2D::FVirtualTex2D(const char* FilePath, bool bWritable, uint64_t CacheSizeInBytes)
+	: Impl(nullptr)
+{
+	FGrid2D Grid2D;
+	uint64_t NumChannels = 0;
+	EElementType ElementType = EElementType::Unknown;
+	uint64_t TileSize = 0;
+	uint64_t DataOffset = 0;
+	{
+		FFileArchive Archive(IArchive::EState::Loading, FilePath);
+		if (!Archive.IsValid())
+		{
+			return;
+		}
+		Details::SerializeVirtualTex2DLayout(Archive, Grid2D, NumChannels, ElementType, TileSize);
+		DataOffset = Archive.Tell();
+	}
+	uint64_t DataSize = 0;
+	if (!Details::GetVirtualTex2DDataSize(Grid2D, NumChannels, ElementType, TileSize, DataSize) || DataSize > ~uint64_t(0) - DataOffset)
+	{
+		return;
+	}
+
+	// the file must hold all the tiles, so a damaged header can't make the cache or the tile table huge
+	Impl = new (UBPA_UCOMMON_MALLOC(sizeof(FImpl)))FImpl(FilePath, bWritable);
+	uint8_t LastByte = 0;
+	if (!Impl->Reader.IsValid() || (bWritable && !Impl->Writer->IsValid()) || !Impl->Reader.ReadAt(DataOffset + DataSize - 1, &LastByte, 1))
+	{
+		*this = FVirtualTex2D();
+		return;
+	}
+	Impl->DataOffset = DataOffset;
+	Impl->Grid2D = Grid2D;
+	Impl->NumChannels = NumChannels;
+	Impl->ElementType = ElementType;
+	Impl->TileSize = TileSize;
+	Impl->Init(CacheSizeInBytes);
+}
+
+UCommon::FVirtualTex2D::FVirtualTex2D(FVirtualTex2D&& Other) noexcept
+	: Impl(Other.Impl)
+{
+	Other.Impl = nullptr;
+}
+
+UCommon::FVirtualTex2D& UCommon::FVirtualTex2D::operator=(FVirtualTex2D&& Other) noexcept
+{
+	FVirtualTex2D Temp(std::move(Other));
+	Swap(Temp);
+	return *this;
+}
+
+void UCommon::FVirtualTex2D::Swap(FVirtualTex2D& Other) noexcept
+{
+	std::swap(Impl, Other.Impl);
+}
+
+UCommon::FVirtualTex2D::~FVirtualTex2D()
+{
+	if (Impl)
+	{
+		if (Impl->bWritable)
+		{
+			Impl->Flush();
+		}
+		Impl->~FImpl();
+		UBPA_UCOMMON_FREE(Impl);
+	}
+}
+
+bool UCommon::FVirtualTex2D::IsValid() const noexcept { return Impl != nullptr; }
+bool UCommon::FVirtualTex2D::IsWritable() const noexcept { return Impl && Impl->bWritable; }
+const UCommon::FGrid2D& UCommon::FVirtualTex2D::GetGrid2D() const noexcept { return Impl->Grid2D; }
+uint64_t UCommon::FVirtualTex2D::GetNumChannels() const noexcept { return Impl->NumChannels; }
+UCommon::EElementType UCommon::FVirtualTex2D::GetElementType() const noexcept { return Impl->ElementType; }
+uint64_t UCommon::FVirtualTex2D::GetTileSize() const noexcept { return Impl->TileSize; }
+UCommon::FGrid2D UCommon::FVirtualTex2D::GetTileGrid2D() const noexcept { return Impl->TileGrid2D; }
+uint64_t UCommon::FVirtualTex2D::GetNumCachedTiles() const noexcept { return Impl->SlotInfos.size(); }
+
+float UCommon::FVirtualTex2D::GetFloat(const FUint64Vector2& Point, uint64_t C)
+{
+	FUint64Vector2 LocalPoint;
+	const uint64_t Tile = Impl->GetTileIndex(Point, LocalPoint);
+	return Impl->GetTile(Tile, false).GetFloat(LocalPoint, C);
+}
+
+void UCommon::FVirtualTex2D::SetFloat(const FUint64Vector2& Point, uint64_t C, float Value)
+{
+	if (!Impl->CheckWritable())
+	{
+		return;
+	}
+	FUint64Vector2 LocalPoint;
+	const uint64_t Tile = Impl->GetTileIndex(Point, LocalPoint);
+	Impl->GetTile(Tile, true).SetFloat(LocalPoint, C, Value);
+}
+
+void UCommon::FVirtualTex2D::BilinearSample(float* Result, const FVector2f& Texcoord, ETextureAddress AddressModeX, ETextureAddress AddressModeY)
+{
+	const FGrid2D& Grid2D = Impl->Grid2D;
+	const FVector2f PointT = Texcoord * FVector2f(Grid2D.GetExtent());
+	const FVector2f PointTOffset = PointT - 0.5f;
+	const FInt64Vector2 IntPoint0 = FInt64Vector2(PointTOffset.Floor());
+	const FInt64Vector2 IntPoint1 = IntPoint0 + 1;
+
+	const FUint64Vector2 Points[2] =
+	{
+		ApplyAddressMode(IntPoint0, Grid2D.GetExtent(), AddressModeX, AddressModeY),
+		ApplyAddressMode(IntPoint1, Grid2D.GetExtent(), AddressModeX, AddressModeY),
+	};
+
+	const FVector2f LocalTexcoord = (PointT - (FVector2f(IntPoint0) + 0.5f)).Clamp(0.f, 1.f);
+	const FVector2f OneMinusLocalTexcoord = FVector2f(1.f) - LocalTexcoord;
+
+	const float Weights[4] =
+	{
+		OneMinusLocalTexcoord.X * OneMinusLocalTexcoord.Y,
+		OneMinusLocalTexcoord.X * LocalTexcoord.Y,
+		LocalTexcoord.X * OneMinusLocalTexcoord.Y,
+		LocalTexcoord.X * LocalTexcoord.Y,
+	};
+
+	// the cache holds at least 4 tiles, so the 4 tap tiles stay resident together
+	const FUint64Vector2 TapPoints[4] =
+	{
+		FUint64Vector2(Points[0].X, Points[0].Y),
+		FUint64Vector2(Points[0].X, Points[1].Y),
+		FUint64Vector2(Points[1].X, Points[0].Y),
+		FUint64Vector2(Points[1].X, Points[1].Y),
+	};
+	FTex2DView TapTiles[4];
+	FUint64Vector2 LocalPoints[4];
+	for (uint64_t Tap = 0; Tap < 4; Tap++)
+	{
+		TapTiles[Tap] = Impl->GetTile(Impl->GetTileIndex(TapPoints[Tap], LocalPoints[Tap]), false);
+	}
+
+	for (uint64_t C = 0; C < Impl->NumChannels; C++)
+	{
+		float Val2[4];
+		for (uint64_t Tap = 0; Tap < 4; Tap++)
+		{
+			Val2[Tap] = TapTiles[Tap].GetFloat(LocalPoints[Tap], C);
+		}
+		Result[C] = UCommon::BilinearInterpolate(Val2, Weights);
+	}
+}
+
+void UCommon::FVirtualTex2D::CopyTo(const FTex2DView& Dst, const FUint64Vector2& Origin)
+{
+	UBPA_UCOMMON_ASSERT(Dst.GetNumChannels() == Impl->NumChannels && Dst.GetElementType() == Impl->ElementType);
+	const FUint64Vector2 Max = Origin + Dst.GetGrid2D().GetExtent();
+	UBPA_UCOMMON_ASSERT(Max.X <= Impl->Grid2D.Width && Max.Y <= Impl->Grid2D.Height);
+	Impl->ForEachTile(Origin, Max, false, false, [&](const FTex2DView& TileView, const FUint64Vector2& First)
+	{
+		Dst.GetSubView(First - Origin, TileView.GetGrid2D()).CopyFrom(TileView);
+	});
+}
+
+void UCommon::FVirtualTex2D::CopyFrom(const FUint64Vector2& Origin, const FConstTex2DView& Src)
+{
+	UBPA_UCOMMON_ASSERT(Src.GetNumChannels() == Impl->NumChannels && Src.GetElementType() == Impl->ElementType);
+	if (!Impl->CheckWritable())
+	{
+		return;
+	}
+	const FUint64Vector2 Max = Origin + Src.GetGrid2D().GetExtent();
+	UBPA_UCOMMON_ASSERT(Max.X <= Impl->Grid2D.Width && Max.Y <= Impl->Grid2D.Height);
+	Impl->ForEachTile(Origin, Max, true, true, [&](const FTex2DView& TileView, const FUint64Vector2& First)
+	{
+		TileView.CopyFrom(Src.GetSubView(First - Origin, TileView.GetGrid2D()));
+	});
+}
+
+bool UCommon::FVirtualTex2D::Flush()
+{
+	if (Impl->bWritable)
+	{
+		Impl->Flush();
+	}
+	return !Impl->bFailed;
+}
+
+UCommon::FVirtualTex2D UCommon::FVirtualTex2D::DownSample(const char* DstFilePath)
+{
+	const FGrid2D& Grid2D = Impl->Grid2D;
+	const FGrid2D HalfGrid2D(std::max<uint64_t>(1, Grid2D.Width / 2), std::max<uint64_t>(1, Grid2D.Height / 2));
+	FVirtualTex2D HalfTex(DstFilePath, HalfGrid2D, Impl->NumChannels, Impl->ElementType, Impl->TileSize, Impl->CacheSizeInBytes);
+	if (!HalfTex.IsValid())
+	{
+		return HalfTex;
+	}
+
+	const uint64_t TileSize = Impl->TileSize;
+	const FGrid2D HalfTileGrid2D = HalfTex.GetTileGrid2D();
+	for (uint64_t TileY = 0; TileY < HalfTileGrid2D.Height; TileY++)
+	{
+		for (uint64_t TileX = 0; TileX < HalfTileGrid2D.Width; TileX++)
+		{
+			const FUint64Vector2 HalfMin(TileX * TileSize, TileY * TileSize);
+			const FUint64Vector2 HalfMax(std::min(HalfMin.X + TileSize, HalfGrid2D.Width), std::min(HalfMin.Y + TileSize, HalfGrid2D.Height));
+			// the 2x2 footprints of the tile, a 1-texel side stays 1 texel as in FTex2D::DownSample
+			const FUint64Vector2 Min = HalfMin * 2;
+			const FUint64Vector2 Max(std::min(HalfMax.X * 2, Grid2D.Width), std::min(HalfMax.Y * 2, Grid2D.Height));
+			FTex2D Window(FGrid2D(Max - Min), Impl->NumChannels, Impl->ElementType);
+			CopyTo(Window, Min);
+			const FTex2D HalfWindow = Window.DownSample();
+			UBPA_UCOMMON_ASSERT(HalfWindow.GetGrid2D() == FGrid2D(HalfMax - HalfMin));
+			HalfTex.CopyFrom(HalfMin, HalfWindow);
+		}
+	}
+	return HalfTex;
+}
+
+void UCommon::FVirtualTex2D::Clamp(float MinValue, float MaxValue, FThreadPool* ThreadPool)
+{
+	if (!Impl->CheckWritable())
+	{
+		return;
+	}
+	Impl->ForEachTile(FUint64Vector2(0, 0), Impl->Grid2D.GetExtent(), true, false, [&](const FTex2DView& TileView, const FUint64Vector2&)
+	{
+		TileView.Clamp(MinValue, MaxValue, ThreadPool);
+	});
+}
+
+void UCommon::FVirtualTex2D::ImageInpainting(FVirtualTex2D& CoverageData, uint64_t Apron, FThreadPool* ThreadPool)
+{
+	const FGrid2D& Grid2D = Impl->Grid2D;
+	UBPA_UCOMMON_ASSERT(CoverageData.GetGrid2D() == Grid2D);
+	UBPA_UCOMMON_ASSERT(CoverageData.GetNumChannels() == 1 || CoverageData.GetNumChannels() == Impl->NumChannels);
+	if (!Impl->CheckWritable())
+	{
+		return;
+	}
+	const uint64_t TileSize = Impl->TileSize;
+	if (Apron == 0)
+	{
+		Apron = TileSize;
+	}
+
+	for (uint64_t TileY = 0; TileY < Impl->TileGrid2D.Height; TileY++)
+	{
+		for (uint64_t TileX = 0; TileX < Impl->TileGrid2D.Width; TileX++)
+		{
+			const FUint64Vector2 TileMin(TileX * TileSize, TileY * TileSize);
+			const FUint64Vector2 TileMax(std::min(TileMin.X + TileSize, Grid2D.Width), std::min(TileMin.Y + TileSize, Grid2D.Height));
+			const FUint64Vector2 Min(TileMin.X - std::min(TileMin.X, Apron), TileMin.Y - std::min(TileMin.Y, Apron));
+			const FUint64Vector2 Max(std::min(TileMax.X + Apron, Grid2D.Width), std::min(TileMax.Y + Apron, Grid2D.Height));
+			const FGrid2D WindowGrid2D(Max - Min);
+
+			// the inpainted tiles around have coverage 0, so their values are ignored
+			FTex2D Coverage(WindowGrid2D, CoverageData.GetNumChannels(), CoverageData.GetElementType());
+			CoverageData.CopyTo(Coverage, Min);
+			FTex2D Window(WindowGrid2D, Impl->NumChannels, Impl->ElementType);
+			CopyTo(Window, Min);
+			Window.ImageInpainting(Coverage, ThreadPool);
+			CopyFrom(TileMin, Window.GetView(TileMin - Min, FGrid2D(TileMax - TileMin)));
+		}
+	}
+}
+
+UCommon::FVirtualTex2D::FStats UCommon::FVirtualTex2D::GetStats() const noexcept { return Impl->Stats; }
+void UCommon::FVirtualTex2D::ResetStats() noexcept { Impl->Stats = FStats(); }
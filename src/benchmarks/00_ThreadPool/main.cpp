@@ -0,0 +1,260 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace UCommon;
+
+namespace
+{
+	const char* GetSchedulerName(FThreadPool::EScheduler Scheduler)
+	{
+		return Scheduler == FThreadPool::EScheduler::SharedQueue ? "SharedQueue" : "WorkStealing";
+	}
+
+	/**
+	 * The plain pool the schedulers are compared against:
+	 * one std::queue<std::function<void()>> behind one mutex, a notify per task.
+	 */
+	class FReferenceThreadPool
+	{
+	public:
+		explicit FReferenceThreadPool(uint64_t NumThreads)
+		{
+			for (uint64_t Index = 0; Index < NumThreads; Index++)
+			{
+				Workers.emplace_back([this]
+				{
+					while (true)
+					{
+						std::function<void()> Task;
+						{
+							std::unique_lock<std::mutex> Lock(Mutex);
+							Condition.wait(Lock, [this] { return bStop || !Tasks.empty(); });
+							if (bStop && Tasks.empty())
+							{
+								return;
+							}
+							Task = std::move(Tasks.front());
+							Tasks.pop();
+						}
+						Task();
+					}
+				});
+			}
+		}
+
+		~FReferenceThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				bStop = true;
+			}
+			Condition.notify_all();
+			for (std::thread& Worker : Workers)
+			{
+				Worker.join();
+			}
+		}
+
+		bool Enqueue(std::function<void()> Task)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				if (bStop)
+				{
+					return false;
+				}
+				Tasks.push(std::move(Task));
+			}
+			Condition.notify_one();
+			return true;
+		}
+
+	private:
+		std::vector<std::thread> Workers;
+		std::queue<std::function<void()>> Tasks;
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		bool bStop = false;
+	};
+
+	/** A few hundred nanoseconds of work, so that scheduling overhead dominates. */
+	uint64_t TinyWork(uint64_t Seed)
+	{
+		for (uint64_t Index = 0; Index < 64; Index++)
+		{
+			Seed = Seed * 6364136223846793005ull + 1442695040888963407ull;
+		}
+		return Seed;
+	}
+
+	/** The caller enqueues every task. Returns tasks per second. */
+	template<typename ThreadPoolT>
+	double RunFlat(ThreadPoolT& ThreadPool, uint64_t NumTasks)
+	{
+		std::atomic<uint64_t> NumDone{ 0 };
+		std::atomic<uint64_t> Sink{ 0 };
+		const auto Begin = std::chrono::steady_clock::now();
+		for (uint64_t Index = 0; Index < NumTasks; Index++)
+		{
+			ThreadPool.Enqueue(std::function<void()>([&NumDone, &Sink, Index]
+			{
+				Sink.fetch_add(TinyWork(Index) & 1, std::memory_order_relaxed);
+				NumDone.fetch_add(1, std::memory_order_release);
+			}));
+		}
+		while (NumDone.load(std::memory_order_acquire) != NumTasks)
+		{
+			std::this_thread::yield();
+		}
+		const std::chrono::duration<double> Seconds = std::chrono::steady_clock::now() - Begin;
+		return NumTasks / Seconds.count();
+	}
+
+	/** NumProducers outside threads enqueue NumTasks tasks between them, contending on the enqueue path. Returns tasks per second. */
+	template<typename ThreadPoolT>
+	double RunProducers(ThreadPoolT& ThreadPool, uint64_t NumTasks, uint64_t NumProducers)
+	{
+		std::atomic<uint64_t> NumDone{ 0 };
+		std::atomic<uint64_t> Sink{ 0 };
+		std::vector<std::thread> Producers;
+		const auto Begin = std::chrono::steady_clock::now();
+		for (uint64_t ProducerIndex = 0; ProducerIndex < NumProducers; ProducerIndex++)
+		{
+			Producers.emplace_back([&ThreadPool, &NumDone, &Sink, NumTasks, NumProducers, ProducerIndex]
+			{
+				for (uint64_t Index = ProducerIndex; Index < NumTasks; Index += NumProducers)
+				{
+					ThreadPool.Enqueue(std::function<void()>([&NumDone, &Sink, Index]
+					{
+						Sink.fetch_add(TinyWork(Index) & 1, std::memory_order_relaxed);
+						NumDone.fetch_add(1, std::memory_order_release);
+					}));
+				}
+			});
+		}
+		for (std::thread& Producer : Producers)
+		{
+			Producer.join();
+		}
+		while (NumDone.load(std::memory_order_acquire) != NumTasks)
+		{
+			std::this_thread::yield();
+		}
+		const std::chrono::duration<double> Seconds = std::chrono::steady_clock::now() - Begin;
+		return NumTasks / Seconds.count();
+	}
+
+	/** Tasks recursively spawn children from worker threads (fan-out 4). Returns tasks per second. */
+	template<typename ThreadPoolT>
+	double RunNested(ThreadPoolT& ThreadPool, uint64_t Depth)
+	{
+		std::atomic<uint64_t> NumDone{ 0 };
+		uint64_t NumTasks = 0;
+		for (uint64_t Level = 0, Count = 1; Level <= Depth; Level++, Count *= 4)
+		{
+			NumTasks += Count;
+		}
+
+		std::function<void(uint64_t)> Spawn = [&](uint64_t Level)
+		{
+			if (Level > 0)
+			{
+				for (uint64_t Index = 0; Index < 4; Index++)
+				{
+					ThreadPool.Enqueue(std::function<void()>([&Spawn, Level] { Spawn(Level - 1); }));
+				}
+			}
+			TinyWork(Level);
+			NumDone.fetch_add(1, std::memory_order_release);
+		};
+
+		const auto Begin = std::chrono::steady_clock::now();
+		ThreadPool.Enqueue(std::function<void()>([&Spawn, Depth] { Spawn(Depth); }));
+		while (NumDone.load(std::memory_order_acquire) != NumTasks)
+		{
+			std::this_thread::yield();
+		}
+		const std::chrono::duration<double> Seconds = std::chrono::steady_clock::now() - Begin;
+		return NumTasks / Seconds.count();
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t NumTasks = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 200000;
+	const uint64_t NestedDepth = Argc > 2 ? std::strtoull(Argv[2], nullptr, 10) : 8;
+	const uint64_t MaxThreads = std::max<uint64_t>(1, std::thread::hardware_concurrency());
+
+	std::cout << "FThreadPool throughput (million tasks / s)" << std::endl;
+	std::cout << "  flat: " << NumTasks << " tasks enqueued by the caller" << std::endl;
+	std::cout << "  producers: the same tasks enqueued by as many outside threads as workers" << std::endl;
+	std::cout << "  nested: fan-out 4, depth " << NestedDepth << ", enqueued by workers" << std::endl;
+	std::cout << "  Reference: std::queue<std::function<void()>> + std::mutex, the baseline" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(8) << "Threads" << std::setw(14) << "Scheduler" << std::setw(10) << "flat" << std::setw(11) << "producers" << std::setw(10) << "nested" << std::endl;
+
+	for (uint64_t NumThreads = 1; ; NumThreads = std::min(NumThreads * 2, MaxThreads))
+	{
+		{
+			FReferenceThreadPool ThreadPool(NumThreads);
+			const double Flat = RunFlat(ThreadPool, NumTasks);
+			const double Producers = RunProducers(ThreadPool, NumTasks, NumThreads);
+			const double Nested = RunNested(ThreadPool, NestedDepth);
+			std::cout << std::setw(8) << NumThreads << std::setw(14) << "Reference"
+				<< std::fixed << std::setprecision(3)
+				<< std::setw(10) << Flat / 1e6 << std::setw(11) << Producers / 1e6 << std::setw(10) << Nested / 1e6 << std::endl;
+		}
+		for (FThreadPool::EScheduler Scheduler : { FThreadPool::EScheduler::SharedQueue, FThreadPool::EScheduler::WorkStealing })
+		{
+			FThreadPool ThreadPool(NumThreads, Scheduler);
+			const double Flat = RunFlat(ThreadPool, NumTasks);
+			const double Producers = RunProducers(ThreadPool, NumTasks, NumThreads);
+			const double Nested = RunNested(ThreadPool, NestedDepth);
+			std::cout << std::setw(8) << NumThreads << std::setw(14) << GetSchedulerName(Scheduler)
+				<< std::fixed << std::setprecision(3)
+				<< std::setw(10) << Flat / 1e6 << std::setw(11) << Producers / 1e6 << std::setw(10) << Nested / 1e6 << std::endl;
+		}
+		if (NumThreads == MaxThreads)
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
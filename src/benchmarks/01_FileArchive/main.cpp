@@ -0,0 +1,120 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Archive.h>
+#include <UCommon/ThreadPool.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace UCommon;
+
+namespace
+{
+	const char* const FilePath = "benchmark_01_file_archive.uasset";
+
+	/** Many 4-byte ByteSerialize calls, the shape of typical object serialization. Returns MB/s. */
+	double RunSmallWrites(const FFileArchiveConfig& Config, uint64_t NumBytes)
+	{
+		const auto Begin = std::chrono::steady_clock::now();
+		{
+			FFileArchive Archive(IArchive::EState::Saving, FilePath, Config);
+			for (uint32_t Index = 0; Index < NumBytes / sizeof(uint32_t); Index++)
+			{
+				Archive.ByteSerialize(Index);
+			}
+		}
+		const std::chrono::duration<double> Seconds = std::chrono::steady_clock::now() - Begin;
+		return NumBytes / (1024. * 1024.) / Seconds.count();
+	}
+
+	/** A few large blobs, the shape of texture payloads. Returns MB/s. */
+	double RunLargeWrites(const FFileArchiveConfig& Config, uint64_t NumBytes)
+	{
+		const uint64_t BlobSize = 16 * 1024 * 1024;
+		std::vector<uint8_t> Blob(BlobSize);
+		for (uint64_t Index = 0; Index < BlobSize; Index++)
+		{
+			Blob[Index] = (uint8_t)(Index * 31);
+		}
+
+		const auto Begin = std::chrono::steady_clock::now();
+		{
+			FFileArchive Archive(IArchive::EState::Saving, FilePath, Config);
+			for (uint64_t Offset = 0; Offset < NumBytes; Offset += BlobSize)
+			{
+				Archive.Serialize(Blob.data(), BlobSize);
+			}
+		}
+		const std::chrono::duration<double> Seconds = std::chrono::steady_clock::now() - Begin;
+		return NumBytes / (1024. * 1024.) / Seconds.count();
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t NumMegaBytes = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 256;
+	const uint64_t NumBytes = NumMegaBytes * 1024 * 1024;
+
+	FThreadPool ThreadPool(1);
+
+	FFileArchiveConfig Direct;
+
+	FFileArchiveConfig Buffered;
+	Buffered.BufferSize = 1024 * 1024;
+
+	FFileArchiveConfig Async;
+	Async.BufferSize = 1024 * 1024;
+	Async.ThreadPool = &ThreadPool;
+
+	struct FMode
+	{
+		const char* Name;
+		const FFileArchiveConfig* Config;
+	};
+	const FMode Modes[] = {
+		{ "Direct", &Direct },
+		{ "Buffered", &Buffered },
+		{ "Async", &Async },
+	};
+
+	std::cout << "FFileArchive write throughput (MB/s), " << NumMegaBytes << " MB per run, 1 MB buffers" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(10) << "Mode" << std::setw(12) << "small" << std::setw(12) << "large" << std::endl;
+	for (const FMode& Mode : Modes)
+	{
+		const double Small = RunSmallWrites(*Mode.Config, NumBytes);
+		const double Large = RunLargeWrites(*Mode.Config, NumBytes);
+		std::cout << std::setw(10) << Mode.Name << std::fixed << std::setprecision(1)
+			<< std::setw(12) << Small << std::setw(12) << Large << std::endl;
+	}
+
+	std::remove(FilePath);
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Archive.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** The previous FMemoryArchive saving path: one value-initializing resize per write. */
+	class FResizeArchive : public IArchive
+	{
+	public:
+		FResizeArchive() : IArchive(EState::Saving) {}
+
+		virtual void Serialize(void* Pointer, uint64_t Length) override
+		{
+			const size_t OriginalSize = Storage.size();
+			Storage.resize(OriginalSize + Length);
+			std::memcpy(Storage.data() + OriginalSize, Pointer, Length);
+		}
+
+		std::vector<uint8_t> Storage;
+	};
+
+	struct FSmallObject
+	{
+		uint32_t Id;
+		float Position[3];
+		uint64_t Flags;
+
+		void Serialize(IArchive& Archive)
+		{
+			Archive.ByteSerialize(Id);
+			Archive.ByteSerialize(Position);
+			Archive.ByteSerialize(Flags);
+		}
+	};
+
+	/** 10k small objects, repeated NumRounds times with a fresh archive. Returns milliseconds per round. */
+	template<typename MakeArchiveT>
+	double RunSmallObjects(MakeArchiveT&& MakeArchive, uint64_t NumRounds)
+	{
+		std::vector<FSmallObject> Objects(10000);
+		for (uint32_t Index = 0; Index < Objects.size(); Index++)
+		{
+			Objects[Index] = { Index, { (float)Index, 1.f, 2.f }, Index * 3ull };
+		}
+		const double Seconds = MeasureSeconds([&]
+		{
+			for (uint64_t Round = 0; Round < NumRounds; Round++)
+			{
+				auto Archive = MakeArchive();
+				for (FSmallObject& Object : Objects)
+				{
+					Object.Serialize(*Archive);
+				}
+			}
+		});
+		return Seconds * 1000. / NumRounds;
+	}
+
+	/** NumBytes of texture rows written 1 MB at a time. Returns MB/s. */
+	template<typename MakeArchiveT>
+	double RunTextureData(MakeArchiveT&& MakeArchive, const std::vector<uint8_t>& Row, uint64_t NumBytes)
+	{
+		const double Seconds = MeasureSeconds([&]
+		{
+			auto Archive = MakeArchive();
+			for (uint64_t Offset = 0; Offset < NumBytes; Offset += Row.size())
+			{
+				Archive->Serialize(const_cast<uint8_t*>(Row.data()), Row.size());
+			}
+		});
+		return NumBytes / (1024. * 1024.) / Seconds;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t NumMegaBytes = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 1024;
+	const uint64_t NumBytes = NumMegaBytes * 1024 * 1024;
+	const uint64_t NumRounds = 100;
+	const uint64_t SmallObjectsSize = 10000 * (sizeof(uint32_t) + 3 * sizeof(float) + sizeof(uint64_t));
+
+	std::vector<uint8_t> Row(1024 * 1024);
+	for (uint64_t Index = 0; Index < Row.size(); Index++)
+	{
+		Row[Index] = (uint8_t)Index;
+	}
+	std::vector<uint8_t> FixedBuffer(std::max(NumBytes, SmallObjectsSize));
+
+	auto MakeResize = [] { return std::make_unique<FResizeArchive>(); };
+	auto MakeGrowing = [] { return std::make_unique<FMemoryArchive>(); };
+	auto MakeReserved = [](uint64_t Capacity)
+	{
+		return [Capacity]
+		{
+			std::unique_ptr<FMemoryArchive> Archive = std::make_unique<FMemoryArchive>();
+			Archive->Reserve(Capacity);
+			return Archive;
+		};
+	};
+	auto MakeFixed = [&FixedBuffer] { return std::make_unique<FMemoryArchive>(FixedBuffer.data(), FixedBuffer.size()); };
+
+	std::cout << "FMemoryArchive saving" << std::endl;
+	std::cout << "  small: 10k objects (3 ByteSerialize each), ms per archive" << std::endl;
+	std::cout << "  texture: " << NumMegaBytes << " MB in 1 MB rows, MB/s" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(16) << "Storage" << std::setw(12) << "small" << std::setw(12) << "texture" << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << std::setw(16) << "resize (old)" << std::setw(12) << RunSmallObjects(MakeResize, NumRounds)
+		<< std::setw(12) << std::setprecision(1) << RunTextureData(MakeResize, Row, NumBytes) << std::setprecision(3) << std::endl;
+	std::cout << std::setw(16) << "geometric" << std::setw(12) << RunSmallObjects(MakeGrowing, NumRounds)
+		<< std::setw(12) << std::setprecision(1) << RunTextureData(MakeGrowing, Row, NumBytes) << std::setprecision(3) << std::endl;
+	std::cout << std::setw(16) << "Reserve" << std::setw(12) << RunSmallObjects(MakeReserved(SmallObjectsSize), NumRounds)
+		<< std::setw(12) << std::setprecision(1) << RunTextureData(MakeReserved(NumBytes), Row, NumBytes) << std::setprecision(3) << std::endl;
+	std::cout << std::setw(16) << "fixed buffer" << std::setw(12) << RunSmallObjects(MakeFixed, NumRounds)
+		<< std::setw(12) << std::setprecision(1) << RunTextureData(MakeFixed, Row, NumBytes) << std::setprecision(3) << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** The previous conversion path: GetFloat and a scalar helper per element. */
+	FTex2D ConvertPerElement(const FTex2D& Src, EElementType ElementType)
+	{
+		FTex2D Tex(Src.GetGrid2D(), Src.GetNumChannels(), ElementType);
+		for (uint64_t Index = 0; Index < Src.GetNumElements(); Index++)
+		{
+			const float Value = Src.GetFloat(Index);
+			switch (ElementType)
+			{
+			case EElementType::Uint8: Tex.At<uint8_t>(Index) = ElementFloatClampToUint8(Value); break;
+			case EElementType::Half: Tex.At<FHalf>(Index) = ElementFloatToHalf(Value); break;
+			case EElementType::Float: Tex.At<float>(Index) = Value; break;
+			case EElementType::Double: Tex.At<double>(Index) = Value; break;
+			default: break;
+			}
+		}
+		return Tex;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 8192;
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	FTex2D FloatTex(FGrid2D(Size, Size), 4, EElementType::Float);
+	for (uint64_t Index = 0; Index < FloatTex.GetNumElements(); Index++)
+	{
+		FloatTex.At<float>(Index) = (float)(Index % 4099) / 2048.f - 0.5f;
+	}
+
+	const EElementType ElementTypes[] = { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double };
+	std::cout << "FTex2D conversion, " << Size << "x" << Size << " RGBA, " << NumThreads << " threads, Melements/s" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(18) << "Conversion" << std::setw(14) << "per element" << std::setw(12) << "ConvertTo" << std::setw(12) << "parallel" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	const double NumMegaElements = FloatTex.GetNumElements() / 1e6;
+	for (EElementType SrcType : ElementTypes)
+	{
+		const FTex2D Src = FloatTex.ConvertTo(SrcType, &ThreadPool);
+		for (EElementType DstType : ElementTypes)
+		{
+			if (SrcType == DstType)
+			{
+				continue;
+			}
+			const double PerElement = MeasureSeconds([&] { ConvertPerElement(Src, DstType); });
+			const double Vectorized = MeasureSeconds([&] { Src.ConvertTo(DstType); });
+			const double Parallel = MeasureSeconds([&] { Src.ConvertTo(DstType, &ThreadPool); });
+			std::cout << std::setw(8) << GetElementTypeName(SrcType) << " -> " << std::setw(6) << GetElementTypeName(DstType)
+				<< std::setw(14) << NumMegaElements / PerElement
+				<< std::setw(12) << NumMegaElements / Vectorized
+				<< std::setw(12) << NumMegaElements / Parallel << std::endl;
+		}
+	}
+
+	return 0;
+}
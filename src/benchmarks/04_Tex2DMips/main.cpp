@@ -0,0 +1,81 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** The previous way to build a chain: one DownSample() allocation per level. */
+	void DownSampleChain(const FTex2D& Tex)
+	{
+		FTex2D Mip = Tex;
+		for (uint64_t Level = 1; Level < Tex.GetGrid2D().GetNumMips(); Level++)
+		{
+			Mip = Mip.DownSample();
+		}
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 4096;
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	FTex2D FloatTex(FGrid2D(Size, Size), 4, EElementType::Float);
+	for (uint64_t Index = 0; Index < FloatTex.GetNumElements(); Index++)
+	{
+		FloatTex.At<float>(Index) = (float)(Index % 4099) / 4099.f;
+	}
+
+	std::cout << "Mip chain of " << Size << "x" << Size << " RGBA, " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(8) << "Type" << std::setw(12) << "DownSample" << std::setw(10) << "Box"
+		<< std::setw(12) << "Box par." << std::setw(12) << "Kaiser par." << std::setw(14) << "Lanczos par." << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	const EElementType ElementTypes[] = { EElementType::Uint8, EElementType::Float, EElementType::Double };
+	for (EElementType ElementType : ElementTypes)
+	{
+		const FTex2D Tex = FloatTex.ConvertTo(ElementType, &ThreadPool);
+		std::cout << std::setw(8) << GetElementTypeName(ElementType)
+			<< std::setw(12) << MeasureMilliseconds([&] { DownSampleChain(Tex); })
+			<< std::setw(10) << MeasureMilliseconds([&] { Tex.GenerateMips(EMipFilter::Box); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.GenerateMips(EMipFilter::Box, &ThreadPool); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.GenerateMips(EMipFilter::Kaiser, &ThreadPool); })
+			<< std::setw(14) << MeasureMilliseconds([&] { Tex.GenerateMips(EMipFilter::Lanczos, &ThreadPool); }) << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** The previous Resize: one BilinearSample per output texel. */
+	FTex2D ResizePerTexel(const FTex2D& Tex, const FGrid2D& Grid2D)
+	{
+		FTex2D Result(Grid2D, Tex.GetNumChannels(), Tex.GetElementType());
+		const auto SampleBuffer = std::make_unique<float[]>(Tex.GetNumChannels());
+		for (const FUint64Vector2& Point : Grid2D)
+		{
+			Tex.BilinearSample(SampleBuffer.get(), Grid2D.GetTexcoord(Point), ETextureAddress::Clamp, ETextureAddress::Clamp);
+			for (uint64_t C = 0; C < Tex.GetNumChannels(); C++)
+			{
+				Result.SetFloat(Point, C, SampleBuffer[C]);
+			}
+		}
+		return Result;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 4096;
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	FTex2D Tex(FGrid2D(Size, Size), 4, EElementType::Float);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<float>(Index) = (float)(Index % 4099) / 4099.f;
+	}
+
+	std::cout << "Resize of " << Size << "x" << Size << " RGBA Float, " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(12) << "Target" << std::setw(12) << "per texel" << std::setw(10) << "Triangle"
+		<< std::setw(12) << "Tri. par." << std::setw(12) << "CatRom par." << std::setw(14) << "Lanczos3 par." << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	const double Scales[] = { 1.5, 0.75, 0.5 };
+	for (double Scale : Scales)
+	{
+		const FGrid2D Target((uint64_t)(Size * Scale), (uint64_t)(Size * Scale));
+		std::cout << std::setw(12) << Target.Width
+			<< std::setw(12) << MeasureMilliseconds([&] { ResizePerTexel(Tex, Target); })
+			<< std::setw(10) << MeasureMilliseconds([&] { Tex.Resize(Target); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.Resize(Target, EResizeFilter::Triangle, &ThreadPool); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.Resize(Target, EResizeFilter::CatmullRom, &ThreadPool); })
+			<< std::setw(14) << MeasureMilliseconds([&] { Tex.Resize(Target, EResizeFilter::Lanczos3, &ThreadPool); }) << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t NumSamples = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : (1ull << 22);
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	// a reprojection-like pattern: a slightly rotated and scaled grid over the texture
+	std::vector<FVector2f> Texcoords(NumSamples);
+	for (uint64_t Index = 0; Index < NumSamples; Index++)
+	{
+		const float X = (float)(Index % 2048) / 2048.f;
+		const float Y = (float)(Index / 2048) / 2048.f;
+		Texcoords[Index] = FVector2f(0.98f * X + 0.05f * Y + 0.01f, -0.05f * X + 0.98f * Y + 0.03f);
+	}
+	const TSpan<const FVector2f> TexcoordSpan(Texcoords.data(), Texcoords.size());
+
+	std::cout << NumSamples << " bilinear samples of a 2048x2048 texture, " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(8) << "Type" << std::setw(10) << "Channels" << std::setw(12) << "per sample"
+		<< std::setw(10) << "batch" << std::setw(12) << "batch par." << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float })
+	{
+		for (uint64_t NumChannels : { 1, 4 })
+		{
+			FTex2D Tex(FGrid2D(2048, 2048), NumChannels, EElementType::Float);
+			for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+			{
+				Tex.At<float>(Index) = (float)(Index % 4099) / 4099.f;
+			}
+			Tex = Tex.ConvertTo(ElementType);
+
+			std::vector<float> Results(NumSamples * NumChannels);
+			std::cout << std::setw(8) << (ElementType == EElementType::Uint8 ? "Uint8" : ElementType == EElementType::Half ? "Half" : "Float")
+				<< std::setw(10) << NumChannels
+				<< std::setw(12) << MeasureMilliseconds([&]
+				{
+					for (uint64_t Index = 0; Index < NumSamples; Index++)
+					{
+						Tex.BilinearSample(Results.data() + Index * NumChannels, Texcoords[Index]);
+					}
+				})
+				<< std::setw(10) << MeasureMilliseconds([&] { Tex.BilinearSampleBatch(TexcoordSpan, Results.data()); })
+				<< std::setw(12) << MeasureMilliseconds([&] { Tex.BilinearSampleBatch(TexcoordSpan, Results.data(), ETextureAddress::Wrap, ETextureAddress::Wrap, &ThreadPool); })
+				<< std::endl;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 4096;
+	const uint64_t NumSamples = Argc > 2 ? std::strtoull(Argv[2], nullptr, 10) : (1ull << 22);
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	// random texcoords over the whole texture, and a column-major scan (rows of samples walk down the texture)
+	std::vector<FVector2f> RandomTexcoords(NumSamples);
+	std::vector<FVector2f> ColumnTexcoords(NumSamples);
+	for (uint64_t Index = 0; Index < NumSamples; Index++)
+	{
+		const uint32_t Hash = HashUint32(static_cast<uint32_t>(Index));
+		RandomTexcoords[Index] = FVector2f((float)(Hash & 0xFFFF) / 65536.f, (float)(Hash >> 16) / 65536.f);
+		ColumnTexcoords[Index] = FVector2f((float)(Index / Size % Size) / (float)Size, (float)(Index % Size) / (float)Size);
+	}
+
+	std::cout << NumSamples << " bilinear samples (BilinearSampleBatch) of a " << Size << "x" << Size << " texture, " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(8) << "Type" << std::setw(10) << "Channels" << std::setw(10) << "Layout"
+		<< std::setw(10) << "random" << std::setw(12) << "random par." << std::setw(10) << "column"
+		<< std::setw(12) << "DownSample" << std::setw(12) << "to layout" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float })
+	{
+		for (uint64_t NumChannels : { 1, 4 })
+		{
+			FTex2D Linear(FGrid2D(Size, Size), NumChannels, EElementType::Float);
+			for (uint64_t Index = 0; Index < Linear.GetNumElements(); Index++)
+			{
+				Linear.At<float>(Index) = (float)(Index % 4099) / 4099.f;
+			}
+			Linear = Linear.ConvertTo(ElementType, &ThreadPool);
+
+			FTex2D Tiled;
+			const double TilingMilliseconds = MeasureMilliseconds([&] { Tiled = Linear.ToStorageLayout(ETex2DStorageLayout::Tiled); });
+			const double UntilingMilliseconds = MeasureMilliseconds([&] { Tiled.ToStorageLayout(ETex2DStorageLayout::Linear); });
+
+			std::vector<float> Results(NumSamples * NumChannels);
+			for (const FTex2D* Tex : { &Linear, &Tiled })
+			{
+				const bool bTiled = Tex->GetStorageLayout() == ETex2DStorageLayout::Tiled;
+				std::cout << std::setw(8) << (ElementType == EElementType::Uint8 ? "Uint8" : ElementType == EElementType::Half ? "Half" : "Float")
+					<< std::setw(10) << NumChannels
+					<< std::setw(10) << (bTiled ? "Tiled" : "Linear")
+					<< std::setw(10) << MeasureMilliseconds([&] { Tex->BilinearSampleBatch({ RandomTexcoords.data(), RandomTexcoords.size() }, Results.data()); })
+					<< std::setw(12) << MeasureMilliseconds([&] { Tex->BilinearSampleBatch({ RandomTexcoords.data(), RandomTexcoords.size() }, Results.data(), ETextureAddress::Wrap, ETextureAddress::Wrap, &ThreadPool); })
+					<< std::setw(10) << MeasureMilliseconds([&] { Tex->BilinearSampleBatch({ ColumnTexcoords.data(), ColumnTexcoords.size() }, Results.data()); })
+					<< std::setw(12) << MeasureMilliseconds([&] { Tex->DownSample(); })
+					<< std::setw(12) << (bTiled ? TilingMilliseconds : UntilingMilliseconds)
+					<< std::endl;
+			}
+		}
+	}
+
+	return 0;
+}
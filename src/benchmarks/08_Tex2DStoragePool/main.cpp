@@ -0,0 +1,108 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** A processing step full of temporaries: a converted copy, a DownSample chain and a Resize output. */
+	void ProcessTemporaries(const FTex2D& Tex, FThreadPool* ThreadPool)
+	{
+		FTex2D Mip = Tex.ToFloat(ThreadPool);
+		for (uint64_t Level = 1; Level < Tex.GetGrid2D().GetNumMips(); Level++)
+		{
+			Mip = Mip.DownSample();
+		}
+		const FGrid2D& Grid2D = Tex.GetGrid2D();
+		const FTex2D Resized = Tex.Resize(FGrid2D(Grid2D.Width * 3 / 4, Grid2D.Height * 3 / 4), EResizeFilter::Triangle, ThreadPool);
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 1024;
+	const uint64_t NumIterations = Argc > 2 ? std::strtoull(Argv[2], nullptr, 10) : 32;
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	std::cout << "Temporaries of " << Size << "x" << Size << " RGBA Uint8, " << NumIterations << " iterations, "
+		<< NumThreads << " threads, ms" << std::endl;
+	std::cout << std::endl;
+
+	FTex2D Tex(FGrid2D(Size, Size), 4, EElementType::Uint8);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<uint8_t>(Index) = static_cast<uint8_t>(Index * 7 % 251);
+	}
+
+	auto Run = [&]
+	{
+		for (uint64_t Iteration = 0; Iteration < NumIterations; Iteration++)
+		{
+			ProcessTemporaries(Tex, &ThreadPool);
+		}
+	};
+	/** Allocation and first write of the mip levels alone. */
+	auto RunAllocations = [&]
+	{
+		for (uint64_t Iteration = 0; Iteration < NumIterations; Iteration++)
+		{
+			for (uint64_t Level = 0; Level < Tex.GetGrid2D().GetNumMips(); Level++)
+			{
+				FTex2D Mip(FGrid2D(std::max<uint64_t>(1, Size >> Level), std::max<uint64_t>(1, Size >> Level)), 4, EElementType::Float);
+				std::memset(Mip.GetStorage(), 0, Mip.GetStorageSizeInBytes());
+			}
+		}
+	};
+
+	std::cout << std::setw(12) << "" << std::setw(14) << "temporaries" << std::setw(14) << "allocations" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << std::setw(12) << "no pool" << std::setw(14) << MeasureMilliseconds(Run) << std::setw(14) << MeasureMilliseconds(RunAllocations) << std::endl;
+
+	FTex2DStoragePool Pool;
+	{
+		FTex2DStoragePoolScope Scope(&Pool);
+		std::cout << std::setw(12) << "pool" << std::setw(14) << MeasureMilliseconds(Run) << std::setw(14) << MeasureMilliseconds(RunAllocations) << std::endl;
+	}
+
+	const FTex2DStoragePool::FStats Stats = Pool.GetStats();
+	std::cout << std::endl;
+	std::cout << "hit rate " << std::setprecision(3) << Stats.GetHitRate()
+		<< " (" << Stats.NumHits << "/" << Stats.NumAllocations << "), peak cached "
+		<< std::setprecision(1) << Stats.PeakCachedSizeInBytes / (1024. * 1024.) << " MB" << std::endl;
+
+	return 0;
+}
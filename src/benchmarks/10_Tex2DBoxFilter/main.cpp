@@ -0,0 +1,109 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** Reference: the window average by direct summation, O(Radius^2) per texel. */
+	FTex2D NaiveBoxBlur(const FTex2D& Tex, uint64_t Radius)
+	{
+		const FGrid2D& Grid2D = Tex.GetGrid2D();
+		const uint64_t NumChannels = Tex.GetNumChannels();
+		FTex2D Result(Grid2D, NumChannels, EElementType::Float);
+		for (uint64_t Y = 0; Y < Grid2D.Height; Y++)
+		{
+			const uint64_t MinY = Y > Radius ? Y - Radius : 0;
+			const uint64_t MaxY = std::min(Grid2D.Height, Y + Radius + 1);
+			for (uint64_t X = 0; X < Grid2D.Width; X++)
+			{
+				const uint64_t MinX = X > Radius ? X - Radius : 0;
+				const uint64_t MaxX = std::min(Grid2D.Width, X + Radius + 1);
+				for (uint64_t C = 0; C < NumChannels; C++)
+				{
+					double Sum = 0.;
+					for (uint64_t WindowY = MinY; WindowY < MaxY; WindowY++)
+					{
+						for (uint64_t WindowX = MinX; WindowX < MaxX; WindowX++)
+						{
+							Sum += Tex.At<float>(FUint64Vector2(WindowX, WindowY), C);
+						}
+					}
+					Result.At<float>(FUint64Vector2(X, Y), C) = (float)(Sum / (double)((MaxX - MinX) * (MaxY - MinY)));
+				}
+			}
+		}
+		return Result;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 2048;
+	const uint64_t NumChannels = 4;
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	FTex2D Tex(FGrid2D(Size, Size), NumChannels, EElementType::Float);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<float>(Index) = (float)(Index % 4099) / 4099.f;
+	}
+
+	std::cout << Size << "x" << Size << "x" << NumChannels << " Float, " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "summed-area table:             " << MeasureMilliseconds([&] { FTex2DSummedAreaTable Table(Tex); }) << std::endl;
+	std::cout << "summed-area table + squares:   " << MeasureMilliseconds([&] { FTex2DSummedAreaTable Table(Tex, true); }) << std::endl;
+	std::cout << "summed-area table, parallel:   " << MeasureMilliseconds([&] { FTex2DSummedAreaTable Table(Tex, true, &ThreadPool); }) << std::endl;
+	std::cout << std::endl;
+
+	std::cout << std::setw(8) << "Radius" << std::setw(12) << "naive" << std::setw(12) << "BoxBlur" << std::setw(12) << "parallel" << std::endl;
+	for (uint64_t Radius : { 1, 4, 16, 64 })
+	{
+		// the naive reference is quadratic in the radius, measured on a crop for the large radii
+		const uint64_t NaiveSize = Radius <= 4 ? Size : std::max<uint64_t>(1, Size / (Radius / 4));
+		FTex2D Crop(FGrid2D(NaiveSize, NaiveSize), NumChannels, EElementType::Float);
+		FTex2D::Copy(Crop, FUint64Vector2(0, 0), Tex, FUint64Vector2(0, 0), FUint64Vector2(NaiveSize, NaiveSize));
+		const double NaiveScale = (double)(Size * Size) / (double)(NaiveSize * NaiveSize);
+
+		std::cout << std::setw(8) << Radius
+			<< std::setw(12) << MeasureMilliseconds([&] { NaiveBoxBlur(Crop, Radius); }) * NaiveScale
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.BoxBlur(Radius); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.BoxBlur(Radius, &ThreadPool); })
+			<< std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,91 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** Reference: the scalar loop of the codec tests, GetFloat per element. */
+	double NaiveMSE(const FTex2D& Tex, const FTex2D& Reference)
+	{
+		double SquaredErrorSum = 0.;
+		for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+		{
+			const double Error = (double)Tex.GetFloat(Index) - (double)Reference.GetFloat(Index);
+			SquaredErrorSum += Error * Error;
+		}
+		return SquaredErrorSum / (double)Tex.GetNumElements();
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 8192;
+	const uint64_t NumChannels = 4;
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+
+	std::cout << Size << "x" << Size << "x" << NumChannels << ", " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(8) << "Type" << std::setw(12) << "naive MSE" << std::setw(12) << "ErrorStats" << std::setw(12) << "parallel"
+		<< std::setw(12) << "Histograms" << std::setw(12) << "SSIM" << std::setw(12) << "parallel" << std::setw(10) << "PSNR" << std::setw(10) << "SSIM" << std::endl;
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float })
+	{
+		FTex2D Reference(FGrid2D(Size, Size), NumChannels, ElementType);
+		FTex2D Tex(FGrid2D(Size, Size), NumChannels, ElementType);
+		for (uint64_t Index = 0; Index < Reference.GetNumElements(); Index++)
+		{
+			const float Value = (float)(Index % 4099) / 4099.f;
+			Reference.SetFloat(Index, Value);
+			Tex.SetFloat(Index, std::min(1.f, Value + (float)(Index % 7) / 512.f));
+		}
+
+		FTex2DErrorStats Stats[NumChannels];
+		uint64_t Histograms[NumChannels * 64];
+		double SSIM = 0.;
+		std::cout << std::fixed << std::setprecision(1) << std::setw(8) << (ElementType == EElementType::Uint8 ? "Uint8" : ElementType == EElementType::Half ? "Half" : "Float")
+			<< std::setw(12) << MeasureMilliseconds([&] { NaiveMSE(Tex, Reference); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.ComputeErrorStats(Reference, Stats); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.ComputeErrorStats(Reference, Stats, 1e-6f, &ThreadPool); })
+			<< std::setw(12) << MeasureMilliseconds([&] { Tex.ComputeErrorHistograms(Reference, 1.f / 64.f, 64, Histograms, &ThreadPool); })
+			<< std::setw(12) << MeasureMilliseconds([&] { SSIM = Tex.ComputeSSIM(Reference); })
+			<< std::setw(12) << MeasureMilliseconds([&] { SSIM = Tex.ComputeSSIM(Reference, nullptr, 1., &ThreadPool); })
+			<< std::setw(10) << std::setprecision(2) << Stats[0].GetPSNR()
+			<< std::setw(10) << std::setprecision(4) << SSIM << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex2D.h>
+#include "../BenchmarkUtils.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+namespace
+{
+	/** Copy every element through the untyped and the typed access paths. */
+	template<typename T, uint64_t N>
+	void Run(const char* Name, uint64_t Size)
+	{
+		const FGrid2D Grid2D(Size, Size);
+		FTex2D Src(Grid2D, N, ElementTypeOf<T>);
+		FTex2D Dst(Grid2D, N, ElementTypeOf<T>);
+		const uint64_t NumElements = Src.GetNumElements();
+		for (uint64_t Index = 0; Index < NumElements; Index++)
+		{
+			Src.SetFloat(Index, (float)(Index % 256) / 255.f);
+		}
+		// touch the pages of Dst before timing
+		std::memset(Dst.GetStorage(), 0, Dst.GetStorageSizeInBytes());
+		const FConstTex2DView SrcView = Src.GetView();
+		const FTex2DView DstView = Dst.GetView();
+		// the typed views alias the same storages
+		const TConstTex2DView<T, N> TypedSrc(SrcView);
+		const TTex2DView<T, N> TypedDst(DstView);
+
+		std::cout << std::setw(10) << Name
+			<< std::setw(14) << MeasureMilliseconds([&]
+				{
+					for (uint64_t Index = 0; Index < NumElements; Index++)
+					{
+						Dst.SetFloat(Index, Src.GetFloat(Index));
+					}
+				})
+			<< std::setw(14) << MeasureMilliseconds([&]
+				{
+					for (uint64_t Y = 0; Y < Size; Y++)
+					{
+						for (uint64_t X = 0; X < Size; X++)
+						{
+							for (uint64_t C = 0; C < N; C++)
+							{
+								DstView.SetFloat(FUint64Vector2(X, Y), C, SrcView.GetFloat(FUint64Vector2(X, Y), C));
+							}
+						}
+					}
+				})
+			<< std::setw(14) << MeasureMilliseconds([&]
+				{
+					for (uint64_t Y = 0; Y < Size; Y++)
+					{
+						for (uint64_t X = 0; X < Size; X++)
+						{
+							for (uint64_t C = 0; C < N; C++)
+							{
+								TypedDst.At(FUint64Vector2(X, Y), C) = TypedSrc.At(FUint64Vector2(X, Y), C);
+							}
+						}
+					}
+				})
+			<< std::setw(14) << MeasureMilliseconds([&]
+				{
+					for (uint64_t Y = 0; Y < Size; Y++)
+					{
+						const T* SrcRow = TypedSrc.GetRow(Y);
+						T* DstRow = TypedDst.GetRow(Y);
+						for (uint64_t X = 0; X < Size * N; X++)
+						{
+							DstRow[X] = SrcRow[X];
+						}
+					}
+				})
+			<< std::setw(14) << MeasureMilliseconds([&] { std::memcpy(Dst.GetStorage(), Src.GetStorage(), NumElements * sizeof(T)); })
+			<< std::endl;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 2048;
+
+	std::cout << Size << "x" << Size << " copy, ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << std::setw(10) << "Type"
+		<< std::setw(14) << "Get/SetFloat"
+		<< std::setw(14) << "view float"
+		<< std::setw(14) << "typed At"
+		<< std::setw(14) << "typed rows"
+		<< std::setw(14) << "memcpy"
+		<< std::endl;
+	Run<uint8_t, 4>("Uint8x4", Size);
+	Run<FHalf, 4>("Halfx4", Size);
+	Run<float, 4>("Floatx4", Size);
+	Run<float, 3>("Floatx3", Size);
+	return 0;
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/VirtualTex2D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t Size = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : 4096;
+	const uint64_t CacheSizeInBytes = (Argc > 2 ? std::strtoull(Argv[2], nullptr, 10) : 16) << 20;
+	const uint64_t NumChannels = 4;
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+	const char* FilePath = "bench_13_virtual_tex2d.bin";
+	const char* HalfFilePath = "bench_13_virtual_tex2d_half.bin";
+
+	const FGrid2D Grid2D(Size, Size);
+	const uint64_t BandHeight = 256;
+	FTex2D Band(FGrid2D(Size, BandHeight), NumChannels, EElementType::Float);
+	for (uint64_t Index = 0; Index < Band.GetNumElements(); Index++)
+	{
+		Band.At<float>(Index) = (float)(Index % 4099) / 4099.f;
+	}
+
+	std::cout << Size << "x" << Size << "x" << NumChannels << " Float (" << (Grid2D.GetArea() * NumChannels * sizeof(float) >> 20)
+		<< " MB), cache " << (CacheSizeInBytes >> 20) << " MB, " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+
+	std::cout << std::setw(10) << "TileSize" << std::setw(12) << "write" << std::setw(12) << "row scan" << std::setw(12) << "tile scan"
+		<< std::setw(12) << "sample" << std::setw(12) << "Clamp" << std::setw(12) << "DownSample" << std::setw(10) << "reads" << std::setw(10) << "writes" << std::endl;
+	for (uint64_t TileSize : { 64, 128, 256 })
+	{
+		FVirtualTex2D VirtualTex(FilePath, Grid2D, NumChannels, EElementType::Float, TileSize, CacheSizeInBytes);
+		std::cout << std::setw(10) << TileSize;
+
+		// bands of rows streamed in, e.g. from an image decoder
+		std::cout << std::setw(12) << MeasureMilliseconds([&]
+			{
+				for (uint64_t Y = 0; Y < Size; Y += BandHeight)
+				{
+					VirtualTex.CopyFrom(FUint64Vector2(0, Y), Band.GetView(FUint64Vector2(0, 0), FGrid2D(Size, std::min(BandHeight, Size - Y))));
+				}
+				VirtualTex.Flush();
+			});
+
+		float Sum = 0.f;
+		// texel by texel in row-major order, one row of tiles fits the cache or thrashes
+		std::cout << std::setw(12) << MeasureMilliseconds([&]
+			{
+				for (uint64_t Y = 0; Y < Size; Y++)
+				{
+					for (uint64_t X = 0; X < Size; X++)
+					{
+						Sum += VirtualTex.GetFloat(FUint64Vector2(X, Y), 0);
+					}
+				}
+			});
+		// texel by texel in tile order
+		std::cout << std::setw(12) << MeasureMilliseconds([&]
+			{
+				for (uint64_t TileY = 0; TileY < Size; TileY += TileSize)
+				{
+					for (uint64_t TileX = 0; TileX < Size; TileX += TileSize)
+					{
+						for (uint64_t Y = TileY; Y < std::min(TileY + TileSize, Size); Y++)
+						{
+							for (uint64_t X = TileX; X < std::min(TileX + TileSize, Size); X++)
+							{
+								Sum += VirtualTex.GetFloat(FUint64Vector2(X, Y), 0);
+							}
+						}
+					}
+				}
+			});
+		// 1M samples along a diagonal stripe, the tiles reuse of a lightmap lookup
+		std::cout << std::setw(12) << MeasureMilliseconds([&]
+			{
+				float Result[NumChannels];
+				for (uint64_t Index = 0; Index < (uint64_t(1) << 20); Index++)
+				{
+					const float T = (float)Index / (float)(uint64_t(1) << 20);
+					VirtualTex.BilinearSample(Result, FVector2f(T, T + 0.05f * (float)(Index % 7) / 7.f));
+					Sum += Result[0];
+				}
+			});
+		VirtualTex.ResetStats();
+		std::cout << std::setw(12) << MeasureMilliseconds([&] { VirtualTex.Clamp(0.1f, 0.9f, &ThreadPool); VirtualTex.Flush(); });
+		std::cout << std::setw(12) << MeasureMilliseconds([&] { FVirtualTex2D Half = VirtualTex.DownSample(HalfFilePath); });
+		const FVirtualTex2D::FStats Stats = VirtualTex.GetStats();
+		std::cout << std::setw(10) << Stats.NumReads << std::setw(10) << Stats.NumWriteBacks << std::endl;
+		if (Sum < 0.f)
+		{
+			std::cout << Sum << std::endl;
+		}
+	}
+
+	// in-memory reference, when the texture fits in RAM
+	FTex2D Tex(Grid2D, NumChannels, EElementType::Float);
+	for (uint64_t Y = 0; Y < Size; Y += BandHeight)
+	{
+		FTex2D::Copy(Tex.GetView(FUint64Vector2(0, Y), FGrid2D(Size, std::min(BandHeight, Size - Y))), Band.GetView(FUint64Vector2(0, 0), FGrid2D(Size, std::min(BandHeight, Size - Y))));
+	}
+	std::cout << "in memory: Clamp " << MeasureMilliseconds([&] { Tex.Clamp(0.1f, 0.9f, &ThreadPool); })
+		<< ", DownSample " << MeasureMilliseconds([&] { FTex2D Half = Tex.DownSample(); }) << std::endl;
+
+	std::remove(FilePath);
+	std::remove(HalfFilePath);
+	return 0;
+}
@@ -0,0 +1,123 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <UCommon/Tex3D.h>
+#include <UCommon/ThreadPool.h>
+#include "../BenchmarkUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace UCommon;
+using namespace UCommon::Benchmark;
+
+int main(int Argc, char** Argv)
+{
+	const uint64_t NumSamples = Argc > 1 ? std::strtoull(Argv[1], nullptr, 10) : (1ull << 20);
+	const uint64_t NumThreads = std::max(1u, std::thread::hardware_concurrency());
+	FThreadPool ThreadPool(NumThreads);
+	const FGrid3D Grid3D(64, 64, 32);
+
+	// probe lookups of shaded points: scattered over the volume, coherent along each 64-sample run
+	std::vector<FVector3f> Texcoords(NumSamples);
+	uint32_t Seed = 1;
+	for (uint64_t Index = 0; Index < NumSamples; Index += 64)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		const FVector3f Origin((float)(Seed & 1023) / 1024.f, (float)((Seed >> 10) & 1023) / 1024.f, (float)((Seed >> 20) & 1023) / 1024.f);
+		for (uint64_t Offset = 0; Offset < 64 && Index + Offset < NumSamples; Offset++)
+		{
+			Texcoords[Index + Offset] = Origin + FVector3f((float)(Offset % 8), (float)(Offset / 8), (float)(Offset % 3)) * 0.004f;
+		}
+	}
+	const TSpan<const FVector3f> TexcoordSpan(Texcoords.data(), Texcoords.size());
+
+	std::cout << NumSamples << " trilinear samples of a " << Grid3D.Width << "x" << Grid3D.Height << "x" << Grid3D.Depth << " volume, " << NumThreads << " threads, ms" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::setw(8) << "Type" << std::setw(10) << "Channels" << std::setw(12) << "slices" << std::setw(12) << "per sample"
+		<< std::setw(10) << "batch" << std::setw(12) << "batch par." << std::setw(10) << "bricked" << std::setw(14) << "bricked par." << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	for (EElementType ElementType : { EElementType::Half, EElementType::Float })
+	{
+		// SH irradiance: L1 / L2 RGB coefficients
+		for (uint64_t NumChannels : { 12, 27 })
+		{
+			FTex3D Tex(Grid3D, NumChannels, ElementType);
+			for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+			{
+				Tex.SetFloat(Index, (float)(Index % 4099) / 4099.f);
+			}
+			const FTex3D Bricked = Tex.ToStorageLayout(ETex3DStorageLayout::Bricked);
+
+			// the former layout: one FTex2D per slice, bilinear in two slices and a lerp
+			std::vector<FTex2D> Slices;
+			for (uint64_t Z = 0; Z < Grid3D.Depth; Z++)
+			{
+				Slices.emplace_back(Grid3D.GetSliceGrid2D(), NumChannels, ElementType);
+				Slices.back().GetView().CopyFrom(Tex.GetSliceView(Z));
+			}
+
+			std::vector<float> Results(NumSamples * NumChannels);
+			std::vector<float> SliceResults(NumChannels * 2);
+			std::cout << std::setw(8) << (ElementType == EElementType::Half ? "Half" : "Float")
+				<< std::setw(10) << NumChannels
+				<< std::setw(12) << MeasureMilliseconds([&]
+				{
+					for (uint64_t Index = 0; Index < NumSamples; Index++)
+					{
+						const float PointZ = Texcoords[Index].Z * (float)Grid3D.Depth - 0.5f;
+						const float FloorZ = std::floor(PointZ);
+						const float WeightZ = PointZ - FloorZ;
+						const int64_t Z = (int64_t)FloorZ;
+						const FVector2f TexcoordXY(Texcoords[Index].X, Texcoords[Index].Y);
+						Slices[ApplyAddressMode(Z, Grid3D.Depth, ETextureAddress::Wrap)].BilinearSample(SliceResults.data(), TexcoordXY);
+						Slices[ApplyAddressMode(Z + 1, Grid3D.Depth, ETextureAddress::Wrap)].BilinearSample(SliceResults.data() + NumChannels, TexcoordXY);
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							Results[Index * NumChannels + C] = SliceResults[C] + WeightZ * (SliceResults[NumChannels + C] - SliceResults[C]);
+						}
+					}
+				})
+				<< std::setw(12) << MeasureMilliseconds([&]
+				{
+					for (uint64_t Index = 0; Index < NumSamples; Index++)
+					{
+						Tex.TrilinearSample(Results.data() + Index * NumChannels, Texcoords[Index]);
+					}
+				})
+				<< std::setw(10) << MeasureMilliseconds([&] { Tex.TrilinearSampleBatch(TexcoordSpan, Results.data()); })
+				<< std::setw(12) << MeasureMilliseconds([&] { Tex.TrilinearSampleBatch(TexcoordSpan, Results.data(), ETextureAddress::Wrap, ETextureAddress::Wrap, ETextureAddress::Wrap, &ThreadPool); })
+				<< std::setw(10) << MeasureMilliseconds([&] { Bricked.TrilinearSampleBatch(TexcoordSpan, Results.data()); })
+				<< std::setw(14) << MeasureMilliseconds([&] { Bricked.TrilinearSampleBatch(TexcoordSpan, Results.data(), ETextureAddress::Wrap, ETextureAddress::Wrap, ETextureAddress::Wrap, &ThreadPool); })
+				<< std::endl;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ubpa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <UCommon/Utils.h>
+
+#include <chrono>
+
+// Helpers shared by the benchmarks, include as "../BenchmarkUtils.h"
+
+namespace UCommon
+{
+	namespace Benchmark
+	{
+		/** Wall time of one call of Func. */
+		template<typename FuncT>
+		double MeasureSeconds(FuncT&& Func)
+		{
+			const auto Begin = std::chrono::steady_clock::now();
+			Func();
+			const std::chrono::duration<double> Seconds = std::chrono::steady_clock::now() - Begin;
+			return Seconds.count();
+		}
+
+		/** Wall time of one call of Func. */
+		template<typename FuncT>
+		double MeasureMilliseconds(FuncT&& Func)
+		{
+			const auto Begin = std::chrono::steady_clock::now();
+			Func();
+			const std::chrono::duration<double, std::milli> Milliseconds = std::chrono::steady_clock::now() - Begin;
+			return Milliseconds.count();
+		}
+
+		/** A cheap integer hash for deterministic pseudo-random inputs. */
+		inline uint32_t HashUint32(uint32_t Value)
+		{
+			Value ^= Value >> 16;
+			Value *= 0x7feb352du;
+			Value ^= Value >> 15;
+			Value *= 0x846ca68bu;
+			Value ^= Value >> 16;
+			return Value;
+		}
+
+		inline const char* GetElementTypeName(EElementType ElementType)
+		{
+			switch (ElementType)
+			{
+			case EElementType::Uint8: return "Uint8";
+			case EElementType::Half: return "Half";
+			case EElementType::Float: return "Float";
+			case EElementType::Double: return "Double";
+			default: return "?";
+			}
+		}
+	}
+}
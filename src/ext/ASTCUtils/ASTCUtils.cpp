@@ -1193,7 +1193,8 @@ void UCommon::CompressImageToASTC(UCommon::FASTCBlock* Blocks, EASTCProfile Prof
 
 	astcenc_context* codec_context;
 
-	const unsigned int thread_count = ASTCConfig.ThreadPool ? ASTCConfig.ThreadPool->GetNumThreads() : 1u;
+	// the calling thread takes part in ParallelFor
+	const unsigned int thread_count = ASTCConfig.ThreadPool ? static_cast<unsigned int>(ASTCConfig.ThreadPool->GetNumThreads()) + 1u : 1u;
 
 	const astcenc_error codec_status = astcenc_context_alloc(&config, thread_count, &codec_context);
 	UBPA_UCOMMON_ASSERT(codec_status == ASTCENC_SUCCESS);
@@ -1222,15 +1223,7 @@ void UCommon::CompressImageToASTC(UCommon::FASTCBlock* Blocks, EASTCProfile Prof
 
 	if (ASTCConfig.ThreadPool)
 	{
-		std::vector<std::future<void>> Tasks;
-		for (uint64_t ID = 0; ID < codec_context->context.thread_count; ID++)
-		{
-			Tasks.push_back(ASTCConfig.ThreadPool->Enqueue(work, ID));
-		}
-		for (auto& Task : Tasks)
-		{
-			Task.wait();
-		}
+		ASTCConfig.ThreadPool->ParallelFor(0, codec_context->context.thread_count, 1, work);
 	}
 	else
 	{
@@ -1,4 +1,12 @@
 #include <UCommon/Archive.h>
+#include <UCommon/Tex2D.h>
+#include <UCommon/ThreadPool.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <UCommon_ext/doctest/doctest.h>
@@ -94,3 +102,474 @@ TEST_CASE("Archive - A2 load from A1 (version upgrade)")
     }
     CHECK(a2.data == (int)expectedA1);
 }
+
+TEST_CASE("Archive - FMappedFileArchive")
+{
+    const FGrid2D Grid2D(7, 5);
+    FTex2D Tex2D(Grid2D, 3, EElementType::Float);
+    for (uint64_t Index = 0; Index < Tex2D.GetNumElements(); Index++)
+    {
+        Tex2D.At<float>(Index) = (float)Index * 0.5f;
+    }
+    {
+        FFileArchive ar(IArchive::EState::Saving, "test_01_archive_mapped.uasset");
+        ar.UseVersion(0x1234, 7);
+        A0 a0;
+        a0.data = 1.5f;
+        a0.Serialize(ar);
+        Tex2D.Serialize(ar);
+    }
+
+    SUBCASE("zero-copy FTex2D")
+    {
+        FMappedFileArchive ar("test_01_archive_mapped.uasset");
+        REQUIRE(ar.IsValid());
+        CHECK(ar.GetVersion(0x1234) == 7);
+
+        A0 a0;
+        a0.Serialize(ar);
+        CHECK(a0.data == 1.5f);
+
+        FTex2D Loaded;
+        Loaded.Serialize(ar);
+        CHECK(Loaded.IsLayoutSameWith(Tex2D));
+        CHECK(Loaded.GetStorageOwnership() == EOwnership::DoNotTakeOwnership);
+        const TSpan<const uint8_t> Mapping = ar.GetMapping();
+        const uint8_t* LoadedStorage = static_cast<const uint8_t*>(Loaded.GetStorage());
+        CHECK((LoadedStorage >= Mapping.GetData() && LoadedStorage + Loaded.GetStorageSizeInBytes() <= Mapping.GetData() + Mapping.Num()));
+        CHECK(std::memcmp(Loaded.GetStorage(), Tex2D.GetStorage(), Tex2D.GetStorageSizeInBytes()) == 0);
+
+        // copy-on-write: the file is untouched
+        Loaded.At<float>(0) = -1.f;
+        FTex2D Reloaded;
+        {
+            FFileArchive FileReader(IArchive::EState::Loading, "test_01_archive_mapped.uasset");
+            A0 Skipped;
+            Skipped.Serialize(FileReader);
+            Reloaded.Serialize(FileReader);
+        }
+        CHECK(Reloaded.GetStorageOwnership() == EOwnership::TakeOwnership);
+        CHECK(Reloaded.At<float>(0) == 0.f);
+
+        // an owned copy outlives the archive
+        FTex2D Owned(Loaded, EOwnership::TakeOwnership, nullptr);
+        CHECK(Owned.GetStorage() != Loaded.GetStorage());
+        CHECK(Owned.At<float>(0) == -1.f);
+    }
+
+    SUBCASE("invalid files")
+    {
+        FMappedFileArchive Missing("test_01_archive_missing.uasset");
+        CHECK_FALSE(Missing.IsValid());
+
+        {
+            std::ofstream Ofs("test_01_archive_garbage.uasset", std::ofstream::binary);
+            Ofs << "not an archive at all";
+        }
+        FMappedFileArchive Garbage("test_01_archive_garbage.uasset");
+        CHECK_FALSE(Garbage.IsValid());
+    }
+}
+
+static void SaveBufferedContent(const char* FilePath, const FFileArchiveConfig& Config)
+{
+    FFileArchive ar(IArchive::EState::Saving, FilePath, Config);
+    ar.UseVersion(0x1234, 3);
+    for (uint32_t Index = 0; Index < 1000; Index++)
+    {
+        A0 a0;
+        a0.data = (float)Index;
+        a0.Serialize(ar);
+    }
+    // larger than the buffers
+    std::vector<uint8_t> Blob(5000);
+    for (size_t Index = 0; Index < Blob.size(); Index++)
+    {
+        Blob[Index] = (uint8_t)(Index * 7);
+    }
+    ar.Serialize(Blob.data(), Blob.size());
+    A0 Last;
+    Last.data = -2.f;
+    Last.Serialize(ar);
+}
+
+static std::vector<char> ReadFileBytes(const char* FilePath)
+{
+    std::ifstream Ifs(FilePath, std::ifstream::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(Ifs), std::istreambuf_iterator<char>());
+}
+
+TEST_CASE("Archive - FMappedFileArchive truncated file")
+{
+    FTex2D Tex2D(FGrid2D(16, 16), 4, EElementType::Float);
+    for (uint64_t Index = 0; Index < Tex2D.GetNumElements(); Index++)
+    {
+        Tex2D.At<float>(Index) = (float)Index;
+    }
+    {
+        FFileArchive ar(IArchive::EState::Saving, "test_01_archive_truncated.uasset");
+        Tex2D.Serialize(ar);
+    }
+
+    // cut the texels short, the header still points at the (empty) version map at the new end
+    std::vector<char> Bytes = ReadFileBytes("test_01_archive_truncated.uasset");
+    Bytes.resize(Bytes.size() - 100);
+    const uint64_t VersionMapOffset = Bytes.size();
+    std::memcpy(Bytes.data() + 8, &VersionMapOffset, sizeof(uint64_t));
+    {
+        std::ofstream Ofs("test_01_archive_truncated.uasset", std::ofstream::binary);
+        Ofs.write(Bytes.data(), (std::streamsize)Bytes.size());
+    }
+
+    FMappedFileArchive ar("test_01_archive_truncated.uasset");
+    REQUIRE(ar.IsValid());
+    FTex2D Loaded;
+    Loaded.Serialize(ar);
+    CHECK_FALSE(Loaded.IsValid());
+    CHECK_FALSE(ar.IsValid());
+
+    // nothing is read past the end
+    A0 a0;
+    a0.data = 1.f;
+    a0.Serialize(ar);
+    CHECK(a0.data == 0.f);
+    CHECK(ar.SerializeView(1) == nullptr);
+}
+
+TEST_CASE("Archive - FFileArchive buffered and async writes")
+{
+    FThreadPool ThreadPool(2);
+
+    SaveBufferedContent("test_01_archive_direct.uasset", FFileArchiveConfig());
+
+    FFileArchiveConfig BufferedConfig;
+    BufferedConfig.BufferSize = 1024;
+    SaveBufferedContent("test_01_archive_buffered.uasset", BufferedConfig);
+
+    FFileArchiveConfig AsyncConfig;
+    AsyncConfig.BufferSize = 1024;
+    AsyncConfig.ThreadPool = &ThreadPool;
+    SaveBufferedContent("test_01_archive_async.uasset", AsyncConfig);
+
+    const std::vector<char> Direct = ReadFileBytes("test_01_archive_direct.uasset");
+    CHECK(Direct.size() == 16 + 1000 * sizeof(float) + 5000 + sizeof(float) + 16);
+    CHECK(ReadFileBytes("test_01_archive_buffered.uasset") == Direct);
+    CHECK(ReadFileBytes("test_01_archive_async.uasset") == Direct);
+
+    FFileArchive ar(IArchive::EState::Loading, "test_01_archive_async.uasset");
+    CHECK(ar.GetVersion(0x1234) == 3);
+    A0 a0;
+    for (uint32_t Index = 0; Index < 1000; Index++)
+    {
+        a0.Serialize(ar);
+    }
+    CHECK(a0.data == 999.f);
+}
+
+static FTex2D MakeHDRTex2D()
+{
+    FTex2D Tex2D(FGrid2D(256, 128), 4, EElementType::Float);
+    for (uint64_t Index = 0; Index < Tex2D.GetNumElements(); Index++)
+    {
+        const uint64_t Pixel = Index / 4;
+        Tex2D.At<float>(Index) = 1.f + (float)(Pixel % 256) / 64.f + (float)(Index % 4) * 0.25f;
+    }
+    return Tex2D;
+}
+
+static void CheckCompressedRoundTrip(FThreadPool* ThreadPool)
+{
+    const FTex2D Tex2D = MakeHDRTex2D();
+    std::vector<uint8_t> Noise(300000);
+    uint32_t Seed = 1;
+    for (uint8_t& Byte : Noise)
+    {
+        Seed = Seed * 1664525u + 1013904223u;
+        Byte = (uint8_t)(Seed >> 24);
+    }
+
+    FCompressedArchiveConfig Config;
+    Config.BlockSize = 64 * 1024;
+    Config.ThreadPool = ThreadPool;
+
+    FMemoryArchive Writer;
+    uint64_t RawSize = 0;
+    {
+        FCompressedArchive ar(&Writer, Config);
+        A0 a0;
+        a0.data = 2.5f;
+        a0.Serialize(ar);
+        FTex2D(Tex2D).Serialize(ar);
+        ar.SequentialContainerByteSerialize(Noise);
+        RawSize = ar.GetRawSize();
+    }
+    const uint64_t CompressedSize = Writer.GetStorage().Num();
+    // data after the compressed stream
+    A0 Tail;
+    Tail.data = 7.f;
+    Tail.Serialize(Writer);
+
+    CHECK(RawSize == sizeof(float) + 40 + Tex2D.GetStorageSizeInBytes() + sizeof(uint64_t) + Noise.size());
+    // the texture compresses well, the noise is stored as is
+    CHECK(CompressedSize < Tex2D.GetStorageSizeInBytes() / 2 + Noise.size() + 1024);
+
+    FMemoryArchive Reader(Writer.GetStorage());
+    {
+        FCompressedArchive ar(&Reader, Config);
+        REQUIRE(ar.IsValid());
+        A0 a0;
+        a0.Serialize(ar);
+        CHECK(a0.data == 2.5f);
+        FTex2D Loaded;
+        Loaded.Serialize(ar);
+        CHECK(Loaded.IsLayoutSameWith(Tex2D));
+        CHECK(std::memcmp(Loaded.GetStorage(), Tex2D.GetStorage(), Tex2D.GetStorageSizeInBytes()) == 0);
+        std::vector<uint8_t> LoadedNoise;
+        ar.SequentialContainerByteSerialize(LoadedNoise);
+        CHECK(LoadedNoise == Noise);
+        CHECK(ar.GetRawSize() == RawSize);
+    }
+    A0 LoadedTail;
+    LoadedTail.Serialize(Reader);
+    CHECK(LoadedTail.data == 7.f);
+}
+
+TEST_CASE("Archive - FCompressedArchive")
+{
+    CheckCompressedRoundTrip(nullptr);
+
+    FThreadPool ThreadPool(3);
+    CheckCompressedRoundTrip(&ThreadPool);
+}
+
+TEST_CASE("Archive - FCompressedArchive skips a corrupted stream")
+{
+    FCompressedArchiveConfig Config;
+    Config.BlockSize = 1024;
+    FMemoryArchive Writer;
+    {
+        FCompressedArchive ar(&Writer, Config);
+        A0 a0;
+        a0.data = 2.5f;
+        a0.Serialize(ar);
+    }
+
+    // stream header (16 bytes) | block header: RawSize, CompressedSize | ...
+    std::vector<uint8_t> Bytes(Writer.GetStorage().begin(), Writer.GetStorage().end());
+    const uint32_t RawSize = 0xFFFFFFF0u;
+    std::memcpy(Bytes.data() + 16, &RawSize, sizeof(uint32_t));
+
+    // the destructor skips the unread blocks, the bad header must not be trusted there
+    FMemoryArchive Reader(TSpan<const uint8_t>(Bytes.data(), Bytes.size()));
+    {
+        FCompressedArchive ar(&Reader, Config);
+        CHECK(ar.IsValid());
+    }
+    // skipping stopped at the bad block header, the (stored) block follows
+    A0 a0;
+    a0.Serialize(Reader);
+    CHECK(a0.data == 2.5f);
+}
+
+TEST_CASE("Archive - FCompressedArchive in a file keeps versions")
+{
+    FThreadPool ThreadPool(2);
+    FCompressedArchiveConfig Config;
+    Config.ThreadPool = &ThreadPool;
+    {
+        FFileArchive File(IArchive::EState::Saving, "test_01_archive_compressed.uasset");
+        FCompressedArchive ar(&File, Config);
+        A2 a2;
+        a2.data = 42;
+        a2.Serialize(ar);
+    }
+    {
+        FFileArchive File(IArchive::EState::Loading, "test_01_archive_compressed.uasset");
+        FCompressedArchive ar(&File, Config);
+        CHECK(ar.GetVersion(0xFFFFAAAAFFFFAAAA) == 1);
+        A2 a2;
+        a2.Serialize(ar);
+        CHECK(a2.data == 42);
+    }
+}
+
+TEST_CASE("Archive - FChunkFileArchive")
+{
+    constexpr uint64_t NumChunks = 1000;
+    std::vector<FGuid> Guids(NumChunks);
+    for (uint64_t Index = 0; Index < NumChunks; Index++)
+    {
+        Guids[Index] = FGuid(1, 2, 3, (uint32_t)Index + 1);
+    }
+
+    {
+        FChunkFileArchive ar(IArchive::EState::Saving, "test_01_archive_chunks.uasset");
+        REQUIRE(ar.IsValid());
+        ar.UseVersion(0x1234, 5);
+        for (uint64_t Index = 0; Index < NumChunks; Index++)
+        {
+            const std::string Name = "Chunk" + std::to_string(Index);
+            ar.BeginChunk(Guids[Index], Name.c_str());
+            FTex2D Tex2D(FGrid2D(1 + Index % 7, 3), 1, EElementType::Float);
+            for (uint64_t ElementIndex = 0; ElementIndex < Tex2D.GetNumElements(); ElementIndex++)
+            {
+                Tex2D.At<float>(ElementIndex) = (float)(Index * 100 + ElementIndex);
+            }
+            Tex2D.Serialize(ar);
+            ar.EndChunk();
+        }
+        ar.BeginChunk("Unnamed guid");
+        A0 a0;
+        a0.data = 3.f;
+        a0.Serialize(ar);
+        // ended by the destructor
+    }
+
+    FChunkFileArchive ar(IArchive::EState::Loading, "test_01_archive_chunks.uasset");
+    REQUIRE(ar.IsValid());
+    CHECK(ar.GetVersion(0x1234) == 5);
+    REQUIRE(ar.GetNumChunks() == NumChunks + 1);
+    CHECK(ar.FindChunk(FGuid(9, 9, 9, 9)) == -1);
+    CHECK(ar.FindChunk("Missing") == -1);
+    CHECK_FALSE(ar.SeekChunk(NumChunks + 1));
+
+    const int64_t Index = ar.FindChunk(Guids[537]);
+    CHECK(Index == 537);
+    CHECK(ar.FindChunk("Chunk537") == 537);
+    CHECK(std::strcmp(ar.GetChunkName(537), "Chunk537") == 0);
+    CHECK(ar.GetChunkGuid(537) == Guids[537]);
+    CHECK(ar.GetChunkSize(537) == 40 + (1 + 537 % 7) * 3 * sizeof(float));
+    REQUIRE(ar.SeekChunk(537));
+    FTex2D Loaded;
+    Loaded.Serialize(ar);
+    CHECK(Loaded.GetGrid2D() == FGrid2D(1 + 537 % 7, 3));
+    CHECK(Loaded.At<float>(2) == 53702.f);
+
+    // any order
+    const int64_t Last = ar.FindChunk("Unnamed guid");
+    CHECK(Last == (int64_t)NumChunks);
+    CHECK_FALSE(ar.GetChunkGuid(NumChunks).IsValid());
+    REQUIRE(ar.SeekChunk(NumChunks));
+    A0 a0;
+    a0.Serialize(ar);
+    CHECK(a0.data == 3.f);
+
+    REQUIRE(ar.SeekChunk(0));
+    FTex2D First;
+    First.Serialize(ar);
+    CHECK(First.At<float>(0) == 0.f);
+}
+
+TEST_CASE("Archive - FChunkFileArchive damaged table")
+{
+    {
+        FChunkFileArchive ar(IArchive::EState::Saving, "test_01_archive_chunks_damaged.uasset");
+        for (const char* Name : { "First", "Second" })
+        {
+            ar.BeginChunk(Name);
+            A0 a0;
+            a0.data = 1.f;
+            a0.Serialize(ar);
+            ar.EndChunk();
+        }
+    }
+
+    // FFileArchive header | Magic, Padding | NumChunks | TableOffset | table: Guid, NameLength, Name, Offset, Size ...
+    const std::vector<char> Bytes = ReadFileBytes("test_01_archive_chunks_damaged.uasset");
+    const uint64_t NumChunksOffset = 16 + 8;
+    const uint64_t TableOffsetOffset = NumChunksOffset + 8;
+    uint64_t TableOffset;
+    std::memcpy(&TableOffset, Bytes.data() + TableOffsetOffset, sizeof(uint64_t));
+    auto OpenPatched = [&](uint64_t Offset, uint64_t Value)
+    {
+        std::vector<char> Patched = Bytes;
+        std::memcpy(Patched.data() + Offset, &Value, sizeof(uint64_t));
+        std::ofstream("test_01_archive_chunks_damaged2.uasset", std::ofstream::binary).write(Patched.data(), (std::streamsize)Patched.size());
+        FChunkFileArchive ar(IArchive::EState::Loading, "test_01_archive_chunks_damaged2.uasset");
+        return ar.IsValid() ? ar.GetNumChunks() : 0;
+    };
+    CHECK(OpenPatched(NumChunksOffset, 2) == 2);
+    CHECK(OpenPatched(NumChunksOffset, uint64_t(1) << 40) == 0);
+    CHECK(OpenPatched(TableOffsetOffset, Bytes.size() + 1) == 0);
+    CHECK(OpenPatched(TableOffsetOffset, 0) == 0);
+    CHECK(OpenPatched(TableOffset + sizeof(FGuid), uint64_t(1) << 40) == 0);
+    // the second chunk's size
+    CHECK(OpenPatched(TableOffset + 2 * (sizeof(FGuid) + 8) + 5 + 8 + 8 + 6 + 8, uint64_t(1) << 40) == 0);
+
+    // a duplicated name
+    {
+        FChunkFileArchive ar(IArchive::EState::Saving, "test_01_archive_chunks_damaged.uasset");
+        for (const char* Name : { "ChunkA", "ChunkB" })
+        {
+            ar.BeginChunk(Name);
+            ar.EndChunk();
+        }
+    }
+    std::vector<char> Duplicated = ReadFileBytes("test_01_archive_chunks_damaged.uasset");
+    std::memcpy(&TableOffset, Duplicated.data() + TableOffsetOffset, sizeof(uint64_t));
+    char& LastLetter = Duplicated[TableOffset + 2 * (sizeof(FGuid) + 8) + 6 + 8 + 8 + 5];
+    REQUIRE(LastLetter == 'B');
+    LastLetter = 'A';
+    std::ofstream("test_01_archive_chunks_damaged2.uasset", std::ofstream::binary).write(Duplicated.data(), (std::streamsize)Duplicated.size());
+    FChunkFileArchive ar(IArchive::EState::Loading, "test_01_archive_chunks_damaged2.uasset");
+    CHECK_FALSE(ar.IsValid());
+}
+
+TEST_CASE("Archive - FMemoryArchive storage")
+{
+    const FTex2D Tex2D = MakeHDRTex2D();
+
+    FMemoryArchive Growing;
+    Growing.Reserve(64);
+    for (uint32_t Index = 0; Index < 1000; Index++)
+    {
+        A0 a0;
+        a0.data = (float)Index;
+        a0.Serialize(Growing);
+    }
+    FTex2D(Tex2D).Serialize(Growing);
+    CHECK(Growing.IsValid());
+    CHECK(Growing.GetStorage().Num() == 1000 * sizeof(float) + 40 + Tex2D.GetStorageSizeInBytes());
+
+    // the same bytes in a fixed buffer
+    std::vector<uint8_t> Buffer(Growing.GetStorage().Num());
+    {
+        FMemoryArchive Fixed(Buffer.data(), Buffer.size());
+        for (uint32_t Index = 0; Index < 1000; Index++)
+        {
+            A0 a0;
+            a0.data = (float)Index;
+            a0.Serialize(Fixed);
+        }
+        FTex2D(Tex2D).Serialize(Fixed);
+        CHECK(Fixed.IsValid());
+        CHECK(Fixed.GetStorage().GetData() == Buffer.data());
+        CHECK(Fixed.GetStorage().Num() == Buffer.size());
+    }
+    CHECK(std::memcmp(Buffer.data(), Growing.GetStorage().GetData(), Buffer.size()) == 0);
+
+    FMemoryArchive Reader(Growing.GetStorage());
+    A0 a0;
+    for (uint32_t Index = 0; Index < 1000; Index++)
+    {
+        a0.Serialize(Reader);
+    }
+    CHECK(a0.data == 999.f);
+    FTex2D Loaded;
+    Loaded.Serialize(Reader);
+    CHECK(std::memcmp(Loaded.GetStorage(), Tex2D.GetStorage(), Tex2D.GetStorageSizeInBytes()) == 0);
+
+    // a wrapper with reserved storage
+    FMemoryArchive Inner;
+    {
+        FArchiveWrapper Wrapper(&Inner);
+        Wrapper.Reserve(Tex2D.GetStorageSizeInBytes() + 40);
+        FTex2D(Tex2D).Serialize(Wrapper);
+    }
+    FMemoryArchive InnerReader(Inner.GetStorage());
+    FArchiveWrapper WrapperReader(&InnerReader);
+    REQUIRE(WrapperReader.IsValid());
+    FTex2D Unwrapped;
+    Unwrapped.Serialize(WrapperReader);
+    CHECK(std::memcmp(Unwrapped.GetStorage(), Tex2D.GetStorage(), Tex2D.GetStorageSizeInBytes()) == 0);
+}
@@ -1,6 +1,13 @@
 #include <UCommon/Tex2D.h>
+#include <UCommon/TexCube.h>
 #include <UCommon/Half.h>
+#include <UCommon/ThreadPool.h>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <UCommon_ext/doctest/doctest.h>
@@ -508,3 +515,1437 @@ TEST_CASE("Tex2D - ImageInpainting SingleChannel Coverage")
 	CHECK_MESSAGE(BorderG > 0.f, "G channel of border pixel should be filled");
 	CHECK_MESSAGE(BorderB > 0.f, "B channel of border pixel should be filled");
 }
+
+TEST_CASE("Tex2D - ImageInpainting Uint8 Coverage and ThreadPool")
+{
+	// odd sizes so the pyramid levels clamp at the edges, large enough to be split into tiles
+	const FGrid2D Grid2D(301, 77);
+	FTex2D Tex(Grid2D, 3, EElementType::Half);
+	FTex2D FloatCoverage(Grid2D, 1, EElementType::Float);
+	FTex2D Uint8Coverage(Grid2D, 1, EElementType::Uint8);
+	for (const FUint64Vector2& Point : Grid2D)
+	{
+		const bool bCovered = ((Point.X / 13) + (Point.Y / 7)) % 3 == 0;
+		for (uint64_t C = 0; C < 3; C++)
+		{
+			Tex.SetFloat(Point, C, bCovered ? (float)((Point.X * 3 + Point.Y * 5 + C) % 17) / 16.f : 0.f);
+		}
+		FloatCoverage.SetFloat(Point, 0, bCovered ? 1.f : 0.f);
+		Uint8Coverage.At<uint8_t>(Point, 0) = bCovered ? 255 : 0;
+	}
+	const FTex2D Uint8CoverageCopy = Uint8Coverage;
+
+	FTex2D Expected = Tex;
+	Expected.ImageInpainting(FloatCoverage);
+
+	FThreadPool ThreadPool(3);
+	FTex2D Parallel = Tex;
+	Parallel.ImageInpainting(FloatCoverage, &ThreadPool);
+	CHECK(std::memcmp(Parallel.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+
+	// the same coverage as Uint8 gives the same result, and the coverage is not modified
+	FTex2D Uint8Result = Tex;
+	Uint8Result.ImageInpainting(Uint8Coverage, &ThreadPool);
+	CHECK(std::memcmp(Uint8Result.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+	CHECK(std::memcmp(Uint8Coverage.GetStorage(), Uint8CoverageCopy.GetStorage(), Uint8Coverage.GetStorageSizeInBytes()) == 0);
+}
+
+static FTex2D MakeBandTestTex2D()
+{
+	FTex2D Tex(FGrid2D(33, 70), 3, EElementType::Float);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<float>(Index) = (float)Index;
+	}
+	return Tex;
+}
+
+static void CheckSerializeBands(FThreadPool* ThreadPool)
+{
+	const FTex2D Tex = MakeBandTestTex2D();
+
+	// Saving produces the rows band by band
+	FMemoryArchive Writer;
+	{
+		FTex2D Produced(Tex.GetGrid2D(), Tex.GetNumChannels(), Tex.GetElementType());
+		std::vector<uint64_t> Bands;
+		Produced.SerializeBands(Writer, 8, [&](uint64_t RowBegin, uint64_t RowEnd)
+		{
+			Bands.push_back(RowBegin);
+			const uint64_t RowSize = Tex.GetGrid2D().Width * Tex.GetNumChannels() * sizeof(float);
+			std::memcpy(static_cast<uint8_t*>(Produced.GetStorage()) + RowBegin * RowSize, static_cast<const uint8_t*>(Tex.GetStorage()) + RowBegin * RowSize, (RowEnd - RowBegin) * RowSize);
+		}, ThreadPool);
+		CHECK(Bands == std::vector<uint64_t>{ 0, 8, 16, 24, 32, 40, 48, 56, 64 });
+	}
+
+	// the format is the one of Serialize
+	FMemoryArchive Reader(Writer.GetStorage());
+	FTex2D Loaded;
+	Loaded.Serialize(Reader);
+	REQUIRE(Loaded.IsLayoutSameWith(Tex));
+	CHECK(std::memcmp(Loaded.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+
+	// Loading processes the rows band by band
+	FMemoryArchive BandReader(Writer.GetStorage());
+	FTex2D Streamed;
+	uint64_t NumRows = 0;
+	Streamed.SerializeBands(BandReader, 16, [&](uint64_t RowBegin, uint64_t RowEnd)
+	{
+		CHECK(RowBegin == NumRows);
+		for (uint64_t Y = RowBegin; Y < RowEnd; Y++)
+		{
+			CHECK(Streamed.At<float>(FUint64Vector2(5, Y), 2) == Tex.At<float>(FUint64Vector2(5, Y), 2));
+			Streamed.At<float>(FUint64Vector2(0, Y), 0) = -1.f;
+		}
+		NumRows = RowEnd;
+	}, ThreadPool);
+	CHECK(NumRows == 70);
+	CHECK(Streamed.At<float>(FUint64Vector2(0, 69), 0) == -1.f);
+	CHECK(Streamed.At<float>(FUint64Vector2(1, 69), 0) == Tex.At<float>(FUint64Vector2(1, 69), 0));
+}
+
+TEST_CASE("Tex2D - SerializeBands")
+{
+	CheckSerializeBands(nullptr);
+
+	FThreadPool ThreadPool(2);
+	CheckSerializeBands(&ThreadPool);
+}
+
+TEST_CASE("Tex2D - SaveFileParallel and LoadFileParallel")
+{
+	const FTex2D Tex = MakeBandTestTex2D();
+	FThreadPool ThreadPool(3);
+
+	REQUIRE(Tex.SaveFileParallel("test_05_tex2d_parallel.bin", ThreadPool, 4));
+
+	// readable as a FFileArchive
+	{
+		FFileArchive Archive(IArchive::EState::Loading, "test_05_tex2d_parallel.bin");
+		FTex2D Loaded;
+		Loaded.Serialize(Archive);
+		REQUIRE(Loaded.IsLayoutSameWith(Tex));
+		CHECK(std::memcmp(Loaded.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+	}
+
+	// a larger file written before must be replaced, not patched
+	FTex2D Small(FGrid2D(2, 2), 1, EElementType::Float);
+	Small.At<float>(3) = 4.f;
+	REQUIRE(Small.SaveFileParallel("test_05_tex2d_parallel.bin", ThreadPool));
+	FTex2D LoadedSmall;
+	REQUIRE(LoadedSmall.LoadFileParallel("test_05_tex2d_parallel.bin", ThreadPool));
+	CHECK(LoadedSmall.GetGrid2D() == FGrid2D(2, 2));
+	CHECK(LoadedSmall.At<float>(3) == 4.f);
+
+	REQUIRE(Tex.SaveFileParallel("test_05_tex2d_parallel.bin", ThreadPool));
+	FTex2D Loaded;
+	REQUIRE(Loaded.LoadFileParallel("test_05_tex2d_parallel.bin", ThreadPool, 7));
+	REQUIRE(Loaded.IsLayoutSameWith(Tex));
+	CHECK(std::memcmp(Loaded.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+	CHECK(Loaded.GetStorageOwnership() == EOwnership::TakeOwnership);
+
+	FTex2D Missing;
+	CHECK_FALSE(Missing.LoadFileParallel("test_05_tex2d_missing.bin", ThreadPool));
+}
+
+static FTex2D MakeConvertTestTex2D(EElementType ElementType)
+{
+	// odd width so the vector loops leave a scalar tail in every row
+	FTex2D Tex(FGrid2D(37, 19), 3, ElementType);
+	const float Specials[] = { 0.f, 1.f, -0.25f, 1.5f, 0.5f / 255.f, 1.5f / 255.f, 254.5f / 255.f, 65504.f, -1e-8f };
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		const float Value = Index % 5 == 0
+			? Specials[(Index / 5) % (sizeof(Specials) / sizeof(float))]
+			: (float)(Index % 1031) / 1000.f - 0.01f;
+		switch (ElementType)
+		{
+		case EElementType::Uint8: Tex.At<uint8_t>(Index) = (uint8_t)(Index * 7); break;
+		case EElementType::Half: Tex.At<FHalf>(Index) = ElementFloatToHalf(Value); break;
+		case EElementType::Float: Tex.At<float>(Index) = Value; break;
+		case EElementType::Double: Tex.At<double>(Index) = (double)Value + 1e-9 * (double)Index; break;
+		default: break;
+		}
+	}
+	return Tex;
+}
+
+/** Reference with the scalar element helpers. */
+static void CheckConvertedElement(const FTex2D& Src, const FTex2D& Dst, uint64_t Index)
+{
+	if (Src.GetElementType() == EElementType::Uint8 && Dst.GetElementType() == EElementType::Double)
+	{
+		CHECK(Dst.At<double>(Index) == ElementUint8ToDouble(Src.At<uint8_t>(Index)));
+		return;
+	}
+	if (Src.GetElementType() == EElementType::Double && Dst.GetElementType() == EElementType::Double)
+	{
+		CHECK(Dst.At<double>(Index) == Src.At<double>(Index));
+		return;
+	}
+	const float Value = Src.GetFloat(Index);
+	switch (Dst.GetElementType())
+	{
+	case EElementType::Uint8: CHECK(Dst.At<uint8_t>(Index) == ElementFloatClampToUint8(Value)); break;
+	case EElementType::Half: {
+		const FHalf Expected = ElementFloatToHalf(Value);
+		CHECK(std::memcmp(&Dst.At<FHalf>(Index), &Expected, sizeof(FHalf)) == 0);
+		break;
+	}
+	case EElementType::Float: CHECK(Dst.At<float>(Index) == Value); break;
+	case EElementType::Double: CHECK(Dst.At<double>(Index) == (double)Value); break;
+	default: break;
+	}
+}
+
+TEST_CASE("Tex2D - ConvertTo")
+{
+	const EElementType ElementTypes[] = { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double };
+	FThreadPool ThreadPool(4);
+	for (EElementType SrcType : ElementTypes)
+	{
+		const FTex2D Src = MakeConvertTestTex2D(SrcType);
+		for (EElementType DstType : ElementTypes)
+		{
+			const FTex2D Dst = Src.ConvertTo(DstType);
+			REQUIRE(Dst.GetElementType() == DstType);
+			REQUIRE(Dst.GetGrid2D() == Src.GetGrid2D());
+			for (uint64_t Index = 0; Index < Src.GetNumElements(); Index++)
+			{
+				CheckConvertedElement(Src, Dst, Index);
+			}
+
+			const FTex2D ParallelDst = Src.ConvertTo(DstType, &ThreadPool);
+			CHECK(std::memcmp(ParallelDst.GetStorage(), Dst.GetStorage(), Dst.GetStorageSizeInBytes()) == 0);
+		}
+	}
+
+	const FTex2D Src = MakeConvertTestTex2D(EElementType::Float);
+	CHECK(Src.ToHalf().GetElementType() == EElementType::Half);
+	CHECK(Src.ToFloat(&ThreadPool).GetElementType() == EElementType::Float);
+	FTex2D Uint8Tex(Src.GetGrid2D(), Src.GetNumChannels(), EElementType::Uint8);
+	Src.ToUint8(Uint8Tex, &ThreadPool);
+	const FTex2D Expected = Src.ToUint8();
+	CHECK(std::memcmp(Uint8Tex.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+}
+
+TEST_CASE("Tex2D - ElementConvert rounding")
+{
+	// ties of x * 255 round away from zero like roundf, out of range values clamp
+	const float Values[] = { 0.5f / 255.f, 1.5f / 255.f, 2.5f / 255.f, 127.5f / 255.f, 254.5f / 255.f, -3.f, 3.f, 0.f, 1.f, 0.49f / 255.f, 0.51f / 255.f };
+	constexpr uint64_t NumValues = sizeof(Values) / sizeof(float);
+	uint8_t Results[NumValues];
+	ElementConvert(Results, EElementType::Uint8, Values, EElementType::Float, NumValues);
+	for (uint64_t Index = 0; Index < NumValues; Index++)
+	{
+		CHECK(Results[Index] == ElementFloatClampToUint8(Values[Index]));
+	}
+}
+
+TEST_CASE("Tex2D - GenerateMips Box")
+{
+	FThreadPool ThreadPool(4);
+	const EElementType ElementTypes[] = { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double };
+	for (EElementType ElementType : ElementTypes)
+	{
+		const FTex2D Tex = MakeConvertTestTex2D(EElementType::Float).ConvertTo(ElementType);
+		const FTex2DMipChain MipChain = Tex.GenerateMips();
+		REQUIRE(MipChain.IsValid());
+		REQUIRE(MipChain.GetNumMips() == Tex.GetGrid2D().GetNumMips());
+		CHECK(std::memcmp(MipChain.GetMip(0).GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+
+		// same as repeated DownSample, levels back to back in one allocation
+		FTex2D Expected = Tex;
+		const uint8_t* End = static_cast<const uint8_t*>(MipChain.GetFlatTex2D().GetStorage());
+		for (uint64_t Level = 0; Level < MipChain.GetNumMips(); Level++)
+		{
+			const FTex2D Mip = MipChain.GetMip(Level);
+			REQUIRE(Mip.GetGrid2D() == Expected.GetGrid2D());
+			CHECK(Mip.GetStorage() == End);
+			CHECK(std::memcmp(Mip.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+			End += Mip.GetStorageSizeInBytes();
+			Expected = Expected.DownSample();
+		}
+		CHECK(End == static_cast<const uint8_t*>(MipChain.GetFlatTex2D().GetStorage()) + MipChain.GetFlatTex2D().GetStorageSizeInBytes());
+
+		const FTex2DMipChain ParallelMipChain = Tex.GenerateMips(EMipFilter::Box, &ThreadPool);
+		CHECK(std::memcmp(ParallelMipChain.GetFlatTex2D().GetStorage(), MipChain.GetFlatTex2D().GetStorage(), MipChain.GetFlatTex2D().GetStorageSizeInBytes()) == 0);
+	}
+
+	FTex2D Half(FGrid2D(2, 2), 1, EElementType::Half);
+	Half.At<FHalf>(0) = ElementFloatToHalf(1.f);
+	Half.At<FHalf>(1) = ElementFloatToHalf(2.f);
+	Half.At<FHalf>(2) = ElementFloatToHalf(3.f);
+	Half.At<FHalf>(3) = ElementFloatToHalf(4.f);
+	CHECK(Half.DownSample().GetFloat(0) == 2.5f);
+}
+
+TEST_CASE("Tex2D - GenerateMips Kaiser and Lanczos")
+{
+	FThreadPool ThreadPool(4);
+	for (EMipFilter Filter : { EMipFilter::Kaiser, EMipFilter::Lanczos })
+	{
+		// normalized weights keep a constant texture constant, odd sizes included
+		FTex2D Constant(FGrid2D(45, 23), 2, EElementType::Float);
+		for (uint64_t Index = 0; Index < Constant.GetNumElements(); Index++)
+		{
+			Constant.At<float>(Index) = Index % 2 == 0 ? 0.25f : 0.75f;
+		}
+		const FTex2DMipChain ConstantMips = Constant.GenerateMips(Filter, &ThreadPool);
+		REQUIRE(ConstantMips.GetNumMips() == 5);
+		CHECK(ConstantMips.GetMipGrid2D(4) == FGrid2D(2, 1));
+		for (uint64_t Level = 1; Level < ConstantMips.GetNumMips(); Level++)
+		{
+			const FTex2D Mip = ConstantMips.GetMip(Level);
+			for (uint64_t Index = 0; Index < Mip.GetNumElements(); Index++)
+			{
+				CHECK(Mip.At<float>(Index) == doctest::Approx(Index % 2 == 0 ? 0.25f : 0.75f).epsilon(1e-5));
+			}
+		}
+
+		// tiles on the pool give the same result, Uint8 stays in range
+		const EElementType ElementTypes[] = { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double };
+		for (EElementType ElementType : ElementTypes)
+		{
+			FTex2D Tex(FGrid2D(600, 70), 3, ElementType);
+			for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+			{
+				Tex.SetFloat(Index, (Index / 3) % 7 < 3 ? 1.f : 0.f);
+			}
+			const FTex2DMipChain Mips = Tex.GenerateMips(Filter);
+			const FTex2DMipChain ParallelMips = Tex.GenerateMips(Filter, &ThreadPool);
+			CHECK(std::memcmp(Mips.GetFlatTex2D().GetStorage(), ParallelMips.GetFlatTex2D().GetStorage(), Mips.GetFlatTex2D().GetStorageSizeInBytes()) == 0);
+			const float Mean = Mips.GetMip(Mips.GetNumMips() - 1).GetFloat(0);
+			CHECK(Mean == doctest::Approx(3.f / 7.f).epsilon(0.05));
+		}
+	}
+}
+
+TEST_CASE("Tex2D - Resize")
+{
+	FThreadPool ThreadPool(4);
+
+	// Triangle magnification is bilinear sampling with clamped edges
+	FTex2D Tex(FGrid2D(13, 9), 3, EElementType::Float);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<float>(Index) = (float)((Index * 37) % 101) / 100.f;
+	}
+	const FTex2D Magnified = Tex.Resize(FGrid2D(40, 21));
+	float Sample[3];
+	for (const FUint64Vector2& Point : Magnified.GetGrid2D())
+	{
+		Tex.BilinearSample(Sample, Magnified.GetGrid2D().GetTexcoord(Point), ETextureAddress::Clamp, ETextureAddress::Clamp);
+		for (uint64_t C = 0; C < 3; C++)
+		{
+			CHECK(Magnified.At<float>(Point, C) == doctest::Approx(Sample[C]).epsilon(1e-5));
+		}
+	}
+
+	// cubic filters with B + 2C = 1 keep a linear ramp away from the edges (up to the tap sampling when minifying)
+	FTex2D Ramp(FGrid2D(64, 4), 1, EElementType::Double);
+	for (const FUint64Vector2& Point : Ramp.GetGrid2D())
+	{
+		Ramp.At<double>(Point, 0) = (double)Point.X + 0.5;
+	}
+	for (EResizeFilter Filter : { EResizeFilter::CatmullRom, EResizeFilter::Mitchell })
+	{
+		for (uint64_t Width : { 200, 20 })
+		{
+			const FTex2D Resized = Ramp.Resize(FGrid2D(Width, 4), Filter);
+			const double Scale = 64. / (double)Width;
+			for (uint64_t X = Width / 4; X < Width - Width / 4; X++)
+			{
+				CHECK(std::abs(Resized.At<double>(FUint64Vector2(X, 2), 0) - ((double)X + 0.5) * Scale) < (Scale < 1. ? 1e-5 : 1e-2));
+			}
+		}
+	}
+
+	// constant textures stay constant, in one pass for any factor, serial and parallel alike
+	const EElementType ElementTypes[] = { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double };
+	for (EResizeFilter Filter : { EResizeFilter::Triangle, EResizeFilter::CatmullRom, EResizeFilter::Lanczos3, EResizeFilter::Mitchell })
+	{
+		for (EElementType ElementType : ElementTypes)
+		{
+			FTex2D Constant(FGrid2D(100, 60), 2, ElementType);
+			for (uint64_t Index = 0; Index < Constant.GetNumElements(); Index++)
+			{
+				Constant.SetFloat(Index, Index % 2 == 0 ? 0.2f : 0.6f);
+			}
+			for (const FGrid2D& Target : { FGrid2D(7, 3), FGrid2D(333, 1), FGrid2D(100, 121) })
+			{
+				const FTex2D Resized = Constant.Resize(Target, Filter);
+				REQUIRE(Resized.GetGrid2D() == Target);
+				for (uint64_t Index = 0; Index < Resized.GetNumElements(); Index++)
+				{
+					CHECK(Resized.GetFloat(Index) == doctest::Approx(Constant.GetFloat(Index % 2)).epsilon(1e-3));
+				}
+				const FTex2D ParallelResized = Constant.Resize(Target, Filter, &ThreadPool);
+				CHECK(std::memcmp(ParallelResized.GetStorage(), Resized.GetStorage(), Resized.GetStorageSizeInBytes()) == 0);
+			}
+		}
+	}
+
+	const FTex2D Small = Tex.DownSample(FGrid2D(2, 1));
+	CHECK(Small.GetGrid2D() == FGrid2D(2, 1));
+}
+
+TEST_CASE("Tex2D - View")
+{
+	FTex2D Tex(FGrid2D(11, 7), 2, EElementType::Float);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<float>(Index) = (float)Index / (float)Tex.GetNumElements();
+	}
+	const FUint64Vector2 Origin(3, 2);
+	const FGrid2D CropGrid2D(5, 4);
+	FTex2D Crop(CropGrid2D, 2, EElementType::Float);
+	FTex2D::Copy(Crop, FUint64Vector2(0, 0), Tex, Origin, CropGrid2D.GetExtent());
+
+	const FConstTex2DView View = static_cast<const FTex2D&>(Tex).GetView(Origin, CropGrid2D);
+	REQUIRE(View.IsValid());
+	CHECK_FALSE(View.IsContiguous());
+	CHECK(View.GetRowStride() == 11 * 2 * sizeof(float));
+	CHECK(&View.At<float>(FUint64Vector2(0, 0), 0) == &Tex.At<float>(Origin, 0));
+	CHECK(View.GetSubView(FUint64Vector2(1, 1), FGrid2D(2, 2)).GetFloat(FUint64Vector2(1, 0), 1) == Tex.GetFloat(FUint64Vector2(5, 3), 1));
+
+	// sampling addresses the edges of the view, as sampling the copied crop does
+	float ViewSample[2];
+	float CropSample[2];
+	for (const FVector2f& Texcoord : { FVector2f(0.f, 0.f), FVector2f(0.33f, 0.71f), FVector2f(1.2f, -0.4f), FVector2f(0.99f, 0.5f) })
+	{
+		for (ETextureAddress AddressMode : { ETextureAddress::Wrap, ETextureAddress::Clamp, ETextureAddress::Mirror })
+		{
+			View.BilinearSample(ViewSample, Texcoord, AddressMode, AddressMode);
+			Crop.BilinearSample(CropSample, Texcoord, AddressMode, AddressMode);
+			CHECK(ViewSample[0] == CropSample[0]);
+			CHECK(ViewSample[1] == CropSample[1]);
+		}
+	}
+
+	// conversion between strided views
+	FTex2D Half(FGrid2D(8, 6), 2, EElementType::Half);
+	std::memset(Half.GetStorage(), 0, Half.GetStorageSizeInBytes());
+	const FTex2DView HalfView = Half.GetView(FUint64Vector2(2, 1), CropGrid2D);
+	View.ConvertTo(HalfView);
+	for (const FUint64Vector2& Point : CropGrid2D)
+	{
+		CHECK(HalfView.GetFloat(Point, 1) == ElementHalfToFloat(ElementFloatToHalf(Crop.GetFloat(Point, 1))));
+	}
+	CHECK(Half.GetFloat(FUint64Vector2(0, 0), 0) == 0.f);
+
+	// in-place operations stay inside the view
+	FTex2D Clamped = Tex;
+	Clamped.GetView(Origin, CropGrid2D).Clamp(0.4f, 0.5f);
+	Clamped.GetView(Origin, CropGrid2D).Threshold(0.45f);
+	for (const FUint64Vector2& Point : Tex.GetGrid2D())
+	{
+		const bool bInside = Point.X >= Origin.X && Point.X < Origin.X + CropGrid2D.Width && Point.Y >= Origin.Y && Point.Y < Origin.Y + CropGrid2D.Height;
+		const float Value = Tex.GetFloat(Point, 0);
+		const float Expected = bInside ? (UCommon::Clamp(Value, 0.4f, 0.5f) < 0.45f ? 0.f : UCommon::Clamp(Value, 0.4f, 0.5f)) : Value;
+		CHECK(Clamped.GetFloat(Point, 0) == Expected);
+	}
+
+	// a saved view loads as a FTex2D, and loads back into a view
+	FMemoryArchive Writer;
+	View.Save(Writer);
+	FMemoryArchive Reader(Writer.GetStorage());
+	FTex2D Loaded;
+	Loaded.Serialize(Reader);
+	REQUIRE(Loaded.IsLayoutSameWith(Crop));
+	CHECK(std::memcmp(Loaded.GetStorage(), Crop.GetStorage(), Crop.GetStorageSizeInBytes()) == 0);
+
+	FTex2D Target(Tex.GetGrid2D(), 2, EElementType::Float);
+	std::memset(Target.GetStorage(), 0, Target.GetStorageSizeInBytes());
+	FMemoryArchive ViewReader(Writer.GetStorage());
+	REQUIRE(Target.GetView(Origin, CropGrid2D).Load(ViewReader));
+	CHECK(Target.At<float>(Origin, 0) == Tex.At<float>(Origin, 0));
+	CHECK(Target.At<float>(FUint64Vector2(0, 0), 0) == 0.f);
+	FMemoryArchive MismatchReader(Writer.GetStorage());
+	CHECK_FALSE(Target.GetView().Load(MismatchReader));
+}
+
+TEST_CASE("Tex2D - BilinearSampleBatch")
+{
+	// 8-lane groups plus a tail, texcoords near and far outside [0, 1] exercise the address modes
+	std::vector<FVector2f> Texcoords;
+	for (uint64_t Index = 0; Index < 64; Index++)
+	{
+		Texcoords.emplace_back((float)((Index * 29) % 67) / 64.f - 0.02f, (float)((Index * 43) % 61) / 58.f - 0.03f);
+	}
+	for (uint64_t Index = 0; Index < 203; Index++)
+	{
+		Texcoords.emplace_back((float)((Index * 37) % 101) / 25.f - 1.5f, (float)((Index * 53) % 89) / 22.f - 1.5f);
+	}
+	Texcoords.emplace_back(0.f, 1.f);
+	const ETextureAddress AddressModes[] = { ETextureAddress::Wrap, ETextureAddress::Clamp, ETextureAddress::Mirror };
+
+	FThreadPool ThreadPool(3);
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+	{
+		const FTex2D Tex = MakeConvertTestTex2D(ElementType);
+		const uint64_t NumChannels = Tex.GetNumChannels();
+		const FConstTex2DView SubView = Tex.GetView().GetSubView(FUint64Vector2(5, 3), FGrid2D(13, 9));
+		for (const FConstTex2DView& View : { Tex.GetView(), SubView })
+		{
+			for (ETextureAddress AddressModeX : AddressModes)
+			{
+				for (ETextureAddress AddressModeY : AddressModes)
+				{
+					std::vector<float> Results(Texcoords.size() * NumChannels);
+					std::vector<float> ParallelResults(Texcoords.size() * NumChannels);
+					View.BilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, Results.data(), AddressModeX, AddressModeY);
+					View.BilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, ParallelResults.data(), AddressModeX, AddressModeY, &ThreadPool);
+					CHECK(Results == ParallelResults);
+
+					std::vector<float> Expected(NumChannels);
+					for (uint64_t Index = 0; Index < Texcoords.size(); Index++)
+					{
+						View.BilinearSample(Expected.data(), Texcoords[Index], AddressModeX, AddressModeY);
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							// FMA contraction may round the texcoords differently between the two paths
+							CHECK(Results[Index * NumChannels + C] == doctest::Approx(Expected[C]).epsilon(1e-4));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Tex2D - Pointwise operations")
+{
+	// large enough to be split across the pool, odd sizes leave vector tails in the strided rows
+	FThreadPool ThreadPool(3);
+	const FGrid2D Grid2D(517, 301);
+	const FUint64Vector2 Origin(3, 2);
+	const FGrid2D CropGrid2D(500, 290);
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+	{
+		FTex2D Source(Grid2D, 1, ElementType);
+		for (uint64_t Index = 0; Index < Source.GetNumElements(); Index++)
+		{
+			const float Value = Index % 97 == 0 ? std::nanf("") : (float)(Index % 211) / 105.f - 0.5f;
+			switch (ElementType)
+			{
+			case EElementType::Uint8: Source.At<uint8_t>(Index) = (uint8_t)(Index * 7); break;
+			case EElementType::Half: Source.At<FHalf>(Index) = ElementFloatToHalf(Value); break;
+			case EElementType::Float: Source.At<float>(Index) = Value; break;
+			case EElementType::Double: Source.At<double>(Index) = (double)Value; break;
+			default: break;
+			}
+		}
+
+		for (int Op = 0; Op < 4; Op++)
+		{
+			auto Run = [Op](const FTex2DView& View, FThreadPool* Pool)
+			{
+				switch (Op)
+				{
+				case 0: View.Clamp(0.25f, 0.75f, Pool); break;
+				case 1: View.Min(0.3f, Pool); break;
+				case 2: View.Max(0.6f, Pool); break;
+				default: View.Threshold(0.45f, Pool); break;
+				}
+			};
+
+			// single elements only take the scalar loops
+			FTex2D Expected = Source;
+			for (const FUint64Vector2& Point : Grid2D)
+			{
+				Run(Expected.GetView(Point, FGrid2D(1, 1)), nullptr);
+			}
+
+			FTex2D Serial = Source;
+			Run(Serial.GetView(), nullptr);
+			CHECK(std::memcmp(Serial.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+
+			FTex2D Parallel = Source;
+			Run(Parallel.GetView(), &ThreadPool);
+			CHECK(std::memcmp(Parallel.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+
+			FTex2D Partial = Source;
+			Run(Partial.GetView(Origin, CropGrid2D), &ThreadPool);
+			const uint64_t ElementSize = ElementGetSize(ElementType);
+			for (const FUint64Vector2& Point : Grid2D)
+			{
+				const bool bInside = Point.X >= Origin.X && Point.X < Origin.X + CropGrid2D.Width && Point.Y >= Origin.Y && Point.Y < Origin.Y + CropGrid2D.Height;
+				const uint64_t Offset = Grid2D.GetIndex(Point) * ElementSize;
+				const FTex2D& Reference = bInside ? Expected : Source;
+				CHECK(std::memcmp(static_cast<const uint8_t*>(Partial.GetStorage()) + Offset, static_cast<const uint8_t*>(Reference.GetStorage()) + Offset, ElementSize) == 0);
+			}
+		}
+	}
+}
+
+TEST_CASE("Tex2D - Apply")
+{
+	FThreadPool ThreadPool(3);
+	auto Square = [](float* Values, uint64_t NumValues)
+	{
+		for (uint64_t Index = 0; Index < NumValues; Index++)
+		{
+			Values[Index] = Values[Index] * Values[Index];
+		}
+	};
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+	{
+		const FTex2D Source = MakeConvertTestTex2D(ElementType);
+		FTex2D Tex = Source;
+		Tex.Apply(Square);
+		FTex2D Large(FGrid2D(400, 300), Source.GetNumChannels(), ElementType);
+		std::memset(Large.GetStorage(), 0, Large.GetStorageSizeInBytes());
+		FTex2D::Copy(Large.GetView(FUint64Vector2(7, 5), Source.GetGrid2D()), Source.GetView());
+		Large.GetView(FUint64Vector2(7, 5), Source.GetGrid2D()).Apply(Square, &ThreadPool);
+		for (const FUint64Vector2& Point : Source.GetGrid2D())
+		{
+			for (uint64_t C = 0; C < Source.GetNumChannels(); C++)
+			{
+				const float Value = Source.GetFloat(Point, C);
+				float Expected = Value * Value;
+				switch (ElementType)
+				{
+				case EElementType::Uint8: Expected = ElementUint8ToFloat(ElementFloatClampToUint8(Expected)); break;
+				case EElementType::Half: Expected = ElementHalfToFloat(ElementFloatToHalf(Expected)); break;
+				default: break;
+				}
+				CHECK(Tex.GetFloat(Point, C) == Expected);
+				CHECK(Large.GetFloat(Point + FUint64Vector2(7, 5), C) == Expected);
+			}
+		}
+		CHECK(Large.GetFloat(FUint64Vector2(0, 0), 0) == 0.f);
+	}
+}
+
+TEST_CASE("Tex2D - Tiled storage layout")
+{
+	FThreadPool ThreadPool(3);
+	std::vector<FVector2f> Texcoords;
+	for (uint64_t Index = 0; Index < 203; Index++)
+	{
+		Texcoords.emplace_back((float)((Index * 37) % 101) / 50.f - 0.5f, (float)((Index * 53) % 89) / 44.f - 0.5f);
+	}
+	const ETextureAddress AddressModes[] = { ETextureAddress::Wrap, ETextureAddress::Clamp, ETextureAddress::Mirror };
+
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+	{
+		// 3 channels, and 1 channel for the gathers of the batch sampling, sizes not multiples of the tile
+		FTex2D Source3 = MakeConvertTestTex2D(ElementType);
+		FTex2D Source1(FGrid2D(29, 13), 1, ElementType);
+		for (const FUint64Vector2& Point : Source1.GetGrid2D())
+		{
+			Source1.SetFloat(Point, 0, (float)((Point.X * 7 + Point.Y * 13) % 23) / 22.f);
+		}
+
+		for (FTex2D* Source : { &Source3, &Source1 })
+		{
+			const FGrid2D& Grid2D = Source->GetGrid2D();
+			const uint64_t NumChannels = Source->GetNumChannels();
+			FTex2D Tiled = Source->ToStorageLayout(ETex2DStorageLayout::Tiled, &ThreadPool);
+			REQUIRE(Tiled.GetStorageLayout() == ETex2DStorageLayout::Tiled);
+			const FGrid2D StorageGrid2D = FTex2D::GetStorageGrid2D(Grid2D, ETex2DStorageLayout::Tiled);
+			CHECK(StorageGrid2D.Width % 8 == 0);
+			CHECK(StorageGrid2D.Height % 8 == 0);
+			CHECK(Tiled.GetNumElements() == StorageGrid2D.GetArea() * NumChannels);
+			CHECK(!Tiled.IsLayoutSameWith(*Source));
+
+			std::vector<bool> bVisited(StorageGrid2D.GetArea(), false);
+			for (const FUint64Vector2& Point : Grid2D)
+			{
+				const uint64_t TexelIndex = Tiled.GetTexelIndex(Point);
+				REQUIRE(TexelIndex < StorageGrid2D.GetArea());
+				CHECK(!bVisited[TexelIndex]);
+				bVisited[TexelIndex] = true;
+				for (uint64_t C = 0; C < NumChannels; C++)
+				{
+					CHECK(Tiled.GetFloat(Point, C) == Source->GetFloat(Point, C));
+				}
+			}
+			for (uint64_t TexelIndex = 0; TexelIndex < StorageGrid2D.GetArea(); TexelIndex++)
+			{
+				if (!bVisited[TexelIndex])
+				{
+					CHECK(Tiled.GetFloat(TexelIndex * NumChannels) == 0.f);
+				}
+			}
+
+			const FTex2D Linear = Tiled.ToStorageLayout(ETex2DStorageLayout::Linear);
+			CHECK(Linear.IsLayoutSameWith(*Source));
+			CHECK(std::memcmp(Linear.GetStorage(), Source->GetStorage(), Source->GetStorageSizeInBytes()) == 0);
+
+			// serialized in Linear order
+			FMemoryArchive SavingArchive;
+			Tiled.Serialize(SavingArchive);
+			FMemoryArchive SourceArchive;
+			Source->Serialize(SourceArchive);
+			REQUIRE(SavingArchive.GetStorage().Num() == SourceArchive.GetStorage().Num());
+			CHECK(std::memcmp(SavingArchive.GetStorage().GetData(), SourceArchive.GetStorage().GetData(), SourceArchive.GetStorage().Num()) == 0);
+
+			const FTex2D TiledHalf = Tiled.DownSample();
+			CHECK(TiledHalf.GetStorageLayout() == ETex2DStorageLayout::Tiled);
+			const FTex2D LinearHalf = TiledHalf.ToStorageLayout(ETex2DStorageLayout::Linear);
+			const FTex2D ExpectedHalf = Source->DownSample();
+			CHECK(std::memcmp(LinearHalf.GetStorage(), ExpectedHalf.GetStorage(), ExpectedHalf.GetStorageSizeInBytes()) == 0);
+
+			for (ETextureAddress AddressModeX : AddressModes)
+			{
+				for (ETextureAddress AddressModeY : AddressModes)
+				{
+					std::vector<float> Results(Texcoords.size() * NumChannels);
+					std::vector<float> Expected(Texcoords.size() * NumChannels);
+					Tiled.BilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, Results.data(), AddressModeX, AddressModeY, &ThreadPool);
+					Source->BilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, Expected.data(), AddressModeX, AddressModeY);
+					CHECK(Results == Expected);
+
+					std::vector<float> Sample(NumChannels);
+					std::vector<float> ExpectedSample(NumChannels);
+					for (const FVector2f& Texcoord : Texcoords)
+					{
+						Tiled.BilinearSample(Sample.data(), Texcoord, AddressModeX, AddressModeY);
+						Source->BilinearSample(ExpectedSample.data(), Texcoord, AddressModeX, AddressModeY);
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							// FMA contraction may round the texcoords differently between the two paths
+							CHECK(Sample[C] == doctest::Approx(ExpectedSample[C]).epsilon(1e-4));
+						}
+					}
+				}
+			}
+
+			FTex2D Clamped = Tiled;
+			Clamped.Clamp(0.25f, 0.75f, &ThreadPool);
+			FTex2D ExpectedClamped = *Source;
+			ExpectedClamped.Clamp(0.25f, 0.75f);
+			const FTex2D ClampedFloat = Clamped.ToFloat();
+			CHECK(ClampedFloat.GetStorageLayout() == ETex2DStorageLayout::Tiled);
+			for (const FUint64Vector2& Point : Grid2D)
+			{
+				for (uint64_t C = 0; C < NumChannels; C++)
+				{
+					CHECK(Clamped.GetFloat(Point, C) == ExpectedClamped.GetFloat(Point, C));
+					CHECK(ClampedFloat.GetFloat(Point, C) == ExpectedClamped.GetFloat(Point, C));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Tex2D - Storage pool")
+{
+	auto IsAligned = [](const FTex2D& Tex)
+	{
+		return reinterpret_cast<uintptr_t>(Tex.GetStorage()) % Tex2DStorageAlignment == 0;
+	};
+
+	SUBCASE("Size classes")
+	{
+		CHECK(FTex2DStoragePool::GetSizeClass(1) == 64);
+		CHECK(FTex2DStoragePool::GetSizeClass(64) == 64);
+		CHECK(FTex2DStoragePool::GetSizeClass(65) == 80);
+		CHECK(FTex2DStoragePool::GetSizeClass(128) == 128);
+		CHECK(FTex2DStoragePool::GetSizeClass(129) == 160);
+		for (uint64_t Size = 1; Size < 100000; Size += 97)
+		{
+			const uint64_t SizeClass = FTex2DStoragePool::GetSizeClass(Size);
+			CHECK(SizeClass >= Size);
+			CHECK(SizeClass % 16 == 0);
+			CHECK(FTex2DStoragePool::GetSizeClass(SizeClass) == SizeClass);
+			CHECK((Size <= 64 || SizeClass * 4 <= Size * 5 + 3 * 64));
+		}
+	}
+
+	SUBCASE("Aligned without pool")
+	{
+		CHECK(FTex2DStoragePool::GetCurrent() == nullptr);
+		for (uint64_t Width : { 1, 3, 17, 255 })
+		{
+			const FTex2D Tex(FGrid2D(Width, 3), 3, EElementType::Uint8);
+			CHECK(IsAligned(Tex));
+			const FTex2D Copy = Tex;
+			CHECK(IsAligned(Copy));
+		}
+		const FTex2D Tiled(FGrid2D(9, 9), 1, EElementType::Float, ETex2DStorageLayout::Tiled);
+		CHECK(IsAligned(Tiled));
+	}
+
+	SUBCASE("Reuse")
+	{
+		FTex2DStoragePool Pool;
+		{
+			FTex2DStoragePoolScope Scope(&Pool);
+			CHECK(FTex2DStoragePool::GetCurrent() == &Pool);
+			void* FirstStorage = nullptr;
+			{
+				FTex2D Tex(FGrid2D(100, 50), 4, EElementType::Float);
+				FirstStorage = Tex.GetStorage();
+				CHECK(IsAligned(Tex));
+			}
+			FTex2DStoragePool::FStats Stats = Pool.GetStats();
+			CHECK(Stats.NumAllocations == 1);
+			CHECK(Stats.NumHits == 0);
+			CHECK(Stats.NumCachedFrees == 1);
+			CHECK(Stats.CachedSizeInBytes == FTex2DStoragePool::GetSizeClass(100 * 50 * 4 * sizeof(float)));
+
+			// a slightly smaller texture of the same size class reuses the storage
+			{
+				FTex2D Tex(FGrid2D(99, 50), 4, EElementType::Float);
+				CHECK(Tex.GetStorage() == FirstStorage);
+			}
+			Stats = Pool.GetStats();
+			CHECK(Stats.NumAllocations == 2);
+			CHECK(Stats.NumHits == 1);
+			CHECK(Stats.GetHitRate() == 0.5);
+
+			// temporaries of a mip chain
+			FTex2D Source(FGrid2D(64, 32), 3, EElementType::Float);
+			for (const FUint64Vector2& Point : Source.GetGrid2D())
+			{
+				for (uint64_t C = 0; C < 3; C++)
+				{
+					Source.SetFloat(Point, C, static_cast<float>(Point.X * 3 + Point.Y * 5 + C) / 300.f);
+				}
+			}
+			const FTex2D Expected = Source.DownSample().DownSample();
+			Pool.ResetStats();
+			for (int Iteration = 0; Iteration < 8; Iteration++)
+			{
+				const FTex2D Converted = Source.ToFloat();
+				const FTex2D Mip = Converted.DownSample().DownSample();
+				CHECK(std::memcmp(Mip.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+			}
+			Stats = Pool.GetStats();
+			CHECK(Stats.NumAllocations == 8 * 3);
+			CHECK(Stats.GetHitRate() > 0.8);
+
+			{
+				FTex2DStoragePoolScope NoPoolScope(nullptr);
+				CHECK(FTex2DStoragePool::GetCurrent() == nullptr);
+				const FTex2D Tex(FGrid2D(100, 50), 4, EElementType::Float);
+				CHECK(Pool.GetStats().NumAllocations == Stats.NumAllocations);
+			}
+			CHECK(FTex2DStoragePool::GetCurrent() == &Pool);
+
+			// user storages are still released by free
+			FTex2D UserTex(FGrid2D(4, 4), 1, EOwnership::TakeOwnership, EElementType::Float, std::malloc(4 * 4 * sizeof(float)));
+			UserTex = FTex2D();
+			CHECK(Pool.GetStats().NumFrees == Stats.NumFrees);
+		}
+		CHECK(FTex2DStoragePool::GetCurrent() == nullptr);
+
+		Pool.Trim();
+		CHECK(Pool.GetStats().CachedSizeInBytes == 0);
+	}
+
+	SUBCASE("Cache limit")
+	{
+		FTex2DStoragePool Pool(4096);
+		FTex2DStoragePoolScope Scope(&Pool);
+		{
+			const FTex2D Large(FGrid2D(64, 64), 1, EElementType::Float);
+			const FTex2D Small(FGrid2D(16, 16), 1, EElementType::Float);
+		}
+		const FTex2DStoragePool::FStats Stats = Pool.GetStats();
+		CHECK(Stats.NumFrees == 2);
+		CHECK(Stats.NumCachedFrees == 1);
+		CHECK(Stats.CachedSizeInBytes == 1024);
+	}
+
+	SUBCASE("Shared by threads")
+	{
+		FTex2DStoragePool Pool;
+		FThreadPool ThreadPool(4);
+		ThreadPool.ParallelFor(0, 64, 1, [&](uint64_t Index)
+		{
+			FTex2DStoragePoolScope Scope(&Pool);
+			for (int Iteration = 0; Iteration < 16; Iteration++)
+			{
+				FTex2D Tex(FGrid2D(32 + Index % 4, 32), 2, EElementType::Half);
+				std::memset(Tex.GetStorage(), static_cast<int>(Index), Tex.GetStorageSizeInBytes());
+				CHECK(IsAligned(Tex));
+			}
+		});
+		const FTex2DStoragePool::FStats Stats = Pool.GetStats();
+		CHECK(Stats.NumAllocations == 64 * 16);
+		CHECK(Stats.NumFrees == 64 * 16);
+		CHECK(Stats.NumHits + (ThreadPool.GetNumThreads() + 1) * 4 >= Stats.NumAllocations);
+	}
+}
+
+TEST_CASE("Tex2D - Planar storage layout")
+{
+	FThreadPool ThreadPool(3);
+	std::vector<FVector2f> Texcoords;
+	for (uint64_t Index = 0; Index < 203; Index++)
+	{
+		Texcoords.emplace_back((float)((Index * 37) % 101) / 50.f - 0.5f, (float)((Index * 53) % 89) / 44.f - 0.5f);
+	}
+	const ETextureAddress AddressModes[] = { ETextureAddress::Wrap, ETextureAddress::Clamp, ETextureAddress::Mirror };
+
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+	{
+		// 3 and 4 channels take the unrolled conversions, 5 channels the generic one
+		FTex2D Source3 = MakeConvertTestTex2D(ElementType);
+		FTex2D Source4(FGrid2D(23, 11), 4, ElementType);
+		FTex2D Source5(FGrid2D(13, 7), 5, ElementType);
+		for (FTex2D* Source : { &Source4, &Source5 })
+		{
+			for (const FUint64Vector2& Point : Source->GetGrid2D())
+			{
+				for (uint64_t C = 0; C < Source->GetNumChannels(); C++)
+				{
+					Source->SetFloat(Point, C, (float)((Point.X * 7 + Point.Y * 13 + C * 5) % 23) / 22.f);
+				}
+			}
+		}
+
+		for (FTex2D* Source : { &Source3, &Source4, &Source5 })
+		{
+			const FGrid2D& Grid2D = Source->GetGrid2D();
+			const uint64_t NumChannels = Source->GetNumChannels();
+			FTex2D Planar = Source->ToStorageLayout(ETex2DStorageLayout::Planar, &ThreadPool);
+			REQUIRE(Planar.GetStorageLayout() == ETex2DStorageLayout::Planar);
+			CHECK(Planar.GetStorageSizeInBytes() == Source->GetStorageSizeInBytes());
+			CHECK(!Planar.IsLayoutSameWith(*Source));
+
+			for (const FUint64Vector2& Point : Grid2D)
+			{
+				for (uint64_t C = 0; C < NumChannels; C++)
+				{
+					CHECK(Planar.GetIndex(Point, C) == C * Grid2D.GetArea() + Grid2D.GetIndex(Point));
+					CHECK(Planar.GetFloat(Point, C) == Source->GetFloat(Point, C));
+					CHECK(Planar.GetPlaneView(C).GetFloat(Point, 0) == Source->GetFloat(Point, C));
+				}
+			}
+
+			const FTex2D Linear = Planar.ToStorageLayout(ETex2DStorageLayout::Linear, &ThreadPool);
+			CHECK(Linear.IsLayoutSameWith(*Source));
+			CHECK(std::memcmp(Linear.GetStorage(), Source->GetStorage(), Source->GetStorageSizeInBytes()) == 0);
+
+			// through Linear between Tiled and Planar
+			const FTex2D Tiled = Planar.ToStorageLayout(ETex2DStorageLayout::Tiled);
+			const FTex2D PlanarFromTiled = Tiled.ToStorageLayout(ETex2DStorageLayout::Planar);
+			CHECK(Tiled.GetStorageLayout() == ETex2DStorageLayout::Tiled);
+			CHECK(std::memcmp(PlanarFromTiled.GetStorage(), Planar.GetStorage(), Planar.GetStorageSizeInBytes()) == 0);
+
+			// serialized interleaved
+			FMemoryArchive SavingArchive;
+			Planar.Serialize(SavingArchive);
+			FMemoryArchive SourceArchive;
+			Source->Serialize(SourceArchive);
+			REQUIRE(SavingArchive.GetStorage().Num() == SourceArchive.GetStorage().Num());
+			CHECK(std::memcmp(SavingArchive.GetStorage().GetData(), SourceArchive.GetStorage().GetData(), SourceArchive.GetStorage().Num()) == 0);
+
+			const FTex2D PlanarHalf = Planar.DownSample();
+			CHECK(PlanarHalf.GetStorageLayout() == ETex2DStorageLayout::Planar);
+			const FTex2D LinearHalf = PlanarHalf.ToStorageLayout(ETex2DStorageLayout::Linear);
+			const FTex2D ExpectedHalf = Source->DownSample();
+			CHECK(std::memcmp(LinearHalf.GetStorage(), ExpectedHalf.GetStorage(), ExpectedHalf.GetStorageSizeInBytes()) == 0);
+
+			for (ETextureAddress AddressModeX : AddressModes)
+			{
+				for (ETextureAddress AddressModeY : AddressModes)
+				{
+					std::vector<float> Results(Texcoords.size() * NumChannels);
+					std::vector<float> Expected(Texcoords.size() * NumChannels);
+					Planar.BilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, Results.data(), AddressModeX, AddressModeY, &ThreadPool);
+					Source->BilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, Expected.data(), AddressModeX, AddressModeY);
+					for (uint64_t Index = 0; Index < Results.size(); Index++)
+					{
+						CHECK(Results[Index] == doctest::Approx(Expected[Index]).epsilon(1e-5));
+					}
+
+					std::vector<float> Sample(NumChannels);
+					std::vector<float> ExpectedSample(NumChannels);
+					for (const FVector2f& Texcoord : Texcoords)
+					{
+						Planar.BilinearSample(Sample.data(), Texcoord, AddressModeX, AddressModeY);
+						Source->BilinearSample(ExpectedSample.data(), Texcoord, AddressModeX, AddressModeY);
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							CHECK(Sample[C] == doctest::Approx(ExpectedSample[C]).epsilon(1e-4));
+						}
+					}
+				}
+			}
+
+			FTex2D Clamped = Planar;
+			Clamped.Clamp(0.25f, 0.75f, &ThreadPool);
+			FTex2D ExpectedClamped = *Source;
+			ExpectedClamped.Clamp(0.25f, 0.75f);
+			const FTex2D ClampedFloat = Clamped.ToFloat();
+			CHECK(ClampedFloat.GetStorageLayout() == ETex2DStorageLayout::Planar);
+			for (const FUint64Vector2& Point : Grid2D)
+			{
+				for (uint64_t C = 0; C < NumChannels; C++)
+				{
+					CHECK(Clamped.GetFloat(Point, C) == ExpectedClamped.GetFloat(Point, C));
+					CHECK(ClampedFloat.GetFloat(Point, C) == ExpectedClamped.GetFloat(Point, C));
+				}
+			}
+		}
+
+		if (ElementType != EElementType::Half)
+		{
+			const FTex2D Planar4 = Source4.ToStorageLayout(ETex2DStorageLayout::Planar);
+			for (const FUint64Vector2& Point : Source4.GetGrid2D())
+			{
+				CHECK(Planar4.GetLinearColor(Point) == Source4.GetLinearColor(Point));
+				CHECK(Planar4.GetDoubleColor(Point) == Source4.GetDoubleColor(Point));
+			}
+		}
+	}
+}
+
+TEST_CASE("Tex2D - Resize, GenerateMips and ImageInpainting in other storage layouts")
+{
+	FThreadPool ThreadPool(3);
+	const FTex2D Source = MakeConvertTestTex2D(EElementType::Float);
+	const FGrid2D& Grid2D = Source.GetGrid2D();
+	FTex2D Coverage(Grid2D, 1, EElementType::Uint8);
+	for (const FUint64Vector2& Point : Grid2D)
+	{
+		Coverage.SetFloat(Point, 0, (Point.X * 3 + Point.Y * 5) % 7 < 3 ? 1.f : 0.f);
+	}
+
+	const FTex2D ExpectedResized = Source.Resize(FGrid2D(23, 41), EResizeFilter::CatmullRom);
+	const FTex2DMipChain ExpectedMips = Source.GenerateMips(EMipFilter::Kaiser);
+	FTex2D ExpectedInpainted = Source;
+	ExpectedInpainted.ImageInpainting(Coverage);
+
+	for (ETex2DStorageLayout StorageLayout : { ETex2DStorageLayout::Tiled, ETex2DStorageLayout::Planar })
+	{
+		const FTex2D Tex = Source.ToStorageLayout(StorageLayout);
+
+		const FTex2D Resized = Tex.Resize(FGrid2D(23, 41), EResizeFilter::CatmullRom, &ThreadPool);
+		CHECK(Resized.GetStorageLayout() == StorageLayout);
+		const FTex2D LinearResized = Resized.ToStorageLayout(ETex2DStorageLayout::Linear);
+		REQUIRE(LinearResized.IsLayoutSameWith(ExpectedResized));
+		CHECK(std::memcmp(LinearResized.GetStorage(), ExpectedResized.GetStorage(), ExpectedResized.GetStorageSizeInBytes()) == 0);
+
+		// the chain is always Linear
+		const FTex2DMipChain Mips = Tex.GenerateMips(EMipFilter::Kaiser, &ThreadPool);
+		REQUIRE(Mips.GetNumMips() == ExpectedMips.GetNumMips());
+		for (uint64_t Level = 0; Level < Mips.GetNumMips(); Level++)
+		{
+			const FTex2D Mip = Mips.GetMip(Level);
+			const FTex2D ExpectedMip = ExpectedMips.GetMip(Level);
+			REQUIRE(Mip.IsLayoutSameWith(ExpectedMip));
+			CHECK(std::memcmp(Mip.GetStorage(), ExpectedMip.GetStorage(), ExpectedMip.GetStorageSizeInBytes()) == 0);
+		}
+
+		// in place, the storage is kept
+		FTex2D Inpainted = Tex;
+		const void* Storage = Inpainted.GetStorage();
+		Inpainted.ImageInpainting(Coverage.ToStorageLayout(StorageLayout), &ThreadPool);
+		CHECK(Inpainted.GetStorageLayout() == StorageLayout);
+		CHECK(Inpainted.GetStorage() == Storage);
+		const FTex2D LinearInpainted = Inpainted.ToStorageLayout(ETex2DStorageLayout::Linear);
+		REQUIRE(LinearInpainted.IsLayoutSameWith(ExpectedInpainted));
+		CHECK(std::memcmp(LinearInpainted.GetStorage(), ExpectedInpainted.GetStorage(), ExpectedInpainted.GetStorageSizeInBytes()) == 0);
+
+		// a Linear texture with a coverage in another layout
+		FTex2D LinearTex = Source;
+		LinearTex.ImageInpainting(Coverage.ToStorageLayout(StorageLayout));
+		CHECK(std::memcmp(LinearTex.GetStorage(), ExpectedInpainted.GetStorage(), ExpectedInpainted.GetStorageSizeInBytes()) == 0);
+
+		// saved in Linear order
+		REQUIRE(Tex.SaveFileParallel("test_05_tex2d_layout.bin", ThreadPool));
+		FTex2D Loaded;
+		REQUIRE(Loaded.LoadFileParallel("test_05_tex2d_layout.bin", ThreadPool));
+		REQUIRE(Loaded.IsLayoutSameWith(Source));
+		CHECK(std::memcmp(Loaded.GetStorage(), Source.GetStorage(), Source.GetStorageSizeInBytes()) == 0);
+	}
+}
+
+TEST_CASE("Tex2D - Summed-area table")
+{
+	FThreadPool ThreadPool(3);
+
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+	{
+		FTex2D Tex(FGrid2D(37, 21), 3, ElementType);
+		for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+		{
+			Tex.SetFloat(Index, (float)((Index * 37) % 101) / 100.f);
+		}
+		std::vector<double> Values(Tex.GetNumElements());
+		for (uint64_t Index = 0; Index < Values.size(); Index++)
+		{
+			// Uint8 is summed as unorm in double
+			Values[Index] = ElementType == EElementType::Uint8 ? (double)Tex.At<uint8_t>(Index) / 255. : (double)Tex.GetFloat(Index);
+		}
+
+		const FTex2DSummedAreaTable Table(Tex, true);
+		REQUIRE(Table.IsValid());
+		REQUIRE(Table.HasSquaredSums());
+		CHECK(Table.GetSums().GetGrid2D() == FGrid2D(38, 22));
+
+		// the parallel scan adds in the same order
+		const FTex2DSummedAreaTable ParallelTable(Tex, true, &ThreadPool);
+		CHECK(std::memcmp(ParallelTable.GetSums().GetStorage(), Table.GetSums().GetStorage(), Table.GetSums().GetStorageSizeInBytes()) == 0);
+		CHECK(std::memcmp(ParallelTable.GetSquaredSums().GetStorage(), Table.GetSquaredSums().GetStorage(), Table.GetSquaredSums().GetStorageSizeInBytes()) == 0);
+		CHECK_FALSE(FTex2DSummedAreaTable(Tex).HasSquaredSums());
+
+		for (uint64_t Index = 0; Index < 200; Index++)
+		{
+			FUint64Vector2 Min((Index * 7) % 37, (Index * 11) % 21);
+			FUint64Vector2 Max((Index * 13) % 38, (Index * 5) % 22);
+			if (Min.X > Max.X) std::swap(Min.X, Max.X);
+			if (Min.Y > Max.Y) std::swap(Min.Y, Max.Y);
+			const uint64_t C = Index % 3;
+
+			double Sum = 0., SquaredSum = 0.;
+			for (uint64_t Y = Min.Y; Y < Max.Y; Y++)
+			{
+				for (uint64_t X = Min.X; X < Max.X; X++)
+				{
+					const double Value = Values[(Y * 37 + X) * 3 + C];
+					Sum += Value;
+					SquaredSum += Value * Value;
+				}
+			}
+			const FTex2DSummedAreaTable::FStats Stats = Table.GetStats(Min, Max, C);
+			const uint64_t Count = (Max.X - Min.X) * (Max.Y - Min.Y);
+			CHECK(Stats.Count == Count);
+			CHECK(std::abs(Table.GetSum(Min, Max, C) - Sum) < 1e-9);
+			CHECK(std::abs(Table.GetSquaredSum(Min, Max, C) - SquaredSum) < 1e-9);
+			CHECK(std::abs(Stats.Sum - Sum) < 1e-9);
+			if (Count > 0)
+			{
+				const double Mean = Sum / (double)Count;
+				CHECK(std::abs(Table.GetMean(Min, Max, C) - Mean) < 1e-12);
+				CHECK(std::abs(Stats.Variance - (SquaredSum / (double)Count - Mean * Mean)) < 1e-9);
+				CHECK(Stats.Variance >= 0.);
+			}
+		}
+
+		// windows are clipped at the edges
+		const FTex2DSummedAreaTable::FStats Corner = Table.GetWindowStats(FUint64Vector2(0, 20), 2, 1);
+		CHECK(Corner.Count == 9);
+		CHECK(Corner.Sum == Table.GetSum(FUint64Vector2(0, 18), FUint64Vector2(3, 21), 1));
+		CHECK(Table.GetWindowStats(FUint64Vector2(18, 10), 100, 0).Count == 37 * 21);
+
+		// BoxBlur against a direct window average, any radius costs the same
+		for (uint64_t Radius : { 0, 1, 4, 50 })
+		{
+			const FTex2D Blurred = Tex.BoxBlur(Radius);
+			REQUIRE(Blurred.GetElementType() == ElementType);
+			const FTex2D ParallelBlurred = Tex.BoxBlur(Radius, &ThreadPool);
+			CHECK(std::memcmp(ParallelBlurred.GetStorage(), Blurred.GetStorage(), Blurred.GetStorageSizeInBytes()) == 0);
+			for (const FUint64Vector2& Point : Tex.GetGrid2D())
+			{
+				const uint64_t MinX = Point.X > Radius ? Point.X - Radius : 0;
+				const uint64_t MinY = Point.Y > Radius ? Point.Y - Radius : 0;
+				const uint64_t MaxX = std::min<uint64_t>(37, Point.X + Radius + 1);
+				const uint64_t MaxY = std::min<uint64_t>(21, Point.Y + Radius + 1);
+				for (uint64_t C = 0; C < 3; C++)
+				{
+					double Sum = 0.;
+					for (uint64_t Y = MinY; Y < MaxY; Y++)
+					{
+						for (uint64_t X = MinX; X < MaxX; X++)
+						{
+							Sum += Values[(Y * 37 + X) * 3 + C];
+						}
+					}
+					const double Mean = Sum / (double)((MaxX - MinX) * (MaxY - MinY));
+					const double Tolerance = ElementType == EElementType::Uint8 ? 0.5 / 255. + 1e-6 : ElementType == EElementType::Half ? 1e-3 : 1e-6;
+					CHECK(std::abs(Blurred.GetFloat(Point, C) - Mean) <= Tolerance);
+				}
+			}
+			if (Radius == 0 && ElementType != EElementType::Half)
+			{
+				CHECK(std::memcmp(Blurred.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+			}
+		}
+
+		// other storage layouts keep their layout
+		for (ETex2DStorageLayout StorageLayout : { ETex2DStorageLayout::Tiled, ETex2DStorageLayout::Planar })
+		{
+			const FTex2D Blurred = Tex.ToStorageLayout(StorageLayout).BoxBlur(3);
+			CHECK(Blurred.GetStorageLayout() == StorageLayout);
+			const FTex2D Linear = Blurred.ToStorageLayout(ETex2DStorageLayout::Linear);
+			const FTex2D Expected = Tex.BoxBlur(3);
+			CHECK(std::memcmp(Linear.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+		}
+	}
+
+	// a sub-view is summed on its own
+	FTex2D Ones(FGrid2D(16, 16), 1, EElementType::Float);
+	for (uint64_t Index = 0; Index < Ones.GetNumElements(); Index++)
+	{
+		Ones.At<float>(Index) = 1.f;
+	}
+	const FTex2DSummedAreaTable SubTable(Ones.GetView(FUint64Vector2(3, 5), FGrid2D(7, 4)));
+	CHECK(SubTable.GetGrid2D() == FGrid2D(7, 4));
+	CHECK(SubTable.GetSum(FUint64Vector2(0, 0), FUint64Vector2(7, 4), 0) == 28.);
+}
+
+TEST_CASE("Tex2D - Error metrics")
+{
+	FThreadPool ThreadPool(3);
+
+	// 1, 2, 4 and 8 channels fill the AVX2 lanes, 3 and 5 take periods of several vectors, 9 the scalar path
+	for (uint64_t NumChannels : { 1, 2, 3, 4, 5, 8, 9 })
+	{
+		for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+		{
+			FTex2D Reference(FGrid2D(45, 31), NumChannels, EElementType::Float);
+			FTex2D Tex(FGrid2D(45, 31), NumChannels, ElementType);
+			for (uint64_t Index = 0; Index < Reference.GetNumElements(); Index++)
+			{
+				Reference.At<float>(Index) = (float)((Index * 37) % 101) / 100.f;
+				Tex.SetFloat(Index, std::min(1.f, std::max(0.f, Reference.At<float>(Index) + (float)((int64_t)((Index * 53) % 31) - 15) / 300.f)));
+			}
+
+			std::vector<FTex2DErrorStats> Stats(NumChannels);
+			Tex.ComputeErrorStats(Reference, Stats.data(), 1e-2f);
+			std::vector<FTex2DErrorStats> ParallelStats(NumChannels);
+			Tex.ComputeErrorStats(Reference, ParallelStats.data(), 1e-2f, &ThreadPool);
+			std::vector<double> SquaredErrorSums(NumChannels, 0.);
+			std::vector<float> MaxAbsErrors(NumChannels, 0.f);
+			std::vector<float> MaxRelErrors(NumChannels, 0.f);
+			for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+			{
+				const uint64_t C = Index % NumChannels;
+				const float Error = Tex.GetFloat(Index) - Reference.At<float>(Index);
+				SquaredErrorSums[C] += (double)(Error * Error);
+				MaxAbsErrors[C] = std::max(MaxAbsErrors[C], std::abs(Error));
+				MaxRelErrors[C] = std::max(MaxRelErrors[C], std::abs(Error) / std::max(std::abs(Reference.At<float>(Index)), 1e-2f));
+			}
+			double MSE = 0.;
+			for (uint64_t C = 0; C < NumChannels; C++)
+			{
+				CHECK(Stats[C].MSE == doctest::Approx(SquaredErrorSums[C] / (45. * 31.)).epsilon(1e-5));
+				CHECK(Stats[C].MaxAbsError == MaxAbsErrors[C]);
+				CHECK(Stats[C].MaxRelError == doctest::Approx(MaxRelErrors[C]).epsilon(1e-6));
+				CHECK(ParallelStats[C].MSE == Stats[C].MSE);
+				CHECK(ParallelStats[C].MaxAbsError == Stats[C].MaxAbsError);
+				CHECK(ParallelStats[C].MaxRelError == Stats[C].MaxRelError);
+				MSE += Stats[C].MSE;
+			}
+			MSE /= (double)NumChannels;
+			CHECK(Tex.ComputeMSE(Reference, &ThreadPool) == MSE);
+			CHECK(Tex.ComputePSNR(Reference) == doctest::Approx(10. * std::log10(1. / MSE)));
+
+			// the histograms count every element once, against a direct binning
+			std::vector<uint64_t> Histograms(NumChannels * 16, 1);
+			Tex.ComputeErrorHistograms(Reference, 0.04f, 16, Histograms.data(), &ThreadPool);
+			std::vector<uint64_t> ExpectedHistograms(NumChannels * 16, 0);
+			for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+			{
+				const float Bin = std::abs(Tex.GetFloat(Index) - Reference.At<float>(Index)) * (16.f / 0.04f);
+				ExpectedHistograms[(Index % NumChannels) * 16 + (Bin < 15.f ? (uint64_t)Bin : 15)]++;
+			}
+			CHECK(Histograms == ExpectedHistograms);
+		}
+	}
+
+	// equal textures, constant offsets and NaN
+	FTex2D Tex(FGrid2D(70, 40), 3, EElementType::Float);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<float>(Index) = (float)((Index * 37) % 101) / 100.f;
+	}
+	CHECK(Tex.ComputeMSE(Tex) == 0.);
+	CHECK(std::isinf(Tex.ComputePSNR(Tex)));
+	double ChannelSSIMs[3];
+	CHECK(Tex.ComputeSSIM(Tex, ChannelSSIMs) == doctest::Approx(1.));
+	CHECK(ChannelSSIMs[2] == doctest::Approx(1.));
+	FTex2D Offset = Tex;
+	Offset.Apply([](float* Values, uint64_t Num) { for (uint64_t Index = 0; Index < Num; Index++) Values[Index] += 0.125f; });
+	CHECK(Offset.ComputePSNR(Tex) == doctest::Approx(20. * std::log10(8.)));
+	CHECK(Offset.ComputePSNR(Tex, 255.) == doctest::Approx(20. * std::log10(8. * 255.)));
+	Offset.At<float>(FUint64Vector2(3, 4), 1) = std::numeric_limits<float>::quiet_NaN();
+	uint64_t Histograms[3 * 4];
+	Offset.ComputeErrorHistograms(Tex, 1.f, 4, Histograms);
+	CHECK(Histograms[0] == 70 * 40);
+	CHECK(Histograms[4] == 70 * 40 - 1);
+	CHECK(Histograms[7] == 1);
+
+	// SSIM against a direct evaluation of the Gaussian windows in double
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Float })
+	{
+		FTex2D Distorted(Tex.GetGrid2D(), 3, ElementType);
+		for (const FUint64Vector2& Point : Tex.GetGrid2D())
+		{
+			for (uint64_t C = 0; C < 3; C++)
+			{
+				Distorted.SetFloat(Point, C, 0.5f * Tex.At<float>(Point, C) + 0.3f * (float)((Point.X / 4 + Point.Y / 3 + C) % 2));
+			}
+		}
+		double Weights[11];
+		double WeightSum = 0.;
+		for (int64_t K = 0; K < 11; K++)
+		{
+			Weights[K] = std::exp(-(double)((K - 5) * (K - 5)) / (2. * 1.5 * 1.5));
+			WeightSum += Weights[K];
+		}
+		double ExpectedSSIMs[3] = {};
+		for (const FUint64Vector2& Point : Tex.GetGrid2D())
+		{
+			for (uint64_t C = 0; C < 3; C++)
+			{
+				double MeanA = 0., MeanB = 0., MeanAA = 0., MeanBB = 0., MeanAB = 0.;
+				for (int64_t KY = 0; KY < 11; KY++)
+				{
+					for (int64_t KX = 0; KX < 11; KX++)
+					{
+						const FUint64Vector2 Tap(
+							(uint64_t)std::min<int64_t>(69, std::max<int64_t>(0, (int64_t)Point.X + KX - 5)),
+							(uint64_t)std::min<int64_t>(39, std::max<int64_t>(0, (int64_t)Point.Y + KY - 5)));
+						const double Weight = Weights[KX] * Weights[KY] / (WeightSum * WeightSum);
+						const double A = (double)Distorted.GetFloat(Tap, C);
+						const double B = (double)Tex.At<float>(Tap, C);
+						MeanA += Weight * A;
+						MeanB += Weight * B;
+						MeanAA += Weight * A * A;
+						MeanBB += Weight * B * B;
+						MeanAB += Weight * A * B;
+					}
+				}
+				const double C1 = 0.01 * 0.01;
+				const double C2 = 0.03 * 0.03;
+				ExpectedSSIMs[C] += (2. * MeanA * MeanB + C1) * (2. * (MeanAB - MeanA * MeanB) + C2)
+					/ ((MeanA * MeanA + MeanB * MeanB + C1) * (MeanAA - MeanA * MeanA + MeanBB - MeanB * MeanB + C2)) / (70. * 40.);
+			}
+		}
+		const double SSIM = Distorted.ComputeSSIM(Tex, ChannelSSIMs);
+		for (uint64_t C = 0; C < 3; C++)
+		{
+			CHECK(ChannelSSIMs[C] == doctest::Approx(ExpectedSSIMs[C]).epsilon(1e-4));
+		}
+		CHECK(SSIM < 0.9);
+		CHECK(Distorted.ComputeSSIM(Tex, nullptr, 1., &ThreadPool) == SSIM);
+
+		// other storage layouts are compared through Linear copies
+		const FTex2D Planar = Distorted.ToStorageLayout(ETex2DStorageLayout::Planar);
+		CHECK(Planar.ComputeSSIM(Tex.ToStorageLayout(ETex2DStorageLayout::Tiled)) == SSIM);
+		CHECK(Planar.ComputeMSE(Tex) == Distorted.ComputeMSE(Tex));
+	}
+}
+
+template<typename T, uint64_t N>
+void CheckTypedTex2D()
+{
+	const FGrid2D Grid2D(13, 7);
+	FTex2D Tex(Grid2D, N, ElementTypeOf<T>);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.SetFloat(Index, (float)((Index * 37) % 101) / 100.f);
+	}
+	const void* Storage = Tex.GetStorage();
+
+	// the typed texture takes the storage without copy and gives it back
+	TTex2D<T, N> Typed(std::move(Tex));
+	REQUIRE(Typed.IsValid());
+	CHECK(Typed.GetStorage() == Storage);
+	CHECK(Typed.GetGrid2D() == Grid2D);
+	const FTex2D& Untyped = Typed.GetTex2D();
+	for (uint64_t Y = 0; Y < Grid2D.Height; Y++)
+	{
+		CHECK(Typed.GetRow(Y) == &Untyped.At<T>(FUint64Vector2(0, Y), 0));
+		for (uint64_t X = 0; X < Grid2D.Width; X++)
+		{
+			for (uint64_t C = 0; C < N; C++)
+			{
+				const FUint64Vector2 Point(X, Y);
+				CHECK(&Typed.At(Point, C) == &Untyped.At<T>(Point, C));
+				CHECK(Typed.GetTexel(Point) + C == &Typed.At(Point, C));
+				CHECK(Typed.GetFloat(Point, C) == Untyped.GetFloat(Point, C));
+			}
+		}
+	}
+
+	// views convert both ways without copy
+	typename TTex2D<T, N>::FView View = Typed.GetView();
+	CHECK(View.IsContiguous());
+	const FTex2DView UntypedView = View;
+	CHECK(UntypedView.GetRow(3) == View.GetRow(3));
+	CHECK(UntypedView.GetElementType() == ElementTypeOf<T>);
+	CHECK(UntypedView.GetNumChannels() == N);
+	const TConstTex2DView<T, N> ConstView = View;
+	CHECK(TConstTex2DView<T, N>(FConstTex2DView(Untyped)).GetRow(2) == ConstView.GetRow(2));
+
+	const TTex2DView<T, N> SubView = View.GetSubView(FUint64Vector2(3, 2), FGrid2D(5, 4));
+	const FTex2DView UntypedSubView = UntypedView.GetSubView(FUint64Vector2(3, 2), FGrid2D(5, 4));
+	CHECK(SubView.GetRowStride() == UntypedSubView.GetRowStride());
+	CHECK_FALSE(SubView.IsContiguous());
+	SubView.SetFloat(FUint64Vector2(1, 1), N - 1, 0.5f);
+	CHECK(UntypedSubView.GetFloat(FUint64Vector2(1, 1), N - 1) == SubView.GetFloat(FUint64Vector2(1, 1), N - 1));
+	CHECK(&SubView.At(FUint64Vector2(1, 1), N - 1) == &Typed.At(FUint64Vector2(4, 3), N - 1));
+
+	// sampling matches the untyped view, address modes included
+	float Expected[N], Result[N];
+	for (uint64_t Index = 0; Index < 64; Index++)
+	{
+		const FVector2f Texcoord((float)Index * 0.037f - 0.4f, (float)Index * 0.029f - 0.3f);
+		ConstView.BilinearSample(Result, Texcoord);
+		UntypedView.BilinearSample(Expected, Texcoord);
+		for (uint64_t C = 0; C < N; C++)
+		{
+			CHECK(FloatEqual(Result[C], Expected[C], 1e-6f));
+		}
+		ConstView.template BilinearSample<ETextureAddress::Clamp, ETextureAddress::Mirror>(Result, Texcoord);
+		UntypedView.BilinearSample(Expected, Texcoord, ETextureAddress::Clamp, ETextureAddress::Mirror);
+		for (uint64_t C = 0; C < N; C++)
+		{
+			CHECK(FloatEqual(Result[C], Expected[C], 1e-6f));
+		}
+		Typed.template BilinearSample<ETextureAddress::Mirror, ETextureAddress::Wrap>(Result, Texcoord);
+		UntypedView.BilinearSample(Expected, Texcoord, ETextureAddress::Mirror, ETextureAddress::Wrap);
+		for (uint64_t C = 0; C < N; C++)
+		{
+			CHECK(FloatEqual(Result[C], Expected[C], 1e-6f));
+		}
+	}
+
+	const FTex2D Released = Typed.ReleaseTex2D();
+	CHECK_FALSE(Typed.IsValid());
+	CHECK(Released.GetStorage() == Storage);
+}
+
+TEST_CASE("Tex2D - Typed texture")
+{
+	CheckTypedTex2D<uint8_t, 3>();
+	CheckTypedTex2D<FHalf, 1>();
+	CheckTypedTex2D<float, 4>();
+	CheckTypedTex2D<double, 2>();
+
+	static_assert(TTex2D<float, 4>::NumChannels == 4 && TTex2D<float, 4>::ElementType == EElementType::Float);
+	static_assert(std::is_same_v<TConstTex2DView<FHalf, 2>::FElement, const FHalf>);
+	static_assert(std::is_convertible_v<TTex2DView<float, 4>, TConstTex2DView<float, 4>>);
+	static_assert(!std::is_convertible_v<TConstTex2DView<float, 4>, TTex2DView<float, 4>>);
+
+	// allocated typed textures are Linear FTex2D
+	TTex2D<float, 2> Tex(FGrid2D(4, 3));
+	for (uint64_t Y = 0; Y < 3; Y++)
+	{
+		float* Row = Tex.GetRow(Y);
+		for (uint64_t X = 0; X < 4 * 2; X++)
+		{
+			Row[X] = (float)(Y * 8 + X);
+		}
+	}
+	CHECK(Tex.GetTex2D().GetStorageLayout() == ETex2DStorageLayout::Linear);
+	CHECK(Tex.GetTex2D().At<float>(FUint64Vector2(3, 2), 1) == 23.f);
+	Tex.SetFloat(FUint64Vector2(1, 1), 0, -1.f);
+	CHECK(Tex.GetTex2D().GetFloat(Tex.GetTex2D().GetIndex(FUint64Vector2(1, 1), 0)) == -1.f);
+	CHECK_FALSE(TTex2D<float, 2>().IsValid());
+}
+
+TEST_CASE("TexCube - GetFaceView")
+{
+	FTexCube TexCube(FTex2D(FGrid2D(4, 4 * 6), 1, EElementType::Float));
+	for (uint64_t Index = 0; Index < TexCube.FlatTex2D.GetNumElements(); Index++)
+	{
+		TexCube.FlatTex2D.At<float>(Index) = (float)(Index / 16);
+	}
+	const FConstTex2DView Face = static_cast<const FTexCube&>(TexCube).GetFaceView(ECubeFace::NegativeY);
+	CHECK(Face.GetGrid2D() == FGrid2D(4, 4));
+	CHECK(Face.GetFloat(FUint64Vector2(3, 3), 0) == 3.f);
+	float Sample;
+	TexCube.BilinearSample(&Sample, FCubeTexcoord(ECubeFace::PositiveZ, FVector2f(0.5f, 0.5f)));
+	CHECK(Sample == 4.f);
+}
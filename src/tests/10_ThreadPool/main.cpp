@@ -0,0 +1,426 @@
+#include <UCommon/ThreadPool.h>
+#include <UCommon/Tex2D.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <UCommon_ext/doctest/doctest.h>
+
+using namespace UCommon;
+
+static const FThreadPool::EScheduler Schedulers[] =
+{
+	FThreadPool::EScheduler::SharedQueue,
+	FThreadPool::EScheduler::WorkStealing,
+};
+
+TEST_CASE("ThreadPool - Enqueue runs every task")
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		std::atomic<uint64_t> Counter{ 0 };
+		{
+			FThreadPool ThreadPool(4, Scheduler);
+			CHECK(ThreadPool.GetNumThreads() == 4);
+			CHECK(ThreadPool.GetScheduler() == Scheduler);
+			for (uint64_t Index = 0; Index < 10000; Index++)
+			{
+				CHECK(ThreadPool.Enqueue(std::function<void()>([&Counter] { ++Counter; })));
+			}
+		} // the destructor drains the queues
+		CHECK(Counter == 10000);
+	}
+}
+
+TEST_CASE("ThreadPool - Enqueue returns futures")
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		FThreadPool ThreadPool(3, Scheduler);
+		std::vector<std::future<uint64_t>> Futures;
+		for (uint64_t Index = 0; Index < 256; Index++)
+		{
+			Futures.push_back(ThreadPool.Enqueue([](uint64_t A, uint64_t B) { return A * B; }, Index, uint64_t(3)));
+		}
+		uint64_t Sum = 0;
+		for (auto& Future : Futures)
+		{
+			Sum += Future.get();
+		}
+		CHECK(Sum == 3 * 255 * 256 / 2);
+	}
+}
+
+TEST_CASE("ThreadPool - WorkStealing nested enqueue")
+{
+	// Every task spawns children from a worker thread, they land in the worker's own deque
+	// and idle workers have to steal them.
+	std::atomic<uint64_t> Counter{ 0 };
+	{
+		FThreadPool ThreadPool(4, FThreadPool::EScheduler::WorkStealing);
+		std::function<void(uint64_t)> Spawn = [&](uint64_t Depth)
+		{
+			++Counter;
+			if (Depth == 0)
+			{
+				return;
+			}
+			for (uint64_t Index = 0; Index < 4; Index++)
+			{
+				ThreadPool.Enqueue(std::function<void()>([&Spawn, Depth] { Spawn(Depth - 1); }));
+			}
+		};
+		ThreadPool.Enqueue(std::function<void()>([&Spawn] { Spawn(6); }));
+		// 1 + 4 + ... + 4^6
+		while (Counter != 5461)
+		{
+			std::this_thread::yield();
+		}
+	}
+	CHECK(Counter == 5461);
+}
+
+TEST_CASE("ThreadPool - Enqueue concurrent with destruction")
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		for (uint64_t Iteration = 0; Iteration < 200; Iteration++)
+		{
+			std::atomic<uint64_t> NumAccepted{ 0 };
+			std::atomic<uint64_t> NumExecuted{ 0 };
+			std::atomic<bool> bEnqueuerDone{ false };
+			std::thread Enqueuer;
+			{
+				FThreadPool ThreadPool(2, Scheduler);
+				// keeps the pool alive until the enqueuer saw the rejection and left it alone
+				ThreadPool.Enqueue(std::function<void()>([&bEnqueuerDone]
+				{
+					while (!bEnqueuerDone)
+					{
+						std::this_thread::yield();
+					}
+				}));
+				Enqueuer = std::thread([&]
+				{
+					while (ThreadPool.Enqueue(std::function<void()>([&NumExecuted] { ++NumExecuted; })))
+					{
+						++NumAccepted;
+					}
+					bEnqueuerDone = true;
+				});
+				while (NumAccepted < Iteration % 8)
+				{
+					std::this_thread::yield();
+				}
+			} // the destructor races with the enqueues
+			Enqueuer.join();
+			// every accepted task ran before the workers exited
+			CHECK(NumExecuted == NumAccepted);
+		}
+	}
+}
+
+TEST_CASE("ThreadPool - Zero threads falls back to SharedQueue")
+{
+	FThreadPool ThreadPool(0, FThreadPool::EScheduler::WorkStealing);
+	CHECK(ThreadPool.GetNumThreads() == 0);
+	CHECK(ThreadPool.GetScheduler() == FThreadPool::EScheduler::SharedQueue);
+}
+
+template<typename FunctionT>
+static void ForEachPool(FunctionT&& Function)
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		for (uint64_t NumThreads : { 0, 1, 4 })
+		{
+			FThreadPool ThreadPool(NumThreads, Scheduler);
+			Function(ThreadPool);
+		}
+	}
+}
+
+TEST_CASE("ThreadPool - ParallelFor visits every index once")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		for (uint64_t GrainSize : { 0, 1, 7, 1000, 5000 })
+		{
+			std::vector<std::atomic<uint32_t>> Visits(1000);
+			ThreadPool.ParallelFor(0, 1000, GrainSize, [&Visits](uint64_t Index) { ++Visits[Index]; });
+			bool bAllOnce = true;
+			for (const auto& Visit : Visits)
+			{
+				bAllOnce &= Visit == 1;
+			}
+			CHECK(bAllOnce);
+		}
+	});
+}
+
+TEST_CASE("ThreadPool - ParallelForRange chunks")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		std::atomic<uint64_t> Sum{ 0 };
+		std::atomic<uint64_t> NumChunks{ 0 };
+		std::atomic<uint64_t> MaxChunkSize{ 0 };
+		ThreadPool.ParallelForRange(10, 110, 16, [&](uint64_t ChunkBegin, uint64_t ChunkEnd)
+		{
+			for (uint64_t Index = ChunkBegin; Index < ChunkEnd; Index++)
+			{
+				Sum += Index;
+			}
+			++NumChunks;
+			uint64_t Size = ChunkEnd - ChunkBegin;
+			uint64_t Max = MaxChunkSize;
+			while (Size > Max && !MaxChunkSize.compare_exchange_weak(Max, Size)) {}
+		});
+		CHECK(Sum == (10 + 109) * 100 / 2);
+		CHECK(NumChunks == (ThreadPool.GetNumThreads() == 0 ? 1 : 7));
+		CHECK(MaxChunkSize <= (ThreadPool.GetNumThreads() == 0 ? 100 : 16));
+
+		bool bCalled = false;
+		ThreadPool.ParallelForRange(5, 5, 0, [&bCalled](uint64_t, uint64_t) { bCalled = true; });
+		CHECK_FALSE(bCalled);
+	});
+}
+
+TEST_CASE("ThreadPool - 2D ParallelFor covers the grid")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		const FGrid2D Grid(100, 37);
+		std::vector<std::atomic<uint32_t>> Visits(Grid.GetArea());
+		ThreadPool.ParallelFor(Grid, FUint64Vector2(16, 8), [&](const FUint64Vector2& TileMin, const FUint64Vector2& TileMax)
+		{
+			for (uint64_t Y = TileMin.Y; Y < TileMax.Y; Y++)
+			{
+				for (uint64_t X = TileMin.X; X < TileMax.X; X++)
+				{
+					++Visits[Grid.GetIndex(FUint64Vector2(X, Y))];
+				}
+			}
+		});
+		bool bAllOnce = true;
+		for (const auto& Visit : Visits)
+		{
+			bAllOnce &= Visit == 1;
+		}
+		CHECK(bAllOnce);
+	});
+}
+
+TEST_CASE("ThreadPool - Nested ParallelFor")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		// Every worker blocks in an inner ParallelFor, which only completes because
+		// waiting threads run queued chunks themselves.
+		std::atomic<uint64_t> Counter{ 0 };
+		ThreadPool.ParallelFor(0, 16, 1, [&](uint64_t)
+		{
+			ThreadPool.ParallelFor(0, 16, 1, [&](uint64_t)
+			{
+				ThreadPool.ParallelFor(0, 16, 0, [&](uint64_t) { ++Counter; });
+			});
+		});
+		CHECK(Counter == 16 * 16 * 16);
+	});
+}
+
+TEST_CASE("ThreadPool - FTask")
+{
+	uint64_t Value = 0;
+	const uint64_t NumAllocations = FThreadPool::GetNumTaskAllocations();
+
+	FTask SmallTask([&Value] { Value += 1; });
+	CHECK(SmallTask.IsValid());
+	FTask MovedTask(std::move(SmallTask));
+	CHECK_FALSE(SmallTask.IsValid());
+	MovedTask();
+	CHECK(Value == 1);
+	CHECK(FThreadPool::GetNumTaskAllocations() == NumAllocations);
+
+	// too large for the inline storage
+	uint64_t Large[16] = { 1, 2, 3 };
+	FTask LargeTask([&Value, Large] { Value += Large[2]; });
+	CHECK(FThreadPool::GetNumTaskAllocations() == NumAllocations + 1);
+	MovedTask = std::move(LargeTask);
+	MovedTask();
+	CHECK(Value == 4);
+
+	// move-only callable
+	std::unique_ptr<uint64_t> Pointer(new uint64_t(5));
+	FTask MoveOnlyTask([&Value, Pointer = std::move(Pointer)] { Value += *Pointer; });
+	MoveOnlyTask();
+	CHECK(Value == 9);
+}
+
+TEST_CASE("ThreadPool - EnqueueTask")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		std::vector<TTaskFuture<uint64_t>> Futures;
+		for (uint64_t Index = 0; Index < 256; Index++)
+		{
+			Futures.push_back(ThreadPool.EnqueueTask([](uint64_t A, uint64_t B) { return A * B; }, Index, uint64_t(3)));
+		}
+		uint64_t Sum = 0;
+		for (auto& Future : Futures)
+		{
+			CHECK(Future.IsValid());
+			Sum += Future.Get();
+		}
+		CHECK(Sum == 3 * 255 * 256 / 2);
+
+		std::atomic<uint64_t> Counter{ 0 };
+		TTaskFuture<void> VoidFuture = ThreadPool.EnqueueTask([&Counter] { ++Counter; });
+		VoidFuture.Wait();
+		CHECK(VoidFuture.IsReady());
+		CHECK(Counter == 1);
+
+		TTaskFuture<std::unique_ptr<uint64_t>> PointerFuture = ThreadPool.EnqueueTask([] { return std::unique_ptr<uint64_t>(new uint64_t(42)); });
+		CHECK(*PointerFuture.Get() == 42);
+
+		// a future dropped before its task ran
+		ThreadPool.EnqueueTask([] { return std::unique_ptr<uint64_t>(new uint64_t(0)); });
+	});
+}
+
+TEST_CASE("ThreadPool - EnqueueTask exceptions")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		for (uint64_t Round = 0; Round < 4; Round++)
+		{
+			TTaskFuture<uint64_t> Future = ThreadPool.EnqueueTask([]() -> uint64_t { throw std::runtime_error("task"); });
+			bool bThrown = false;
+			try
+			{
+				Future.Get();
+			}
+			catch (const std::runtime_error& Error)
+			{
+				bThrown = std::string(Error.what()) == "task";
+			}
+			CHECK(bThrown);
+
+			TTaskFuture<void> VoidFuture = ThreadPool.EnqueueTask([] { throw 7; });
+			bThrown = false;
+			try
+			{
+				VoidFuture.Get();
+			}
+			catch (int Value)
+			{
+				bThrown = Value == 7;
+			}
+			CHECK(bThrown);
+
+			// dropped before its task threw, the state is recycled all the same
+			ThreadPool.EnqueueTask([]() -> std::unique_ptr<uint64_t> { throw std::runtime_error("dropped"); });
+
+			// the recycled states still hold values
+			CHECK(ThreadPool.EnqueueTask([] { return uint64_t(5); }).Get() == 5);
+		}
+	});
+}
+
+TEST_CASE("ThreadPool - Nested EnqueueTask wait")
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		// The only worker waits for a task queued behind it, Wait() has to run it.
+		FThreadPool ThreadPool(1, Scheduler);
+		TTaskFuture<uint64_t> Outer = ThreadPool.EnqueueTask([&ThreadPool]
+		{
+			TTaskFuture<uint64_t> Inner = ThreadPool.EnqueueTask([] { return uint64_t(7); });
+			return Inner.Get() * 2;
+		});
+		CHECK(Outer.Get() == 14);
+	}
+}
+
+TEST_CASE("ThreadPool - WaitUntil wakes up for tasks enqueued later")
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		// The only worker waits for a task enqueued from outside after it went to sleep,
+		// the enqueue has to wake it up to run that task.
+		FThreadPool ThreadPool(1, Scheduler);
+		std::atomic<bool> bWaiting{ false };
+		std::atomic<bool> bDone{ false };
+		TTaskFuture<uint64_t> Outer = ThreadPool.EnqueueTask([&]
+		{
+			bWaiting = true;
+			std::mutex Mutex;
+			std::condition_variable Condition;
+			ThreadPool.WaitUntil(Mutex, Condition, [&] { return bDone.load(); });
+			return uint64_t(14);
+		});
+		while (!bWaiting)
+		{
+			std::this_thread::yield();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		// only the sleeping worker can run it: poll instead of helping with Get()
+		REQUIRE(ThreadPool.Enqueue(FTask([&bDone] { bDone = true; })));
+		while (!Outer.IsReady())
+		{
+			std::this_thread::yield();
+		}
+		CHECK(Outer.Get() == 14);
+	}
+}
+
+TEST_CASE("ThreadPool - Steady state does not allocate")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		std::vector<TTaskFuture<uint64_t>> Futures(512);
+		std::atomic<uint64_t> Counter{ 0 };
+		auto RunRound = [&]
+		{
+			for (uint64_t Index = 0; Index < Futures.size(); Index++)
+			{
+				Futures[Index] = ThreadPool.EnqueueTask([Index] { return Index; });
+			}
+			for (uint64_t Index = 0; Index < 512; Index++)
+			{
+				ThreadPool.Enqueue(FTask([&Counter] { ++Counter; }));
+			}
+			for (auto& Future : Futures)
+			{
+				Future.Get();
+			}
+			ThreadPool.ParallelFor(0, 1024, 0, [&Counter](uint64_t) { ++Counter; });
+			while (Counter % 1536 != 0)
+			{
+				// a pool without workers only runs tasks when asked to
+				ThreadPool.TryRunOneTask();
+			}
+			for (auto& Future : Futures)
+			{
+				Future.Reset();
+			}
+		};
+
+		// warm up the queues and the future state pool
+		RunRound();
+		RunRound();
+		const uint64_t NumAllocations = FThreadPool::GetNumTaskAllocations();
+		for (uint64_t Round = 0; Round < 8; Round++)
+		{
+			RunRound();
+		}
+		CHECK(FThreadPool::GetNumTaskAllocations() == NumAllocations);
+	});
+}
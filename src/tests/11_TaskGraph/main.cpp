@@ -0,0 +1,159 @@
+#include <UCommon/TaskGraph.h>
+
+#include <atomic>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <UCommon_ext/doctest/doctest.h>
+
+using namespace UCommon;
+
+static const FThreadPool::EScheduler Schedulers[] =
+{
+	FThreadPool::EScheduler::SharedQueue,
+	FThreadPool::EScheduler::WorkStealing,
+};
+
+template<typename FunctionT>
+static void ForEachPool(FunctionT&& Function)
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		for (uint64_t NumThreads : { 0, 1, 4 })
+		{
+			FThreadPool ThreadPool(NumThreads, Scheduler);
+			Function(ThreadPool);
+		}
+	}
+}
+
+TEST_CASE("TaskGraph - Chain")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		std::vector<uint64_t> Order;
+		FTaskGraph TaskGraph;
+		const uint64_t A = TaskGraph.AddNode(FTask([&Order] { Order.push_back(0); }));
+		const uint64_t B = TaskGraph.AddContinuation(A, FTask([&Order] { Order.push_back(1); }));
+		TaskGraph.AddContinuation(B, FTask([&Order] { Order.push_back(2); }));
+		CHECK(TaskGraph.GetNumNodes() == 3);
+
+		CHECK(TaskGraph.Run(ThreadPool));
+		TaskGraph.Wait();
+		CHECK_FALSE(TaskGraph.IsRunning());
+		CHECK(Order == std::vector<uint64_t>{ 0, 1, 2 });
+
+		// the graph can be run again
+		CHECK(TaskGraph.Run(ThreadPool));
+		TaskGraph.Wait();
+		CHECK(Order == std::vector<uint64_t>{ 0, 1, 2, 0, 1, 2 });
+	});
+}
+
+TEST_CASE("TaskGraph - Pipelines overlap and respect dependencies")
+{
+	// load -> convert -> mips -> encode, plus a join over every texture
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		constexpr uint64_t NumTextures = 64;
+		constexpr uint64_t NumStages = 4;
+		std::vector<std::atomic<uint64_t>> Progress(NumTextures);
+		std::atomic<uint64_t> NumErrors{ 0 };
+
+		FTaskGraph TaskGraph;
+		std::vector<uint64_t> LastStages;
+		for (uint64_t Texture = 0; Texture < NumTextures; Texture++)
+		{
+			uint64_t Node = static_cast<uint64_t>(-1);
+			for (uint64_t Stage = 0; Stage < NumStages; Stage++)
+			{
+				FTask Task([&Progress, &NumErrors, Texture, Stage]
+				{
+					if (Progress[Texture].load() != Stage)
+					{
+						++NumErrors;
+					}
+					Progress[Texture].store(Stage + 1);
+				});
+				Node = Stage == 0 ? TaskGraph.AddNode(std::move(Task)) : TaskGraph.AddContinuation(Node, std::move(Task));
+			}
+			LastStages.push_back(Node);
+		}
+		bool bAllDone = false;
+		TaskGraph.AddContinuation(TSpan<const uint64_t>(LastStages.data(), LastStages.size()), FTask([&]
+		{
+			bAllDone = true;
+			for (const auto& TextureProgress : Progress)
+			{
+				bAllDone &= TextureProgress.load() == NumStages;
+			}
+		}));
+
+		CHECK(TaskGraph.Run(ThreadPool));
+		TaskGraph.Wait();
+		CHECK(NumErrors == 0);
+		CHECK(bAllDone);
+	});
+}
+
+TEST_CASE("TaskGraph - Diamond")
+{
+	ForEachPool([](FThreadPool& ThreadPool)
+	{
+		std::atomic<uint64_t> Value{ 1 };
+		FTaskGraph TaskGraph;
+		const uint64_t Top = TaskGraph.AddNode(FTask([&Value] { Value = Value * 2; }));
+		const uint64_t Left = TaskGraph.AddNode(FTask([&Value] { Value += 10; }));
+		const uint64_t Right = TaskGraph.AddNode(FTask([&Value] { Value += 100; }));
+		const uint64_t Bottom = TaskGraph.AddNode(FTask([&Value] { Value = Value * 3; }));
+		TaskGraph.AddEdge(Top, Left);
+		TaskGraph.AddEdge(Top, Right);
+		TaskGraph.AddEdge(Left, Bottom);
+		TaskGraph.AddEdge(Right, Bottom);
+		CHECK(TaskGraph.Run(ThreadPool));
+		TaskGraph.Wait();
+		CHECK(Value == (1 * 2 + 10 + 100) * 3);
+	});
+}
+
+TEST_CASE("TaskGraph - Cycle")
+{
+	FThreadPool ThreadPool(2);
+	bool bRan = false;
+	FTaskGraph TaskGraph;
+	const uint64_t Root = TaskGraph.AddNode(FTask([&bRan] { bRan = true; }));
+	const uint64_t A = TaskGraph.AddContinuation(Root, FTask([&bRan] { bRan = true; }));
+	const uint64_t B = TaskGraph.AddContinuation(A, FTask([&bRan] { bRan = true; }));
+	TaskGraph.AddEdge(B, A);
+	CHECK_FALSE(TaskGraph.Run(ThreadPool));
+	TaskGraph.Wait();
+	CHECK_FALSE(bRan);
+
+	TaskGraph.Reset();
+	CHECK(TaskGraph.GetNumNodes() == 0);
+	CHECK(TaskGraph.Run(ThreadPool));
+	TaskGraph.Wait();
+}
+
+TEST_CASE("TaskGraph - Run from a task")
+{
+	for (FThreadPool::EScheduler Scheduler : Schedulers)
+	{
+		// the only worker waits for the inner graph and has to run its nodes itself
+		FThreadPool ThreadPool(1, Scheduler);
+		TTaskFuture<uint64_t> Future = ThreadPool.EnqueueTask([&ThreadPool]
+		{
+			std::atomic<uint64_t> Sum{ 0 };
+			FTaskGraph TaskGraph;
+			const uint64_t Root = TaskGraph.AddNode(FTask([&Sum] { Sum += 1; }));
+			for (uint64_t Index = 0; Index < 8; Index++)
+			{
+				TaskGraph.AddContinuation(Root, FTask([&Sum] { Sum += 2; }));
+			}
+			TaskGraph.Run(ThreadPool);
+			TaskGraph.Wait();
+			return Sum.load();
+		});
+		CHECK(Future.Get() == 17);
+	}
+}
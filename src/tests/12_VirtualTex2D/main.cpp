@@ -0,0 +1,250 @@
+#include <UCommon/VirtualTex2D.h>
+#include <UCommon/ThreadPool.h>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <UCommon_ext/doctest/doctest.h>
+
+using namespace UCommon;
+
+static bool FloatEqual(float A, float B, float Tolerance)
+{
+	return std::abs(A - B) < Tolerance;
+}
+
+static std::vector<char> ReadFileBytes(const char* FilePath)
+{
+	std::ifstream Ifs(FilePath, std::ifstream::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(Ifs), std::istreambuf_iterator<char>());
+}
+
+static void WriteFileBytes(const char* FilePath, const std::vector<char>& Bytes)
+{
+	std::ofstream Ofs(FilePath, std::ofstream::binary);
+	Ofs.write(Bytes.data(), (std::streamsize)Bytes.size());
+}
+
+TEST_CASE("VirtualTex2D - Tile cache")
+{
+	const FGrid2D Grid2D(37, 29);
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Float })
+	{
+		FTex2D Tex(Grid2D, 3, ElementType);
+		for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+		{
+			Tex.SetFloat(Index, (float)((Index * 37) % 101) / 100.f);
+		}
+
+		// 8x8 tiles, the budget of one tile keeps the minimum of 4
+		const uint64_t TileSizeInBytes = 8 * 8 * 3 * ElementGetSize(ElementType);
+		FVirtualTex2D VirtualTex("test_12_virtual_tex2d.bin", Grid2D, 3, ElementType, 8, TileSizeInBytes);
+		REQUIRE(VirtualTex.IsValid());
+		CHECK(VirtualTex.IsWritable());
+		CHECK(VirtualTex.GetTileGrid2D() == FGrid2D(5, 4));
+		CHECK(VirtualTex.GetNumCachedTiles() == 4);
+		CHECK(VirtualTex.GetFloat(FUint64Vector2(36, 28), 2) == 0.f);
+
+		// whole tiles are written without being read
+		VirtualTex.ResetStats();
+		VirtualTex.CopyFrom(FUint64Vector2(0, 0), Tex);
+		CHECK(VirtualTex.GetStats().NumMisses == 20);
+		CHECK(VirtualTex.GetStats().NumReads == 5 + 4 - 1);
+		CHECK(VirtualTex.GetStats().NumWriteBacks == 20 - 4);
+
+		for (uint64_t Index = 0; Index < Grid2D.GetArea(); Index++)
+		{
+			// a scattered order, to go through evictions
+			const FUint64Vector2 Point = Grid2D.GetPoint((Index * 389) % Grid2D.GetArea());
+			for (uint64_t C = 0; C < 3; C++)
+			{
+				CHECK(VirtualTex.GetFloat(Point, C) == Tex.GetFloat(Tex.GetIndex(Point, C)));
+			}
+		}
+
+		float Expected[3], Result[3];
+		for (uint64_t Index = 0; Index < 64; Index++)
+		{
+			const FVector2f Texcoord((float)Index * 0.037f - 0.4f, (float)Index * 0.029f - 0.3f);
+			for (ETextureAddress AddressMode : { ETextureAddress::Wrap, ETextureAddress::Clamp, ETextureAddress::Mirror })
+			{
+				Tex.BilinearSample(Expected, Texcoord, AddressMode, AddressMode);
+				VirtualTex.BilinearSample(Result, Texcoord, AddressMode, AddressMode);
+				for (uint64_t C = 0; C < 3; C++)
+				{
+					CHECK(FloatEqual(Result[C], Expected[C], 1e-6f));
+				}
+			}
+		}
+
+		FTex2D Crop(FGrid2D(19, 11), 3, ElementType);
+		VirtualTex.CopyTo(Crop, FUint64Vector2(7, 15));
+		for (uint64_t Y = 0; Y < 11; Y++)
+		{
+			CHECK(std::memcmp(Crop.GetView().GetRow(Y), Tex.GetView(FUint64Vector2(7, 15 + Y), FGrid2D(19, 1)).GetRow(0), Crop.GetView().GetRowSizeInBytes()) == 0);
+		}
+
+		VirtualTex.SetFloat(FUint64Vector2(20, 10), 1, 0.25f);
+		Tex.SetFloat(Tex.GetIndex(FUint64Vector2(20, 10), 1), 0.25f);
+		CHECK(VirtualTex.Flush());
+		CHECK(VirtualTex.GetStats().NumHits > 0);
+
+		// reopened with another budget, the tiles come from the file
+		VirtualTex = FVirtualTex2D();
+		FVirtualTex2D Reopened("test_12_virtual_tex2d.bin", false, 2 * TileSizeInBytes);
+		REQUIRE(Reopened.IsValid());
+		CHECK_FALSE(Reopened.IsWritable());
+		CHECK(Reopened.GetGrid2D() == Grid2D);
+		CHECK(Reopened.GetNumChannels() == 3);
+		CHECK(Reopened.GetElementType() == ElementType);
+		CHECK(Reopened.GetTileSize() == 8);
+		FTex2D Loaded(Grid2D, 3, ElementType);
+		Reopened.CopyTo(Loaded, FUint64Vector2(0, 0));
+		CHECK(std::memcmp(Loaded.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+		CHECK(Reopened.Flush());
+	}
+	CHECK_FALSE(FVirtualTex2D("test_12_missing_virtual_tex2d.bin").IsValid());
+}
+
+TEST_CASE("VirtualTex2D - Streaming operations")
+{
+	FThreadPool ThreadPool(3);
+	const FGrid2D Grid2D(45, 27);
+	FTex2D Tex(Grid2D, 2, EElementType::Float);
+	FTex2D Coverage(Grid2D, 1, EElementType::Uint8);
+	for (uint64_t Index = 0; Index < Tex.GetNumElements(); Index++)
+	{
+		Tex.At<float>(Index) = (float)((Index * 37) % 101) / 100.f;
+	}
+	for (uint64_t Index = 0; Index < Grid2D.GetArea(); Index++)
+	{
+		// holes of a few texels and one large hole
+		const FUint64Vector2 Point = Grid2D.GetPoint(Index);
+		const bool bHole = (Index * 7) % 5 == 0 || (Point.X > 10 && Point.X < 30 && Point.Y > 5 && Point.Y < 20);
+		Coverage.At<uint8_t>(Index) = bHole ? 0 : 255;
+	}
+
+	const uint64_t CacheSizeInBytes = 6 * 8 * 8 * 2 * sizeof(float);
+	FVirtualTex2D VirtualTex("test_12_virtual_tex2d.bin", Grid2D, 2, EElementType::Float, 8, CacheSizeInBytes);
+	REQUIRE(VirtualTex.IsValid());
+	VirtualTex.CopyFrom(FUint64Vector2(0, 0), Tex);
+
+	SUBCASE("DownSample")
+	{
+		FVirtualTex2D Half = VirtualTex.DownSample("test_12_virtual_tex2d_half.bin");
+		REQUIRE(Half.IsValid());
+		const FTex2D Expected = Tex.DownSample();
+		REQUIRE(Half.GetGrid2D() == Expected.GetGrid2D());
+		FTex2D Result(Expected.GetGrid2D(), 2, EElementType::Float);
+		Half.CopyTo(Result, FUint64Vector2(0, 0));
+		CHECK(std::memcmp(Result.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+
+		FVirtualTex2D Quarter = Half.DownSample("test_12_virtual_tex2d_quarter.bin");
+		CHECK(Quarter.GetGrid2D() == Expected.DownSample().GetGrid2D());
+	}
+
+	SUBCASE("Clamp")
+	{
+		VirtualTex.Clamp(0.2f, 0.7f, &ThreadPool);
+		FTex2D Expected = Tex;
+		Expected.Clamp(0.2f, 0.7f);
+		FTex2D Result(Grid2D, 2, EElementType::Float);
+		VirtualTex.CopyTo(Result, FUint64Vector2(0, 0));
+		CHECK(std::memcmp(Result.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+	}
+
+	SUBCASE("ImageInpainting")
+	{
+		FVirtualTex2D VirtualCoverage("test_12_virtual_tex2d_coverage.bin", Grid2D, 1, EElementType::Uint8, 16);
+		VirtualCoverage.CopyFrom(FUint64Vector2(0, 0), Coverage);
+
+		// a window over the whole texture is the in-memory inpainting
+		FTex2D Expected = Tex;
+		Expected.ImageInpainting(Coverage);
+		VirtualTex.ImageInpainting(VirtualCoverage, 64, &ThreadPool);
+		FTex2D Result(Grid2D, 2, EElementType::Float);
+		VirtualTex.CopyTo(Result, FUint64Vector2(0, 0));
+		CHECK(std::memcmp(Result.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+
+		// small windows keep the covered texels and fill every hole
+		VirtualTex.CopyFrom(FUint64Vector2(0, 0), Tex);
+		VirtualTex.ImageInpainting(VirtualCoverage, 4);
+		VirtualTex.CopyTo(Result, FUint64Vector2(0, 0));
+		for (uint64_t Index = 0; Index < Grid2D.GetArea(); Index++)
+		{
+			for (uint64_t C = 0; C < 2; C++)
+			{
+				const float Value = Result.At<float>(Index * 2 + C);
+				if (Coverage.At<uint8_t>(Index) != 0)
+				{
+					CHECK(Value == Tex.At<float>(Index * 2 + C));
+				}
+				else
+				{
+					CHECK((Value >= 0.f && Value <= 1.f));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("VirtualTex2D - Read-only and damaged files")
+{
+	const FGrid2D Grid2D(20, 12);
+	{
+		FVirtualTex2D VirtualTex("test_12_virtual_tex2d.bin", Grid2D, 2, EElementType::Float, 8, 0);
+		REQUIRE(VirtualTex.IsValid());
+		VirtualTex.SetFloat(FUint64Vector2(3, 4), 1, 0.5f);
+	}
+
+	SUBCASE("read-only")
+	{
+		// the cache of 4 tiles is smaller than the 6 tiles, so rejected writes would be evicted
+		FVirtualTex2D VirtualTex("test_12_virtual_tex2d.bin", false, 0);
+		REQUIRE(VirtualTex.IsValid());
+		FTex2D Ones(Grid2D, 2, EElementType::Float);
+		for (uint64_t Index = 0; Index < Ones.GetNumElements(); Index++)
+		{
+			Ones.At<float>(Index) = 1.f;
+		}
+		VirtualTex.SetFloat(FUint64Vector2(3, 4), 1, 2.f);
+		VirtualTex.CopyFrom(FUint64Vector2(0, 0), Ones);
+		VirtualTex.Clamp(0.7f, 0.8f);
+		FVirtualTex2D Coverage("test_12_virtual_tex2d_coverage.bin", Grid2D, 1, EElementType::Uint8, 8, 0);
+		VirtualTex.ImageInpainting(Coverage);
+		for (uint64_t Index = 0; Index < Grid2D.GetArea(); Index++)
+		{
+			CHECK(VirtualTex.GetFloat(Grid2D.GetPoint(Index), 0) == 0.f);
+		}
+		CHECK(VirtualTex.GetFloat(FUint64Vector2(3, 4), 1) == 0.5f);
+		CHECK_FALSE(VirtualTex.Flush());
+	}
+
+	SUBCASE("damaged header")
+	{
+		// FFileArchive header | Grid2D | NumChannels | ElementType | TileSize
+		const std::vector<char> Bytes = ReadFileBytes("test_12_virtual_tex2d.bin");
+		const uint64_t GridOffset = 16;
+		const uint64_t TileSizeOffset = GridOffset + sizeof(FGrid2D) + sizeof(uint64_t) + sizeof(EElementType);
+		auto OpenPatched = [&](uint64_t Offset, uint64_t Value)
+		{
+			std::vector<char> Patched = Bytes;
+			std::memcpy(Patched.data() + Offset, &Value, sizeof(uint64_t));
+			WriteFileBytes("test_12_virtual_tex2d_damaged.bin", Patched);
+			return FVirtualTex2D("test_12_virtual_tex2d_damaged.bin", false).IsValid();
+		};
+		CHECK(OpenPatched(TileSizeOffset, 8));
+		CHECK_FALSE(OpenPatched(TileSizeOffset, 0));
+		CHECK_FALSE(OpenPatched(TileSizeOffset, ~uint64_t(0) >> 20));
+		CHECK_FALSE(OpenPatched(GridOffset, uint64_t(1) << 40));
+		CHECK_FALSE(OpenPatched(GridOffset + sizeof(FGrid2D) + sizeof(uint64_t), 1000));
+
+		// the tiles are cut short
+		WriteFileBytes("test_12_virtual_tex2d_damaged.bin", std::vector<char>(Bytes.begin(), Bytes.begin() + (Bytes.size() - 10)));
+		CHECK_FALSE(FVirtualTex2D("test_12_virtual_tex2d_damaged.bin", false).IsValid());
+	}
+}
@@ -0,0 +1,286 @@
+#include <UCommon/Tex3D.h>
+#include <UCommon/Half.h>
+#include <UCommon/ThreadPool.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <UCommon_ext/doctest/doctest.h>
+
+using namespace UCommon;
+
+static FTex3D MakeTestTex3D(const FGrid3D& Grid3D, uint64_t NumChannels, EElementType ElementType, ETex3DStorageLayout StorageLayout = ETex3DStorageLayout::Linear)
+{
+	FTex3D Tex(Grid3D, NumChannels, ElementType, StorageLayout);
+	for (const FUint64Vector& Point : Grid3D)
+	{
+		for (uint64_t C = 0; C < NumChannels; C++)
+		{
+			Tex.SetFloat(Point, C, (float)((Point.X * 7 + Point.Y * 13 + Point.Z * 29 + C * 5) % 31) / 31.f);
+		}
+	}
+	return Tex;
+}
+
+/** Trilinear filtering of channel C in double, from the texels. */
+static double ReferenceTrilinearSample(const FTex3D& Tex, const FVector3f& Texcoord, uint64_t C, const ETextureAddress AddressModes[3])
+{
+	const FUint64Vector Extent = Tex.GetGrid3D().GetExtent();
+	int64_t Points[3];
+	double Fracs[3];
+	for (uint64_t Axis = 0; Axis < 3; Axis++)
+	{
+		const double PointT = (double)(Texcoord[Axis] * (float)Extent[Axis]) - 0.5;
+		Points[Axis] = (int64_t)std::floor(PointT);
+		Fracs[Axis] = UCommon::Clamp(PointT - std::floor(PointT), 0., 1.);
+	}
+	double Result = 0.;
+	for (uint64_t Tap = 0; Tap < 8; Tap++)
+	{
+		double Weight = 1.;
+		FUint64Vector Point;
+		for (uint64_t Axis = 0; Axis < 3; Axis++)
+		{
+			const uint64_t Bit = (Tap >> (2 - Axis)) & 1;
+			Weight *= Bit ? Fracs[Axis] : 1. - Fracs[Axis];
+			Point[Axis] = ApplyAddressMode(Points[Axis] + (int64_t)Bit, Extent[Axis], AddressModes[Axis]);
+		}
+		Result += Weight * Tex.GetFloat(Point, C);
+	}
+	return Result;
+}
+
+TEST_CASE("Tex3D - Grid and ownership")
+{
+	const FGrid3D Grid3D(5, 3, 4);
+	CHECK(Grid3D.GetVolume() == 60);
+	CHECK(Grid3D.GetNumMips() == 2);
+	CHECK(FGrid3D(64, 32, 16).GetNumMips() == 5);
+	uint64_t Index = 0;
+	for (const FUint64Vector& Point : Grid3D)
+	{
+		CHECK(Grid3D.GetIndex(Point) == Index);
+		CHECK(Grid3D.GetPoint(Index) == Point);
+		CHECK(Grid3D.GetPoint(Grid3D.GetTexcoord(Point)) == Point);
+		Index++;
+	}
+	CHECK(Index == Grid3D.GetVolume());
+
+	// Linear: slice Z is a Width x Height texture, stacked vertically in the flat FTex2D
+	FTex3D Tex = MakeTestTex3D(Grid3D, 2, EElementType::Float);
+	REQUIRE(Tex.IsValid());
+	CHECK(Tex.GetFlatTex2D().GetGrid2D() == FGrid2D(5, 12));
+	CHECK(Tex.GetStorageOwnership() == EOwnership::TakeOwnership);
+	const FConstTex2DView Slice = static_cast<const FTex3D&>(Tex).GetSliceView(2);
+	CHECK(Slice.GetGrid2D() == FGrid2D(5, 3));
+	CHECK(Slice.At<float>(FUint64Vector2(4, 1), 1) == Tex.At<float>(FUint64Vector(4, 1, 2), 1));
+	CHECK(Tex.At<FVector2f>(FUint64Vector(4, 1, 2)).Y == Tex.At<float>(FUint64Vector(4, 1, 2), 1));
+
+	// a stack of slices in one FTex2D is wrapped without copy
+	FTex2D Stack(FGrid2D(5, 12), 2, EElementType::Float);
+	std::memcpy(Stack.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes());
+	const void* StackStorage = Stack.GetStorage();
+	const FTex3D Wrapped(std::move(Stack), 4);
+	CHECK(Wrapped.GetGrid3D() == Grid3D);
+	CHECK(Wrapped.GetStorage() == StackStorage);
+	CHECK(Wrapped.GetFloat(FUint64Vector(3, 2, 1), 0) == Tex.GetFloat(FUint64Vector(3, 2, 1), 0));
+
+	// same ownership semantics as FTex2D
+	const FTex3D Copy(Tex);
+	CHECK(Copy.GetStorage() != Tex.GetStorage());
+	CHECK(std::memcmp(Copy.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+	const FTex3D Borrowed(Tex, EOwnership::DoNotTakeOwnership, nullptr);
+	CHECK(Borrowed.GetStorage() == Tex.GetStorage());
+	const FTex3D Reference(Grid3D, 2, EOwnership::DoNotTakeOwnership, EElementType::Float, Tex.GetStorage());
+	CHECK(Reference.GetFloat(FUint64Vector(1, 1, 1), 1) == Tex.GetFloat(FUint64Vector(1, 1, 1), 1));
+
+	FTex3D Target(Grid3D, 2, EElementType::Float);
+	void* TargetStorage = Target.GetStorage();
+	Target = Copy;
+	CHECK(Target.GetStorage() == TargetStorage);
+	CHECK(std::memcmp(Target.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+
+	FTex3D Moved(std::move(Tex));
+	CHECK_FALSE(Tex.IsValid());
+	CHECK(Tex.GetGrid3D() == FGrid3D());
+	CHECK(Moved.IsLayoutSameWith(Copy));
+	Moved.Reset();
+	CHECK_FALSE(Moved.IsValid());
+
+	// Bricked: 4x4x4 bricks, one per row of the flat FTex2D
+	const FTex3D Bricked = Copy.ToStorageLayout(ETex3DStorageLayout::Bricked);
+	CHECK(Bricked.GetFlatTex2D().GetGrid2D() == FGrid2D(64, 2));
+	CHECK(FTex3D::GetStorageGrid3D(Grid3D, ETex3DStorageLayout::Bricked) == FGrid3D(8, 4, 4));
+	CHECK(Bricked.GetTexelIndex(FUint64Vector(1, 1, 1)) == 7);
+	CHECK(Bricked.GetTexelIndex(FUint64Vector(2, 0, 0)) == 8);
+	CHECK(Bricked.GetTexelIndex(FUint64Vector(4, 0, 0)) == 64);
+	CHECK(Bricked.GetTexelIndex(FUint64Vector(0, 0, 2)) == 32);
+	for (const FUint64Vector& Point : Grid3D)
+	{
+		CHECK(Bricked.GetFloat(Point, 1) == Copy.GetFloat(Point, 1));
+	}
+	// padding texels are zero
+	CHECK(Bricked.GetFloat(FTex3D::GetNumElements(Grid3D, 2, ETex3DStorageLayout::Bricked) - 1) == 0.f);
+	const FTex3D Linear = Bricked.ToStorageLayout(ETex3DStorageLayout::Linear);
+	CHECK(std::memcmp(Linear.GetStorage(), Copy.GetStorage(), Copy.GetStorageSizeInBytes()) == 0);
+}
+
+TEST_CASE("Tex3D - TrilinearSample")
+{
+	// 8-lane groups plus a tail, texcoords near and far outside [0, 1] exercise the address modes
+	std::vector<FVector3f> Texcoords;
+	for (uint64_t Index = 0; Index < 64; Index++)
+	{
+		Texcoords.emplace_back((float)((Index * 29) % 67) / 64.f - 0.02f, (float)((Index * 43) % 61) / 58.f - 0.03f, (float)((Index * 17) % 53) / 50.f - 0.02f);
+	}
+	for (uint64_t Index = 0; Index < 75; Index++)
+	{
+		Texcoords.emplace_back((float)((Index * 37) % 101) / 25.f - 1.5f, (float)((Index * 53) % 89) / 22.f - 1.5f, (float)((Index * 41) % 83) / 20.f - 1.5f);
+	}
+	Texcoords.emplace_back(0.f, 1.f, 0.5f);
+	const ETextureAddress AddressModes[] = { ETextureAddress::Wrap, ETextureAddress::Clamp, ETextureAddress::Mirror };
+
+	FThreadPool ThreadPool(3);
+	const FGrid3D Grid3D(7, 6, 5);
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Half, EElementType::Float, EElementType::Double })
+	{
+		// 1 channel is gathered, 11 channels are interpolated 8 at a time plus a tail
+		for (uint64_t NumChannels : { 1, 3, 11 })
+		{
+			const FTex3D Tex = MakeTestTex3D(Grid3D, NumChannels, ElementType);
+			const FTex3D Bricked = Tex.ToStorageLayout(ETex3DStorageLayout::Bricked);
+
+			// texel centers return the texels
+			std::vector<float> Texel(NumChannels);
+			Tex.TrilinearSample(Texel.data(), Grid3D.GetTexcoord(FUint64Vector(6, 2, 3)));
+			CHECK(Texel[NumChannels - 1] == Tex.GetFloat(FUint64Vector(6, 2, 3), NumChannels - 1));
+
+			for (ETextureAddress AddressModeX : AddressModes)
+			{
+				for (ETextureAddress AddressModeZ : AddressModes)
+				{
+					const ETextureAddress AddressModeY = AddressModeX == AddressModeZ ? ETextureAddress::Mirror : ETextureAddress::Wrap;
+					const ETextureAddress Modes[3] = { AddressModeX, AddressModeY, AddressModeZ };
+					std::vector<float> Results(Texcoords.size() * NumChannels);
+					std::vector<float> ParallelResults(Texcoords.size() * NumChannels);
+					std::vector<float> BrickedResults(Texcoords.size() * NumChannels);
+					Tex.TrilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, Results.data(), AddressModeX, AddressModeY, AddressModeZ);
+					Tex.TrilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, ParallelResults.data(), AddressModeX, AddressModeY, AddressModeZ, &ThreadPool);
+					Bricked.TrilinearSampleBatch({ Texcoords.data(), Texcoords.size() }, BrickedResults.data(), AddressModeX, AddressModeY, AddressModeZ);
+					CHECK(Results == ParallelResults);
+					CHECK(Results == BrickedResults);
+
+					std::vector<float> Expected(NumChannels);
+					for (uint64_t Index = 0; Index < Texcoords.size(); Index++)
+					{
+						Tex.TrilinearSample(Expected.data(), Texcoords[Index], AddressModeX, AddressModeY, AddressModeZ);
+						for (uint64_t C = 0; C < NumChannels; C++)
+						{
+							// FMA contraction may round the texcoords differently between the two paths
+							CHECK(Results[Index * NumChannels + C] == doctest::Approx(Expected[C]).epsilon(1e-4));
+							CHECK(Expected[C] == doctest::Approx(ReferenceTrilinearSample(Tex, Texcoords[Index], C, Modes)).epsilon(1e-3));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Tex3D - Mips")
+{
+	FThreadPool ThreadPool(3);
+	for (EElementType ElementType : { EElementType::Uint8, EElementType::Float })
+	{
+		// odd extents drop the last texel, an extent of 1 is kept
+		const FTex3D Tex = MakeTestTex3D(FGrid3D(9, 6, 1), 3, ElementType);
+		const FTex3D Half = Tex.DownSample();
+		REQUIRE(Half.GetGrid3D() == FGrid3D(4, 3, 1));
+		for (const FUint64Vector& Point : Half.GetGrid3D())
+		{
+			for (uint64_t C = 0; C < 3; C++)
+			{
+				float Sum = 0.f;
+				for (uint64_t Index = 0; Index < 4; Index++)
+				{
+					Sum += Tex.GetFloat(FUint64Vector(2 * Point.X + Index % 2, 2 * Point.Y + Index / 2, 0), C);
+				}
+				CHECK(Half.GetFloat(Point, C) == doctest::Approx(Sum / 4.f).epsilon(ElementType == EElementType::Uint8 ? 1e-2 : 1e-6));
+			}
+		}
+	}
+
+	const FTex3D Tex = MakeTestTex3D(FGrid3D(12, 10, 7), 2, EElementType::Half);
+	const FTex3D Bricked = Tex.ToStorageLayout(ETex3DStorageLayout::Bricked);
+	const FTex3D Half = Tex.DownSample();
+	REQUIRE(Half.GetGrid3D() == FGrid3D(6, 5, 3));
+	float Sum = 0.f;
+	for (const FUint64Vector& Point : FGrid3D(2, 2, 2))
+	{
+		Sum += Tex.GetFloat(FUint64Vector(10, 8, 4) + Point, 1);
+	}
+	CHECK(Half.GetFloat(FUint64Vector(5, 4, 2), 1) == ElementHalfToFloat(ElementFloatToHalf(Sum / 8.f)));
+
+	// a Bricked texture gives the same texels, in parallel too
+	const FTex3D BrickedHalf = Bricked.DownSample(&ThreadPool);
+	CHECK(BrickedHalf.GetStorageLayout() == ETex3DStorageLayout::Bricked);
+	const FTex3D BrickedHalfLinear = BrickedHalf.ToStorageLayout(ETex3DStorageLayout::Linear);
+	CHECK(std::memcmp(BrickedHalfLinear.GetStorage(), Half.GetStorage(), Half.GetStorageSizeInBytes()) == 0);
+
+	for (const FTex3D* Source : { &Tex, &Bricked })
+	{
+		const FTex3DMipChain MipChain = Source->GenerateMips(&ThreadPool);
+		REQUIRE(MipChain.GetNumMips() == 3);
+		CHECK(MipChain.GetStorageLayout() == Source->GetStorageLayout());
+		CHECK(MipChain.GetMipGrid3D(2) == FGrid3D(3, 2, 1));
+		CHECK(std::memcmp(MipChain.GetMip(0).GetStorage(), Source->GetStorage(), Source->GetStorageSizeInBytes()) == 0);
+		FTex3D Expected = *Source;
+		for (uint64_t Level = 1; Level < MipChain.GetNumMips(); Level++)
+		{
+			Expected = Expected.DownSample();
+			const FTex3D Mip = MipChain.GetMip(Level);
+			CHECK(Mip.GetStorageOwnership() == EOwnership::DoNotTakeOwnership);
+			REQUIRE(Mip.IsLayoutSameWith(Expected));
+			CHECK(std::memcmp(Mip.GetStorage(), Expected.GetStorage(), Expected.GetStorageSizeInBytes()) == 0);
+		}
+	}
+}
+
+TEST_CASE("Tex3D - Serialize")
+{
+	const FTex3D Tex = MakeTestTex3D(FGrid3D(6, 5, 3), 4, EElementType::Float);
+	for (ETex3DStorageLayout StorageLayout : { ETex3DStorageLayout::Linear, ETex3DStorageLayout::Bricked })
+	{
+		FTex3D Saved = Tex.ToStorageLayout(StorageLayout);
+		FMemoryArchive Writer;
+		Saved.Serialize(Writer);
+
+		// always Linear, the slices are a serialized FTex2D
+		FMemoryArchive Reader(Writer.GetStorage());
+		FTex3D Loaded;
+		Loaded.Serialize(Reader);
+		REQUIRE(Loaded.IsLayoutSameWith(Tex));
+		CHECK(std::memcmp(Loaded.GetStorage(), Tex.GetStorage(), Tex.GetStorageSizeInBytes()) == 0);
+	}
+}
+
+TEST_CASE("Tex3D - Serialize inconsistent archive")
+{
+	const FTex3D Tex = MakeTestTex3D(FGrid3D(6, 5, 3), 2, EElementType::Float);
+	FMemoryArchive Writer;
+	FTex3D(Tex).Serialize(Writer);
+
+	// a Depth that doesn't match the slices
+	std::vector<uint8_t> Bytes(Writer.GetStorage().begin(), Writer.GetStorage().end());
+	const uint64_t Depth = 4;
+	std::memcpy(Bytes.data() + offsetof(FGrid3D, Depth), &Depth, sizeof(uint64_t));
+
+	FMemoryArchive Reader(TSpan<const uint8_t>(Bytes.data(), Bytes.size()));
+	FTex3D Loaded;
+	Loaded.Serialize(Reader);
+	CHECK_FALSE(Loaded.IsValid());
+	CHECK(Loaded.GetGrid3D() == FGrid3D());
+}